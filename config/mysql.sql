@@ -23,6 +23,11 @@ CREATE TABLE `mt_cds_object` (
   `flags` int(11) unsigned NOT NULL default '1',
   `track_number` int(11) default NULL,
   `service_id` varchar(255) default NULL,
+  `upnp_artist` varchar(255) default NULL,
+  `upnp_album` varchar(255) default NULL,
+  `upnp_genre` varchar(255) default NULL,
+  `dc_date` varchar(255) default NULL,
+  `path_key` varchar(767) CHARACTER SET ascii COLLATE ascii_bin default NULL,
   PRIMARY KEY  (`id`),
   KEY `cds_object_ref_id` (`ref_id`),
   KEY `cds_object_parent_id` (`parent_id`,`object_type`,`dc_title`),
@@ -30,26 +35,31 @@ CREATE TABLE `mt_cds_object` (
   KEY `location_parent` (`location_hash`,`parent_id`),
   KEY `cds_object_track_number` (`track_number`),
   KEY `cds_object_service_id` (`service_id`),
-  CONSTRAINT `mt_cds_object_ibfk_1` FOREIGN KEY (`ref_id`) REFERENCES `mt_cds_object` (`id`) ON DELETE CASCADE ON UPDATE CASCADE,
-  CONSTRAINT `mt_cds_object_ibfk_2` FOREIGN KEY (`parent_id`) REFERENCES `mt_cds_object` (`id`) ON DELETE CASCADE ON UPDATE CASCADE
-) ENGINE=MyISAM CHARSET=utf8;
-INSERT INTO `mt_cds_object` VALUES (-1,NULL,-1,0,NULL,NULL,NULL,NULL,NULL,NULL,NULL,0,NULL,9,NULL,NULL);
-INSERT INTO `mt_cds_object` VALUES (0,NULL,-1,1,'object.container','Root',NULL,NULL,NULL,NULL,NULL,0,NULL,9,NULL,NULL);
+  KEY `cds_object_upnp_artist` (`upnp_artist`),
+  KEY `cds_object_upnp_album` (`upnp_album`),
+  KEY `cds_object_upnp_genre` (`upnp_genre`),
+  KEY `cds_object_dc_date` (`dc_date`),
+  KEY `cds_object_path_key` (`path_key`)
+) ENGINE=InnoDB CHARSET=utf8;
+INSERT INTO `mt_cds_object` VALUES (-1,NULL,-1,0,NULL,NULL,NULL,NULL,NULL,NULL,NULL,0,NULL,9,NULL,NULL,NULL,NULL,NULL,NULL,NULL);
+INSERT INTO `mt_cds_object` VALUES (0,NULL,-1,1,'object.container','Root',NULL,NULL,NULL,NULL,NULL,0,NULL,9,NULL,NULL,NULL,NULL,NULL,NULL,',');
 UPDATE `mt_cds_object` SET `id`='0' WHERE `id`='1';
-INSERT INTO `mt_cds_object` VALUES (1,NULL,0,1,'object.container','PC Directory',NULL,NULL,NULL,NULL,NULL,0,NULL,9,NULL,NULL);
+INSERT INTO `mt_cds_object` VALUES (1,NULL,0,1,'object.container','PC Directory',NULL,NULL,NULL,NULL,NULL,0,NULL,9,NULL,NULL,NULL,NULL,NULL,NULL,',1,');
 CREATE TABLE `mt_cds_active_item` (
   `id` int(11) NOT NULL,
   `action` varchar(255) NOT NULL,
   `state` varchar(255) NOT NULL,
-  PRIMARY KEY  (`id`),
-  CONSTRAINT `mt_cds_active_item_ibfk_1` FOREIGN KEY (`id`) REFERENCES `mt_cds_object` (`id`) ON DELETE CASCADE ON UPDATE CASCADE
-) ENGINE=MyISAM CHARSET=utf8;
+  PRIMARY KEY  (`id`)
+) ENGINE=InnoDB CHARSET=utf8;
 CREATE TABLE `mt_internal_setting` (
   `key` varchar(40) NOT NULL,
   `value` varchar(255) NOT NULL,
   PRIMARY KEY  (`key`)
-) ENGINE=MyISAM CHARSET=utf8;
-INSERT INTO `mt_internal_setting` VALUES ('db_version','5');
+) ENGINE=InnoDB CHARSET=utf8;
+INSERT INTO `mt_internal_setting` VALUES ('db_version','12');
+INSERT INTO `mt_internal_setting` VALUES ('migration_metadata_dictionary','1');
+INSERT INTO `mt_internal_setting` VALUES ('migration_metadata_columns','1');
+INSERT INTO `mt_internal_setting` VALUES ('migration_path_keys','1');
 CREATE TABLE `mt_autoscan` (
   `id` int(11) NOT NULL auto_increment,
   `obj_id` int(11) default NULL,
@@ -64,18 +74,56 @@ CREATE TABLE `mt_autoscan` (
   `path_ids` blob,
   `touched` tinyint(4) unsigned NOT NULL default '1',
   PRIMARY KEY `id` (`id`),
-  UNIQUE KEY `mt_autoscan_obj_id` (`obj_id`),
-  CONSTRAINT `mt_autoscan_ibfk_1` FOREIGN KEY (`obj_id`) REFERENCES `mt_cds_object` (`id`) ON DELETE CASCADE ON UPDATE CASCADE
-) ENGINE=MyISAM CHARSET=utf8;
+  UNIQUE KEY `mt_autoscan_obj_id` (`obj_id`)
+) ENGINE=InnoDB CHARSET=utf8;
+CREATE TABLE `mt_metadata_property` (
+  `id` int(11) NOT NULL auto_increment,
+  `name` varchar(255) NOT NULL,
+  PRIMARY KEY `id` (`id`),
+  UNIQUE KEY `metadata_property_name` (`name`)
+) ENGINE=InnoDB CHARSET=utf8 COLLATE=utf8_bin;
+CREATE TABLE `mt_metadata_value` (
+  `id` int(11) NOT NULL auto_increment,
+  `value_hash` int(11) unsigned NOT NULL,
+  `value` text NOT NULL,
+  PRIMARY KEY `id` (`id`),
+  UNIQUE KEY `metadata_value_hash` (`value_hash`,`value`(255))
+) ENGINE=InnoDB CHARSET=utf8 COLLATE=utf8_bin;
 CREATE TABLE `mt_metadata` (
   `id` int(11) NOT NULL auto_increment,
   `item_id` int(11) NOT NULL,
-  `property_name` varchar(255) NOT NULL,
-  `property_value` text NOT NULL,
+  `property_id` int(11) NOT NULL,
+  `value_id` int(11) NOT NULL,
   PRIMARY KEY `id` (`id`),
   KEY `metadata_item_id` (`item_id`),
-  CONSTRAINT `mt_metadata_idfk1` FOREIGN KEY (`item_id`) REFERENCES `mt_cds_object` (`id`) ON DELETE CASCADE ON UPDATE CASCADE
-) ENGINE=MyISAM CHARSET=utf8;
+  KEY `metadata_value_id` (`value_id`,`property_id`)
+) ENGINE=InnoDB CHARSET=utf8;
+CREATE VIEW `mt_metadata_view` AS SELECT `m`.`id`, `m`.`item_id`, `p`.`name` AS `property_name`, `v`.`value` AS `property_value`, `v`.`value_hash`
+  FROM `mt_metadata` `m` JOIN `mt_metadata_property` `p` ON `p`.`id` = `m`.`property_id` JOIN `mt_metadata_value` `v` ON `v`.`id` = `m`.`value_id`;
+CREATE TABLE `mt_service_state` (
+  `object_id` int(11) NOT NULL,
+  `service_prefix` char(1) NOT NULL,
+  `service_id` varchar(255) NOT NULL,
+  `content_hash` varchar(16) NOT NULL default '',
+  `last_seen` bigint(20) unsigned NOT NULL default '0',
+  PRIMARY KEY `object_id` (`object_id`),
+  KEY `service_state_seen` (`service_prefix`,`last_seen`)
+) ENGINE=InnoDB CHARSET=utf8;
+CREATE TABLE `mt_sequence` (
+  `name` varchar(40) NOT NULL,
+  `next_id` int(11) NOT NULL,
+  PRIMARY KEY  (`name`)
+) ENGINE=InnoDB CHARSET=utf8;
+INSERT INTO `mt_sequence` VALUES ('object',2);
+INSERT INTO `mt_sequence` VALUES ('metadata',1);
+CREATE TABLE `mt_change_log` (
+  `id` int(11) NOT NULL auto_increment,
+  `container_id` int(11) NOT NULL,
+  `update_id` int(11) NOT NULL,
+  `changed` bigint(20) unsigned NOT NULL,
+  PRIMARY KEY  (`id`),
+  KEY `change_log_changed` (`changed`)
+) ENGINE=InnoDB CHARSET=utf8;
 /*!40101 SET SQL_MODE=@OLD_SQL_MODE */;
 /*!40014 SET FOREIGN_KEY_CHECKS=@OLD_FOREIGN_KEY_CHECKS */;
 /*!40014 SET UNIQUE_CHECKS=@OLD_UNIQUE_CHECKS */;
@@ -16,12 +16,17 @@ CREATE TABLE "mt_cds_object" (
   "flags" integer unsigned NOT NULL default 1,
   "track_number" integer default NULL,
   "service_id" varchar(255) default NULL,
+  "upnp_artist" varchar(255) default NULL COLLATE NOCASE,
+  "upnp_album" varchar(255) default NULL COLLATE NOCASE,
+  "upnp_genre" varchar(255) default NULL COLLATE NOCASE,
+  "dc_date" varchar(255) default NULL COLLATE NOCASE,
+  "path_key" varchar(767) default NULL,
   CONSTRAINT "cds_object_ibfk_1" FOREIGN KEY ("ref_id") REFERENCES "mt_cds_object" ("id") ON DELETE CASCADE ON UPDATE CASCADE,
   CONSTRAINT "cds_object_ibfk_2" FOREIGN KEY ("parent_id") REFERENCES "mt_cds_object" ("id") ON DELETE CASCADE ON UPDATE CASCADE
 );
-INSERT INTO "mt_cds_object" VALUES(-1, NULL, -1, 0, NULL, NULL, NULL, NULL, NULL, NULL, NULL, 0, NULL, 9, NULL, NULL);
-INSERT INTO "mt_cds_object" VALUES(0, NULL, -1, 1, 'object.container', 'Root', NULL, NULL, NULL, NULL, NULL, 0, NULL, 9, NULL, NULL);
-INSERT INTO "mt_cds_object" VALUES(1, NULL, 0, 1, 'object.container', 'PC Directory', NULL, NULL, NULL, NULL, NULL, 0, NULL, 9, NULL, NULL);
+INSERT INTO "mt_cds_object" VALUES(-1, NULL, -1, 0, NULL, NULL, NULL, NULL, NULL, NULL, NULL, 0, NULL, 9, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+INSERT INTO "mt_cds_object" VALUES(0, NULL, -1, 1, 'object.container', 'Root', NULL, NULL, NULL, NULL, NULL, 0, NULL, 9, NULL, NULL, NULL, NULL, NULL, NULL, ',');
+INSERT INTO "mt_cds_object" VALUES(1, NULL, 0, 1, 'object.container', 'PC Directory', NULL, NULL, NULL, NULL, NULL, 0, NULL, 9, NULL, NULL, NULL, NULL, NULL, NULL, ',1,');
 CREATE TABLE "mt_cds_active_item" (
   "id" integer primary key,
   "action" varchar(255) NOT NULL,
@@ -32,7 +37,10 @@ CREATE TABLE "mt_internal_setting" (
   "key" varchar(40) primary key NOT NULL,
   "value" varchar(255) NOT NULL
 );
-INSERT INTO "mt_internal_setting" VALUES('db_version', '5');
+INSERT INTO "mt_internal_setting" VALUES('db_version', '11');
+INSERT INTO "mt_internal_setting" VALUES('migration_metadata_dictionary', '1');
+INSERT INTO "mt_internal_setting" VALUES('migration_metadata_columns', '1');
+INSERT INTO "mt_internal_setting" VALUES('migration_path_keys', '1');
 CREATE TABLE "mt_autoscan" (
   "id" integer primary key,
   "obj_id" integer default NULL,
@@ -48,13 +56,44 @@ CREATE TABLE "mt_autoscan" (
   "touched" tinyint unsigned NOT NULL default '1',
   CONSTRAINT "mt_autoscan_id" FOREIGN KEY ("obj_id") REFERENCES "mt_cds_object" ("id") ON DELETE CASCADE ON UPDATE CASCADE
 );
+CREATE TABLE "mt_metadata_property" (
+  "id" integer primary key,
+  "name" varchar(255) NOT NULL
+);
+CREATE TABLE "mt_metadata_value" (
+  "id" integer primary key,
+  "value_hash" integer unsigned NOT NULL,
+  "value" text NOT NULL
+);
 CREATE TABLE "mt_metadata" (
   "id" integer primary key,
   "item_id" integer NOT NULL,
-  "property_name" varchar(255) NOT NULL,
-  "property_value" text NOT NULL,
+  "property_id" integer NOT NULL,
+  "value_id" integer NOT NULL,
   CONSTRAINT "mt_metadata_idfk1" FOREIGN KEY ("item_id") REFERENCES "mt_cds_object" ("id") ON DELETE CASCADE ON UPDATE CASCADE
 );
+CREATE VIEW "mt_metadata_view" AS SELECT m.id, m.item_id, p.name AS property_name, v.value AS property_value, v.value_hash
+  FROM mt_metadata m JOIN mt_metadata_property p ON p.id = m.property_id JOIN mt_metadata_value v ON v.id = m.value_id;
+CREATE TABLE "mt_service_state" (
+  "object_id" integer primary key,
+  "service_prefix" char(1) NOT NULL,
+  "service_id" varchar(255) NOT NULL,
+  "content_hash" varchar(16) NOT NULL default '',
+  "last_seen" integer unsigned NOT NULL default 0,
+  CONSTRAINT "mt_service_state_ibfk_1" FOREIGN KEY ("object_id") REFERENCES "mt_cds_object" ("id") ON DELETE CASCADE ON UPDATE CASCADE
+);
+CREATE TABLE "mt_sequence" (
+  "name" varchar(40) primary key NOT NULL,
+  "next_id" integer NOT NULL
+);
+INSERT INTO "mt_sequence" VALUES('object', 2);
+INSERT INTO "mt_sequence" VALUES('metadata', 1);
+CREATE TABLE "mt_change_log" (
+  "id" integer primary key autoincrement,
+  "container_id" integer NOT NULL,
+  "update_id" integer NOT NULL,
+  "changed" integer unsigned NOT NULL
+);
 CREATE INDEX mt_cds_object_ref_id ON mt_cds_object(ref_id);
 CREATE INDEX mt_cds_object_parent_id ON mt_cds_object(parent_id,object_type,dc_title);
 CREATE INDEX mt_object_type ON mt_cds_object(object_type);
@@ -63,5 +102,15 @@ CREATE INDEX mt_track_number ON mt_cds_object(track_number);
 CREATE INDEX mt_internal_setting_key ON mt_internal_setting(key);
 CREATE UNIQUE INDEX mt_autoscan_obj_id ON mt_autoscan(obj_id);
 CREATE INDEX mt_cds_object_service_id ON mt_cds_object(service_id);
+CREATE INDEX mt_cds_object_upnp_artist ON mt_cds_object(upnp_artist);
+CREATE INDEX mt_cds_object_upnp_album ON mt_cds_object(upnp_album);
+CREATE INDEX mt_cds_object_upnp_genre ON mt_cds_object(upnp_genre);
+CREATE INDEX mt_cds_object_dc_date ON mt_cds_object(dc_date);
+CREATE INDEX mt_cds_object_path_key ON mt_cds_object(path_key);
 CREATE INDEX mt_metadata_item_id ON mt_metadata(item_id);
+CREATE INDEX mt_metadata_value_id ON mt_metadata(value_id,property_id);
+CREATE UNIQUE INDEX mt_metadata_property_name ON mt_metadata_property(name);
+CREATE UNIQUE INDEX mt_metadata_value_hash ON mt_metadata_value(value_hash,value);
+CREATE INDEX mt_service_state_seen ON mt_service_state(service_prefix,last_seen);
+CREATE INDEX mt_change_log_changed ON mt_change_log(changed);
 COMMIT;
@@ -31,6 +31,8 @@
 
 #include "action_request.h"
 
+#include <netdb.h>
+
 using namespace zmm;
 using namespace mxml;
 
@@ -45,6 +47,12 @@ ActionRequest::ActionRequest(UpnpActionRequest* upnp_request)
     std::string xml = cxml;
     ixmlFreeDOMString(cxml);
 
+    auto addr = UpnpActionRequest_get_CtrlPtIPAddr(upnp_request);
+    char host[NI_MAXHOST];
+    if (addr != nullptr && addr->ss_family != AF_UNSPEC
+        && getnameinfo(reinterpret_cast<const struct sockaddr*>(addr), sizeof(struct sockaddr_storage), host, sizeof(host), nullptr, 0, NI_NUMERICHOST) == 0)
+        client = host;
+
     Ref<Parser> parser(new Parser());
 
     request = parser->parseString(xml)->getRoot();
@@ -62,6 +70,10 @@ std::string ActionRequest::getServiceID()
 {
     return serviceID;
 }
+std::string ActionRequest::getClient()
+{
+    return client;
+}
 Ref<Element> ActionRequest::getRequest()
 {
     return request;
@@ -67,6 +67,11 @@ protected:
     /// Returned by getServiceID()
     std::string serviceID;
 
+    /// \brief Address of the control point that sent the request.
+    ///
+    /// Returned by getClient()
+    std::string client;
+
     /// \brief XML holding the request that comes to us.
     ///
     /// Returned by getRequest()
@@ -91,6 +96,10 @@ public:
     /// \brief Returns the ID of the service (the action is for this service id)
     std::string getServiceID();
 
+    /// \brief Returns the numeric address of the requesting control point,
+    /// an empty string if it is unknown.
+    std::string getClient();
+
     /// \brief Returns the XML representation of the request.
     zmm::Ref<mxml::Element> getRequest();
 
@@ -74,16 +74,46 @@ void AutoscanDirectory::setCurrentLMT(time_t lmt)
 
 AutoscanList::AutoscanList(std::shared_ptr<Storage> storage)
     : storage(storage)
+    , snapshot(std::make_shared<Snapshot>())
 {
-    list = Ref<Array<AutoscanDirectory>>(new Array<AutoscanDirectory>());
+}
+
+std::string AutoscanList::normalizeLocation(std::string location)
+{
+    while (location.length() > 1 && location.back() == '/')
+        location.pop_back();
+    return location;
+}
+
+void AutoscanList::publish(std::vector<Ref<AutoscanDirectory>> list)
+{
+    auto next = std::make_shared<Snapshot>();
+    for (auto& dir : list) {
+        if (dir == nullptr)
+            continue;
+        next->byObjectID[dir->getObjectID()] = dir;
+        next->byLocation[normalizeLocation(dir->getLocation())] = dir;
+    }
+    next->byScanID = std::move(list);
+    std::atomic_store(&snapshot, std::shared_ptr<const Snapshot>(next));
+}
+
+void AutoscanList::removeAt(std::vector<Ref<AutoscanDirectory>>& list, size_t index)
+{
+    list[index]->setScanID(INVALID_SCAN_ID);
+    // keep the scan IDs of the following directories
+    if (index == list.size() - 1)
+        list.pop_back();
+    else
+        list[index] = nullptr;
 }
 
 void AutoscanList::updateLMinDB()
 {
-    AutoLock lock(mutex);
-    for (int i = 0; i < list->size(); i++) {
-        log_debug("i: %d\n", i);
-        Ref<AutoscanDirectory> ad = list->get(i);
+    auto current = load();
+    for (size_t i = 0; i < current->byScanID.size(); i++) {
+        log_debug("i: %zu\n", i);
+        Ref<AutoscanDirectory> ad = current->byScanID[i];
         if (ad != nullptr)
             storage->autoscanUpdateLM(ad);
     }
@@ -92,32 +122,35 @@ void AutoscanList::updateLMinDB()
 int AutoscanList::add(Ref<AutoscanDirectory> dir)
 {
     AutoLock lock(mutex);
-    return _add(dir);
+    auto list = load()->byScanID;
+    int scanID = _add(list, dir);
+    publish(std::move(list));
+    return scanID;
 }
 
-int AutoscanList::_add(Ref<AutoscanDirectory> dir)
+int AutoscanList::_add(std::vector<Ref<AutoscanDirectory>>& list, Ref<AutoscanDirectory> dir)
 {
 
-    std::string loc = dir->getLocation();
+    std::string loc = normalizeLocation(dir->getLocation());
     int nil_index = -1;
 
-    for (int i = 0; i < list->size(); i++) {
-        if (list->get(i) == nullptr) {
+    for (size_t i = 0; i < list.size(); i++) {
+        if (list[i] == nullptr) {
             nil_index = i;
             continue;
         }
 
-        if (loc == list->get(i)->getLocation()) {
+        if (loc == normalizeLocation(list[i]->getLocation())) {
             throw _Exception("Attempted to add same autoscan path twice");
         }
     }
 
     if (nil_index != -1) {
         dir->setScanID(nil_index);
-        list->set(dir, nil_index);
+        list[nil_index] = dir;
     } else {
-        dir->setScanID(list->size());
-        list->append(dir);
+        dir->setScanID(list.size());
+        list.push_back(dir);
     }
 
     return dir->getScanID();
@@ -126,73 +159,74 @@ int AutoscanList::_add(Ref<AutoscanDirectory> dir)
 void AutoscanList::addList(zmm::Ref<AutoscanList> list)
 {
     AutoLock lock(mutex);
+    auto copy = load()->byScanID;
 
-    for (int i = 0; i < list->list->size(); i++) {
-        if (list->list->get(i) == nullptr)
+    for (auto& dir : list->load()->byScanID) {
+        if (dir == nullptr)
             continue;
 
-        _add(list->list->get(i));
+        _add(copy, dir);
     }
+    publish(std::move(copy));
 }
 
 Ref<Array<AutoscanDirectory>> AutoscanList::getArrayCopy()
 {
-    AutoLock lock(mutex);
-    Ref<Array<AutoscanDirectory>> copy(new Array<AutoscanDirectory>(list->size()));
-    for (int i = 0; i < list->size(); i++)
-        copy->append(list->get(i));
+    auto current = load();
+    Ref<Array<AutoscanDirectory>> copy(new Array<AutoscanDirectory>(current->byScanID.size()));
+    for (auto& dir : current->byScanID)
+        copy->append(dir);
 
     return copy;
 }
 
 Ref<AutoscanDirectory> AutoscanList::get(int id)
 {
-    AutoLock lock(mutex);
+    auto current = load();
 
-    if ((id < 0) || (id >= list->size()))
+    if ((id < 0) || (id >= int(current->byScanID.size())))
         return nullptr;
 
-    return list->get(id);
+    return current->byScanID[id];
 }
 
 Ref<AutoscanDirectory> AutoscanList::getByObjectID(int objectID)
 {
-    AutoLock lock(mutex);
+    auto current = load();
 
-    for (int i = 0; i < list->size(); i++) {
-        if (list->get(i) != nullptr && objectID == list->get(i)->getObjectID())
-            return list->get(i);
+    auto it = current->byObjectID.find(objectID);
+    if (it != current->byObjectID.end() && it->second->getObjectID() == objectID)
+        return it->second;
+
+    // the object ID was changed after the snapshot was taken
+    for (auto& dir : current->byScanID) {
+        if (dir != nullptr && objectID == dir->getObjectID())
+            return dir;
     }
     return nullptr;
 }
 
 Ref<AutoscanDirectory> AutoscanList::get(std::string location)
 {
-    AutoLock lock(mutex);
-    for (int i = 0; i < list->size(); i++) {
-        if (list->get(i) != nullptr && (location == list->get(i)->getLocation()))
-            return list->get(i);
-    }
-    return nullptr;
+    auto current = load();
+    auto it = current->byLocation.find(normalizeLocation(location));
+    if (it == current->byLocation.end())
+        return nullptr;
+    return it->second;
 }
 
 void AutoscanList::remove(int id)
 {
     AutoLock lock(mutex);
+    auto list = load()->byScanID;
 
-    if ((id < 0) || (id >= list->size())) {
+    if ((id < 0) || (id >= int(list.size())) || list[id] == nullptr) {
         log_debug("No such ID %d!\n", id);
         return;
     }
 
-    Ref<AutoscanDirectory> dir = list->get(id);
-    dir->setScanID(INVALID_SCAN_ID);
-
-    if (id == list->size() - 1) {
-        list->removeUnordered(id);
-    } else {
-        list->set(nullptr, id);
-    }
+    removeAt(list, id);
+    publish(std::move(list));
 
     log_debug("ID %d removed!\n", id);
 }
@@ -200,68 +234,55 @@ void AutoscanList::remove(int id)
 int AutoscanList::removeByObjectID(int objectID)
 {
     AutoLock lock(mutex);
-
-    for (int i = 0; i < list->size(); i++) {
-        if (list->get(i) != nullptr && objectID == list->get(i)->getObjectID()) {
-            Ref<AutoscanDirectory> dir = list->get(i);
-            dir->setScanID(INVALID_SCAN_ID);
-            if (i == list->size() - 1) {
-                list->removeUnordered(i);
-            } else {
-                list->set(nullptr, i);
-            }
-            return i;
-        }
-    }
-    return INVALID_SCAN_ID;
+    Ref<AutoscanDirectory> dir = getByObjectID(objectID);
+    if (dir == nullptr)
+        return INVALID_SCAN_ID;
+
+    int scanID = dir->getScanID();
+    auto list = load()->byScanID;
+    removeAt(list, scanID);
+    publish(std::move(list));
+    return scanID;
 }
 
 int AutoscanList::remove(std::string location)
 {
     AutoLock lock(mutex);
-
-    for (int i = 0; i < list->size(); i++) {
-        if (list->get(i) != nullptr && location == list->get(i)->getLocation()) {
-            Ref<AutoscanDirectory> dir = list->get(i);
-            dir->setScanID(INVALID_SCAN_ID);
-            if (i == list->size() - 1) {
-                list->removeUnordered(i);
-            } else {
-                list->set(nullptr, i);
-            }
-            return i;
-        }
-    }
-    return INVALID_SCAN_ID;
+    Ref<AutoscanDirectory> dir = get(location);
+    if (dir == nullptr)
+        return INVALID_SCAN_ID;
+
+    int scanID = dir->getScanID();
+    auto list = load()->byScanID;
+    removeAt(list, scanID);
+    publish(std::move(list));
+    return scanID;
 }
 
 Ref<AutoscanList> AutoscanList::removeIfSubdir(std::string parent, bool persistent)
 {
     AutoLock lock(mutex);
+    auto current = load();
+    auto list = current->byScanID;
 
     Ref<AutoscanList> rm_id_list(new AutoscanList(storage));
 
-    for (int i = 0; i < list->size(); i++) {
-        if (list->get(i) != nullptr && startswith(list->get(i)->getLocation(), parent)) {
-            Ref<AutoscanDirectory> dir = list->get(i);
-            if (dir == nullptr)
-                continue;
-            if (dir->persistent() && !persistent) {
-                continue;
-            }
-            Ref<AutoscanDirectory> copy(new AutoscanDirectory());
-            dir->copyTo(copy);
-            rm_id_list->add(copy);
-            copy->setScanID(dir->getScanID());
-            dir->setScanID(INVALID_SCAN_ID);
-            if (i == list->size() - 1) {
-                list->removeUnordered(i);
-            } else {
-                list->set(nullptr, i);
-            }
+    // the locations below parent follow it in the sorted index
+    for (auto it = current->byLocation.lower_bound(parent); it != current->byLocation.end() && startswith(it->first, parent); ++it) {
+        Ref<AutoscanDirectory> dir = it->second;
+        if (dir->persistent() && !persistent) {
+            continue;
         }
+        Ref<AutoscanDirectory> copy(new AutoscanDirectory());
+        dir->copyTo(copy);
+        rm_id_list->add(copy);
+        int scanID = dir->getScanID();
+        copy->setScanID(scanID);
+        removeAt(list, scanID);
     }
 
+    if (rm_id_list->size() > 0)
+        publish(std::move(list));
     return rm_id_list;
 }
 
@@ -269,12 +290,11 @@ void AutoscanList::notifyAll(Timer::Subscriber* sub)
 {
     if (sub == nullptr)
         return;
-    AutoLock lock(mutex);
 
-    for (int i = 0; i < list->size(); i++) {
-        if (list->get(i) == nullptr)
+    for (auto& dir : load()->byScanID) {
+        if (dir == nullptr)
             continue;
-        sub->timerNotify(list->get(i)->getTimerParameter());
+        sub->timerNotify(dir->getTimerParameter());
     }
 }
 
@@ -35,7 +35,11 @@
 
 #include "util/timer.h"
 #include "zmm/zmmf.h"
+#include <map>
+#include <memory>
 #include <mutex>
+#include <unordered_map>
+#include <vector>
 
 #define INVALID_SCAN_ID -1
 
@@ -55,6 +59,11 @@ enum class ScanMode {
 class Storage;
 class AutoscanDirectory;
 
+/// \brief The autoscan directories of one scan mode.
+///
+/// Lookups work on an immutable snapshot of the list that is indexed by
+/// scan ID, object ID and location, so they never wait for a writer.
+/// Every change copies the list, updates the copy and publishes it.
 class AutoscanList : public zmm::Object {
 public:
     AutoscanList(std::shared_ptr<Storage> storage);
@@ -76,7 +85,7 @@ public:
 
     zmm::Ref<AutoscanDirectory> getByObjectID(int objectID);
 
-    int size() { return list->size(); }
+    int size() { return int(load()->byScanID.size()); }
 
     /// \brief removes the AutoscanDirectory given by its scan ID
     void remove(int id);
@@ -123,13 +132,35 @@ public:
 */
 
 protected:
+    struct Snapshot {
+        /// \brief indexed by scan ID, removed directories leave a gap
+        std::vector<zmm::Ref<AutoscanDirectory>> byScanID;
+        /// \brief object IDs at the time of the snapshot, they may change later
+        std::unordered_map<int, zmm::Ref<AutoscanDirectory>> byObjectID;
+        /// \brief sorted by normalized location for prefix lookups
+        std::map<std::string, zmm::Ref<AutoscanDirectory>> byLocation;
+    };
+
     std::shared_ptr<Storage> storage;
 
-    std::recursive_mutex mutex;
-    using AutoLock = std::lock_guard<std::recursive_mutex>;
+    /// \brief serializes writers, readers only load the snapshot
+    std::mutex mutex;
+    using AutoLock = std::lock_guard<std::mutex>;
+
+    std::shared_ptr<const Snapshot> snapshot;
+
+    std::shared_ptr<const Snapshot> load() const { return std::atomic_load(&snapshot); }
+
+    /// \brief Builds the indexes of the new list and replaces the snapshot.
+    /// Must be called with the mutex held.
+    void publish(std::vector<zmm::Ref<AutoscanDirectory>> list);
+
+    /// \brief Removes the directory at the given position of a list copy.
+    static void removeAt(std::vector<zmm::Ref<AutoscanDirectory>>& list, size_t index);
+
+    static int _add(std::vector<zmm::Ref<AutoscanDirectory>>& list, zmm::Ref<AutoscanDirectory> dir);
 
-    zmm::Ref<zmm::Array<AutoscanDirectory>> list;
-    int _add(zmm::Ref<AutoscanDirectory> dir);
+    static std::string normalizeLocation(std::string location);
 };
 
 /// \brief Provides information about one autoscan directory.
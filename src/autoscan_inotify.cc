@@ -35,6 +35,7 @@
 
 #include "autoscan_inotify.h"
 #include "content_manager.h"
+#include "metadata/subtitle_handler.h"
 #include "storage/storage.h"
 
 #include <dirent.h>
@@ -232,6 +233,8 @@ void AutoscanInotify::threadProc()
                         if (mask & IN_ISDIR)
                             monitorUnmonitorRecursive(path, false, adir, watchAs->getNormalizedAutoscanPath(), false);
                     }
+                    if (!(mask & IN_ISDIR) && mask & (IN_DELETE | IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO) && SubtitleHandler::isSubtitle(path))
+                        content->updateSubtitles(path);
                 }
                 if (mask & IN_IGNORED) {
                     removeWatchMoves(wd);
@@ -81,7 +81,7 @@ int CdsObject::equals(std::shared_ptr<CdsObject> obj, bool exactly)
     if (!resourcesEqual(obj))
         return 0;
 
-    if (!std::equal(metadata.begin(), metadata.end(), obj->getMetadata().begin()))
+    if (metadata != obj->metadata)
         return 0;
 
     if (exactly
@@ -89,7 +89,7 @@ int CdsObject::equals(std::shared_ptr<CdsObject> obj, bool exactly)
             && mtime == obj->getMTime()
             && sizeOnDisk == obj->getSizeOnDisk()
             && virt == obj->isVirtual()
-            && std::equal(auxdata.begin(), auxdata.end(), obj->auxdata.begin())
+            && auxdata == obj->auxdata
             && objectFlags == obj->getFlags())
         )
         return 0;
@@ -48,6 +48,14 @@
 
 #define RESOURCE_OPTION_FOURCC "4cc"
 
+/// \brief extension of a subtitle file that follows the name of its video,
+/// e.g. ".en.srt"
+#define RESOURCE_OPTION_SUBTITLE_EXT "sub"
+
+/// \brief byte offset of embedded artwork that is stored in the file as it
+/// is, the size is in the size attribute
+#define RESOURCE_OPTION_ARTWORK_OFFSET "aof"
+
 class CdsResource {
 protected:
     int handlerType;
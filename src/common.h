@@ -69,6 +69,7 @@
 #define D_HTTP_TRANSFER_MODE_STREAMING "Streaming"
 #define D_HTTP_TRANSFER_MODE_INTERACTIVE "Interactive"
 #define D_HTTP_CONTENT_FEATURES_HEADER "contentFeatures.dlna.org"
+#define D_HTTP_TIME_SEEK_RANGE_HEADER "TimeSeekRange.dlna.org"
 
 #define D_PROFILE "DLNA.ORG_PN"
 #define D_CONVERSION_INDICATOR "DLNA.ORG_CI"
@@ -80,7 +81,7 @@
 #define D_OP_SEEK_TIME "10"
 #define D_OP_SEEK_BOTH "11"
 #define D_OP_SEEK_DISABLED "00"
-// since we are using only range seek
+// byte range seeks work on every file served as it is
 #define D_OP_SEEK_ENABLED D_OP_SEEK_RANGE
 #define D_FLAGS "DLNA.ORG_FLAGS"
 #define D_TR_FLAGS_AV "01200000000000000000000000000000"
@@ -226,6 +227,18 @@
 #define DEFAULT_ALIVE_INTERVAL 1800 // seconds
 #define ALIVE_INTERVAL_MIN 62 // seconds
 #define DEFAULT_BOOKMARK_FILE "gerbera.html"
+#define DEFAULT_TRACE_FILE "gerbera-trace.json"
+#define DEFAULT_MEMORY_SOFT_LIMIT 0 // MB, 0 disables the limit
+#define DEFAULT_MEMORY_CHECK_INTERVAL 30 // seconds
+#define DEFAULT_SCHEDULING_IMPORT_NICE 0 // 0 keeps the server's value
+#define DEFAULT_SCHEDULING_IMPORT_IO_CLASS "none"
+#define DEFAULT_SCHEDULING_THUMBNAIL_IO_CLASS "none"
+#define DEFAULT_SCHEDULING_TRANSCODE_NICE 0
+#define DEFAULT_SCHEDULING_TRANSCODE_IO_CLASS "none"
+#define DEFAULT_SCHEDULING_IO_LEVEL 4 // best-effort default of the kernel
+#define DEFAULT_SCHEDULING_THROTTLE_DELAY 0 // ms per file, 0 disables the throttle
+#define DEFAULT_SCHEDULING_THROTTLE_MAX_STREAMS 1
+#define DEFAULT_SCHEDULING_THROTTLE_MAX_LATENCY 50 // ms
 #define DEFAULT_IGNORE_UNKNOWN_EXTENSIONS NO
 #define DEFAULT_CASE_SENSITIVE_EXTENSION_MAPPINGS NO
 #define DEFAULT_IMPORT_SCRIPT "import.js"
@@ -235,6 +248,10 @@
 #define DEFAULT_WEB_DIR "web"
 #define DEFAULT_JS_DIR "js"
 #define DEFAULT_HIDDEN_FILES_VALUE NO
+#define ID3_READ_STYLE_FAST "fast"
+#define ID3_READ_STYLE_AVERAGE "average"
+#define ID3_READ_STYLE_ACCURATE "accurate"
+#define DEFAULT_ID3_READ_STYLE ID3_READ_STYLE_AVERAGE
 #define DEFAULT_UPNP_STRING_LIMIT (-1)
 #define DEFAULT_SESSION_TIMEOUT 30
 #define SESSION_TIMEOUT_CHECK_INTERVAL (5 * 60)
@@ -277,6 +294,17 @@
 
 #define URL_VALUE_TRANSCODE "1"
 #define DEFAULT_STORAGE_CACHING_ENABLED YES
+#define DEFAULT_STORAGE_PROFILING_ENABLED NO
+#define DEFAULT_STORAGE_SLOW_QUERY_THRESHOLD 200
+#define STORAGE_ROLE_STANDALONE "standalone"
+#define STORAGE_ROLE_WRITER "writer"
+#define STORAGE_ROLE_READER "reader"
+#define DEFAULT_STORAGE_ROLE STORAGE_ROLE_STANDALONE
+#define DEFAULT_STORAGE_CHANGE_POLL_INTERVAL 2
+#define DEFAULT_STORAGE_BROWSE_INDEX_ENABLED YES
+#define DEFAULT_STORAGE_BROWSE_SNAPSHOT_WINDOW 30
+#define DEFAULT_STORAGE_MAINTENANCE_INTERVAL 86400 // seconds, 0 disables the maintenance
+#define DEFAULT_STORAGE_MAINTENANCE_SLICE 200 // ms
 #ifdef HAVE_SQLITE3
 #define MT_SQLITE_SYNC_FULL 2
 #define MT_SQLITE_SYNC_NORMAL 1
@@ -316,6 +316,8 @@ Ref<Element> ConfigGenerator::generateMappings() {
   mtcontent->appendElementChild(treat_as("audio/mp4", CONTENT_TYPE_MP4));
   mtcontent->appendElementChild(treat_as("video/x-matroska", CONTENT_TYPE_MKV));
   mtcontent->appendElementChild(treat_as("audio/x-matroska", CONTENT_TYPE_MKA));
+  mtcontent->appendElementChild(treat_as("video/mp2t", CONTENT_TYPE_MPEGTS));
+  mtcontent->appendElementChild(treat_as("video/MP2T", CONTENT_TYPE_MPEGTS));
   mtcontent->appendElementChild(treat_as("audio/x-dsd", CONTENT_TYPE_DSD));
   mappings->appendElementChild(mtcontent);
 
@@ -33,6 +33,7 @@
 #include "common.h"
 #include "metadata/metadata_handler.h"
 #include "storage/storage.h"
+#include "util/scheduling.h"
 #include "util/string_converter.h"
 #include "util/tools.h"
 #ifdef BSD_NATIVE_UUID
@@ -364,6 +365,64 @@ void ConfigManager::validate(std::string serverhome)
     NEW_OPTION(dbDriver);
     SET_OPTION(CFG_SERVER_STORAGE_DRIVER);
 
+    temp = getOption("/server/storage/attribute::profiling",
+        DEFAULT_STORAGE_PROFILING_ENABLED);
+    if (!validateYesNo(temp))
+        throw _Exception("Error in config file: incorrect parameter for <storage profiling=\"\" /> attribute");
+    NEW_BOOL_OPTION(temp == "yes" ? true : false);
+    SET_BOOL_OPTION(CFG_SERVER_STORAGE_PROFILING);
+
+    temp_int = getIntOption("/server/storage/attribute::slow-query-threshold",
+        DEFAULT_STORAGE_SLOW_QUERY_THRESHOLD);
+    if (temp_int < 0)
+        throw _Exception("Error in config file: incorrect parameter for <storage slow-query-threshold=\"\" /> attribute");
+    NEW_INT_OPTION(temp_int);
+    SET_INT_OPTION(CFG_SERVER_STORAGE_SLOW_QUERY_THRESHOLD);
+
+    temp = getOption("/server/storage/attribute::role",
+        DEFAULT_STORAGE_ROLE);
+    if (temp != STORAGE_ROLE_STANDALONE && temp != STORAGE_ROLE_WRITER && temp != STORAGE_ROLE_READER)
+        throw _Exception("Error in config file: incorrect parameter for <storage role=\"\" /> attribute");
+    if (temp != STORAGE_ROLE_STANDALONE && dbDriver != "mysql")
+        throw _Exception("Error in config file: <storage role=\"" + temp + "\" /> requires a shared mysql database");
+    NEW_OPTION(temp);
+    SET_OPTION(CFG_SERVER_STORAGE_ROLE);
+
+    temp_int = getIntOption("/server/storage/attribute::change-poll-interval",
+        DEFAULT_STORAGE_CHANGE_POLL_INTERVAL);
+    if (temp_int < 1)
+        throw _Exception("Error in config file: incorrect parameter for <storage change-poll-interval=\"\" /> attribute");
+    NEW_INT_OPTION(temp_int);
+    SET_INT_OPTION(CFG_SERVER_STORAGE_CHANGE_POLL_INTERVAL);
+
+    temp = getOption("/server/storage/attribute::browse-index",
+        DEFAULT_STORAGE_BROWSE_INDEX_ENABLED);
+    if (!validateYesNo(temp))
+        throw _Exception("Error in config file: incorrect parameter for <storage browse-index=\"\" /> attribute");
+    NEW_BOOL_OPTION(temp == "yes" ? true : false);
+    SET_BOOL_OPTION(CFG_SERVER_STORAGE_BROWSE_INDEX);
+
+    temp_int = getIntOption("/server/storage/attribute::browse-snapshot-window",
+        DEFAULT_STORAGE_BROWSE_SNAPSHOT_WINDOW);
+    if (temp_int < 0)
+        throw _Exception("Error in config file: incorrect parameter for <storage browse-snapshot-window=\"\" /> attribute");
+    NEW_INT_OPTION(temp_int);
+    SET_INT_OPTION(CFG_SERVER_STORAGE_BROWSE_SNAPSHOT_WINDOW);
+
+    temp_int = getIntOption("/server/storage/attribute::maintenance-interval",
+        DEFAULT_STORAGE_MAINTENANCE_INTERVAL);
+    if (temp_int < 0)
+        throw _Exception("Error in config file: incorrect parameter for <storage maintenance-interval=\"\" /> attribute");
+    NEW_INT_OPTION(temp_int);
+    SET_INT_OPTION(CFG_SERVER_STORAGE_MAINTENANCE_INTERVAL);
+
+    temp_int = getIntOption("/server/storage/attribute::maintenance-slice",
+        DEFAULT_STORAGE_MAINTENANCE_SLICE);
+    if (temp_int < 1)
+        throw _Exception("Error in config file: incorrect parameter for <storage maintenance-slice=\"\" /> attribute");
+    NEW_INT_OPTION(temp_int);
+    SET_INT_OPTION(CFG_SERVER_STORAGE_MAINTENANCE_SLICE);
+
     //    temp = checkOption_("/server/storage/database-file");
     //    check_path_ex(construct_path(temp));
 
@@ -547,6 +606,8 @@ void ConfigManager::validate(std::string serverhome)
         mime_content["audio/aiff"] = CONTENT_TYPE_AIFF;
         mime_content["video/x-msvideo"] = CONTENT_TYPE_AVI;
         mime_content["video/mpeg"] = CONTENT_TYPE_MPEG;
+        mime_content["video/mp2t"] = CONTENT_TYPE_MPEGTS;
+        mime_content["video/MP2T"] = CONTENT_TYPE_MPEGTS;
     }
 
     NEW_DICT_OPTION(mime_content);
@@ -679,6 +740,113 @@ void ConfigManager::validate(std::string serverhome)
     NEW_OPTION(temp);
     SET_OPTION(CFG_SERVER_BOOKMARK_FILE);
 
+    temp = getOption("/server/trace-file", DEFAULT_TRACE_FILE);
+    NEW_OPTION(construct_path(temp));
+    SET_OPTION(CFG_SERVER_TRACE_FILE);
+
+    temp_int = getIntOption("/server/memory/attribute::soft-limit",
+        DEFAULT_MEMORY_SOFT_LIMIT);
+    if (temp_int < 0)
+        throw _Exception("Error in config file: incorrect parameter for <memory soft-limit=\"\" /> attribute");
+    NEW_INT_OPTION(temp_int);
+    SET_INT_OPTION(CFG_SERVER_MEMORY_SOFT_LIMIT);
+
+    temp_int = getIntOption("/server/memory/attribute::check-interval",
+        DEFAULT_MEMORY_CHECK_INTERVAL);
+    if (temp_int < 1)
+        throw _Exception("Error in config file: incorrect parameter for <memory check-interval=\"\" /> attribute");
+    NEW_INT_OPTION(temp_int);
+    SET_INT_OPTION(CFG_SERVER_MEMORY_CHECK_INTERVAL);
+
+    temp_int = getIntOption("/server/scheduling/import/attribute::nice",
+        DEFAULT_SCHEDULING_IMPORT_NICE);
+    if (temp_int < 0 || temp_int > 19)
+        throw _Exception("Error in config file: incorrect parameter for <import nice=\"\" /> attribute");
+    NEW_INT_OPTION(temp_int);
+    SET_INT_OPTION(CFG_SERVER_SCHEDULING_IMPORT_NICE);
+
+    temp = getOption("/server/scheduling/import/attribute::io-class",
+        DEFAULT_SCHEDULING_IMPORT_IO_CLASS);
+    if (!Scheduling::isIOClass(temp))
+        throw _Exception("Error in config file: incorrect parameter for <import io-class=\"\" /> attribute");
+    NEW_OPTION(temp);
+    SET_OPTION(CFG_SERVER_SCHEDULING_IMPORT_IO_CLASS);
+
+    temp_int = getIntOption("/server/scheduling/import/attribute::io-level",
+        DEFAULT_SCHEDULING_IO_LEVEL);
+    if (temp_int < 0 || temp_int > 7)
+        throw _Exception("Error in config file: incorrect parameter for <import io-level=\"\" /> attribute");
+    NEW_INT_OPTION(temp_int);
+    SET_INT_OPTION(CFG_SERVER_SCHEDULING_IMPORT_IO_LEVEL);
+
+    temp = getOption("/server/scheduling/import/attribute::cgroup", "");
+    if (string_ok(temp) && temp.at(0) != '/')
+        throw _Exception("Error in config file: <import cgroup=\"\" /> must be an absolute path");
+    NEW_OPTION(temp);
+    SET_OPTION(CFG_SERVER_SCHEDULING_IMPORT_CGROUP);
+
+    temp = getOption("/server/scheduling/thumbnail/attribute::io-class",
+        DEFAULT_SCHEDULING_THUMBNAIL_IO_CLASS);
+    if (!Scheduling::isIOClass(temp))
+        throw _Exception("Error in config file: incorrect parameter for <thumbnail io-class=\"\" /> attribute");
+    NEW_OPTION(temp);
+    SET_OPTION(CFG_SERVER_SCHEDULING_THUMBNAIL_IO_CLASS);
+
+    temp_int = getIntOption("/server/scheduling/thumbnail/attribute::io-level",
+        DEFAULT_SCHEDULING_IO_LEVEL);
+    if (temp_int < 0 || temp_int > 7)
+        throw _Exception("Error in config file: incorrect parameter for <thumbnail io-level=\"\" /> attribute");
+    NEW_INT_OPTION(temp_int);
+    SET_INT_OPTION(CFG_SERVER_SCHEDULING_THUMBNAIL_IO_LEVEL);
+
+    temp_int = getIntOption("/server/scheduling/transcode/attribute::nice",
+        DEFAULT_SCHEDULING_TRANSCODE_NICE);
+    if (temp_int < 0 || temp_int > 19)
+        throw _Exception("Error in config file: incorrect parameter for <transcode nice=\"\" /> attribute");
+    NEW_INT_OPTION(temp_int);
+    SET_INT_OPTION(CFG_SERVER_SCHEDULING_TRANSCODE_NICE);
+
+    temp = getOption("/server/scheduling/transcode/attribute::io-class",
+        DEFAULT_SCHEDULING_TRANSCODE_IO_CLASS);
+    if (!Scheduling::isIOClass(temp))
+        throw _Exception("Error in config file: incorrect parameter for <transcode io-class=\"\" /> attribute");
+    NEW_OPTION(temp);
+    SET_OPTION(CFG_SERVER_SCHEDULING_TRANSCODE_IO_CLASS);
+
+    temp_int = getIntOption("/server/scheduling/transcode/attribute::io-level",
+        DEFAULT_SCHEDULING_IO_LEVEL);
+    if (temp_int < 0 || temp_int > 7)
+        throw _Exception("Error in config file: incorrect parameter for <transcode io-level=\"\" /> attribute");
+    NEW_INT_OPTION(temp_int);
+    SET_INT_OPTION(CFG_SERVER_SCHEDULING_TRANSCODE_IO_LEVEL);
+
+    temp = getOption("/server/scheduling/transcode/attribute::cgroup", "");
+    if (string_ok(temp) && temp.at(0) != '/')
+        throw _Exception("Error in config file: <transcode cgroup=\"\" /> must be an absolute path");
+    NEW_OPTION(temp);
+    SET_OPTION(CFG_SERVER_SCHEDULING_TRANSCODE_CGROUP);
+
+    temp_int = getIntOption("/server/scheduling/throttle/attribute::delay",
+        DEFAULT_SCHEDULING_THROTTLE_DELAY);
+    if (temp_int < 0)
+        throw _Exception("Error in config file: incorrect parameter for <throttle delay=\"\" /> attribute");
+    NEW_INT_OPTION(temp_int);
+    SET_INT_OPTION(CFG_SERVER_SCHEDULING_THROTTLE_DELAY);
+
+    temp_int = getIntOption("/server/scheduling/throttle/attribute::max-streams",
+        DEFAULT_SCHEDULING_THROTTLE_MAX_STREAMS);
+    if (temp_int < 0)
+        throw _Exception("Error in config file: incorrect parameter for <throttle max-streams=\"\" /> attribute");
+    NEW_INT_OPTION(temp_int);
+    SET_INT_OPTION(CFG_SERVER_SCHEDULING_THROTTLE_MAX_STREAMS);
+
+    temp_int = getIntOption("/server/scheduling/throttle/attribute::max-latency",
+        DEFAULT_SCHEDULING_THROTTLE_MAX_LATENCY);
+    if (temp_int < 0)
+        throw _Exception("Error in config file: incorrect parameter for <throttle max-latency=\"\" /> attribute");
+    NEW_INT_OPTION(temp_int);
+    SET_INT_OPTION(CFG_SERVER_SCHEDULING_THROTTLE_MAX_LATENCY);
+
     temp = getOption("/server/name", DESC_FRIENDLY_NAME);
     NEW_OPTION(temp);
     SET_OPTION(CFG_SERVER_NAME);
@@ -968,6 +1136,20 @@ void ConfigManager::validate(std::string serverhome)
     }
     NEW_STRARR_OPTION(createArrayFromNodeset(el, "add-data", "tag"));
     SET_STRARR_OPTION(CFG_IMPORT_LIBOPTS_ID3_AUXDATA_TAGS_LIST);
+
+    el = getElement("/import/library-options/id3/metadata");
+    if (el == nullptr) {
+        getOption("/import/library-options/id3/metadata", "");
+    }
+    NEW_STRARR_OPTION(createArrayFromNodeset(el, "add-data", "tag"));
+    SET_STRARR_OPTION(CFG_IMPORT_LIBOPTS_ID3_METADATA_TAGS_LIST);
+
+    temp = getOption("/import/library-options/id3/attribute::read-style",
+        DEFAULT_ID3_READ_STYLE);
+    if (temp != ID3_READ_STYLE_FAST && temp != ID3_READ_STYLE_AVERAGE && temp != ID3_READ_STYLE_ACCURATE)
+        throw _Exception("Error in config file: incorrect parameter for <id3 read-style=\"\" /> attribute");
+    NEW_OPTION(temp);
+    SET_OPTION(CFG_IMPORT_LIBOPTS_ID3_READ_STYLE);
 #endif
 
 #if defined(HAVE_FFMPEG)
@@ -2015,6 +2197,16 @@ bool ConfigManager::getBoolOption(config_option_t option)
     return o->getBoolOption();
 }
 
+void ConfigManager::setOption(config_option_t option, std::string value)
+{
+    options->at(option) = std::make_shared<Option>(value);
+}
+
+void ConfigManager::setBoolOption(config_option_t option, bool value)
+{
+    options->at(option) = std::make_shared<BoolOption>(value);
+}
+
 std::map<std::string,std::string> ConfigManager::getDictionaryOption(config_option_t option)
 {
     return options->at(option)->getDictionaryOption();
@@ -72,6 +72,22 @@ typedef enum {
     CFG_SERVER_EXTEND_PROTOCOLINFO_DLNA_SEEK,
     CFG_SERVER_HIDE_PC_DIRECTORY,
     CFG_SERVER_BOOKMARK_FILE,
+    CFG_SERVER_TRACE_FILE,
+    CFG_SERVER_MEMORY_SOFT_LIMIT,
+    CFG_SERVER_MEMORY_CHECK_INTERVAL,
+    CFG_SERVER_SCHEDULING_IMPORT_NICE,
+    CFG_SERVER_SCHEDULING_IMPORT_IO_CLASS,
+    CFG_SERVER_SCHEDULING_IMPORT_IO_LEVEL,
+    CFG_SERVER_SCHEDULING_IMPORT_CGROUP,
+    CFG_SERVER_SCHEDULING_THUMBNAIL_IO_CLASS,
+    CFG_SERVER_SCHEDULING_THUMBNAIL_IO_LEVEL,
+    CFG_SERVER_SCHEDULING_TRANSCODE_NICE,
+    CFG_SERVER_SCHEDULING_TRANSCODE_IO_CLASS,
+    CFG_SERVER_SCHEDULING_TRANSCODE_IO_LEVEL,
+    CFG_SERVER_SCHEDULING_TRANSCODE_CGROUP,
+    CFG_SERVER_SCHEDULING_THROTTLE_DELAY,
+    CFG_SERVER_SCHEDULING_THROTTLE_MAX_STREAMS,
+    CFG_SERVER_SCHEDULING_THROTTLE_MAX_LATENCY,
     CFG_SERVER_CUSTOM_HTTP_HEADERS,
     CFG_SERVER_UPNP_TITLE_AND_DESC_STRING_LIMIT,
     CFG_SERVER_UI_ENABLED,
@@ -84,6 +100,14 @@ typedef enum {
     CFG_SERVER_UI_ITEMS_PER_PAGE_DROPDOWN,
     CFG_SERVER_UI_SHOW_TOOLTIPS,
     CFG_SERVER_STORAGE_DRIVER,
+    CFG_SERVER_STORAGE_PROFILING,
+    CFG_SERVER_STORAGE_SLOW_QUERY_THRESHOLD,
+    CFG_SERVER_STORAGE_ROLE,
+    CFG_SERVER_STORAGE_CHANGE_POLL_INTERVAL,
+    CFG_SERVER_STORAGE_BROWSE_INDEX,
+    CFG_SERVER_STORAGE_BROWSE_SNAPSHOT_WINDOW,
+    CFG_SERVER_STORAGE_MAINTENANCE_INTERVAL,
+    CFG_SERVER_STORAGE_MAINTENANCE_SLICE,
 #ifdef HAVE_SQLITE3
     CFG_SERVER_STORAGE_SQLITE_DATABASE_FILE,
     CFG_SERVER_STORAGE_SQLITE_SYNCHRONOUS,
@@ -152,6 +176,8 @@ typedef enum {
 #endif
 #if defined(HAVE_TAGLIB)
     CFG_IMPORT_LIBOPTS_ID3_AUXDATA_TAGS_LIST,
+    CFG_IMPORT_LIBOPTS_ID3_METADATA_TAGS_LIST,
+    CFG_IMPORT_LIBOPTS_ID3_READ_STYLE,
 #endif
     CFG_TRANSCODING_PROFILE_LIST,
 #ifdef HAVE_CURL
@@ -203,6 +229,16 @@ public:
     /// \param option option to retrieve.
     bool getBoolOption(config_option_t option);
 
+    /// \brief replaces the value of a config option of type String
+    /// \param option option to change.
+    /// \param value new value.
+    void setOption(config_option_t option, std::string value);
+
+    /// \brief replaces the value of a config option of type bool
+    /// \param option option to change.
+    /// \param value new value.
+    void setBoolOption(config_option_t option, bool value);
+
     /// \brief returns a config option of type Dictionary
     /// \param option option to retrieve.
     std::map<std::string,std::string> getDictionaryOption(config_option_t option);
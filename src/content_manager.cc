@@ -29,24 +29,32 @@
 
 /// \file content_manager.cc
 
+#include <algorithm>
+#include <atomic>
 #include <cerrno>
 #include <cstring>
+#include <deque>
 #include <dirent.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <thread>
 #include <unistd.h>
 
 #include "config/config_manager.h"
 #include "storage/storage.h"
 #include "content_manager.h"
 #include "util/filesystem.h"
+#include "util/memory_accounting.h"
 #include "layout/fallback_layout.h"
 #include "metadata/metadata_handler.h"
+#include "metadata/subtitle_handler.h"
 #include "util/rexp.h"
+#include "util/scheduling.h"
 #include "web/session_manager.h"
 #include "util/string_converter.h"
 #include "util/timer.h"
 #include "util/tools.h"
+#include "util/trace.h"
 #include "update_manager.h"
 #include "util/process.h"
 
@@ -72,15 +80,24 @@
 
 #define DEFAULT_DIR_CACHE_CAPACITY 10
 #define CM_INITIAL_QUEUE_SIZE 20
+// file types detected by libmagic that are remembered for rescans
+#define MIME_CACHE_SIZE 10000
+
+// files read in parallel by bulkImport() before they are added in one transaction
+#define BULK_IMPORT_BATCH_SIZE 1024
+// objects of bulkObjects() handled between two progress reports
+#define BULK_OBJECTS_CHUNK size_t(200)
+// finished bulkObjects() tasks whose result can be asked for
+#define BULK_RESULTS_KEPT size_t(32)
+// files whose key frame index is kept for seeking
+#define SEEK_INDEX_CACHE_SIZE 64
+// internal setting that marks the subtitles of existing videos as looked up
+#define SUBTITLE_MIGRATION_SETTING "migration_subtitles"
 
 #ifdef HAVE_MAGIC
-// for older versions of filemagic
-extern "C" {
-#include <magic.h>
-}
-
-struct magic_set* ms = nullptr;
+#include "util/mime_detector.h"
 #endif
+#include "util/seek_index.h"
 
 using namespace zmm;
 using namespace mxml;
@@ -122,6 +139,7 @@ ContentManager::ContentManager(std::shared_ptr<ConfigManager> config, std::share
     acct = Ref<CMAccounting>(new CMAccounting());
     taskQueue1 = Ref<ObjectQueue<GenericTask>>(new ObjectQueue<GenericTask>(CM_INITIAL_QUEUE_SIZE));
     taskQueue2 = Ref<ObjectQueue<GenericTask>>(new ObjectQueue<GenericTask>(CM_INITIAL_QUEUE_SIZE));
+    seekIndexes = std::make_shared<SeekIndexCache>(SEEK_INDEX_CACHE_SIZE);
 
     Ref<Element> tmpEl;
 
@@ -143,6 +161,12 @@ ContentManager::ContentManager(std::shared_ptr<ConfigManager> config, std::share
 
     mimetype_contenttype_map = config->getDictionaryOption(CFG_IMPORT_MAPPINGS_MIMETYPE_TO_CONTENTTYPE_LIST);
 
+    // reader nodes only serve what the writer node imports
+    if (storage->isReader()) {
+        autoscan_timed = Ref<AutoscanList>(new AutoscanList(storage));
+        return;
+    }
+
     auto config_timed_list = config->getAutoscanListOption(CFG_IMPORT_AUTOSCAN_TIMED_LIST);
     int i;
     for (i = 0; i < config_timed_list->size(); i++) {
@@ -167,7 +191,7 @@ void ContentManager::init()
     auto self = shared_from_this();
     inotify = std::make_unique<AutoscanInotify>(storage, self);
 
-    if (config->getBoolOption(CFG_IMPORT_AUTOSCAN_USE_INOTIFY)) {
+    if (config->getBoolOption(CFG_IMPORT_AUTOSCAN_USE_INOTIFY) && !storage->isReader()) {
         auto config_inotify_list = config->getAutoscanListOption(CFG_IMPORT_AUTOSCAN_INOTIFY_LIST);
         for (i = 0; i < config_inotify_list->size(); i++) {
             Ref<AutoscanDirectory> dir = config_inotify_list->get(i);
@@ -191,30 +215,17 @@ void ContentManager::init()
 #endif
 /* init filemagic */
 #ifdef HAVE_MAGIC
-    if (!ignore_unknown_extensions) {
-        ms = magic_open(MAGIC_MIME);
-        if (ms == nullptr) {
-            log_error("magic_open failed\n");
-        } else {
-            std::string optMagicFile = config->getOption(CFG_IMPORT_MAGIC_FILE);
-            const char* magicFile = NULL;
-            if (!optMagicFile.empty())
-                magicFile = optMagicFile.c_str();
-            if (magic_load(ms, magicFile) == -1) {
-                log_warning("magic_load: %s\n", magic_error(ms));
-                magic_close(ms);
-                ms = nullptr;
-            }
-        }
-    }
+    if (!ignore_unknown_extensions)
+        mime = std::make_shared<MimeDetector>(config->getOption(CFG_IMPORT_MAGIC_FILE), MIME_CACHE_SIZE);
 #endif // HAVE_MAGIC
 
     std::string layout_type = config->getOption(CFG_IMPORT_SCRIPTING_VIRTUAL_LAYOUT_TYPE);
-    if ((layout_type == "builtin") || (layout_type == "js"))
+    if (((layout_type == "builtin") || (layout_type == "js")) && !storage->isReader())
         layout_enabled = true;
 
 #ifdef ONLINE_SERVICES
     online_services = Ref<OnlineServiceList>(new OnlineServiceList());
+    if (!storage->isReader()) {
 
 #ifdef SOPCAST
     if (config->getBoolOption(CFG_ONLINE_CONTENT_SOPCAST_ENABLED)) {
@@ -267,7 +278,7 @@ void ContentManager::init()
         }
     }
 #endif // ATRAILERS
-
+    }
 #endif // ONLINE_SERVICES
 
     reMimetype = Ref<RExp>(new RExp());
@@ -280,7 +291,54 @@ void ContentManager::init()
         throw _Exception("Could not start task thread");
     }
 
-    autoscan_timed->notifyAll(this);
+    MemoryAccounting::setSampler(MemoryAccounting::ACCOUNT_TASK_QUEUES, [this]() {
+        AutoLock lock(mutex);
+        MemoryAccounting::Usage usage = { 0, 0 };
+        for (auto queue : { taskQueue1, taskQueue2 }) {
+            for (int i = 0; i < queue->size(); i++) {
+                usage.bytes += queue->get(i)->getMemoryUsage();
+                usage.items++;
+            }
+        }
+        return usage;
+    });
+
+    for (int i = 0; i < autoscan_timed->size(); i++) {
+        Ref<AutoscanDirectory> dir = autoscan_timed->get(i);
+        auto param = std::make_shared<Timer::Parameter>(Timer::Parameter::timer_param_t::IDAutoscan, dir->getScanID());
+        log_debug("Adding timed scan with interval %d\n", dir->getInterval());
+        timer->addTimerSubscriber(this, dir->getInterval(), param, false);
+    }
+}
+
+ContentManager::~ContentManager() { log_debug("ContentManager destroyed\n"); }
+
+void ContentManager::initDeferred()
+{
+    auto self = shared_from_this();
+    Ref<GenericTask> task(new CMDeferredInitTask(self));
+    task->setDescription("Initializing content manager");
+    addTask(task);
+}
+
+void ContentManager::_initDeferred()
+{
+    PhaseTimer phases("startup");
+
+    _loadAccounting();
+    phases.phase("accounting");
+
+    if (layout_enabled)
+        initLayout();
+#ifdef HAVE_JS
+    if (!storage->isReader())
+        initJS();
+#endif
+    phases.phase("scripts");
+
+    if (!storage->isReader())
+        migrateSubtitles();
+    phases.phase("subtitles");
 
 #ifdef HAVE_INOTIFY
     if (config->getBoolOption(CFG_IMPORT_AUTOSCAN_USE_INOTIFY)) {
@@ -291,17 +349,15 @@ void ContentManager::init()
                 inotify->monitor(dir);
         }
     }
+    phases.phase("inotify");
 #endif
 
-    for (int i = 0; i < autoscan_timed->size(); i++) {
-        Ref<AutoscanDirectory> dir = autoscan_timed->get(i);
-        auto param = std::make_shared<Timer::Parameter>(Timer::Parameter::timer_param_t::IDAutoscan, dir->getScanID());
-        log_debug("Adding timed scan with interval %d\n", dir->getInterval());
-        timer->addTimerSubscriber(this, dir->getInterval(), param, false);
-    }
-}
+    // the initial scans are queued with low priority behind this task
+    autoscan_timed->notifyAll(this);
+    phases.phase("autoscan");
 
-ContentManager::~ContentManager() { log_debug("ContentManager destroyed\n"); }
+    log_info("Deferred initialisation done after %lld ms (%s)\n", phases.total(), phases.summary().c_str());
+}
 
 void ContentManager::registerExecutor(std::shared_ptr<Executor> exec)
 {
@@ -350,9 +406,11 @@ void ContentManager::timerNotify(std::shared_ptr<Timer::Parameter> parameter)
 void ContentManager::shutdown()
 {
     log_debug("start\n");
-    AutoLockU lock(mutex);
+    MemoryAccounting::setSampler(MemoryAccounting::ACCOUNT_TASK_QUEUES, nullptr);
+    // before the lock, a transaction may be waiting for it
     log_debug("updating last_modified data for autoscan in database...\n");
     autoscan_timed->updateLMinDB();
+    AutoLockU lock(mutex);
 
 #ifdef HAVE_JS
     destroyJS();
@@ -397,10 +455,7 @@ void ContentManager::shutdown()
     taskThread = 0;
 
 #ifdef HAVE_MAGIC
-    if (ms) {
-        magic_close(ms);
-        ms = nullptr;
-    }
+    mime = nullptr;
 #endif
     log_debug("end\n");
     log_debug("ContentManager destroyed\n");
@@ -483,6 +538,7 @@ void ContentManager::addVirtualItem(std::shared_ptr<CdsObject> obj, bool allow_f
 
 int ContentManager::_addFile(std::string path, std::string rootPath, bool recursive, bool hidden, Ref<GenericTask> task)
 {
+    TRACE_SPAN("import", "addFile", path);
     if (hidden == false) {
         std::string filename = get_filename(path);
         if (string_ok(filename) && filename.at(0) == '.')
@@ -653,6 +709,12 @@ void ContentManager::_rescanDirectory(int containerID, int scanID, ScanMode scan
         }
     }
 
+    // subtitles are resources of their videos, adding or deleting one
+    // changes the directory but not the videos
+    struct stat dirbuf;
+    bool dirChanged = scanLevel == ScanLevel::Full && stat(location.c_str(), &dirbuf) == 0 && last_modified_current_max < dirbuf.st_mtime;
+    std::vector<int> unchangedFiles;
+
     // request only items if non-recursive scan is wanted
     unique_ptr<unordered_set<int>> list = storage->getObjects(containerID, !adir->getRecursive());
 
@@ -675,6 +737,7 @@ void ContentManager::_rescanDirectory(int containerID, int scanID, ScanMode scan
         }
 
         path = location + DIR_SEPARATOR + name;
+        ImportThrottle::pause();
         ret = stat(path.c_str(), &statbuf);
         if (ret != 0) {
             log_error("Failed to stat %s, %s\n", path.c_str(), mt_strerror(errno).c_str());
@@ -703,7 +766,8 @@ void ContentManager::_rescanDirectory(int containerID, int scanID, ScanMode scan
                         addFileInternal(path, location, false, false, adir->getHidden());
                         // update time variable
                         last_modified_current_max = statbuf.st_mtime;
-                    }
+                    } else if (dirChanged)
+                        unchangedFiles.push_back(objectID);
                 } else if (scanLevel == ScanLevel::Basic)
                     continue;
                 else
@@ -759,12 +823,23 @@ void ContentManager::_rescanDirectory(int containerID, int scanID, ScanMode scan
         }
     }
 
+    if (dirChanged) {
+        for (int objectID : unchangedFiles) {
+            if (shutdownFlag || ((task != nullptr) && !task->isValid()))
+                return;
+            updateSubtitleResources(objectID);
+        }
+        if (last_modified_current_max < dirbuf.st_mtime)
+            last_modified_current_max = dirbuf.st_mtime;
+    }
+
     adir->setCurrentLMT(last_modified_current_max);
 }
 
 /* scans the given directory and adds everything recursively */
 void ContentManager::addRecursive(std::string path, bool hidden, Ref<GenericTask> task)
 {
+    TRACE_SPAN("import", "addRecursive", path);
     if (hidden == false) {
         log_debug("Checking path %s\n", path.c_str());
         if (path.at(0) == '.')
@@ -805,6 +880,7 @@ void ContentManager::addRecursive(std::string path, bool hidden, Ref<GenericTask
             task->setDescription("Importing: " + newPath);
         }
 
+        ImportThrottle::pause();
         try {
             std::shared_ptr<CdsObject> obj = nullptr;
             if (parentID > 0)
@@ -862,6 +938,115 @@ void ContentManager::addRecursive(std::string path, bool hidden, Ref<GenericTask
     closedir(dir);
 }
 
+void ContentManager::bulkImport(Ref<Array<AutoscanDirectory>> roots, int threads)
+{
+    if (layout_enabled)
+        initLayout();
+#ifdef HAVE_JS
+    initJS();
+#endif
+
+    // every path keeps the start point it was found below, the layout
+    // places it relative to that and its flags decide what is listed
+    struct BulkPath {
+        std::string path;
+        std::string rootPath;
+        Ref<AutoscanDirectory> root;
+    };
+
+    // the start points are listed like any other directory
+    std::deque<BulkPath> dirs;
+    std::vector<BulkPath> batch;
+    for (int i = 0; i < roots->size(); i++) {
+        Ref<AutoscanDirectory> root = roots->get(i);
+        std::string location = reduce_string(root->getLocation(), DIR_SEPARATOR);
+        if (location.size() > 1 && location.back() == DIR_SEPARATOR)
+            location.pop_back();
+        if (check_path(location, true)) {
+            ensurePathExistence(location);
+            dirs.push_back({ location, location, root });
+        } else {
+            batch.push_back({ location, location, root });
+        }
+    }
+
+    long long imported = 0;
+    while ((!dirs.empty() || !batch.empty()) && !shutdownFlag) {
+        // whole directories are listed, a batch may grow beyond its size
+        while (batch.size() < BULK_IMPORT_BATCH_SIZE && !dirs.empty()) {
+            BulkPath dirPath = dirs.front();
+            dirs.pop_front();
+            DIR* dir = opendir(dirPath.path.c_str());
+            if (dir == nullptr) {
+                log_warning("could not list directory %s : %s\n", dirPath.path.c_str(), strerror(errno));
+                continue;
+            }
+            bool hidden = dirPath.root->getHidden();
+            struct dirent* dent;
+            while ((dent = readdir(dir)) != nullptr) {
+                const char* name = dent->d_name;
+                if (name[0] == '.' && (!hidden || name[1] == 0 || (name[1] == '.' && name[2] == 0)))
+                    continue;
+                std::string newPath = (dirPath.path == "/" ? dirPath.path : dirPath.path + DIR_SEPARATOR) + name;
+                if (config->getConfigFilename() != newPath)
+                    batch.push_back({ newPath, dirPath.rootPath, dirPath.root });
+            }
+            closedir(dir);
+        }
+
+        // reading the files is what takes time, storage and layout stay on this thread
+        std::vector<std::shared_ptr<CdsObject>> objects(batch.size());
+        std::atomic<size_t> next(0);
+        auto extract = [&]() {
+            for (size_t i = next++; i < batch.size() && !shutdownFlag; i = next++) {
+                try {
+                    objects[i] = createObjectFromFile(batch[i].path);
+                } catch (const Exception& e) {
+                    log_warning("skipping %s : %s\n", batch[i].path.c_str(), e.getMessage().c_str());
+                }
+            }
+        };
+        std::vector<std::thread> workers;
+        for (int i = 1; i < threads && size_t(i) < batch.size(); i++)
+            workers.emplace_back(extract);
+        extract();
+        for (auto& worker : workers)
+            worker.join();
+
+        storage->beginTransaction();
+        for (size_t i = 0; i < batch.size(); i++) {
+            auto obj = objects[i];
+            if (obj == nullptr)
+                continue;
+            if (IS_CDS_CONTAINER(obj->getObjectType())) {
+                // the start points themselves are always listed
+                if (batch[i].root->getRecursive())
+                    dirs.push_back(batch[i]);
+                continue;
+            }
+            try {
+                if (storage->findObjectIDByPath(batch[i].path) != INVALID_OBJECT_ID)
+                    continue;
+                addObject(obj);
+                imported++;
+                if (layout != nullptr) {
+                    layout->processCdsObject(obj, batch[i].rootPath);
+#ifdef HAVE_JS
+                    std::string content_type = getValueOrDefault(mimetype_contenttype_map, std::static_pointer_cast<CdsItem>(obj)->getMimeType());
+                    if ((playlist_parser_script != nullptr) && (content_type == CONTENT_TYPE_PLAYLIST))
+                        playlist_parser_script->processPlaylistObject(obj, nullptr);
+#endif // JS
+                }
+            } catch (const Exception& e) {
+                log_warning("skipping %s : %s\n", batch[i].path.c_str(), e.getMessage().c_str());
+            }
+        }
+        storage->commitTransaction();
+        batch.clear();
+        log_info("Indexed %lld files, %d directories left to list\n", imported, (int)dirs.size());
+    }
+}
+
 void ContentManager::updateObject(int objectID, const std::map<std::string,std::string>& parameters)
 {
     std::string title = getValueOrDefault(parameters, "title");
@@ -994,17 +1179,17 @@ void ContentManager::addObject(std::shared_ptr<CdsObject> obj)
         obj->setLocation(reduce_string(obj->getLocation(), DIR_SEPARATOR));
     }
 
-    storage->addObject(obj, &containerChanged);
+    int grandparentChanged = INVALID_OBJECT_ID;
+    storage->addObject(obj, &containerChanged, &grandparentChanged);
     log_debug("After adding: parent ID is %d\n", obj->getParentID());
 
     update_manager->containerChanged(containerChanged);
     session_manager->containerChangedUI(containerChanged);
 
-    int parent_id = obj->getParentID();
-    if ((parent_id != -1) && (storage->getChildCount(parent_id) == 1)) {
-        auto parent = storage->loadObject(parent_id);
-        log_debug("Will update ID %d\n", parent->getParentID());
-        update_manager->containerChanged(parent->getParentID());
+    // the parent got its first child
+    if (grandparentChanged != INVALID_OBJECT_ID) {
+        log_debug("Will update ID %d\n", grandparentChanged);
+        update_manager->containerChanged(grandparentChanged);
     }
 
     update_manager->containerChanged(obj->getParentID());
@@ -1028,6 +1213,8 @@ int ContentManager::addContainerChain(std::string chain, std::string lastClass,
     if (!string_ok(chain))
         throw _Exception("addContainerChain() called with empty chain parameter");
 
+    TRACE_SPAN("import", "addContainerChain", chain);
+
     log_debug("received chain: %s (%s) [%s]\n", chain.c_str(), lastClass.c_str(), dict_encode_simple(lastMetadata).c_str());
     storage->addContainerChain(chain, lastClass, lastRefID, &containerID, &updateID, lastMetadata);
 
@@ -1074,6 +1261,7 @@ std::shared_ptr<CdsObject> ContentManager::convertObject(std::shared_ptr<CdsObje
 // returns nullptr if file ignored due to configuration
 std::shared_ptr<CdsObject> ContentManager::createObjectFromFile(std::string path, bool magic, bool allow_fifo)
 {
+    TRACE_SPAN("import", "createObjectFromFile", path);
     std::string filename = get_filename(path);
 
     struct stat statbuf;
@@ -1103,7 +1291,8 @@ std::shared_ptr<CdsObject> ContentManager::createObjectFromFile(std::string path
                 if (ignore_unknown_extensions)
                     return nullptr; // item should be ignored
 #ifdef HAVE_MAGIC
-                mimetype = getMIMETypeFromFile(path);
+                if (mime != nullptr)
+                    mimetype = mime->fromFile(path, statbuf);
 #endif
             }
         }
@@ -1233,6 +1422,8 @@ void ContentManager::reloadLayout()
 
 void ContentManager::threadProc()
 {
+    Scheduling::applyToThread(Scheduling::GROUP_IMPORT);
+
     Ref<GenericTask> task;
     AutoLockU lock(mutex);
     working = true;
@@ -1251,8 +1442,10 @@ void ContentManager::threadProc()
 
         // log_debug("content manager Async START %s\n", task->getDescription().c_str());
         try {
-            if (task->isValid())
+            if (task->isValid()) {
+                TRACE_SPAN("task", "ContentManager::task", task->getDescription());
                 task->run();
+            }
         } catch (const ServerShutdownException& se) {
             shutdownFlag = true;
         } catch (const Exception& e) {
@@ -1356,37 +1549,6 @@ void ContentManager::fetchOnlineContentInternal(
     addTask(task, lowPriority);
 }
 
-void ContentManager::cleanupOnlineServiceObjects(zmm::Ref<OnlineService> service)
-{
-    log_debug("Finished fetch cycle for service: %s\n", service->getServiceName().c_str());
-
-    if (service->getItemPurgeInterval() > 0) {
-        auto ids = storage->getServiceObjectIDs(service->getStoragePrefix());
-
-        struct timespec current, last;
-        getTimespecNow(&current);
-        last.tv_nsec = 0;
-        std::string temp;
-
-        for (int object_id : *ids) {
-            auto obj = storage->loadObject(object_id);
-            if (obj == nullptr)
-                continue;
-
-            temp = obj->getAuxData(ONLINE_SERVICE_LAST_UPDATE);
-            if (!string_ok(temp))
-                continue;
-
-            last.tv_sec = std::stol(temp);
-
-            if ((service->getItemPurgeInterval() > 0) && ((current.tv_sec - last.tv_sec) > service->getItemPurgeInterval())) {
-                log_debug("Purging old online service object %s\n", obj->getTitle().c_str());
-                removeObject(object_id, false);
-            }
-        }
-    }
-}
-
 #endif
 
 void ContentManager::invalidateAddTask(Ref<GenericTask> t, std::string path)
@@ -1465,49 +1627,247 @@ void ContentManager::removeObject(int objectID, bool async, bool all)
             return;
         }
 
-        if (IS_CDS_CONTAINER(obj->getObjectType())) {
-            int i;
+        if (IS_CDS_CONTAINER(obj->getObjectType()))
+            prepareContainerRemoval(path);
 
-            // make sure to remove possible child autoscan directories from the scanlist
-            Ref<AutoscanList> rm_list = autoscan_timed->removeIfSubdir(path);
-            for (i = 0; i < rm_list->size(); i++) {
-                timer->removeTimerSubscriber(this, rm_list->get(i)->getTimerParameter(), true);
-            }
+        addTask(task);
+    } else {
+        _removeObject(objectID, all);
+    }
+}
+
+void ContentManager::prepareContainerRemoval(const std::string& path)
+{
+    int i;
+
+    // make sure to remove possible child autoscan directories from the scanlist
+    Ref<AutoscanList> rm_list = autoscan_timed->removeIfSubdir(path);
+    for (i = 0; i < rm_list->size(); i++) {
+        timer->removeTimerSubscriber(this, rm_list->get(i)->getTimerParameter(), true);
+    }
 #ifdef HAVE_INOTIFY
-            if (config->getBoolOption(CFG_IMPORT_AUTOSCAN_USE_INOTIFY)) {
-                rm_list = autoscan_inotify->removeIfSubdir(path);
-                for (i = 0; i < rm_list->size(); i++) {
-                    Ref<AutoscanDirectory> dir = rm_list->get(i);
-                    inotify->unmonitor(dir);
-                }
-            }
+    if (config->getBoolOption(CFG_IMPORT_AUTOSCAN_USE_INOTIFY)) {
+        rm_list = autoscan_inotify->removeIfSubdir(path);
+        for (i = 0; i < rm_list->size(); i++) {
+            Ref<AutoscanDirectory> dir = rm_list->get(i);
+            inotify->unmonitor(dir);
+        }
+    }
 #endif
 
-            AutoLock lock(mutex);
-            int qsize = taskQueue1->size();
+    AutoLock lock(mutex);
+    int qsize = taskQueue1->size();
+
+    // we have to make sure that a currently running autoscan task will not
+    // launch add tasks for directories that anyway are going to be deleted
+    for (i = 0; i < qsize; i++) {
+        Ref<GenericTask> t = taskQueue1->get(i);
+        invalidateAddTask(t, path);
+    }
+
+    qsize = taskQueue2->size();
+    for (i = 0; i < qsize; i++) {
+        Ref<GenericTask> t = taskQueue2->get(i);
+        invalidateAddTask(t, path);
+    }
+
+    Ref<GenericTask> t = getCurrentTask();
+    if (t != nullptr) {
+        invalidateAddTask(t, path);
+    }
+}
+
+unsigned int ContentManager::bulkObjects(BulkAction action, const std::vector<int>& objectIDs, const std::map<std::string, std::string>& parameters)
+{
+    if (objectIDs.empty())
+        return 0;
+
+    auto self = shared_from_this();
+    Ref<GenericTask> task(new CMBulkObjectsTask(self, action, objectIDs, parameters));
+    task->setDescription("Queued: " + std::to_string(objectIDs.size()) + " objects");
+    addTask(task);
+
+    // the task may have finished already and left its result
+    AutoLock lock(mutex);
+    bulkResults.emplace(task->getID(), BulkResult());
+    while (bulkResults.size() > BULK_RESULTS_KEPT)
+        bulkResults.erase(bulkResults.begin());
+    return task->getID();
+}
+
+std::unique_ptr<BulkResult> ContentManager::getBulkResult(unsigned int taskID)
+{
+    AutoLock lock(mutex);
+    auto it = bulkResults.find(taskID);
+    if (it == bulkResults.end())
+        return nullptr;
+    return std::make_unique<BulkResult>(it->second);
+}
+
+void ContentManager::_bulkObjects(BulkAction action, const std::vector<int>& objectIDs, const std::map<std::string, std::string>& parameters, Ref<GenericTask> task)
+{
+    std::string verb = action == BulkAction::Remove ? "Removing" : (action == BulkAction::Rescan ? "Rescanning" : "Editing");
+    std::vector<int> upnpChanged;
+    std::vector<int> uiChanged;
+    BulkResult result;
+
+    // one announcement for all committed chunks instead of one per object
+    auto finish = [&](const std::string& error) {
+        for (auto* changed : { &upnpChanged, &uiChanged }) {
+            std::sort(changed->begin(), changed->end());
+            changed->erase(std::unique(changed->begin(), changed->end()), changed->end());
+            changed->erase(std::remove(changed->begin(), changed->end(), INVALID_OBJECT_ID), changed->end());
+        }
+        session_manager->containerChangedUI(uiChanged);
+        update_manager->containersChanged(upnpChanged);
+
+        result.done = true;
+        result.error = error;
+        AutoLock lock(mutex);
+        bulkResults[task->getID()] = result;
+        while (bulkResults.size() > BULK_RESULTS_KEPT)
+            bulkResults.erase(bulkResults.begin());
+    };
 
-            // we have to make sure that a currently running autoscan task will not
-            // launch add tasks for directories that anyway are going to be deleted
-            for (i = 0; i < qsize; i++) {
-                Ref<GenericTask> t = taskQueue1->get(i);
-                invalidateAddTask(t, path);
+    try {
+        for (size_t start = 0; start < objectIDs.size() && !shutdownFlag && task->isValid(); start += BULK_OBJECTS_CHUNK) {
+            size_t end = std::min(start + BULK_OBJECTS_CHUNK, objectIDs.size());
+            task->setDescription(verb + ": " + std::to_string(start) + " of " + std::to_string(objectIDs.size()) + " objects");
+
+            if (action == BulkAction::Rescan) {
+                // rescans only queue tasks of their own
+                for (size_t i = start; i < end; i++) {
+                    Ref<AutoscanDirectory> adir = autoscan_timed->getByObjectID(objectIDs[i]);
+#ifdef HAVE_INOTIFY
+                    if (adir == nullptr && config->getBoolOption(CFG_IMPORT_AUTOSCAN_USE_INOTIFY))
+                        adir = autoscan_inotify->getByObjectID(objectIDs[i]);
+#endif
+                    if (adir == nullptr) {
+                        log_warning("Object %d is not an autoscan directory, not rescanning it\n", objectIDs[i]);
+                        result.failedIDs.push_back(objectIDs[i]);
+                        continue;
+                    }
+                    rescanDirectory(objectIDs[i], adir->getScanID(), adir->getScanMode());
+                }
+                continue;
             }
 
-            qsize = taskQueue2->size();
-            for (i = 0; i < qsize; i++) {
-                Ref<GenericTask> t = taskQueue2->get(i);
-                invalidateAddTask(t, path);
+            std::vector<int> chunk(objectIDs.begin() + start, objectIDs.begin() + end);
+            while (!bulkChunk(action, chunk, parameters, upnpChanged, uiChanged, result.failedIDs)) {
             }
+        }
+    } catch (const Exception& e) {
+        finish(e.getMessage());
+        throw;
+    }
+    finish("");
+    log_info("%s of %zu objects done, %zu failed\n", verb.c_str(), objectIDs.size(), result.failedIDs.size());
+}
 
-            Ref<GenericTask> t = getCurrentTask();
-            if (t != nullptr) {
-                invalidateAddTask(t, path);
+bool ContentManager::bulkChunk(BulkAction action, std::vector<int>& objectIDs, const std::map<std::string, std::string>& parameters,
+    std::vector<int>& upnpChanged, std::vector<int>& uiChanged, std::vector<int>& failedIDs)
+{
+    std::vector<int> upnp;
+    std::vector<int> ui;
+    storage->beginTransaction();
+    try {
+        if (action == BulkAction::Remove) {
+            auto list = std::make_unique<std::unordered_set<int>>();
+            for (int objectID : objectIDs) {
+                if (objectID == CDS_ID_ROOT || objectID == CDS_ID_FS_ROOT || IS_FORBIDDEN_CDS_ID(objectID)) {
+                    log_warning("Not removing protected object %d\n", objectID);
+                    failedIDs.push_back(objectID);
+                    continue;
+                }
+                std::shared_ptr<CdsObject> obj;
+                try {
+                    obj = storage->loadObject(objectID);
+                } catch (const Exception& e) {
+                    // already gone with an earlier container of the list
+                    continue;
+                }
+                if (IS_CDS_CONTAINER(obj->getObjectType()) && string_ok(obj->getLocation()))
+                    prepareContainerRemoval(obj->getLocation());
+                list->insert(objectID);
+            }
+            auto changedContainers = storage->removeObjects(list, getValueOrDefault(parameters, "all") == "1");
+            if (changedContainers != nullptr) {
+                upnp = changedContainers->upnp;
+                ui = changedContainers->ui;
+            }
+        } else {
+            for (auto it = objectIDs.begin(); it != objectIDs.end(); ++it) {
+                try {
+                    editObject(*it, parameters, upnp);
+                } catch (const Exception& e) {
+                    log_warning("Could not edit object %d: %s\n", *it, e.getMessage().c_str());
+                    failedIDs.push_back(*it);
+                    objectIDs.erase(it);
+                    storage->rollbackTransaction();
+                    return false;
+                }
             }
+            ui = upnp;
         }
+    } catch (const Exception&) {
+        storage->rollbackTransaction();
+        throw;
+    }
+    storage->commitTransaction();
 
-        addTask(task);
-    } else {
-        _removeObject(objectID, all);
+    upnpChanged.insert(upnpChanged.end(), upnp.begin(), upnp.end());
+    uiChanged.insert(uiChanged.end(), ui.begin(), ui.end());
+    return true;
+}
+
+void ContentManager::editObject(int objectID, const std::map<std::string, std::string>& parameters, std::vector<int>& changedContainers)
+{
+    auto obj = storage->loadObject(objectID);
+    int objectType = obj->getObjectType();
+    auto clone = CdsObject::createObject(storage, objectType);
+    obj->copyTo(clone);
+
+    std::string upnp_class = getValueOrDefault(parameters, "class");
+    if (string_ok(upnp_class))
+        clone->setClass(upnp_class);
+
+    if (IS_CDS_ITEM(objectType)) {
+        auto item = std::static_pointer_cast<CdsItem>(clone);
+        std::string mimetype = getValueOrDefault(parameters, "mime-type");
+        if (string_ok(mimetype)) {
+            item->setMimeType(mimetype);
+            if (item->getResourceCount() > 0) {
+                auto resource = item->getResource(0);
+                std::vector<std::string> parts = split_string(resource->getAttribute("protocolInfo"), ':');
+                resource->addAttribute("protocolInfo", renderProtocolInfo(mimetype, parts.empty() ? PROTOCOL : parts[0]));
+            }
+        }
+        // unlike updateObject(), a missing description is left alone
+        auto description = parameters.find("description");
+        if (description != parameters.end()) {
+            if (string_ok(description->second))
+                item->setMetadata(MetadataHandler::getMetaFieldName(M_DESCRIPTION), description->second);
+            else
+                item->removeMetadata(MetadataHandler::getMetaFieldName(M_DESCRIPTION));
+        }
+    }
+
+    if (obj->equals(clone, true))
+        return;
+
+    clone->validate();
+    int containerChanged = INVALID_OBJECT_ID;
+    storage->updateObject(clone, &containerChanged);
+    changedContainers.push_back(containerChanged);
+    changedContainers.push_back(obj->getParentID());
+}
+
+void ContentManager::removeObjects(const std::unique_ptr<std::unordered_set<int>>& list, bool all)
+{
+    auto changedContainers = storage->removeObjects(list, all);
+    if (changedContainers != nullptr) {
+        session_manager->containerChangedUI(changedContainers->ui);
+        update_manager->containersChanged(changedContainers->upnp);
     }
 }
 
@@ -1789,7 +2149,7 @@ void ContentManager::triggerPlayHook(std::shared_ptr<CdsObject> obj)
 {
     log_debug("start\n");
 
-    if (config->getBoolOption(CFG_SERVER_EXTOPTS_MARK_PLAYED_ITEMS_ENABLED) && !obj->getFlag(OBJECT_FLAG_PLAYED)) {
+    if (config->getBoolOption(CFG_SERVER_EXTOPTS_MARK_PLAYED_ITEMS_ENABLED) && !obj->getFlag(OBJECT_FLAG_PLAYED) && !storage->isReader()) {
         std::vector<std::string>  mark_list = config->getStringArrayOption(CFG_SERVER_EXTOPTS_MARK_PLAYED_ITEMS_CONTENT_LIST);
         for (size_t i = 0; i < mark_list.size(); i++) {
             if (startswith(std::static_pointer_cast<CdsItem>(obj)->getMimeType(), mark_list[i])) {
@@ -1811,6 +2171,54 @@ void ContentManager::triggerPlayHook(std::shared_ptr<CdsObject> obj)
     log_debug("end\n");
 }
 
+std::shared_ptr<SeekIndex> ContentManager::getSeekIndex(std::string path)
+{
+    return seekIndexes->get(path);
+}
+
+void ContentManager::updateSubtitles(std::string path)
+{
+    for (const auto& video : SubtitleHandler::findVideos(path)) {
+        int objectID = storage->findObjectIDByPath(video);
+        if (objectID != INVALID_OBJECT_ID)
+            updateSubtitleResources(objectID);
+    }
+}
+
+void ContentManager::updateSubtitleResources(int objectID)
+{
+    auto obj = storage->loadObject(objectID);
+    if (!IS_CDS_ITEM(obj->getObjectType()))
+        return;
+    auto item = std::static_pointer_cast<CdsItem>(obj);
+    if (!startswith(item->getMimeType(), "video"))
+        return;
+    SubtitleHandler handler(config);
+    if (handler.updateResources(item)) {
+        log_debug("Subtitles of %s changed\n", item->getLocation().c_str());
+        updateObject(item);
+    }
+}
+
+void ContentManager::migrateSubtitles()
+{
+    if (string_ok(storage->getInternalSetting(SUBTITLE_MIGRATION_SETTING)))
+        return;
+
+    auto ids = storage->getFileItemIDs("video/");
+    log_info("Looking for subtitles of %zu videos\n", ids->size());
+    for (int objectID : *ids) {
+        if (shutdownFlag)
+            return;
+        try {
+            updateSubtitleResources(objectID);
+        } catch (const Exception& e) {
+            log_warning("Subtitles of object %d not updated: %s\n", objectID, e.getMessage().c_str());
+        }
+    }
+    storage->storeInternalSetting(SUBTITLE_MIGRATION_SETTING, "1");
+}
+
 CMAddFileTask::CMAddFileTask(std::shared_ptr<ContentManager> content,
     std::string path, std::string rootpath, bool recursive, bool hidden, bool cancellable)
     : GenericTask(ContentManagerTask)
@@ -1850,6 +2258,25 @@ void CMRemoveObjectTask::run()
     content->_removeObject(objectID, all);
 }
 
+CMBulkObjectsTask::CMBulkObjectsTask(std::shared_ptr<ContentManager> content,
+    BulkAction action, std::vector<int> objectIDs,
+    std::map<std::string, std::string> parameters)
+    : GenericTask(ContentManagerTask)
+    , content(content)
+    , action(action)
+    , objectIDs(std::move(objectIDs))
+    , parameters(std::move(parameters))
+{
+    this->taskType = BulkObjects;
+    // objects that are already processed stay processed
+    cancellable = true;
+}
+
+void CMBulkObjectsTask::run()
+{
+    content->_bulkObjects(action, objectIDs, parameters, Ref<GenericTask>(this));
+}
+
 CMRescanDirectoryTask::CMRescanDirectoryTask(std::shared_ptr<ContentManager> content,
     int objectID, int scanID, ScanMode scanMode, bool cancellable)
     : GenericTask(ContentManagerTask)
@@ -1921,6 +2348,19 @@ void CMLoadAccountingTask::run()
     content->_loadAccounting();
 }
 
+CMDeferredInitTask::CMDeferredInitTask(std::shared_ptr<ContentManager> content)
+    : GenericTask(ContentManagerTask)
+    , content(content)
+{
+    this->taskType = DeferredInit;
+    this->cancellable = false;
+}
+
+void CMDeferredInitTask::run()
+{
+    content->_initDeferred();
+}
+
 CMAccounting::CMAccounting()
     : Object()
 {
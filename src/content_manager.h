@@ -72,6 +72,9 @@ class UpdateManager;
 namespace web { class SessionManager; }
 class Runtime;
 class LastFm;
+class MimeDetector;
+class SeekIndex;
+class SeekIndexCache;
 class ContentManager;
 class TaskProcessor;
 
@@ -90,6 +93,7 @@ public:
     std::string getPath();
     std::string getRootPath();
     virtual void run() override;
+    size_t getMemoryUsage() override { return sizeof(*this) + description.size() + path.size() + rootpath.size(); }
 };
 
 class CMRemoveObjectTask : public GenericTask {
@@ -102,6 +106,39 @@ public:
     CMRemoveObjectTask(std::shared_ptr<ContentManager> content,
         int objectID, bool all);
     virtual void run() override;
+    size_t getMemoryUsage() override { return sizeof(*this) + description.size(); }
+};
+
+/// \brief Operations of ContentManager::bulkObjects()
+enum class BulkAction {
+    Remove,
+    Rescan,
+    Edit
+};
+
+/// \brief Outcome of a ContentManager::bulkObjects() task
+struct BulkResult {
+    /// \brief the task has finished or failed
+    bool done = false;
+    /// \brief objects that could not be removed, rescanned or edited
+    std::vector<int> failedIDs;
+    /// \brief message of the error that stopped the task, empty if none
+    std::string error;
+};
+
+class CMBulkObjectsTask : public GenericTask {
+protected:
+    std::shared_ptr<ContentManager> content;
+    BulkAction action;
+    std::vector<int> objectIDs;
+    std::map<std::string, std::string> parameters;
+
+public:
+    CMBulkObjectsTask(std::shared_ptr<ContentManager> content,
+        BulkAction action, std::vector<int> objectIDs,
+        std::map<std::string, std::string> parameters);
+    virtual void run() override;
+    size_t getMemoryUsage() override { return sizeof(*this) + description.size() + objectIDs.size() * sizeof(int) + parameters.size() * sizeof(*parameters.begin()); }
 };
 
 class CMLoadAccountingTask : public GenericTask {
@@ -110,6 +147,16 @@ protected:
 public:
     CMLoadAccountingTask(std::shared_ptr<ContentManager> content);
     virtual void run() override;
+    size_t getMemoryUsage() override { return sizeof(*this) + description.size(); }
+};
+
+class CMDeferredInitTask : public GenericTask {
+protected:
+    std::shared_ptr<ContentManager> content;
+public:
+    CMDeferredInitTask(std::shared_ptr<ContentManager> content);
+    virtual void run() override;
+    size_t getMemoryUsage() override { return sizeof(*this) + description.size(); }
 };
 
 class CMRescanDirectoryTask : public GenericTask {
@@ -124,6 +171,7 @@ public:
         int objectID, int scanID, ScanMode scanMode,
         bool cancellable);
     virtual void run() override;
+    size_t getMemoryUsage() override { return sizeof(*this) + description.size(); }
 };
 
 class CMAccounting : public zmm::Object {
@@ -151,6 +199,7 @@ public:
         zmm::Ref<OnlineService> service, zmm::Ref<Layout> layout,
         bool cancellable, bool unscheduled_refresh);
     virtual void run() override;
+    size_t getMemoryUsage() override { return sizeof(*this) + description.size(); }
 };
 #endif
 
@@ -161,6 +210,12 @@ public:
         std::shared_ptr<Timer> timer, std::shared_ptr<TaskProcessor> task_processor,
         std::shared_ptr<Runtime> scripting_runtime, std::shared_ptr<LastFm> last_fm);
     void init();
+
+    /// \brief Queues the initialisation that is not needed to answer
+    /// requests: accounting, script compilation, inotify watches and the
+    /// initial autoscans. Called once the server has been announced.
+    void initDeferred();
+
     virtual ~ContentManager();
     void shutdown();
 
@@ -207,11 +262,41 @@ public:
         bool hidden = false, bool lowPriority = false,
         bool cancellable = true);
 
+    /// \brief Adds files and directory trees to the database as fast as
+    /// possible, synchronously and without going through the task queue.
+    ///
+    /// Metadata of a batch of files is read by the given number of threads,
+    /// the batch is then added to storage and layout in one transaction.
+    /// \param roots files and directories to add, their recursive and
+    /// hidden flags apply to everything found below them
+    /// \param threads number of threads reading files
+    void bulkImport(zmm::Ref<zmm::Array<AutoscanDirectory>> roots, int threads);
+
     int ensurePathExistence(std::string path);
     void removeObject(int objectID, bool async = true, bool all = false);
+    /// \brief Removes a set of objects with one storage call, synchronously.
+    void removeObjects(const std::unique_ptr<std::unordered_set<int>>& list, bool all = false);
     void rescanDirectory(int objectID, int scanID, ScanMode scanMode,
         std::string descPath = "", bool cancellable = true);
 
+    /// \brief Removes, rescans or edits a list of objects in one task.
+    ///
+    /// Removals and edits are committed in chunks of one storage
+    /// transaction each, an object whose edit fails is left out and the
+    /// rest of its chunk is done again. The containers changed by the
+    /// committed chunks are announced once at the end, also when a later
+    /// chunk failed; the task description reports the progress.
+    /// \param action what to do with the objects
+    /// \param objectIDs objects to process
+    /// \param parameters "all" for removals, "class", "mime-type" and
+    /// "description" for edits; only the given fields are changed
+    /// \return ID of the task for getBulkResult(), 0 if there is nothing to do
+    unsigned int bulkObjects(BulkAction action, const std::vector<int>& objectIDs, const std::map<std::string, std::string>& parameters);
+
+    /// \brief Returns the outcome of a bulkObjects() task, nullptr if the
+    /// task is unknown or too old.
+    std::unique_ptr<BulkResult> getBulkResult(unsigned int taskID);
+
     /// \brief Updates an object in the database using the given parameters.
     /// \param objectID ID of the object to update
     /// \param parameters key value pairs of fields to be updated
@@ -227,9 +312,6 @@ public:
     void fetchOnlineContent(service_type_t service, bool lowPriority = true,
         bool cancellable = true,
         bool unscheduled_refresh = false);
-
-    void cleanupOnlineServiceObjects(zmm::Ref<OnlineService> service);
-
 #endif //ONLINE_SERVICES
 
     /// \brief Adds a virtual item.
@@ -329,10 +411,27 @@ public:
 
     void triggerPlayHook(std::shared_ptr<CdsObject> obj);
 
+    /// \brief Returns the key frame index of a media file, built on the
+    /// first request and kept while the file is unchanged.
+    /// \return nullptr if the container is not supported
+    std::shared_ptr<SeekIndex> getSeekIndex(std::string path);
+
+    /// \brief Updates the subtitle resources of the videos a subtitle file
+    /// belongs to after it was added, changed or removed.
+    void updateSubtitles(std::string path);
+
 protected:
     void initLayout();
     void destroyLayout();
 
+    /// \brief Replaces the subtitle resources of a video item with the
+    /// subtitle files next to it now.
+    void updateSubtitleResources(int objectID);
+
+    /// \brief Adds the subtitle resources to the videos imported before
+    /// subtitles were looked up on import, once.
+    void migrateSubtitles();
+
 #ifdef HAVE_JS
     void initJS();
     void destroyJS();
@@ -359,6 +458,13 @@ protected:
     std::map<std::string,std::string> extension_mimetype_map;
     std::map<std::string,std::string> mimetype_upnpclass_map;
     std::map<std::string,std::string> mimetype_contenttype_map;
+#ifdef HAVE_MAGIC
+    /// \brief detects files with unknown extensions, nullptr if they are ignored
+    std::shared_ptr<MimeDetector> mime;
+#endif
+    std::shared_ptr<SeekIndexCache> seekIndexes;
+    /// \brief results of the last bulkObjects() tasks by task ID
+    std::map<unsigned int, BulkResult> bulkResults;
 
     zmm::Ref<AutoscanList> autoscan_timed;
 #ifdef HAVE_INOTIFY
@@ -369,6 +475,7 @@ protected:
     std::vector<std::shared_ptr<Executor>> process_list;
 
     void _loadAccounting();
+    void _initDeferred();
 
     int addFileInternal(std::string path, std::string rootpath,
         bool recursive = true,
@@ -379,6 +486,18 @@ protected:
     int _addFile(std::string path, std::string rootPath, bool recursive = false, bool hidden = false, zmm::Ref<GenericTask> task = nullptr);
     //void _addFile2(std::string path, bool recursive=0);
     void _removeObject(int objectID, bool all);
+    void _bulkObjects(BulkAction action, const std::vector<int>& objectIDs, const std::map<std::string, std::string>& parameters, zmm::Ref<GenericTask> task);
+    /// \brief Runs one chunk of a bulkObjects() task in a transaction.
+    /// \return false if an edit failed, its object was moved from
+    /// objectIDs to failedIDs and the chunk was rolled back
+    bool bulkChunk(BulkAction action, std::vector<int>& objectIDs, const std::map<std::string, std::string>& parameters,
+        std::vector<int>& upnpChanged, std::vector<int>& uiChanged, std::vector<int>& failedIDs);
+    /// \brief Changes the given fields of an object and collects the
+    /// containers to announce.
+    void editObject(int objectID, const std::map<std::string, std::string>& parameters, std::vector<int>& changedContainers);
+    /// \brief Drops the autoscans below a container that is going to be
+    /// removed and the pending add tasks for it.
+    void prepareContainerRemoval(const std::string& path);
 
     void _rescanDirectory(int containerID, int scanID, ScanMode scanMode, ScanLevel scanLevel, zmm::Ref<GenericTask> task = nullptr);
     /* for recursive addition */
@@ -434,11 +553,13 @@ protected:
 
     friend void CMAddFileTask::run();
     friend void CMRemoveObjectTask::run();
+    friend void CMBulkObjectsTask::run();
     friend void CMRescanDirectoryTask::run();
 #ifdef ONLINE_SERVICES
     friend void CMFetchOnlineContentTask::run();
 #endif
     friend void CMLoadAccountingTask::run();
+    friend void CMDeferredInitTask::run();
 };
 
 #endif // __CONTENT_MANAGER_H__
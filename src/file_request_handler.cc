@@ -229,39 +229,29 @@ void FileRequestHandler::getInfo(const char* filename, UpnpFileInfo* info)
     } else {
         UpnpFileInfo_set_FileLength(info, statbuf.st_size);
 
+        // a time seek is answered with the bytes from the key frame before it
+        std::string range = Headers::getRequestHeader(info, D_HTTP_TIME_SEEK_RANGE_HEADER);
+        SeekIndex::Point point;
+        std::shared_ptr<SeekIndex> index;
+        if (!is_srt && string_ok(range) && (index = findSeekPoint(path, range, point)) != nullptr) {
+            std::string duration = index->getDuration() > 0 ? SeekIndex::formatNpt(index->getDuration()) : "";
+            std::string timeSeekRange = "npt=" + SeekIndex::formatNpt(point.time) + "-" + duration
+                + "/" + (string_ok(duration) ? duration : "*")
+                + " bytes=" + std::to_string(point.offset) + "-" + std::to_string(statbuf.st_size - 1)
+                + "/" + std::to_string(statbuf.st_size);
+            headers.addHeader(D_HTTP_TIME_SEEK_RANGE_HEADER, timeSeekRange);
+            UpnpFileInfo_set_FileLength(info, statbuf.st_size - point.offset);
+        }
+
         if (config->getBoolOption(CFG_SERVER_EXTEND_PROTOCOLINFO_SM_HACK)) {
-            if (startswith(item->getMimeType(), "video")) {
-                // Look for subtitle file and returns it's URL
-                // in CaptionInfo.sec response header.
-                // To be more compliant with original Samsung
-                // server we should check for getCaptionInfo.sec: 1
-                // request header.
-                std::vector<std::string> subexts;
-                subexts.reserve(4);
-                subexts.push_back(".srt");
-                subexts.push_back(".ssa");
-                subexts.push_back(".smi");
-                subexts.push_back(".sub");
-
-                std::string bfilepath = path.substr(0, path.rfind('.'));
-                std::string validext;
-                for (size_t i = 0; i < subexts.size(); i++) {
-                    std::string ext = subexts[i];
-
-                    std::string fpath = bfilepath + ext;
-                    if (access(fpath.c_str(), R_OK) == 0) {
-                        validext = ext;
-                        break;
-                    }
-                }
-
-                if (validext.length() > 0) {
-                    std::string burlpath = filename;
-                    burlpath = burlpath.substr(0, burlpath.rfind('.'));
-                    std::string url = "http://" + Server::getIP() + ":" + Server::getPort() + burlpath + validext;
-                    headers.addHeader("CaptionInfo.sec:", url);
-                }
-            }
+            // Return the URL of the subtitle found on import in the
+            // CaptionInfo.sec response header.
+            // To be more compliant with original Samsung
+            // server we should check for getCaptionInfo.sec: 1
+            // request header.
+            std::string url = xmlBuilder->getSubtitleURL(item);
+            if (string_ok(url))
+                headers.addHeader("CaptionInfo.sec", url);
         }
         auto mappings = config->getDictionaryOption(
             CFG_IMPORT_MAPPINGS_MIMETYPE_TO_CONTENTTYPE_LIST);
@@ -476,7 +466,9 @@ std::unique_ptr<IOHandler> FileRequestHandler::open(const char* filename,
 
     } else {
         if (!is_srt && string_ok(tr_profile)) {
-            std::string range = getValueOrDefault(params, "range");
+            // the time seek header takes precedence over a range in the URL
+            if (!string_ok(range))
+                range = getValueOrDefault(params, "range");
 
             Ref<TranscodeDispatcher> tr_d(new TranscodeDispatcher(config, content));
             Ref<TranscodingProfile> tp = config->getTranscodingProfileListOption(CFG_TRANSCODING_PROFILE_LIST)->getByName(tr_profile);
@@ -510,9 +502,27 @@ std::unique_ptr<IOHandler> FileRequestHandler::open(const char* filename,
 
             auto io_handler = std::make_unique<FileIOHandler>(path);
             io_handler->open(mode);
+
+            // getInfo announced the stream to start at the key frame
+            SeekIndex::Point point;
+            if (!is_srt && string_ok(range) && findSeekPoint(path, range, point) != nullptr) {
+                log_debug("time seek %s starts at byte %lld\n", range.c_str(), (long long)point.offset);
+                io_handler->seek(point.offset, SEEK_SET);
+            }
             content->triggerPlayHook(obj);
             log_debug("end\n");
             return io_handler;
         }
     }
 }
+
+std::shared_ptr<SeekIndex> FileRequestHandler::findSeekPoint(const std::string& path, const std::string& range, SeekIndex::Point& point)
+{
+    double start = SeekIndex::parseNptStart(range);
+    if (start < 0)
+        return nullptr;
+    auto index = content->getSeekIndex(path);
+    if (index == nullptr || !index->find(start, point))
+        return nullptr;
+    return index;
+}
@@ -35,6 +35,7 @@
 #include <memory>
 #include "common.h"
 #include "request_handler.h"
+#include "util/seek_index.h"
 #include "upnp_xml.h"
 
 // forward declaration
@@ -62,6 +63,12 @@ public:
         const char* filename,
         enum UpnpOpenFileMode mode,
         std::string range);
+    bool servesMedia() const override { return true; }
+
+protected:
+    /// \brief Maps the start of a time seek range to the key frame before it.
+    /// \return nullptr if the range is invalid or the file has no index
+    std::shared_ptr<SeekIndex> findSeekPoint(const std::string& path, const std::string& range, SeekIndex::Point& point);
 };
 
 #endif // __FILE_REQUEST_HANDLER_H__
@@ -31,6 +31,7 @@
 
 #include "io_handler_buffer_helper.h"
 #include "config/config_manager.h"
+#include "util/memory_accounting.h"
 
 using namespace zmm;
 using namespace std;
@@ -67,6 +68,7 @@ void IOHandlerBufferHelper::open(enum UpnpOpenFileMode mode)
     buffer = (char*)MALLOC(bufSize);
     if (buffer == nullptr)
         throw _Exception("Failed to allocate memory for transcoding buffer!");
+    MemoryAccounting::add(MemoryAccounting::ACCOUNT_IO_BUFFERS, bufSize, 1);
 
     startBufferThread();
     isOpen = true;
@@ -184,6 +186,7 @@ void IOHandlerBufferHelper::close()
     stopBufferThread();
     FREE(buffer);
     buffer = nullptr;
+    MemoryAccounting::sub(MemoryAccounting::ACCOUNT_IO_BUFFERS, bufSize, 1);
 }
 
 // thread stuff...
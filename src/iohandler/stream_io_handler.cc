@@ -0,0 +1,73 @@
+/*GRB*
+
+Gerbera - https://gerbera.io/
+
+    stream_io_handler.cc - this file is part of Gerbera.
+
+    Copyright (C) 2016-2019 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file stream_io_handler.cc
+
+#include "stream_io_handler.h"
+#include <chrono>
+
+#include "util/scheduling.h"
+
+StreamIOHandler::StreamIOHandler(std::unique_ptr<IOHandler> handler)
+    : handler(std::move(handler))
+{
+    ImportThrottle::streamOpened();
+}
+
+StreamIOHandler::~StreamIOHandler()
+{
+    ImportThrottle::streamClosed();
+}
+
+void StreamIOHandler::open(enum UpnpOpenFileMode mode)
+{
+    handler->open(mode);
+}
+
+size_t StreamIOHandler::read(char* buf, size_t length)
+{
+    auto start = std::chrono::steady_clock::now();
+    size_t ret = handler->read(buf, length);
+    ImportThrottle::recordRead(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+    return ret;
+}
+
+size_t StreamIOHandler::write(char* buf, size_t length)
+{
+    return handler->write(buf, length);
+}
+
+void StreamIOHandler::seek(off_t offset, int whence)
+{
+    handler->seek(offset, whence);
+}
+
+off_t StreamIOHandler::tell()
+{
+    return handler->tell();
+}
+
+void StreamIOHandler::close()
+{
+    handler->close();
+}
@@ -0,0 +1,51 @@
+/*GRB*
+
+Gerbera - https://gerbera.io/
+
+    stream_io_handler.h - this file is part of Gerbera.
+
+    Copyright (C) 2016-2019 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file stream_io_handler.h
+/// \brief Definition of the StreamIOHandler class.
+#ifndef __STREAM_IO_HANDLER_H__
+#define __STREAM_IO_HANDLER_H__
+
+#include <memory>
+
+#include "io_handler.h"
+
+/// \brief Serves a media stream through another IOHandler and reports
+/// it to the ImportThrottle while it is open.
+class StreamIOHandler : public IOHandler {
+public:
+    explicit StreamIOHandler(std::unique_ptr<IOHandler> handler);
+    ~StreamIOHandler() override;
+
+    void open(enum UpnpOpenFileMode mode) override;
+    size_t read(char* buf, size_t length) override;
+    size_t write(char* buf, size_t length) override;
+    void seek(off_t offset, int whence) override;
+    off_t tell() override;
+    void close() override;
+
+protected:
+    std::unique_ptr<IOHandler> handler;
+};
+
+#endif // __STREAM_IO_HANDLER_H__
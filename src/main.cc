@@ -47,11 +47,13 @@
 
 #include "contrib/cxxopts.hpp"
 #include "server.h"
+#include "util/trace.h"
 
 using namespace zmm;
 
 int shutdown_flag = 0;
 int restart_flag = 0;
+int trace_flag = 0;
 pthread_t main_thread_id;
 
 std::mutex mutex;
@@ -109,7 +111,8 @@ int main(int argc, char** argv, char** envp)
     ("l,logfile", "Set log location", cxxopts::value<std::string>())("compile-info", "Print compile info and exit")
     ("v,version", "Print version info and exit")("h,help", "Print this help and exit")
     ("create-config", "Print a default config.xml file and exit")
-    ("add-file", "Scan a file into the DB on startup, can be specified multiple times", cxxopts::value<std::vector<std::string>>(), "FILE");
+    ("add-file", "Scan a file into the DB on startup, can be specified multiple times", cxxopts::value<std::vector<std::string>>(), "FILE")
+    ("index-only", "Build the DB from the --add-file paths or the autoscan directories without starting the server, then exit");
 
     try {
         cxxopts::ParseResult opts = options.parse(argc, argv);
@@ -259,6 +262,24 @@ int main(int argc, char** argv, char** envp)
             exit(EXIT_FAILURE);
         }
 
+        // default signal handling applies, an interrupted build leaves the
+        // existing database untouched
+        if (opts.count("index-only") > 0) {
+            std::vector<std::string> files;
+            if (opts.count("add-file") > 0)
+                files = opts["add-file"].as<std::vector<std::string>>();
+            try {
+                auto indexer = std::make_shared<Server>(config);
+                indexer->index(files);
+            } catch (const Exception& e) {
+                log_error("%s\n", e.getMessage().c_str());
+                e.printStackTrace();
+                exit(EXIT_FAILURE);
+            }
+            log_close();
+            exit(EXIT_SUCCESS);
+        }
+
         struct sigaction action;
         sigset_t mask_set;
         main_thread_id = pthread_self();
@@ -286,6 +307,10 @@ int main(int argc, char** argv, char** envp)
             log_error("Could not register SIGPIPE handler!\n");
         }
 
+        if (sigaction(SIGUSR1, &action, nullptr) < 0) {
+            log_error("Could not register SIGUSR1 handler!\n");
+        }
+
         std::shared_ptr<Server> server;
         try {
             server = std::make_shared<Server>(config);
@@ -347,6 +372,21 @@ int main(int argc, char** argv, char** envp)
         while (!shutdown_flag) {
             cond.wait(lock);
 
+            if (trace_flag != 0) {
+                trace_flag = 0;
+                if (!Trace::isEnabled()) {
+                    Trace::clear();
+                    Trace::setEnabled(true);
+                } else {
+                    Trace::setEnabled(false);
+                    try {
+                        Trace::dump(config->getOption(CFG_SERVER_TRACE_FILE));
+                    } catch (const Exception& e) {
+                        log_error("%s\n", e.getMessage().c_str());
+                    }
+                }
+            }
+
             if (restart_flag != 0) {
                 log_info("Restarting Gerbera!\n");
                 try {
@@ -432,6 +472,8 @@ void signal_handler(int signum)
         }
     } else if (signum == SIGHUP) {
         restart_flag = 1;
+    } else if (signum == SIGUSR1) {
+        trace_flag = 1;
     }
 
     cond.notify_one();
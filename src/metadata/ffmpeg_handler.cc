@@ -61,6 +61,7 @@ extern "C" {
 #ifdef HAVE_FFMPEGTHUMBNAILER
 #include "iohandler/mem_io_handler.h"
 #include <libffmpegthumbnailer/videothumbnailerc.h>
+#include "util/scheduling.h"
 #endif
 
 #include "config/config_manager.h"
@@ -404,6 +405,7 @@ std::unique_ptr<IOHandler> FfmpegHandler::serveContent(std::shared_ptr<CdsItem>
     }
 
     pthread_mutex_lock(&thumb_lock);
+    Scheduling::IOPriorityScope ioPriority(Scheduling::GROUP_THUMBNAIL);
 
 #ifdef FFMPEGTHUMBNAILER_OLD_API
     video_thumbnailer* th = create_thumbnailer();
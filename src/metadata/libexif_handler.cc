@@ -35,6 +35,7 @@
 #include "libexif_handler.h"
 #include "config/config_manager.h"
 #include "iohandler/mem_io_handler.h"
+#include "util/image_resolution.h"
 #include "util/tools.h"
 
 using namespace zmm;
@@ -345,9 +346,9 @@ void LibExifHandler::fillMetadata(std::shared_ptr<CdsItem> item)
 
     ed = exif_data_new_from_file(item->getLocation().c_str());
 
+    // the resolution was read from the image header before
     if (!ed) {
-        log_debug("Exif data not found, attempting to set resolution internally...\n");
-        set_jpeg_resolution_resource(item, 0);
+        log_debug("Exif data not found\n");
         return;
     }
 
@@ -357,30 +358,24 @@ void LibExifHandler::fillMetadata(std::shared_ptr<CdsItem> item)
             process_ifd(ed->ifd[i], item, sc, aux);
     }
 
-    // we got the image resolution so we can add our resource
-    if (string_ok(imageX) && string_ok(imageY)) {
+    // EXIF dimensions are only used if the header could not be read,
+    // editors often leave them unchanged when an image is resized
+    std::string resolution = item->getResource(0)->getAttribute(MetadataHandler::getResAttrName(R_RESOLUTION));
+    if (!string_ok(resolution) && string_ok(imageX) && string_ok(imageY)) {
         item->getResource(0)->addAttribute(MetadataHandler::getResAttrName(R_RESOLUTION),
             imageX + "x" + imageY);
-    } else {
-        set_jpeg_resolution_resource(item, 0);
     }
 
-    if (ed->size) {
-        try {
-            std::unique_ptr<IOHandler> io_h(new MemIOHandler(ed->data, ed->size));
-            io_h->open(UPNP_READ);
-            std::string th_resolution = get_jpeg_resolution(io_h);
-            log_debug("RESOLUTION: %s\n", th_resolution.c_str());
-
-            auto resource = std::make_shared<CdsResource>(CH_LIBEXIF);
-            resource->addAttribute(MetadataHandler::getResAttrName(R_PROTOCOLINFO), renderProtocolInfo(item->getMimeType()));
-            resource->addAttribute(MetadataHandler::getResAttrName(R_RESOLUTION), th_resolution);
-            resource->addParameter(RESOURCE_CONTENT_TYPE, EXIF_THUMBNAIL);
-            item->addResource(resource);
-        } catch (const Exception& e) {
-            e.printStackTrace();
-        }
+    int thumbWidth, thumbHeight;
+    if (ed->size && probeImageResolution(reinterpret_cast<const char*>(ed->data), ed->size, &thumbWidth, &thumbHeight)) {
+        std::string th_resolution = std::to_string(thumbWidth) + "x" + std::to_string(thumbHeight);
+        log_debug("RESOLUTION: %s\n", th_resolution.c_str());
 
+        auto resource = std::make_shared<CdsResource>(CH_LIBEXIF);
+        resource->addAttribute(MetadataHandler::getResAttrName(R_PROTOCOLINFO), renderProtocolInfo(item->getMimeType()));
+        resource->addAttribute(MetadataHandler::getResAttrName(R_RESOLUTION), th_resolution);
+        resource->addParameter(RESOURCE_CONTENT_TYPE, EXIF_THUMBNAIL);
+        item->addResource(resource);
     } // (ed->size)
     exif_data_unref(ed);
 }
@@ -32,7 +32,9 @@
 
 #include "metadata_handler.h"
 #include "config/config_manager.h"
+#include "util/image_resolution.h"
 #include "util/tools.h"
+#include "util/trace.h"
 
 #ifdef HAVE_EXIV2
 #include "metadata/exiv2_handler.h"
@@ -55,6 +57,7 @@
 #endif
 
 #include "metadata/fanart_handler.h"
+#include "metadata/subtitle_handler.h"
 
 using namespace zmm;
 
@@ -100,6 +103,7 @@ MetadataHandler::MetadataHandler(std::shared_ptr<ConfigManager> config)
 
 void MetadataHandler::setMetadata(std::shared_ptr<ConfigManager> config, std::shared_ptr<CdsItem> item) {
     std::string location = item->getLocation();
+    TRACE_SPAN("metadata", "setMetadata", location);
     off_t filesize;
 
     string_ok_ex(location);
@@ -111,6 +115,15 @@ void MetadataHandler::setMetadata(std::shared_ptr<ConfigManager> config, std::sh
     resource->addAttribute(getResAttrName(R_PROTOCOLINFO), renderProtocolInfo(mimetype));
     resource->addAttribute(getResAttrName(R_SIZE), std::to_string(filesize));
 
+    // renderers use the resolution to pick a resource, without it they
+    // fetch the whole image to learn its size
+    if (startswith(mimetype, "image/")) {
+        TRACE_SPAN("metadata", "probeImageResolution");
+        std::string resolution = getImageResolution(location);
+        if (string_ok(resolution))
+            resource->addAttribute(getResAttrName(R_RESOLUTION), resolution);
+    }
+
     item->addResource(resource);
 
     auto mappings = config->getDictionaryOption(CFG_IMPORT_MAPPINGS_MIMETYPE_TO_CONTENTTYPE_LIST);
@@ -122,30 +135,35 @@ void MetadataHandler::setMetadata(std::shared_ptr<ConfigManager> config, std::sh
 
 #ifdef HAVE_TAGLIB
     if ((content_type == CONTENT_TYPE_MP3) || ((content_type == CONTENT_TYPE_OGG) && (!item->getFlag(OBJECT_FLAG_OGG_THEORA))) || (content_type == CONTENT_TYPE_WMA) || (content_type == CONTENT_TYPE_WAVPACK) || (content_type == CONTENT_TYPE_FLAC) || (content_type == CONTENT_TYPE_PCM) || (content_type == CONTENT_TYPE_AIFF) || (content_type == CONTENT_TYPE_APE) || (content_type == CONTENT_TYPE_MP4)) {
+        TRACE_SPAN("metadata", "TagLibHandler");
         TagLibHandler(config).fillMetadata(item);
     }
 #endif // HAVE_TAGLIB
 
 #ifdef HAVE_EXIV2
     if (content_type == CONTENT_TYPE_JPG) {
+        TRACE_SPAN("metadata", "Exiv2Handler");
         Exiv2Handler(config).fillMetadata(item);
     }
 #endif
 
 #ifdef HAVE_LIBEXIF
     if (content_type == CONTENT_TYPE_JPG) {
+        TRACE_SPAN("metadata", "LibExifHandler");
         LibExifHandler(config).fillMetadata(item);
     }
 #endif // HAVE_LIBEXIF
 
 #ifdef HAVE_MATROSKA
     if (content_type == CONTENT_TYPE_MKV) {
+        TRACE_SPAN("metadata", "MatroskaHandler");
         MatroskaHandler(config).fillMetadata(item);
     }
 #endif
 
 #ifdef HAVE_FFMPEG
     if (content_type != CONTENT_TYPE_PLAYLIST && ((content_type == CONTENT_TYPE_OGG && item->getFlag(OBJECT_FLAG_OGG_THEORA)) || startswith(item->getMimeType(), "video") || startswith(item->getMimeType(), "audio"))) {
+        TRACE_SPAN("metadata", "FfmpegHandler");
         FfmpegHandler(config).fillMetadata(item);
     }
 #else
@@ -160,6 +178,9 @@ void MetadataHandler::setMetadata(std::shared_ptr<ConfigManager> config, std::sh
 
     // Fanart for all things!
     FanArtHandler(config).fillMetadata(item);
+
+    // subtitles come last, artwork URLs expect the art at the second resource
+    SubtitleHandler(config).fillMetadata(item);
 }
 
 std::string MetadataHandler::getMetaFieldName(metadata_fields_t field)
@@ -193,6 +214,8 @@ std::unique_ptr<MetadataHandler> MetadataHandler::createHandler(std::shared_ptr<
 #endif
     case CH_FANART:
         return std::make_unique<FanArtHandler>(config);
+    case CH_SUBTITLE:
+        return std::make_unique<SubtitleHandler>(config);
     default:
         throw _Exception("unknown content handler ID: " + std::to_string(handlerType));
     }
@@ -47,6 +47,7 @@
 #define CH_FLAC 7
 #define CH_FANART 8
 #define CH_MATROSKA 9
+#define CH_SUBTITLE 10
 
 #define CONTENT_TYPE_MP3 "mp3"
 #define CONTENT_TYPE_OGG "ogg"
@@ -60,6 +61,7 @@
 #define CONTENT_TYPE_PCM "pcm"
 #define CONTENT_TYPE_AVI "avi"
 #define CONTENT_TYPE_MPEG "mpeg"
+#define CONTENT_TYPE_MPEGTS "mpegts"
 #define CONTENT_TYPE_QUICKTIME "quicktime"
 #define CONTENT_TYPE_MKV "mkv"
 #define CONTENT_TYPE_MKA "mka"
@@ -0,0 +1,211 @@
+/*GRB*
+
+Gerbera - https://gerbera.io/
+
+    subtitle_handler.cc - this file is part of Gerbera.
+
+    Copyright (C) 2016-2019 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file subtitle_handler.cc
+/// \brief Implementation of the SubtitleHandler class.
+
+#include "subtitle_handler.h"
+
+#include <algorithm>
+#include <dirent.h>
+#include <mutex>
+#include <sys/stat.h>
+
+#include "cds_objects.h"
+#include "iohandler/file_io_handler.h"
+#include "util/tools.h"
+
+// subtitle files kept for one video
+#define MAX_SUBTITLES 16
+
+static const struct {
+    const char* extension;
+    const char* mimeType;
+} subtitleTypes[] = {
+    { ".srt", "text/srt" },
+    { ".ssa", "text/x-ssa" },
+    { ".smi", "smi/caption" },
+    { ".sub", MIMETYPE_TEXT },
+};
+
+// the import adds the files of one directory after another, so the names
+// of the directory listed last serve all of its videos
+static std::mutex listingMutex;
+static std::string listingDir;
+static struct timespec listingMtime;
+static std::vector<std::string> listingNames;
+
+using AutoLock = std::lock_guard<std::mutex>;
+
+static const char* getSubtitleMimeType(const std::string& path)
+{
+    size_t dot = path.rfind('.');
+    if (dot == std::string::npos)
+        return nullptr;
+    std::string extension = tolower_string(path.substr(dot));
+    for (const auto& type : subtitleTypes) {
+        if (extension == type.extension)
+            return type.mimeType;
+    }
+    return nullptr;
+}
+
+static void splitPath(const std::string& path, std::string& dir, std::string& name)
+{
+    size_t slash = path.rfind(DIR_SEPARATOR);
+    dir = slash != std::string::npos ? path.substr(0, slash) : ".";
+    name = slash != std::string::npos ? path.substr(slash + 1) : path;
+}
+
+// file name without its extension
+static std::string getStem(const std::string& name)
+{
+    size_t dot = name.rfind('.');
+    return dot != std::string::npos && dot > 0 ? name.substr(0, dot) : name;
+}
+
+// lists the directory unless the listing of it is still current,
+// the caller holds listingMutex
+static void listDirectory(const std::string& dir, bool relist)
+{
+    struct stat statbuf;
+    if (stat(dir.c_str(), &statbuf) != 0) {
+        listingDir.clear();
+        listingNames.clear();
+        return;
+    }
+    if (!relist && dir == listingDir && statbuf.st_mtim.tv_sec == listingMtime.tv_sec && statbuf.st_mtim.tv_nsec == listingMtime.tv_nsec)
+        return;
+
+    listingDir = dir;
+    listingMtime = statbuf.st_mtim;
+    listingNames.clear();
+    DIR* d = opendir(dir.c_str());
+    if (d == nullptr)
+        return;
+    struct dirent* entry;
+    while ((entry = readdir(d)) != nullptr) {
+        if (entry->d_name[0] != '.')
+            listingNames.emplace_back(entry->d_name);
+    }
+    closedir(d);
+}
+
+SubtitleHandler::SubtitleHandler(std::shared_ptr<ConfigManager> config)
+    : MetadataHandler(config)
+{
+}
+
+bool SubtitleHandler::isSubtitle(const std::string& path)
+{
+    return getSubtitleMimeType(path) != nullptr;
+}
+
+void SubtitleHandler::addResources(std::shared_ptr<CdsItem> item, bool relist)
+{
+    std::string dir, name;
+    splitPath(item->getLocation(), dir, name);
+    std::string prefix = getStem(name) + ".";
+
+    // the extension that follows the name of the video, e.g. ".en.srt"
+    std::vector<std::string> extensions;
+    {
+        AutoLock lock(listingMutex);
+        listDirectory(dir, relist);
+        for (const auto& file : listingNames) {
+            if (file.size() > prefix.size() && file.compare(0, prefix.size(), prefix) == 0 && isSubtitle(file))
+                extensions.push_back(file.substr(prefix.size() - 1));
+        }
+    }
+
+    // the plain name comes first, players showing only one subtitle take it
+    std::sort(extensions.begin(), extensions.end(), [](const std::string& a, const std::string& b) {
+        return a.size() != b.size() ? a.size() < b.size() : a < b;
+    });
+    if (extensions.size() > MAX_SUBTITLES)
+        extensions.resize(MAX_SUBTITLES);
+
+    for (const auto& extension : extensions) {
+        log_debug("Subtitle found for %s: %s\n", item->getLocation().c_str(), extension.c_str());
+        auto resource = std::make_shared<CdsResource>(CH_SUBTITLE);
+        resource->addAttribute(MetadataHandler::getResAttrName(R_PROTOCOLINFO), renderProtocolInfo(getSubtitleMimeType(extension)));
+        resource->addOption(RESOURCE_OPTION_SUBTITLE_EXT, extension);
+        item->addResource(resource);
+    }
+}
+
+void SubtitleHandler::fillMetadata(std::shared_ptr<CdsItem> item)
+{
+    if (startswith(item->getMimeType(), "video"))
+        addResources(item, false);
+}
+
+bool SubtitleHandler::updateResources(std::shared_ptr<CdsItem> item)
+{
+    std::vector<std::shared_ptr<CdsResource>> resources;
+    std::vector<std::string> before;
+    for (const auto& resource : item->getResources()) {
+        if (resource->getHandlerType() == CH_SUBTITLE)
+            before.push_back(resource->getOption(RESOURCE_OPTION_SUBTITLE_EXT));
+        else
+            resources.push_back(resource);
+    }
+    item->setResources(resources);
+    if (startswith(item->getMimeType(), "video"))
+        addResources(item, true);
+
+    std::vector<std::string> after;
+    for (const auto& resource : item->getResources()) {
+        if (resource->getHandlerType() == CH_SUBTITLE)
+            after.push_back(resource->getOption(RESOURCE_OPTION_SUBTITLE_EXT));
+    }
+    return before != after;
+}
+
+std::vector<std::string> SubtitleHandler::findVideos(const std::string& subtitlePath)
+{
+    std::string dir, name;
+    splitPath(subtitlePath, dir, name);
+
+    std::vector<std::string> videos;
+    AutoLock lock(listingMutex);
+    listDirectory(dir, true);
+    for (const auto& file : listingNames) {
+        std::string prefix = getStem(file) + ".";
+        if (file != name && !isSubtitle(file) && name.size() > prefix.size() && name.compare(0, prefix.size(), prefix) == 0)
+            videos.push_back(dir + DIR_SEPARATOR + file);
+    }
+    return videos;
+}
+
+std::unique_ptr<IOHandler> SubtitleHandler::serveContent(std::shared_ptr<CdsItem> item, int resNum)
+{
+    std::string dir, name;
+    splitPath(item->getLocation(), dir, name);
+    std::string path = dir + DIR_SEPARATOR + getStem(name) + item->getResource(resNum)->getOption(RESOURCE_OPTION_SUBTITLE_EXT);
+
+    log_debug("Subtitle: Opening name: %s\n", path.c_str());
+
+    auto io_handler = std::make_unique<FileIOHandler>(path);
+    return io_handler;
+}
@@ -0,0 +1,61 @@
+/*GRB*
+
+Gerbera - https://gerbera.io/
+
+    subtitle_handler.h - this file is part of Gerbera.
+
+    Copyright (C) 2016-2019 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file subtitle_handler.h
+/// \brief Definition of the SubtitleHandler class.
+
+#ifndef __METADATA_SUBTITLE_H__
+#define __METADATA_SUBTITLE_H__
+
+#include <vector>
+
+#include "metadata_handler.h"
+
+/// \brief This class finds subtitle files next to a video, e.g. movie.srt or
+/// movie.en.srt for movie.mkv, and adds them as resources of the item.
+///
+/// The files are looked for once on import, so rendering and serving the
+/// item do not have to probe the filesystem.
+class SubtitleHandler : public MetadataHandler {
+public:
+    SubtitleHandler(std::shared_ptr<ConfigManager> config);
+    virtual void fillMetadata(std::shared_ptr<CdsItem> item);
+    virtual std::unique_ptr<IOHandler> serveContent(std::shared_ptr<CdsItem> item, int resNum);
+
+    /// \brief Replaces the subtitle resources of an item with the files
+    /// that are present now.
+    /// \return true if the resources changed
+    bool updateResources(std::shared_ptr<CdsItem> item);
+
+    /// \return true if the file has a subtitle extension
+    static bool isSubtitle(const std::string& path);
+
+    /// \brief Finds the files a subtitle may belong to, i.e. movie.mkv and
+    /// movie.en.avi for movie.en.srt.
+    static std::vector<std::string> findVideos(const std::string& subtitlePath);
+
+protected:
+    void addResources(std::shared_ptr<CdsItem> item, bool relist);
+};
+
+#endif // __METADATA_SUBTITLE_H__
@@ -32,6 +32,8 @@
 
 #ifdef HAVE_TAGLIB
 
+#include <algorithm>
+
 #include <taglib/aifffile.h>
 #include <taglib/apefile.h>
 #include <taglib/asffile.h>
@@ -56,21 +58,35 @@
 
 using namespace zmm;
 
+// bytes of embedded artwork passed to libmagic when the tag has no usable type
+#define ARTWORK_MAGIC_HEAD_SIZE 1024
+// bytes at the start and the end of embedded artwork compared to find it in the file
+#define ARTWORK_FIND_PATTERN_SIZE 64
+
 TagLibHandler::TagLibHandler(std::shared_ptr<ConfigManager> config)
     : MetadataHandler(config)
 {
+    std::string style = config->getOption(CFG_IMPORT_LIBOPTS_ID3_READ_STYLE);
+    if (style == ID3_READ_STYLE_FAST)
+        readStyle = TagLib::AudioProperties::Fast;
+    else if (style == ID3_READ_STYLE_ACCURATE)
+        readStyle = TagLib::AudioProperties::Accurate;
+    else
+        readStyle = TagLib::AudioProperties::Average;
+
+    // fields are given by their symbol or their UPnP property
+    std::vector<std::string> tags = config->getStringArrayOption(CFG_IMPORT_LIBOPTS_ID3_METADATA_TAGS_LIST);
+    for (int i = 0; i < M_MAX; i++) {
+        fields[i] = tags.empty();
+        for (const auto& tag : tags) {
+            if (tag == MT_KEYS[i].sym || tag == MT_KEYS[i].upnp)
+                fields[i] = true;
+        }
+    }
 }
 
-void TagLibHandler::addField(metadata_fields_t field, const TagLib::File& file, const TagLib::Tag* tag, std::shared_ptr<CdsItem> item) const
+void TagLibHandler::addField(metadata_fields_t field, const TagLib::PropertyMap& properties, const TagLib::Tag* tag, std::shared_ptr<CdsItem> item, StringConverter* sc) const
 {
-    if (tag == nullptr)
-        return;
-
-    if (tag->isEmpty())
-        return;
-
-    auto sc = StringConverter::i2i(config); // sure is sure
-
     TagLib::String val;
     TagLib::StringList list;
     std::string value;
@@ -121,31 +137,31 @@ void TagLibHandler::addField(metadata_fields_t field, const TagLib::File& file,
             return;
         break;
     case M_ALBUMARTIST:
-        // we have to use file.properties() instead of tag->properties()
+        // properties come from file.properties() instead of tag->properties()
         // because the latter returns incomplete properties
         // https://mail.kde.org/pipermail/taglib-devel/2015-May/002729.html
-        list = file.properties()["ALBUMARTIST"];
+        list = properties["ALBUMARTIST"];
         if (!list.isEmpty())
             val = list[0];
         else
             return;
         break;
     case M_COMPOSER:
-        list = file.properties()["COMPOSER"];
+        list = properties["COMPOSER"];
         if (!list.isEmpty())
             val = list[0];
         else
             return;
         break;
     case M_CONDUCTOR:
-        list = file.properties()["CONDUCTOR"];
+        list = properties["CONDUCTOR"];
         if (!list.isEmpty())
             val = list[0];
         else
             return;
         break;
     case M_ORCHESTRA:
-        list = file.properties()["ORCHESTRA"];
+        list = properties["ORCHESTRA"];
         if (!list.isEmpty())
             val = list[0];
         else
@@ -173,8 +189,19 @@ void TagLibHandler::populateGenericTags(std::shared_ptr<CdsItem> item, const Tag
 
     const TagLib::Tag* tag = file.tag();
 
-    for (int i = 0; i < M_MAX; i++)
-        addField((metadata_fields_t)i, file, tag, item);
+    if (!tag->isEmpty()) {
+        auto sc = StringConverter::i2i(config); // sure is sure
+
+        // the property map is built from all frames, so only once and only if needed
+        TagLib::PropertyMap properties;
+        if (fields[M_ALBUMARTIST] || fields[M_COMPOSER] || fields[M_CONDUCTOR] || fields[M_ORCHESTRA])
+            properties = file.properties();
+
+        for (int i = 0; i < M_MAX; i++) {
+            if (fields[i])
+                addField((metadata_fields_t)i, properties, tag, item, sc.get());
+        }
+    }
 
     int temp;
 
@@ -252,14 +279,30 @@ std::string TagLibHandler::getContentTypeFromByteVector(const TagLib::ByteVector
 {
     std::string art_mimetype = MIMETYPE_DEFAULT;
 #ifdef HAVE_MAGIC
-    art_mimetype = getMIMETypeFromBuffer(data.data(), data.size());
+    // image signatures are at the start, the rest of the picture is not looked at
+    art_mimetype = getMIMETypeFromBuffer(data.data(), std::min<size_t>(data.size(), ARTWORK_MAGIC_HEAD_SIZE));
     if (!string_ok(art_mimetype))
         return MIMETYPE_DEFAULT;
 #endif
     return art_mimetype;
 }
 
-void TagLibHandler::addArtworkResource(std::shared_ptr<CdsItem> item, std::string art_mimetype)
+long TagLibHandler::findArtwork(TagLib::File& file, const TagLib::ByteVector& data, long limit) const
+{
+    if (data.size() < ARTWORK_FIND_PATTERN_SIZE)
+        return -1;
+    long offset = file.find(data.mid(0, ARTWORK_FIND_PATTERN_SIZE));
+    if (offset < 0 || offset + long(data.size()) > limit)
+        return -1;
+
+    // a picture that was changed when it was stored does not end the same
+    file.seek(offset + data.size() - ARTWORK_FIND_PATTERN_SIZE);
+    if (file.readBlock(ARTWORK_FIND_PATTERN_SIZE) != data.mid(data.size() - ARTWORK_FIND_PATTERN_SIZE))
+        return -1;
+    return offset;
+}
+
+void TagLibHandler::addArtworkResource(std::shared_ptr<CdsItem> item, std::string art_mimetype, unsigned int size, long offset)
 {
     // if we could not determine the mimetype, then there is no
     // point to add the resource - it's probably garbage
@@ -270,6 +313,10 @@ void TagLibHandler::addArtworkResource(std::shared_ptr<CdsItem> item, std::strin
         resource->addAttribute(MetadataHandler::getResAttrName(
                                    R_PROTOCOLINFO),
             renderProtocolInfo(art_mimetype));
+        if (size > 0)
+            resource->addAttribute(MetadataHandler::getResAttrName(R_SIZE), std::to_string(size));
+        if (size > 0 && offset >= 0)
+            resource->addOption(RESOURCE_OPTION_ARTWORK_OFFSET, std::to_string(offset));
         resource->addParameter(RESOURCE_CONTENT_TYPE,
             ID3_ALBUM_ART);
         item->addResource(resource);
@@ -283,6 +330,23 @@ std::unique_ptr<IOHandler> TagLibHandler::serveContent(std::shared_ptr<CdsItem>
 
     TagLib::FileStream roStream(item->getLocation().c_str(), true); // Open read only
 
+    // artwork whose place was found on import is read without parsing the tags
+    auto resource = item->getResource(resNum);
+    std::string offset = resource->getOption(RESOURCE_OPTION_ARTWORK_OFFSET);
+    std::string size = resource->getAttribute(MetadataHandler::getResAttrName(R_SIZE));
+    if (string_ok(offset) && string_ok(size)) {
+        try {
+            unsigned long length = std::stoul(size);
+            roStream.seek(std::stol(offset));
+            TagLib::ByteVector data = roStream.readBlock(length);
+            if (data.size() == length)
+                return std::make_unique<MemIOHandler>(data.data(), data.size());
+        } catch (const std::logic_error& e) {
+        }
+        log_debug("TagLibHandler: artwork of %s moved, reading the tags\n", item->getLocation().c_str());
+        roStream.seek(0);
+    }
+
     if (content_type == CONTENT_TYPE_MP3) {
 
         TagLib::MPEG::File f(&roStream, TagLib::ID3v2::FrameFactory::instance());
@@ -386,7 +450,7 @@ std::unique_ptr<IOHandler> TagLibHandler::serveContent(std::shared_ptr<CdsItem>
 
 void TagLibHandler::extractMP3(TagLib::IOStream* roStream, std::shared_ptr<CdsItem> item)
 {
-    TagLib::MPEG::File mp3(roStream, TagLib::ID3v2::FrameFactory::instance());
+    TagLib::MPEG::File mp3(roStream, TagLib::ID3v2::FrameFactory::instance(), true, readStyle);
 
     if (!mp3.isValid() || !mp3.hasID3v2Tag()) {
         log_debug("TagLibHandler: could not open mp3 file: %s\n",
@@ -397,7 +461,7 @@ void TagLibHandler::extractMP3(TagLib::IOStream* roStream, std::shared_ptr<CdsIt
 
     auto sc = StringConverter::i2i(config);
 
-    auto frameListMap = mp3.ID3v2Tag()->frameListMap();
+    const auto& frameListMap = mp3.ID3v2Tag()->frameListMap();
     // http://id3.org/id3v2.4.0-frames "4.2.6. User defined text information frame"
     bool hasTXXXFrames = frameListMap.contains("TXXX");
 
@@ -452,23 +516,34 @@ void TagLibHandler::extractMP3(TagLib::IOStream* roStream, std::shared_ptr<CdsIt
         }
     }
 
-    const TagLib::ID3v2::FrameList apicFrameList = mp3.ID3v2Tag()->frameList("APIC");
-    if (!apicFrameList.isEmpty()) {
-        auto art = static_cast<const TagLib::ID3v2::AttachedPictureFrame*>(apicFrameList.front());
+    // the frame list map is already there, looking up the pictures parses nothing
+    auto apic = frameListMap.find("APIC");
+    if (apic != frameListMap.end() && !apic->second.isEmpty()) {
+        auto art = static_cast<const TagLib::ID3v2::AttachedPictureFrame*>(apic->second.front());
 
+        // picture() returns a copy, ByteVector shares the picture data with the frame
         const TagLib::ByteVector pic = art->picture();
         std::string art_mimetype = sc->convert(art->mimeType().toCString(true));
         if (!isValidArtworkContentType(art_mimetype)) {
             art_mimetype = getContentTypeFromByteVector(pic);
         }
 
-        addArtworkResource(item, art_mimetype);
+        // pictures of unsynchronised, compressed or encrypted frames are
+        // not stored as they are
+        const TagLib::ID3v2::Header* tagHeader = mp3.ID3v2Tag()->header();
+        const TagLib::ID3v2::Frame::Header* frameHeader = art->header();
+        long offset = -1;
+        if (!tagHeader->unsynchronisation() && !frameHeader->unsynchronisation()
+            && !frameHeader->compression() && !frameHeader->encryption())
+            offset = findArtwork(mp3, pic, tagHeader->completeTagSize());
+
+        addArtworkResource(item, art_mimetype, pic.size(), offset);
     }
 }
 
 void TagLibHandler::extractOgg(TagLib::IOStream* roStream, std::shared_ptr<CdsItem> item)
 {
-    TagLib::Ogg::Vorbis::File vorbis(item->getLocation().c_str());
+    TagLib::Ogg::Vorbis::File vorbis(roStream, true, readStyle);
 
     if (!vorbis.isValid()) {
         log_debug("TagLibHandler: could not open ogg file: %s\n",
@@ -495,12 +570,12 @@ void TagLibHandler::extractOgg(TagLib::IOStream* roStream, std::shared_ptr<CdsIt
     if (!isValidArtworkContentType(art_mimetype)) {
         art_mimetype = getContentTypeFromByteVector(data);
     }
-    addArtworkResource(item, art_mimetype);
+    addArtworkResource(item, art_mimetype, data.size());
 }
 
 void TagLibHandler::extractASF(TagLib::IOStream* roStream, std::shared_ptr<CdsItem> item)
 {
-    TagLib::ASF::File asf(roStream);
+    TagLib::ASF::File asf(roStream, true, readStyle);
 
     if (!asf.isValid()) {
         log_debug("TagLibHandler: could not open asf/wma file: %s\n",
@@ -521,16 +596,17 @@ void TagLibHandler::extractASF(TagLib::IOStream* roStream, std::shared_ptr<CdsIt
 
         auto sc = StringConverter::i2i(config);
         std::string art_mimetype = sc->convert(wmpic.mimeType().toCString(true));
+        const TagLib::ByteVector data = wmpic.picture();
         if (!isValidArtworkContentType(art_mimetype)) {
-            art_mimetype = getContentTypeFromByteVector(wmpic.picture());
+            art_mimetype = getContentTypeFromByteVector(data);
         }
-        addArtworkResource(item, art_mimetype);
+        addArtworkResource(item, art_mimetype, data.size(), findArtwork(asf, data, asf.length()));
     }
 }
 
 void TagLibHandler::extractFLAC(TagLib::IOStream* roStream, std::shared_ptr<CdsItem> item)
 {
-    TagLib::FLAC::File flac(roStream, TagLib::ID3v2::FrameFactory::instance());
+    TagLib::FLAC::File flac(roStream, TagLib::ID3v2::FrameFactory::instance(), true, readStyle);
 
     if (!flac.isValid()) {
         log_debug("TagLibHandler: could not open flac file: %s\n",
@@ -542,6 +618,9 @@ void TagLibHandler::extractFLAC(TagLib::IOStream* roStream, std::shared_ptr<CdsI
     auto sc = StringConverter::i2i(config);
 
     std::vector<std::string> aux_tags_list = config->getStringArrayOption(CFG_IMPORT_LIBOPTS_ID3_AUXDATA_TAGS_LIST);
+    TagLib::PropertyMap propertyMap;
+    if (!aux_tags_list.empty())
+        propertyMap = flac.properties();
     for (size_t j = 0; j < aux_tags_list.size(); j++) {
 
         std::string desiredTag = aux_tags_list[j];
@@ -549,8 +628,6 @@ void TagLibHandler::extractFLAC(TagLib::IOStream* roStream, std::shared_ptr<CdsI
             continue;
         }
 
-        auto propertyMap = flac.properties();
-
         if (propertyMap.contains(desiredTag.c_str())) {
             const auto property = propertyMap[desiredTag.c_str()];
             if (property.isEmpty())
@@ -577,12 +654,13 @@ void TagLibHandler::extractFLAC(TagLib::IOStream* roStream, std::shared_ptr<CdsI
     if (!isValidArtworkContentType(art_mimetype)) {
         art_mimetype = getContentTypeFromByteVector(data);
     }
-    addArtworkResource(item, art_mimetype);
+    // picture blocks keep the picture as it is
+    addArtworkResource(item, art_mimetype, data.size(), findArtwork(flac, data, flac.length()));
 }
 
 void TagLibHandler::extractAPE(TagLib::IOStream* roStream, std::shared_ptr<CdsItem> item)
 {
-    TagLib::APE::File ape(roStream);
+    TagLib::APE::File ape(roStream, true, readStyle);
 
     if (!ape.isValid()) {
         log_debug("TagLibHandler: could not open APE file: %s\n",
@@ -594,7 +672,7 @@ void TagLibHandler::extractAPE(TagLib::IOStream* roStream, std::shared_ptr<CdsIt
 
 void TagLibHandler::extractWavPack(TagLib::IOStream* roStream, std::shared_ptr<CdsItem> item)
 {
-    TagLib::WavPack::File wavpack(roStream);
+    TagLib::WavPack::File wavpack(roStream, true, readStyle);
 
     if (!wavpack.isValid()) {
         log_debug("TagLibHandler: could not open WavPack file: %s\n",
@@ -606,7 +684,7 @@ void TagLibHandler::extractWavPack(TagLib::IOStream* roStream, std::shared_ptr<C
 
 void TagLibHandler::extractMP4(TagLib::IOStream* roStream, std::shared_ptr<CdsItem> item)
 {
-    TagLib::MP4::File mp4(roStream);
+    TagLib::MP4::File mp4(roStream, true, readStyle);
     populateGenericTags(item, mp4);
 
     if (!mp4.isValid()) {
@@ -622,21 +700,20 @@ void TagLibHandler::extractMP4(TagLib::IOStream* roStream, std::shared_ptr<CdsIt
 
     std::string art_mimetype;
 
-    TagLib::MP4::ItemListMap itemsListMap = mp4.tag()->itemListMap();
-    if (itemsListMap.contains("covr")) {
-        TagLib::MP4::Item coverItem = itemsListMap["covr"];
-        TagLib::MP4::CoverArtList coverArtList = coverItem.toCoverArtList();
+    const TagLib::MP4::ItemListMap& itemsListMap = mp4.tag()->itemListMap();
+    auto cover = itemsListMap.find("covr");
+    if (cover != itemsListMap.end()) {
+        const TagLib::MP4::CoverArtList coverArtList = cover->second.toCoverArtList();
         if (coverArtList.isEmpty()) {
             log_debug("TagLibHandler: mp4 file has no coverart");
             return;
         }
 
-        TagLib::MP4::CoverArt coverArt = coverArtList.front();
-        TagLib::ByteVector data = coverArt.data();
+        const TagLib::ByteVector data = coverArtList.front().data();
         art_mimetype = getContentTypeFromByteVector(data);
 
         if (string_ok(art_mimetype))
-            addArtworkResource(item, art_mimetype);
+            addArtworkResource(item, art_mimetype, data.size());
     } else {
         log_debug("TagLibHandler: mp4 file has no 'covr' item");
     }
@@ -644,7 +721,7 @@ void TagLibHandler::extractMP4(TagLib::IOStream* roStream, std::shared_ptr<CdsIt
 
 void TagLibHandler::extractAiff(TagLib::IOStream* roStream, std::shared_ptr<CdsItem> item)
 {
-    TagLib::RIFF::AIFF::File aiff(roStream);
+    TagLib::RIFF::AIFF::File aiff(roStream, true, readStyle);
 
     if (!aiff.isValid()) {
         log_debug("TagLibHandler: could not open AIFF file: %s\n",
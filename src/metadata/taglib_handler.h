@@ -37,12 +37,16 @@
 
 #include <string>
 
+#include <taglib/audioproperties.h>
 #include <taglib/tbytevector.h>
 #include <taglib/tfile.h>
 #include <taglib/tiostream.h>
+#include <taglib/tpropertymap.h>
 
 #include "metadata_handler.h"
 
+class StringConverter;
+
 /// \brief This class is responsible for reading id3 or ogg tags metadata
 class TagLibHandler : public MetadataHandler {
 public:
@@ -51,12 +55,20 @@ public:
     virtual std::unique_ptr<IOHandler> serveContent(std::shared_ptr<CdsItem> item, int resNum);
 
 private:
-    void addField(metadata_fields_t field, const TagLib::File& file, const TagLib::Tag* tag, std::shared_ptr<CdsItem> item) const;
+    /// \brief how thoroughly audio properties are computed, fast only reads headers
+    TagLib::AudioProperties::ReadStyle readStyle;
+    /// \brief fields taken from the tags, all unless configured otherwise
+    bool fields[M_MAX];
+
+    void addField(metadata_fields_t field, const TagLib::PropertyMap& properties, const TagLib::Tag* tag, std::shared_ptr<CdsItem> item, StringConverter* sc) const;
 
     void populateGenericTags(std::shared_ptr<CdsItem> item, const TagLib::File& file) const;
     bool isValidArtworkContentType(std::string content_type);
     std::string getContentTypeFromByteVector(const TagLib::ByteVector& data) const;
-    void addArtworkResource(std::shared_ptr<CdsItem> item, std::string content_type);
+    /// \brief Returns where the picture is stored unchanged in the file, -1
+    /// if it is not found before limit.
+    long findArtwork(TagLib::File& file, const TagLib::ByteVector& data, long limit) const;
+    void addArtworkResource(std::shared_ptr<CdsItem> item, std::string content_type, unsigned int size, long offset = -1);
     void extractMP3(TagLib::IOStream* roStream, std::shared_ptr<CdsItem> item);
     void extractOgg(TagLib::IOStream* roStream, std::shared_ptr<CdsItem> item);
     void extractASF(TagLib::IOStream* roStream, std::shared_ptr<CdsItem> item);
@@ -105,6 +105,7 @@ protected:
     void print_internal(std::ostringstream &buf, int indent) override;
     
     friend class Parser;
+    friend class StreamParser;
 };
 
 
@@ -0,0 +1,137 @@
+/*GRB*
+
+Gerbera - https://gerbera.io/
+
+    stream_parser.cc - this file is part of Gerbera.
+
+    Copyright (C) 2016-2019 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file stream_parser.cc
+
+#include "stream_parser.h"
+
+#include <algorithm>
+
+#include "mxml.h"
+
+using namespace zmm;
+using namespace mxml;
+
+StreamParser::StreamParser(std::vector<std::string> recordNames, RecordHandler handler)
+    : recordNames(recordNames)
+    , handler(handler)
+    , recordCount(0)
+{
+    parser = XML_ParserCreate(nullptr);
+    if (!parser)
+        throw Exception("Unable to allocate XML parser");
+
+    XML_SetUserData(parser, this);
+    XML_SetElementHandler(parser, StreamParser::element_start, StreamParser::element_end);
+    XML_SetCharacterDataHandler(parser, StreamParser::character_data);
+}
+
+StreamParser::~StreamParser()
+{
+    XML_ParserFree(parser);
+}
+
+void StreamParser::feed(const char* data, size_t length)
+{
+    parse(data, length, false);
+}
+
+void StreamParser::finish()
+{
+    parse(nullptr, 0, true);
+}
+
+void StreamParser::parse(const char* data, size_t length, bool isFinal)
+{
+    if (XML_Parse(parser, data, length, isFinal) != XML_STATUS_OK) {
+        if (handlerError != nullptr)
+            std::rethrow_exception(handlerError);
+
+        Ref<Context> ctx(new Context(""));
+        ctx->line = XML_GetCurrentLineNumber(parser);
+        ctx->col = XML_GetCurrentColumnNumber(parser);
+        throw ParseException(XML_ErrorString(XML_GetErrorCode(parser)), ctx);
+    }
+}
+
+void StreamParser::flushText()
+{
+    // expat may deliver one text in several pieces
+    if (!text.empty() && !elements.empty()) {
+        Ref<Text> textEl(new Text(text));
+        elements.back()->appendChild(RefCast(textEl, Node));
+    }
+    text.clear();
+}
+
+void XMLCALL StreamParser::element_start(void* userdata, const char* name, const char** attrs)
+{
+    auto* self = static_cast<StreamParser*>(userdata);
+
+    if (self->rootName.empty())
+        self->rootName = name;
+
+    if (self->elements.empty()
+        && std::find(self->recordNames.begin(), self->recordNames.end(), name) == self->recordNames.end())
+        return;
+
+    self->flushText();
+
+    Ref<Element> el(new Element(name));
+    for (int i = 0; attrs[i]; i += 2)
+        el->addAttribute(attrs[i], attrs[i + 1]);
+
+    if (!self->elements.empty())
+        self->elements.back()->appendElementChild(el);
+    self->elements.push_back(el);
+}
+
+void XMLCALL StreamParser::element_end(void* userdata, const char* name)
+{
+    auto* self = static_cast<StreamParser*>(userdata);
+    if (self->elements.empty())
+        return;
+
+    self->flushText();
+
+    Ref<Element> el = self->elements.back();
+    self->elements.pop_back();
+    if (!self->elements.empty())
+        return;
+
+    self->recordCount++;
+    try {
+        self->handler(el);
+    } catch (...) {
+        // exceptions must not pass through expat
+        self->handlerError = std::current_exception();
+        XML_StopParser(self->parser, XML_FALSE);
+    }
+}
+
+void XMLCALL StreamParser::character_data(void* userdata, const XML_Char* s, int len)
+{
+    auto* self = static_cast<StreamParser*>(userdata);
+    if (!self->elements.empty())
+        self->text.append(s, len);
+}
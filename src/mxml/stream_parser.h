@@ -0,0 +1,94 @@
+/*GRB*
+
+Gerbera - https://gerbera.io/
+
+    stream_parser.h - this file is part of Gerbera.
+
+    Copyright (C) 2016-2019 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file stream_parser.h
+/// \brief Incremental parser handing out one record element at a time.
+#ifndef __MXML_STREAM_PARSER_H__
+#define __MXML_STREAM_PARSER_H__
+
+#include <exception>
+#include <expat.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "zmm/zmmf.h"
+
+namespace mxml {
+
+class Element;
+
+/// \brief Parses a document that is delivered in chunks, for example while
+/// it is being downloaded.
+///
+/// Only elements with one of the record names are built, each record is
+/// passed to the handler when it is closed and released afterwards. Content
+/// outside of records is skipped, so memory use is bounded by the largest
+/// record instead of the whole document. Records nested in records are
+/// part of the outer record.
+class StreamParser : public zmm::Object {
+public:
+    using RecordHandler = std::function<void(zmm::Ref<Element> record)>;
+
+    StreamParser(std::vector<std::string> recordNames, RecordHandler handler);
+    virtual ~StreamParser();
+
+    /// \brief Parses the next part of the document.
+    ///
+    /// Exceptions thrown by the handler stop the parser and are rethrown.
+    void feed(const char* data, size_t length);
+
+    /// \brief Signals the end of the document, throws a ParseException if
+    /// it is incomplete.
+    void finish();
+
+    /// \brief name of the document element, empty until it was parsed
+    std::string getRootName() { return rootName; }
+
+    /// \brief number of records passed to the handler
+    int getRecordCount() { return recordCount; }
+
+protected:
+    void parse(const char* data, size_t length, bool isFinal);
+    void flushText();
+
+    XML_Parser parser;
+    std::vector<std::string> recordNames;
+    RecordHandler handler;
+
+    std::string rootName;
+    int recordCount;
+
+    /// \brief the record being built and its open elements, empty outside of records
+    std::vector<zmm::Ref<Element>> elements;
+    std::string text;
+    std::exception_ptr handlerError;
+
+    static void XMLCALL element_start(void* userdata, const char* name, const char** attrs);
+    static void XMLCALL element_end(void* userdata, const char* name);
+    static void XMLCALL character_data(void* userdata, const XML_Char* s, int len);
+};
+
+} // namespace mxml
+
+#endif // __MXML_STREAM_PARSER_H__
@@ -55,27 +55,15 @@ public:
     ATrailersContentHandler(std::shared_ptr<ConfigManager> config,
         std::shared_ptr<Storage> storage);
 
-    /// \brief Sets the service XML from which we will extract the objects.
-    /// \return false if service XML contained an error status.
-    bool setServiceContent(zmm::Ref<mxml::Element> service);
-
-    /// \brief retrieves an object from the service.
-    ///
-    /// Each invokation of this funtion will return a new object,
-    /// when the whole service XML is parsed and no more objects are left,
-    /// this function will return nullptr.
-    ///
-    /// \return CdsObject or nullptr if there are no more objects to parse.
-    std::shared_ptr<CdsObject> getNextObject();
+    /// \brief Creates an object from a movieinfo element of the service XML.
+    /// \return CdsObject or nullptr if the element does not describe a
+    /// usable trailer.
+    std::shared_ptr<CdsObject> getObject(zmm::Ref<mxml::Element> trailer);
 
 protected:
     std::shared_ptr<ConfigManager> config;
     std::shared_ptr<Storage> storage;
 
-    zmm::Ref<mxml::Element> service_xml;
-    int current_trailer_index;
-    int trailer_count;
-
     std::string trailer_mimetype;
 };
 
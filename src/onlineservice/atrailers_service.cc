@@ -37,8 +37,8 @@
 #include "config/config_manager.h"
 #include "config/config_options.h"
 #include "content_manager.h"
+#include "online_service_refresh.h"
 #include "server.h"
-#include "util/string_converter.h"
 #include "zmm/zmm.h"
 
 #include <string>
@@ -90,46 +90,38 @@ Ref<Object> ATrailersService::defineServiceTask(Ref<Element> xmlopt, Ref<Object>
     return nullptr;
 }
 
-Ref<Element> ATrailersService::getData()
+int ATrailersService::getData(StreamParser::RecordHandler handler)
 {
     long retcode;
-    auto sc = StringConverter::i2i(config);
-
-    std::string buffer;
+    Ref<StreamParser> parser(new StreamParser({ "movieinfo" }, handler));
+    auto sink = [&parser](const char* data, size_t length) {
+        parser->feed(data, length);
+    };
 
     try {
         log_debug("DOWNLOADING URL: %s\n", service_url.c_str());
-        buffer = url->download(service_url, &retcode,
-            curl_handle, false, true, true);
-    } catch (const Exception& ex) {
-        log_error("Failed to download Apple Trailers XML data: %s\n",
-            ex.getMessage().c_str());
-        return nullptr;
-    }
-
-    if (buffer.empty())
-        return nullptr;
+        url->downloadStream(service_url, &retcode, sink, curl_handle, true, true);
 
-    if (retcode != 200)
-        return nullptr;
+        if (retcode != 200)
+            throw _Exception("HTTP return code " + std::to_string(retcode));
 
-    log_debug("GOT BUFFER\n%s\n", buffer.c_str());
-    Ref<Parser> parser(new Parser());
-    try {
-        return parser->parseString(sc->convert(buffer))->getRoot();
+        parser->finish();
     } catch (const ParseException& pe) {
         log_error("Error parsing Apple Trailers XML %s line %d:\n%s\n",
             pe.context->location.c_str(),
             pe.context->line,
             pe.getMessage().c_str());
-        return nullptr;
+        throw _Exception("Failed to get XML content from Trailers service");
     } catch (const Exception& ex) {
-        log_error("Error parsing Apple Trailers XML %s\n",
+        log_error("Failed to download Apple Trailers XML data: %s\n",
             ex.getMessage().c_str());
-        return nullptr;
+        throw _Exception("Failed to get XML content from Trailers service");
     }
 
-    return nullptr;
+    if (parser->getRootName() != "records")
+        throw _Exception("Received invalid XML for Apple Trailers service");
+
+    return parser->getRecordCount();
 }
 
 bool ATrailersService::refreshServiceData(Ref<Layout> layout)
@@ -148,47 +140,25 @@ bool ATrailersService::refreshServiceData(Ref<Layout> layout)
     if (pid != pthread_self())
         throw _Exception("Not allowed to call refreshServiceData from different threads!");
 
-    Ref<Element> reply = getData();
-
     Ref<ATrailersContentHandler> sc(new ATrailersContentHandler(config, storage));
-    if (reply != nullptr)
-        sc->setServiceContent(reply);
-    else {
-        log_debug("Failed to get XML content from Trailers service\n");
-        throw _Exception("Failed to get XML content from Trailers service");
-    }
+    OnlineServiceRefresh refresh(storage, content, layout, this);
 
-    std::shared_ptr<CdsObject> obj;
-    do {
-        obj = sc->getNextObject();
+    // items are compared while the listing is downloaded, they are written
+    // by finish() once the listing is complete
+    auto count = getData([&](Ref<Element> trailer) {
+        auto obj = sc->getObject(trailer);
         if (obj == nullptr)
-            break;
+            return;
 
         obj->setVirtual(true);
+        refresh.process(obj);
+    });
 
-        auto old = storage->loadObjectByServiceID(std::static_pointer_cast<CdsItem>(obj)->getServiceID());
-        if (old == nullptr) {
-            log_debug("Adding new Trailers object\n");
-
-            if (layout != nullptr)
-                layout->processCdsObject(obj, nullptr);
-        } else {
-            log_debug("Updating existing Trailers object\n");
-            obj->setID(old->getID());
-            obj->setParentID(old->getParentID());
-            //            struct timespec oldt, newt;
-            //            oldt.tv_nsec = 0;
-            //            oldt.tv_sec = old->getAuxData(ONLINE_SERVICE_LAST_UPDATE).toLong();
-            //            newt.tv_nsec = 0;
-            //            newt.tv_sec = obj->getAuxData(ONLINE_SERVICE_LAST_UPDATE).toLong();
-            content->updateObject(obj);
-        }
-
-//        if (server->getShutdownStatus())
-//            return false;
-
-    } while (obj != nullptr);
+    // an incomplete or empty listing must not purge the existing items
+    if (count == 0)
+        throw _Exception("No content received from Trailers service");
 
+    refresh.finish();
     return false;
 }
 
@@ -38,6 +38,7 @@
 #include <memory>
 #include <curl/curl.h>
 #include "mxml/mxml.h"
+#include "mxml/stream_parser.h"
 #include "online_service.h"
 #include "url.h"
 #include "zmm/zmm.h"
@@ -84,8 +85,10 @@ protected:
     // url retriever class
     zmm::Ref<URL> url;
 
-    /// \brief This function will retrieve the service XML
-    zmm::Ref<mxml::Element> getData();
+    /// \brief Downloads the service XML and passes every movieinfo element
+    /// to the handler while the download is in progress.
+    /// \return number of elements passed to the handler
+    int getData(mxml::StreamParser::RecordHandler handler);
 };
 
 #endif //__ONLINE_SERVICE_H__
@@ -0,0 +1,174 @@
+/*GRB*
+
+Gerbera - https://gerbera.io/
+
+    online_service_refresh.cc - this file is part of Gerbera.
+
+    Copyright (C) 2016-2019 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file online_service_refresh.cc
+
+#ifdef ONLINE_SERVICES
+
+#include "online_service_refresh.h"
+
+#include <cstdint>
+#include <cstdio>
+
+#include "cds_objects.h"
+#include "content_manager.h"
+#include "layout/layout.h"
+#include "online_service.h"
+#include "util/logger.h"
+
+using namespace zmm;
+
+OnlineServiceRefresh::OnlineServiceRefresh(std::shared_ptr<Storage> storage,
+    std::shared_ptr<ContentManager> content,
+    Ref<Layout> layout, OnlineService* service)
+    : storage(storage)
+    , content(content)
+    , layout(layout)
+    , service(service)
+    , added(0)
+    , updated(0)
+    , unchanged(0)
+    , purged(0)
+{
+    servicePrefix = service->getStoragePrefix();
+    started = time(nullptr);
+    state = storage->getServiceState(servicePrefix);
+}
+
+void OnlineServiceRefresh::process(std::shared_ptr<CdsObject> obj)
+{
+    auto item = std::static_pointer_cast<CdsItem>(obj);
+    std::string serviceID = item->getServiceID();
+    std::string hash = getContentHash(obj);
+
+    auto it = state->find(serviceID);
+    if (it == state->end()) {
+        (*state)[serviceID].contentHash = hash;
+        pending.push_back({ obj, serviceID, hash, INVALID_OBJECT_ID });
+        added++;
+        return;
+    }
+
+    auto& entry = it->second;
+    // the listing contained the item more than once, it was kept above
+    if (entry.objectIDs.empty())
+        return;
+
+    if (entry.contentHash == hash) {
+        seen.insert(seen.end(), entry.objectIDs.begin(), entry.objectIDs.end());
+        unchanged++;
+        return;
+    }
+
+    entry.contentHash = hash;
+    pending.push_back({ obj, serviceID, hash, entry.objectIDs.front() });
+    updated++;
+}
+
+void OnlineServiceRefresh::apply(std::map<std::string, std::string>& hashes)
+{
+    for (auto& item : pending) {
+        if (item.objectID == INVALID_OBJECT_ID) {
+            log_debug("Adding new %s object\n", service->getServiceName().c_str());
+            if (layout != nullptr)
+                layout->processCdsObject(item.obj, nullptr);
+        } else {
+            log_debug("Updating existing %s object\n", service->getServiceName().c_str());
+            auto old = storage->loadObject(item.objectID);
+            item.obj->setID(old->getID());
+            item.obj->setParentID(old->getParentID());
+            content->updateObject(item.obj);
+        }
+        hashes[item.serviceID] = item.hash;
+    }
+}
+
+void OnlineServiceRefresh::finish()
+{
+    std::map<std::string, std::string> hashes;
+
+    // a failed refresh leaves the objects of the service as they were
+    storage->beginTransaction();
+    try {
+        apply(hashes);
+        storage->touchServiceObjects(seen, started);
+        storage->storeServiceState(servicePrefix, hashes, started);
+
+        int purgeInterval = service->getItemPurgeInterval();
+        if (purgeInterval > 0) {
+            auto stale = storage->getStaleServiceObjects(servicePrefix, started - purgeInterval);
+            purged = stale->size();
+            if (purged > 0) {
+                log_debug("Purging %d old %s objects\n", purged, service->getServiceName().c_str());
+                content->removeObjects(stale);
+            }
+        }
+    } catch (const Exception&) {
+        storage->rollbackTransaction();
+        throw;
+    }
+    storage->commitTransaction();
+
+    log_debug("Finished fetch cycle for service %s: %d added, %d updated, %d unchanged, %d purged\n",
+        service->getServiceName().c_str(), added, updated, unchanged, purged);
+}
+
+std::string OnlineServiceRefresh::getContentHash(std::shared_ptr<CdsObject> obj)
+{
+    // 64 bit FNV-1a, fields are terminated so that values can not shift
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    auto add = [&hash](const std::string& value) {
+        for (unsigned char c : value) {
+            hash ^= c;
+            hash *= 0x100000001b3ULL;
+        }
+        hash ^= 0xff;
+        hash *= 0x100000001b3ULL;
+    };
+
+    add(obj->getTitle());
+    add(obj->getClass());
+    add(obj->getLocation());
+    add(std::to_string(obj->getFlags()));
+    if (IS_CDS_ITEM(obj->getObjectType()))
+        add(std::static_pointer_cast<CdsItem>(obj)->getMimeType());
+
+    for (const auto& entry : obj->getMetadata()) {
+        add(entry.first);
+        add(entry.second);
+    }
+    for (const auto& entry : obj->getAuxData()) {
+        if (entry.first == ONLINE_SERVICE_LAST_UPDATE)
+            continue;
+        add(entry.first);
+        add(entry.second);
+    }
+    for (const auto& resource : obj->getResources())
+        add(resource->encode());
+
+    char buf[17];
+    snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(hash));
+    return buf;
+}
+
+#endif //ONLINE_SERVICES
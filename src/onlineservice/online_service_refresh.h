@@ -0,0 +1,115 @@
+/*GRB*
+
+Gerbera - https://gerbera.io/
+
+    online_service_refresh.h - this file is part of Gerbera.
+
+    Copyright (C) 2016-2019 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file online_service_refresh.h
+/// \brief Definition of the OnlineServiceRefresh class.
+
+#ifdef ONLINE_SERVICES
+
+#ifndef __ONLINE_SERVICE_REFRESH_H__
+#define __ONLINE_SERVICE_REFRESH_H__
+
+#include <ctime>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "storage/storage.h"
+#include "zmm/zmmf.h"
+
+// forward declaration
+class CdsObject;
+class ContentManager;
+class Layout;
+class OnlineService;
+
+/// \brief Applies the items fetched from an online service to the database.
+///
+/// The state of all objects of the service is loaded once. Every fetched
+/// item is compared with it by content hash while the feed is downloaded:
+/// unchanged items are only marked as seen, changed and new items are kept
+/// in memory. Nothing is written before finish(), so a failed fetch leaves
+/// the database untouched and no transaction is open during the download.
+class OnlineServiceRefresh {
+public:
+    OnlineServiceRefresh(std::shared_ptr<Storage> storage,
+        std::shared_ptr<ContentManager> content,
+        zmm::Ref<Layout> layout, OnlineService* service);
+
+    /// \brief Compares the object with the stored state and keeps it if
+    /// it was added or changed.
+    void process(std::shared_ptr<CdsObject> obj);
+
+    /// \brief Adds and updates the kept objects, writes their state and
+    /// purges stale objects in one storage transaction, which is rolled
+    /// back if any of it fails.
+    void finish();
+
+    /// \brief Hash over everything a refresh may change, except the
+    /// time of the last update.
+    static std::string getContentHash(std::shared_ptr<CdsObject> obj);
+
+    int getAddedCount() { return added; }
+    int getUpdatedCount() { return updated; }
+    int getUnchangedCount() { return unchanged; }
+    int getPurgedCount() { return purged; }
+
+protected:
+    std::shared_ptr<Storage> storage;
+    std::shared_ptr<ContentManager> content;
+    zmm::Ref<Layout> layout;
+    OnlineService* service;
+
+    char servicePrefix;
+    time_t started;
+
+    /// \brief Added or changed item of the feed.
+    struct Pending {
+        std::shared_ptr<CdsObject> obj;
+        std::string serviceID;
+        std::string hash;
+        /// \brief object to update, INVALID_OBJECT_ID for new items
+        int objectID;
+    };
+
+    std::unique_ptr<std::unordered_map<std::string, Storage::ServiceState>> state;
+    /// \brief objects of unchanged items
+    std::vector<int> seen;
+    /// \brief added and changed items in feed order
+    std::vector<Pending> pending;
+
+    /// \brief Writes the pending items, hashes receives the content hash
+    /// of every item written.
+    void apply(std::map<std::string, std::string>& hashes);
+
+    int added;
+    int updated;
+    int unchanged;
+    int purged;
+};
+
+#endif //__ONLINE_SERVICE_REFRESH_H__
+
+#endif //ONLINE_SERVICES
@@ -48,184 +48,142 @@ SopCastContentHandler::SopCastContentHandler(std::shared_ptr<ConfigManager> conf
 {
 }
 
-bool SopCastContentHandler::setServiceContent(zmm::Ref<mxml::Element> service)
+std::vector<std::shared_ptr<CdsObject>> SopCastContentHandler::getObjects(Ref<Element> group)
 {
-    std::string temp;
+    std::vector<std::shared_ptr<CdsObject>> objects;
 
-    if (service->getName() != "channels")
-        throw _Exception("Invalid XML for SopCast service received");
+    if (group->getName() != "group")
+        return objects;
 
-    channels = service;
+    std::string groupName = trim_string(group->getText());
+    if (!string_ok(groupName)) {
+        groupName = group->getAttribute("en");
+        if (!string_ok(groupName))
+            groupName = "Unknown";
+    }
 
-    group_count = channels->childCount();
-    if (group_count < 1)
-        return false;
+    for (int i = 0; i < group->childCount(); i++) {
+        Ref<Node> n = group->getChild(i);
+        if ((n == nullptr) || (n->getType() != mxml_node_element))
+            continue;
 
-    current_group_node_index = 0;
-    current_channel_index = 0;
-    channel_count = 0;
-    current_group = nullptr;
+        Ref<Element> channel = RefCast(n, Element);
+        if (channel->getName() != "channel")
+            continue;
 
-    return true;
+        auto item = getChannel(channel, groupName);
+        if (item != nullptr)
+            objects.push_back(item);
+    }
+
+    return objects;
 }
 
-std::shared_ptr<CdsObject> SopCastContentHandler::getNextObject()
+std::shared_ptr<CdsObject> SopCastContentHandler::getChannel(Ref<Element> channel, std::string groupName)
 {
-#define DATE_BUF_LEN 12
     std::string temp;
     struct timespec ts;
 
-    while (current_group_node_index < group_count) {
-        if (current_group == nullptr) {
-            Ref<Node> n = channels->getChild(current_group_node_index);
-            current_group_node_index++;
-
-            if (n == nullptr)
-                continue;
-
-            if (n->getType() != mxml_node_element)
-                continue;
-
-            current_group = RefCast(n, Element);
-            channel_count = current_group->childCount();
-
-            if ((current_group->getName() != "group") || (channel_count < 1)) {
-                current_group = nullptr;
-                current_group_name = nullptr;
-                continue;
-            } else {
-                current_group_name = current_group->getText();
-                if (!string_ok(current_group_name)) {
-                    current_group_name = current_group->getAttribute("en");
-                    if (!string_ok(current_group_name))
-                        current_group_name = "Unknown";
-                }
-            }
-
-            current_channel_index = 0;
-        }
+    auto item = std::make_shared<CdsItemExternalURL>(storage);
+    auto resource = std::make_shared<CdsResource>(CH_DEFAULT);
+    item->addResource(resource);
 
-        if (current_channel_index >= channel_count) {
-            current_group = nullptr;
-            continue;
-        }
+    item->setAuxData(ONLINE_SERVICE_AUX_ID,
+        std::to_string(OS_SopCast));
 
-        while (current_channel_index < channel_count) {
-            Ref<Node> n = current_group->getChild(current_channel_index);
-            current_channel_index++;
-
-            if ((n == nullptr) || (n->getType() != mxml_node_element))
-                continue;
-
-            Ref<Element> channel = RefCast(n, Element);
-
-            if (channel->getName() != "channel")
-                continue;
-
-            auto item = std::make_shared<CdsItemExternalURL>(storage);
-            auto resource = std::make_shared<CdsResource>(CH_DEFAULT);
-            item->addResource(resource);
-
-            item->setAuxData(ONLINE_SERVICE_AUX_ID,
-                std::to_string(OS_SopCast));
-
-            item->setAuxData(SOPCAST_AUXDATA_GROUP, current_group_name);
-
-            temp = channel->getAttribute("id");
-            if (!string_ok(temp)) {
-                log_warning("Failed to retrieve SopCast channel ID\n");
-                continue;
-            }
-
-            temp.insert(temp.begin(), OnlineService::getStoragePrefix(OS_SopCast));
-            item->setServiceID(temp);
-
-            temp = channel->getChildText("stream_type");
-            if (!string_ok(temp)) {
-                log_warning("Failed to retrieve SopCast channel mimetype\n");
-                continue;
-            }
-
-            // I wish they had a mimetype setting
-            //auto mappings = config->getDictionaryOption(CFG_IMPORT_MAPPINGS_EXTENSION_TO_MIMETYPE_LIST);
-            //std::string mt = getValueOrDefault(mappings, temp);
-            std::string mt;
-            // map was empty, we have to do construct the mimetype ourselves
-            if (!string_ok(mt)) {
-                if (temp == "wmv")
-                    mt = "video/sopcast-x-ms-wmv";
-                else if (temp == "mp3")
-                    mt = "audio/sopcast-mpeg";
-                else if (temp == "wma")
-                    mt = "audio/sopcast-x-ms-wma";
-                else {
-                    log_warning("Could not determine mimetype for SopCast channel (stream_type: %s)\n", temp.c_str());
-                    mt = "application/sopcast-stream";
-                }
-            }
-            resource->addAttribute(MetadataHandler::getResAttrName(R_PROTOCOLINFO),
-                renderProtocolInfo(mt, SOPCAST_PROTOCOL));
-            item->setMimeType(mt);
-
-            Ref<Element> tmp_el = channel->getChildByName("sop_address");
-            if (tmp_el == nullptr) {
-                log_warning("Failed to retrieve SopCast channel URL\n");
-                continue;
-            }
-
-            temp = tmp_el->getChildText("item");
-            if (!string_ok(temp)) {
-                log_warning("Failed to retrieve SopCast channel URL\n");
-                continue;
-            }
-            item->setURL(temp);
-
-            tmp_el = channel->getChildByName("name");
-            if (tmp_el == nullptr) {
-                log_warning("Failed to retrieve SopCast channel name\n");
-                continue;
-            }
-
-            temp = tmp_el->getAttribute("en");
-            if (string_ok(temp))
-                item->setTitle(temp);
-            else
-                item->setTitle("Unknown");
-
-            tmp_el = channel->getChildByName("region");
-            if (tmp_el != nullptr) {
-                temp = tmp_el->getAttribute("en");
-                if (string_ok(temp))
-                    item->setMetadata(MetadataHandler::getMetaFieldName(M_REGION), temp);
-            }
-
-            temp = channel->getChildText("description");
-            if (string_ok(temp))
-                item->setMetadata(MetadataHandler::getMetaFieldName(M_DESCRIPTION), temp);
-
-            temp = channel->getAttribute("language");
-            if (string_ok(temp))
-                item->setAuxData(SOPCAST_AUXDATA_LANGUAGE, temp);
-
-            item->setClass(UPNP_DEFAULT_CLASS_VIDEO_BROADCAST);
-
-            getTimespecNow(&ts);
-            item->setAuxData(ONLINE_SERVICE_LAST_UPDATE, std::to_string(ts.tv_sec));
-            item->setFlag(OBJECT_FLAG_PROXY_URL);
-            item->setFlag(OBJECT_FLAG_ONLINE_SERVICE);
-
-            try {
-                item->validate();
-                return item;
-            } catch (const Exception& ex) {
-                log_warning("Failed to validate newly created SopCast item: %s\n",
-                    ex.getMessage().c_str());
-                continue;
-            }
+    item->setAuxData(SOPCAST_AUXDATA_GROUP, groupName);
+
+    temp = channel->getAttribute("id");
+    if (!string_ok(temp)) {
+        log_warning("Failed to retrieve SopCast channel ID\n");
+        return nullptr;
+    }
+
+    temp.insert(temp.begin(), OnlineService::getStoragePrefix(OS_SopCast));
+    item->setServiceID(temp);
+
+    temp = channel->getChildText("stream_type");
+    if (!string_ok(temp)) {
+        log_warning("Failed to retrieve SopCast channel mimetype\n");
+        return nullptr;
+    }
+
+    // I wish they had a mimetype setting
+    //auto mappings = config->getDictionaryOption(CFG_IMPORT_MAPPINGS_EXTENSION_TO_MIMETYPE_LIST);
+    //std::string mt = getValueOrDefault(mappings, temp);
+    std::string mt;
+    // map was empty, we have to do construct the mimetype ourselves
+    if (!string_ok(mt)) {
+        if (temp == "wmv")
+            mt = "video/sopcast-x-ms-wmv";
+        else if (temp == "mp3")
+            mt = "audio/sopcast-mpeg";
+        else if (temp == "wma")
+            mt = "audio/sopcast-x-ms-wma";
+        else {
+            log_warning("Could not determine mimetype for SopCast channel (stream_type: %s)\n", temp.c_str());
+            mt = "application/sopcast-stream";
         }
     }
+    resource->addAttribute(MetadataHandler::getResAttrName(R_PROTOCOLINFO),
+        renderProtocolInfo(mt, SOPCAST_PROTOCOL));
+    item->setMimeType(mt);
+
+    Ref<Element> tmp_el = channel->getChildByName("sop_address");
+    if (tmp_el == nullptr) {
+        log_warning("Failed to retrieve SopCast channel URL\n");
+        return nullptr;
+    }
+
+    temp = tmp_el->getChildText("item");
+    if (!string_ok(temp)) {
+        log_warning("Failed to retrieve SopCast channel URL\n");
+        return nullptr;
+    }
+    item->setURL(temp);
 
-    return nullptr;
+    tmp_el = channel->getChildByName("name");
+    if (tmp_el == nullptr) {
+        log_warning("Failed to retrieve SopCast channel name\n");
+        return nullptr;
+    }
+
+    temp = tmp_el->getAttribute("en");
+    if (string_ok(temp))
+        item->setTitle(temp);
+    else
+        item->setTitle("Unknown");
+
+    tmp_el = channel->getChildByName("region");
+    if (tmp_el != nullptr) {
+        temp = tmp_el->getAttribute("en");
+        if (string_ok(temp))
+            item->setMetadata(MetadataHandler::getMetaFieldName(M_REGION), temp);
+    }
+
+    temp = channel->getChildText("description");
+    if (string_ok(temp))
+        item->setMetadata(MetadataHandler::getMetaFieldName(M_DESCRIPTION), temp);
+
+    temp = channel->getAttribute("language");
+    if (string_ok(temp))
+        item->setAuxData(SOPCAST_AUXDATA_LANGUAGE, temp);
+
+    item->setClass(UPNP_DEFAULT_CLASS_VIDEO_BROADCAST);
+
+    getTimespecNow(&ts);
+    item->setAuxData(ONLINE_SERVICE_LAST_UPDATE, std::to_string(ts.tv_sec));
+    item->setFlag(OBJECT_FLAG_PROXY_URL);
+    item->setFlag(OBJECT_FLAG_ONLINE_SERVICE);
+
+    try {
+        item->validate();
+        return item;
+    } catch (const Exception& ex) {
+        log_warning("Failed to validate newly created SopCast item: %s\n",
+            ex.getMessage().c_str());
+        return nullptr;
+    }
 }
 
 #endif //SOPCAST
@@ -45,6 +45,7 @@
 #define SOPCAST_AUXDATA_GROUP SOPCAST_SERVICE_ID "2"
 
 #include <memory>
+#include <vector>
 #include "cds_objects.h"
 #include "mxml/mxml.h"
 
@@ -57,31 +58,15 @@ class SopCastContentHandler : public zmm::Object {
 public:
     SopCastContentHandler(std::shared_ptr<ConfigManager> config, std::shared_ptr<Storage> storage);
 
-    /// \brief Sets the service XML from which we will extract the objects.
-    /// \return false if service XML contained an error status.
-    bool setServiceContent(zmm::Ref<mxml::Element> service);
-
-    /// \brief retrieves an object from the service.
-    ///
-    /// Each invokation of this funtion will return a new object,
-    /// when the whole service XML is parsed and no more objects are left,
-    /// this function will return nullptr.
-    ///
-    /// \return CdsObject or nullptr if there are no more objects to parse.
-    std::shared_ptr<CdsObject> getNextObject();
+    /// \brief Creates the objects for all channels of a group element of
+    /// the service XML, channels that can not be used are skipped.
+    std::vector<std::shared_ptr<CdsObject>> getObjects(zmm::Ref<mxml::Element> group);
 
 protected:
     std::shared_ptr<ConfigManager> config;
     std::shared_ptr<Storage> storage;
 
-    zmm::Ref<mxml::Element> channels;
-    int current_group_node_index;
-    int group_count;
-    int current_channel_index;
-    int channel_count;
-    std::string current_group_name;
-
-    zmm::Ref<mxml::Element> current_group;
+    std::shared_ptr<CdsObject> getChannel(zmm::Ref<mxml::Element> channel, std::string groupName);
 };
 
 #endif //__SOPCAST_CONTENT_HANDLER_H__
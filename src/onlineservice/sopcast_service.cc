@@ -35,9 +35,9 @@
 #include "storage/storage.h"
 #include "config/config_manager.h"
 #include "content_manager.h"
+#include "online_service_refresh.h"
 #include "server.h"
 #include "sopcast_content_handler.h"
-#include "util/string_converter.h"
 #include "zmm/zmm.h"
 
 using namespace zmm;
@@ -80,46 +80,38 @@ Ref<Object> SopCastService::defineServiceTask(Ref<Element> xmlopt, Ref<Object> p
     return nullptr;
 }
 
-Ref<Element> SopCastService::getData()
+int SopCastService::getData(StreamParser::RecordHandler handler)
 {
     long retcode;
-    auto sc = StringConverter::i2i(config);
-
-    std::string buffer;
+    Ref<StreamParser> parser(new StreamParser({ "group" }, handler));
+    auto sink = [&parser](const char* data, size_t length) {
+        parser->feed(data, length);
+    };
 
     try {
         log_debug("DOWNLOADING URL: %s\n", SOPCAST_CHANNEL_URL);
-        buffer = url->download(SOPCAST_CHANNEL_URL, &retcode,
-            curl_handle, false, true, true);
-
-    } catch (const Exception& ex) {
-        log_error("Failed to download SopCast XML data: %s\n",
-            ex.getMessage().c_str());
-        return nullptr;
-    }
-
-    if (buffer.empty())
-        return nullptr;
+        url->downloadStream(SOPCAST_CHANNEL_URL, &retcode, sink, curl_handle, true, true);
 
-    if (retcode != 200)
-        return nullptr;
+        if (retcode != 200)
+            throw _Exception("HTTP return code " + std::to_string(retcode));
 
-    log_debug("GOT BUFFER\n%s\n", buffer.c_str());
-    Ref<Parser> parser(new Parser());
-    try {
-        return parser->parseString(sc->convert(std::string(buffer.c_str())))->getRoot();
+        parser->finish();
     } catch (const ParseException& pe) {
         log_error("Error parsing SopCast XML %s line %d:\n%s\n",
             pe.context->location.c_str(),
             pe.context->line,
             pe.getMessage().c_str());
-        return nullptr;
+        throw _Exception("Failed to get XML content from SopCast service");
     } catch (const Exception& ex) {
-        log_error("Error parsing SopCast XML %s\n", ex.getMessage().c_str());
-        return nullptr;
+        log_error("Failed to download SopCast XML data: %s\n",
+            ex.getMessage().c_str());
+        throw _Exception("Failed to get XML content from SopCast service");
     }
 
-    return nullptr;
+    if (parser->getRootName() != "channels")
+        throw _Exception("Received invalid XML for SopCast service");
+
+    return parser->getRecordCount();
 }
 
 bool SopCastService::refreshServiceData(Ref<Layout> layout)
@@ -138,49 +130,23 @@ bool SopCastService::refreshServiceData(Ref<Layout> layout)
     if (pid != pthread_self())
         throw _Exception("Not allowed to call refreshServiceData from different threads!");
 
-    Ref<Element> reply = getData();
-
     Ref<SopCastContentHandler> sc(new SopCastContentHandler(config, storage));
-    if (reply != nullptr)
-        sc->setServiceContent(reply);
-    else {
-        log_debug("Failed to get XML content from SopCast service\n");
-        throw _Exception("Failed to get XML content from SopCast service");
-    }
-
-    std::shared_ptr<CdsObject> obj;
-    do {
-        /// \todo add try/catch here and a possibility do find out if we
-        /// may request more stuff or if we are at the end of the list
-        obj = sc->getNextObject();
-        if (obj == nullptr)
-            break;
-
-        obj->setVirtual(true);
-
-        auto old = storage->loadObjectByServiceID(std::static_pointer_cast<CdsItem>(obj)->getServiceID());
-        if (old == nullptr) {
-            log_debug("Adding new SopCast object\n");
-
-            if (layout != nullptr)
-                layout->processCdsObject(obj, nullptr);
-        } else {
-            log_debug("Updating existing SopCast object\n");
-            obj->setID(old->getID());
-            obj->setParentID(old->getParentID());
-            //            struct timespec oldt, newt;
-            //            oldt.tv_nsec = 0;
-            //            oldt.tv_sec = old->getAuxData(ONLINE_SERVICE_LAST_UPDATE).toLong();
-            //            newt.tv_nsec = 0;
-            //            newt.tv_sec = obj->getAuxData(ONLINE_SERVICE_LAST_UPDATE).toLong();
-            content->updateObject(obj);
+    OnlineServiceRefresh refresh(storage, content, layout, this);
+
+    // items are compared while the listing is downloaded, they are written
+    // by finish() once the listing is complete
+    auto count = getData([&](Ref<Element> group) {
+        for (const auto& obj : sc->getObjects(group)) {
+            obj->setVirtual(true);
+            refresh.process(obj);
         }
+    });
 
-//        if (server->getShutdownStatus())
-//            return false;
-
-    } while (obj != nullptr);
+    // an incomplete or empty listing must not purge the existing items
+    if (count == 0)
+        throw _Exception("No content received from SopCast service");
 
+    refresh.finish();
     return false;
 }
 
@@ -36,6 +36,7 @@
 #define __SOPCAST_SERVICE_H__
 
 #include "mxml/mxml.h"
+#include "mxml/stream_parser.h"
 #include "online_service.h"
 #include "url.h"
 #include "zmm/zmm.h"
@@ -81,8 +82,10 @@ protected:
     // url retriever class
     zmm::Ref<URL> url;
 
-    /// \brief This function will retrieve the XML according to the parametrs
-    zmm::Ref<mxml::Element> getData();
+    /// \brief Downloads the service XML and passes every group element
+    /// to the handler while the download is in progress.
+    /// \return number of elements passed to the handler
+    int getData(mxml::StreamParser::RecordHandler handler);
 };
 
 #endif //__ONLINE_SERVICE_H__
@@ -49,6 +49,10 @@ public:
 
     virtual std::unique_ptr<IOHandler> open(const char* filename, enum UpnpOpenFileMode mode, std::string range) = 0;
 
+    /// \brief Tells if open() returns media streams, those slow down
+    /// imports and keep database maintenance waiting.
+    virtual bool servesMedia() const { return false; }
+
     /// \brief Splits the url into a path and parameters string.
     /// Only '?' and '/' separators are allowed, otherwise an exception will
     /// be thrown.
@@ -33,6 +33,11 @@
 
 #include "runtime.h"
 
+#include <cstddef>
+#include <cstdlib>
+
+#include "util/memory_accounting.h"
+
 using namespace zmm;
 using namespace std;
 
@@ -42,11 +47,63 @@ static void fatal_handler(void *udata, const char *msg)
     abort();
 }
 
+// every block carries its size in front of the data so that frees can be accounted
+union AllocHeader {
+    size_t size;
+    std::max_align_t align;
+};
+
+static void* accounted_alloc(void* udata, duk_size_t size)
+{
+    if (size == 0)
+        return nullptr;
+    auto header = static_cast<AllocHeader*>(malloc(sizeof(AllocHeader) + size));
+    if (header == nullptr)
+        return nullptr;
+    header->size = size;
+    MemoryAccounting::add(MemoryAccounting::ACCOUNT_SCRIPTING, size);
+    return header + 1;
+}
+
+static void accounted_free(void* udata, void* ptr)
+{
+    if (ptr == nullptr)
+        return;
+    auto header = static_cast<AllocHeader*>(ptr) - 1;
+    MemoryAccounting::sub(MemoryAccounting::ACCOUNT_SCRIPTING, header->size);
+    free(header);
+}
+
+static void* accounted_realloc(void* udata, void* ptr, duk_size_t size)
+{
+    if (ptr == nullptr)
+        return accounted_alloc(udata, size);
+    if (size == 0) {
+        accounted_free(udata, ptr);
+        return nullptr;
+    }
+    auto header = static_cast<AllocHeader*>(ptr) - 1;
+    size_t oldSize = header->size;
+    header = static_cast<AllocHeader*>(realloc(header, sizeof(AllocHeader) + size));
+    if (header == nullptr)
+        return nullptr;
+    header->size = size;
+    MemoryAccounting::add(MemoryAccounting::ACCOUNT_SCRIPTING, (long long)size - (long long)oldSize);
+    return header + 1;
+}
+
 Runtime::Runtime() {
-    ctx = duk_create_heap(nullptr, nullptr, nullptr, nullptr, fatal_handler);
+    ctx = duk_create_heap(accounted_alloc, accounted_realloc, accounted_free, nullptr, fatal_handler);
+
+    // a forced collection releases garbage held by finished imports
+    MemoryAccounting::setShrinker(MemoryAccounting::ACCOUNT_SCRIPTING, [this]() {
+        AutoLock lock(mutex);
+        duk_gc(ctx, 0);
+    });
 }
 Runtime::~Runtime()
 {
+    MemoryAccounting::setShrinker(MemoryAccounting::ACCOUNT_SCRIPTING, nullptr);
     duk_destroy_heap(ctx);
 }
 
@@ -33,6 +33,7 @@
 
 #include "script.h"
 #include "util/tools.h"
+#include "util/trace.h"
 #include "metadata/metadata_handler.h"
 #include "js_functions.h"
 #include "config/config_manager.h"
@@ -302,6 +303,7 @@ void Script::_execute()
 
 void Script::execute()
 {
+    TRACE_SPAN("script", "Script::execute");
     Runtime::AutoLock lock(runtime->getMutex());
     duk_push_thread_stash(ctx, ctx);
     duk_get_prop_string(ctx, -1, "script");
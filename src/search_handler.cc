@@ -442,14 +442,42 @@ std::string ASTOrOperator::emit() const
     return sqlEmitter.emit(this, lhs->emit(), rhs->emit());
 }
 
+unsigned int metadataValueHash(const std::string& value)
+{
+    return stringHash(aslowercase(value));
+}
+
+const std::vector<std::pair<std::string, std::string>>& getMetadataColumns()
+{
+    static const std::vector<std::pair<std::string, std::string>> columns = {
+        { "upnp:artist", "upnp_artist" },
+        { "upnp:album", "upnp_album" },
+        { "upnp:genre", "upnp_genre" },
+        { "dc:date", "dc_date" },
+    };
+    return columns;
+}
+
+std::string metadataColumn(const std::string& property)
+{
+    for (const auto& column : getMetadataColumns()) {
+        if (column.first == property)
+            return column.second;
+    }
+    return "";
+}
+
 std::string DefaultSQLEmitter::emitSQL(const ASTNode* node) const
 {
     std::string predicates = node->emit();
     if (predicates.length() > 0) {
         std::stringstream sql;
-        sql << "from mt_cds_object c "
-            << "inner join mt_metadata m on c.id = m.item_id "
-            << "where "
+        sql << "from mt_cds_object c ";
+        // predicates on metadata columns need no join, at worst a value
+        // that looks like a predicate adds a join that is not needed
+        if (predicates.find("m.property_name") != std::string::npos)
+            sql << "inner join mt_metadata_view m on c.id = m.item_id ";
+        sql << "where "
             << predicates;
         return sql.str();
     } else
@@ -471,7 +499,21 @@ std::string DefaultSQLEmitter::emit(const ASTCompareOperator* node, const std::s
         throw _Exception("operator not yet supported");
 
     std::stringstream sqlFragment;
-    sqlFragment << "(m.property_name='" << property << "' and lower(m.property_value)"
+    // metadata columns compare case insensitive by their collation
+    auto column = metadataColumn(property);
+    if (!column.empty()) {
+        sqlFragment << "(c." << column << operatr << "'" << value << "' and c.upnp_class is not null)";
+        return sqlFragment.str();
+    }
+
+    sqlFragment << "(m.property_name='" << property << "' and ";
+    // escaped values are not stored verbatim and the hash only folds ASCII
+    // case while lower() of MySQL also folds other letters, in both cases
+    // the hash would miss matching values
+    bool ascii = std::none_of(value.begin(), value.end(), [](char c) { return c & 0x80; });
+    if (ascii && value.find_first_of("\\'") == std::string::npos)
+        sqlFragment << "m.value_hash=" << metadataValueHash(value) << " and ";
+    sqlFragment << "lower(m.property_value)"
                 << operatr << "lower('" << value << "') and c.upnp_class is not null)";
     return sqlFragment.str();
 }
@@ -485,6 +527,17 @@ std::string DefaultSQLEmitter::emit(const ASTStringOperator* node, const std::st
         throw _Exception("operator not supported");
 
     std::stringstream sqlFragment;
+    auto column = metadataColumn(property);
+    if (!column.empty() && lcOperator != "derivedfrom") {
+        if (lcOperator == "contains")
+            sqlFragment << "(c." << column << " like '%" << value << "%' and c.upnp_class is not null)";
+        else if (lcOperator == "doesnotcontain")
+            sqlFragment << "(c." << column << " not like '%" << value << "%' and c.upnp_class is not null)";
+        else
+            sqlFragment << "(c." << column << " like '" << value << "%' and c.upnp_class is not null)";
+        return sqlFragment.str();
+    }
+
     if (lcOperator == "contains") {
         sqlFragment << "(m.property_name='" << property << "' and lower(m.property_value) "
                     << "like"
@@ -517,7 +570,11 @@ std::string DefaultSQLEmitter::emit(const ASTExistsOperator* node, const std::st
     } else {
         throw _Exception("invalid value on rhs of exists operator");
     }
-    sqlFragment << "(m.property_name='" << property << "' and m.property_value is " << exists << " and c.upnp_class is not null)";
+    auto column = metadataColumn(property);
+    if (!column.empty())
+        sqlFragment << "(c." << column << " is " << exists << " and c.upnp_class is not null)";
+    else
+        sqlFragment << "(m.property_name='" << property << "' and m.property_value is " << exists << " and c.upnp_class is not null)";
     return sqlFragment.str();
 }
 
@@ -397,4 +397,16 @@ private:
     std::shared_ptr<SearchLexer> lexer;
     const SQLEmitter& sqlEmitter;
 };
+
+/// \brief Hash stored with every metadata value, equal for values that
+/// only differ in ASCII case, so that equality searches can use an index.
+/// Searches for values with other than ASCII characters do not use it.
+unsigned int metadataValueHash(const std::string& value);
+
+/// \brief Returns the column of mt_cds_object that holds a copy of the
+/// property for indexed search and sorting, empty for other properties.
+std::string metadataColumn(const std::string& property);
+
+/// \brief Properties copied to their own column, with the column name.
+const std::vector<std::pair<std::string, std::string>>& getMetadataColumns();
 #endif // __SEARCH_HANDLER_H__
@@ -38,24 +38,41 @@
 #include "onlineservice/lastfm_scrobbler.h"
 #endif
 
+#include <algorithm>
+#include <fcntl.h>
+#include <thread>
+#include <unistd.h>
+
 #include "server.h"
 #include "config/config_manager.h"
 #include "content_manager.h"
 #include "file_request_handler.h"
+#include "iohandler/stream_io_handler.h"
 #include "update_manager.h"
+#include "util/memory_accounting.h"
+#include "util/scheduling.h"
 #include "util/task_processor.h"
 #include "web/session_manager.h"
 #include "storage/storage.h"
+#include "storage/storage_maintenance.h"
 #ifdef HAVE_CURL
 #include "url_request_handler.h"
 #endif
 #include "device_description_handler.h"
 #include "serve_request_handler.h"
+#include "util/headers.h"
 #include "web/pages.h"
 
 using namespace zmm;
 using namespace mxml;
 
+// libupnp asks for the file info and opens the file in the same worker
+// thread, only the former gets to see the request headers (libupnp 1.8.5
+// and newer, see Headers::getRequestHeader). The info callback runs first
+// for every request and overwrites the range of a request that was never
+// opened, like a HEAD request.
+static thread_local std::string requestRange;
+
 static int static_upnp_callback(Upnp_EventType eventtype, const void* event, void* cookie)
 {
     return static_cast<Server*>(cookie)->handleUpnpEvent(eventtype, event);
@@ -63,6 +80,7 @@ static int static_upnp_callback(Upnp_EventType eventtype, const void* event, voi
 
 Server::Server(std::shared_ptr<ConfigManager> config)
     : config(config)
+    , startupTimer("startup")
 {
     server_shutdown_flag = false;
 }
@@ -79,14 +97,17 @@ void Server::init()
 #endif
 
     // initalize what is needed
+    Scheduling::init(config);
     auto self = shared_from_this();
     timer = std::make_shared<Timer>();
     timer->init();
     task_processor = std::make_shared<TaskProcessor>();
     task_processor->init();
     scripting_runtime = std::make_shared<Runtime>();
+    startupTimer.phase("threads");
     storage = Storage::createInstance(config, timer);
-    update_manager = std::make_shared<UpdateManager>(storage, self);
+    startupTimer.phase("storage");
+    update_manager = std::make_shared<UpdateManager>(config, storage, self);
     update_manager->init();
     session_manager = std::make_shared<web::SessionManager>(config, timer);
 #ifdef HAVE_LASTFMLIB
@@ -97,10 +118,120 @@ void Server::init()
         config, storage, update_manager, session_manager, timer, task_processor, scripting_runtime, last_fm
     );
     content->init();
+    startupTimer.phase("content");
+    memory_limit = std::make_shared<MemorySoftLimit>(config, timer);
+    memory_limit->init();
+    maintenance = std::make_shared<StorageMaintenance>(config, storage, timer, [this]() {
+        return ImportThrottle::getStreams() == 0 && content->getTasklist() == nullptr;
+    });
+    maintenance->init();
 }
 
 Server::~Server() { log_debug("Server destroyed\n"); }
 
+// flushes a file or directory to disk
+static void syncPath(const std::string& path, int flags)
+{
+    int fd = open(path.c_str(), flags);
+    if (fd < 0)
+        throw _Exception("could not open " + path + ": " + mt_strerror(errno));
+    int ret = fsync(fd);
+    int err = errno;
+    close(fd);
+    if (ret != 0)
+        throw _Exception("could not sync " + path + ": " + mt_strerror(err));
+}
+
+void Server::index(std::vector<std::string> paths)
+{
+#ifdef HAVE_SQLITE3
+    if (config->getOption(CFG_SERVER_STORAGE_DRIVER) != "sqlite3")
+        throw _Exception("Indexing is only supported with the sqlite3 storage");
+    if (config->getOption(CFG_SERVER_STORAGE_ROLE) == STORAGE_ROLE_READER)
+        throw _Exception("Indexing is not possible on a reader node");
+
+    // paths given on the command line are added like the web UI adds them,
+    // autoscan directories keep their recursive and hidden settings
+    Ref<Array<AutoscanDirectory>> roots(new Array<AutoscanDirectory>());
+    for (const auto& path : paths)
+        roots->append(Ref<AutoscanDirectory>(new AutoscanDirectory(path, ScanMode::Timed, ScanLevel::Full,
+            true, false, INVALID_SCAN_ID, 0, config->getBoolOption(CFG_IMPORT_HIDDEN_FILES))));
+    if (paths.empty()) {
+        for (auto option : {
+                 CFG_IMPORT_AUTOSCAN_TIMED_LIST,
+#ifdef HAVE_INOTIFY
+                 CFG_IMPORT_AUTOSCAN_INOTIFY_LIST,
+#endif
+             }) {
+            auto list = config->getAutoscanListOption(option);
+            for (int i = 0; i < list->size(); i++)
+                roots->append(list->get(i));
+        }
+    }
+    if (roots->size() == 0)
+        throw _Exception("Nothing to index: no directories given and no autoscan directories configured");
+
+    // the database is built in a file of its own and only replaces the
+    // configured one when it is complete
+    std::string dbFile = config->getOption(CFG_SERVER_STORAGE_SQLITE_DATABASE_FILE);
+    std::string buildFile = dbFile + ".indexing";
+    if (unlink(buildFile.c_str()) != 0 && errno != ENOENT)
+        throw _Exception("could not remove " + buildFile + ": " + mt_strerror(errno));
+    config->setOption(CFG_SERVER_STORAGE_SQLITE_DATABASE_FILE, buildFile);
+    config->setBoolOption(CFG_SERVER_STORAGE_SQLITE_RESTORE, true);
+    config->setBoolOption(CFG_SERVER_STORAGE_SQLITE_BACKUP_ENABLED, false);
+
+    // same as init() without UPnP, the timer thread is not started, so
+    // timed autoscans and online services do not run during the build
+    auto self = shared_from_this();
+    timer = std::make_shared<Timer>();
+    task_processor = std::make_shared<TaskProcessor>();
+    task_processor->init();
+    scripting_runtime = std::make_shared<Runtime>();
+    storage = Storage::createInstance(config, timer);
+    startupTimer.phase("storage");
+    update_manager = std::make_shared<UpdateManager>(config, storage, self);
+    update_manager->init();
+    session_manager = std::make_shared<web::SessionManager>(config, timer);
+    content = std::make_shared<ContentManager>(
+        config, storage, update_manager, session_manager, timer, task_processor, scripting_runtime, last_fm
+    );
+    content->init();
+
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    log_info("Indexing %d locations into %s with %d threads\n", roots->size(), buildFile.c_str(), threads);
+    storage->beginBulkLoad();
+    content->bulkImport(roots, threads);
+    startupTimer.phase("import");
+    storage->endBulkLoad();
+    startupTimer.phase("indexes");
+
+    content->shutdown();
+    content = nullptr;
+    session_manager = nullptr;
+    update_manager->shutdown();
+    update_manager = nullptr;
+    storage->shutdown();
+    storage = nullptr;
+    scripting_runtime = nullptr;
+    task_processor->shutdown();
+    task_processor = nullptr;
+    timer = nullptr;
+
+    // the build ran without journal and sync, so the data is flushed
+    // before the rename makes it the database of the server
+    syncPath(buildFile, O_RDONLY);
+    if (rename(buildFile.c_str(), dbFile.c_str()) != 0)
+        throw _Exception("could not move " + buildFile + " to " + dbFile + ": " + mt_strerror(errno));
+    syncPath(split_path(dbFile).at(0), O_RDONLY | O_DIRECTORY);
+    config->setOption(CFG_SERVER_STORAGE_SQLITE_DATABASE_FILE, dbFile);
+
+    log_info("Database %s built after %lld ms (%s)\n", dbFile.c_str(), startupTimer.total(), startupTimer.summary().c_str());
+#else
+    throw _Exception("Indexing is only supported with the sqlite3 storage");
+#endif
+}
+
 void Server::run()
 {
     int ret = 0; // general purpose error code
@@ -136,6 +267,7 @@ void Server::run()
     }
 
     log_info("Server bound to: %s\n", ip.c_str());
+    startupTimer.phase("upnp init");
 
     virtualUrl = "http://" + ip + ":" + std::to_string(port) + "/" + virtual_directory;
 
@@ -211,6 +343,8 @@ void Server::run()
         throw _UpnpException(ret, "run: UpnpRegisterRootDevice failed");
     }
 
+    startupTimer.phase("device registration");
+
     log_debug("Creating ContentDirectoryService\n");
     cds = std::make_unique<ContentDirectoryService>(config, storage, xmlbuilder.get(), deviceHandle,
         config->getIntOption(CFG_SERVER_UPNP_TITLE_AND_DESC_STRING_LIMIT));
@@ -229,6 +363,12 @@ void Server::run()
         throw _UpnpException(ret, "run: UpnpSendAdvertisement failed");
     }
 
+    startupTimer.phase("announce");
+    log_info("Server announced after %lld ms (%s)\n", startupTimer.total(), startupTimer.summary().c_str());
+
+    // everything the server does not need to answer requests runs from now on
+    content->initDeferred();
+
     config->writeBookmark(ip, std::to_string(port));
     log_info("The Web UI can be reached by following this link: http://%s:%d/\n", ip.c_str(), port);
 
@@ -261,6 +401,11 @@ void Server::shutdown()
     log_debug("now calling upnp finish\n");
     UpnpFinish();
 
+    memory_limit->shutdown();
+    memory_limit = nullptr;
+    maintenance->shutdown();
+    maintenance = nullptr;
+
     content->shutdown();
     content = nullptr;
 #ifdef HAVE_LASTFMLIB
@@ -410,7 +555,9 @@ void Server::routeSubscriptionRequest(const std::unique_ptr<SubscriptionRequest>
 // Temp
 void Server::sendCDSSubscriptionUpdate(std::string updateString)
 {
-    cds->sendSubscriptionUpdate(updateString);
+    // no one to notify while index() builds the database
+    if (cds != nullptr)
+        cds->sendSubscriptionUpdate(updateString);
 }
 
 std::unique_ptr<RequestHandler> Server::createRequestHandler(const char* filename) const
@@ -464,6 +611,7 @@ int Server::registerVirtualDirCallbacks()
     int ret = UpnpVirtualDir_set_GetInfoCallback([](const char* filename, UpnpFileInfo* info, const void* cookie) -> int {
 #endif
         try {
+            requestRange = Headers::getRequestHeader(info, D_HTTP_TIME_SEEK_RANGE_HEADER);
             auto reqHandler = static_cast<const Server *>(cookie)->createRequestHandler(filename);
             reqHandler->getInfo(filename, info);
         } catch (const ServerShutdownException& se) {
@@ -486,10 +634,14 @@ int Server::registerVirtualDirCallbacks()
     ret = UpnpVirtualDir_set_OpenCallback([](const char* filename, enum UpnpOpenFileMode mode, const void* cookie) -> UpnpWebFileHandle {
 #endif
         std::string link = urlUnescape(filename);
+        std::string range = requestRange;
+        requestRange.clear();
 
         try {
             auto reqHandler = static_cast<const Server*>(cookie)->createRequestHandler(filename);
-            auto ioHandler = reqHandler->open(link.c_str(), mode, "");
+            auto ioHandler = reqHandler->open(link.c_str(), mode, range);
+            if (reqHandler->servesMedia())
+                ioHandler = std::make_unique<StreamIOHandler>(std::move(ioHandler));
             auto ioPtr = (UpnpWebFileHandle)ioHandler.release();
             //log_debug("%p open(%s)\n", ioPtr, filename);
             return ioPtr;
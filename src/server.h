@@ -38,12 +38,15 @@
 #include "upnp_cds.h"
 #include "upnp_cm.h"
 #include "upnp_mrreg.h"
+#include "util/trace.h"
 
 // forward declaration
 class ConfigManager;
 class Storage;
 class UpdateManager;
 class Timer;
+class MemorySoftLimit;
+class StorageMaintenance;
 namespace web { class SessionManager; }
 class TaskProcessor;
 class Runtime;
@@ -64,6 +67,16 @@ public:
 
     virtual ~Server();
 
+    /// \brief Builds the database from the given paths without starting
+    /// UPnP and returns when it is done.
+    ///
+    /// The database is written to a new file next to the configured one,
+    /// with relaxed durability and the search indexes created after the
+    /// load. It atomically replaces the configured file when it is
+    /// complete. Without paths the configured autoscan directories are
+    /// indexed.
+    void index(std::vector<std::string> paths);
+
     /// \brief Cleanup routine to shutdown the server.
     ///
     /// Unregisters the device with the SDK, shuts down the
@@ -120,6 +133,8 @@ protected:
     std::shared_ptr<Storage> storage;
     std::shared_ptr<UpdateManager> update_manager;
     std::shared_ptr<Timer> timer;
+    std::shared_ptr<MemorySoftLimit> memory_limit;
+    std::shared_ptr<StorageMaintenance> maintenance;
     std::shared_ptr<web::SessionManager> session_manager;
     std::shared_ptr<TaskProcessor> task_processor;
     std::shared_ptr<Runtime> scripting_runtime;
@@ -168,6 +183,10 @@ protected:
     /// The value is read from the configuration.
     int aliveAdvertisementInterval;
 
+    /// \brief Durations of the startup phases up to the first
+    /// advertisement, reported once the server is announced.
+    PhaseTimer startupTimer;
+
     std::unique_ptr<UpnpXMLBuilder> xmlbuilder;
 
     /// \brief ContentDirectoryService instance.
@@ -0,0 +1,382 @@
+/*GRB*
+
+Gerbera - https://gerbera.io/
+
+    cds_tree_index.cc - this file is part of Gerbera.
+
+    Copyright (C) 2016-2019 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+
+/// \file cds_tree_index.cc
+
+#include "cds_tree_index.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "cds_objects.h"
+#include "common.h"
+#include "util/memory_accounting.h"
+
+// containers whose invalidation is remembered, more are forgotten by
+// rejecting all pending results
+#define CDS_TREE_INDEX_MAX_CHANGES 4096
+
+CdsTreeIndex::CdsTreeIndex(size_t maxEntries, bool bytewiseTitles)
+    : maxEntries(maxEntries)
+    , entries(0)
+    , bytes(0)
+    , bytewiseTitles(bytewiseTitles)
+    , clock(0)
+    , clearedAt(0)
+{
+}
+
+CdsTreeIndex::~CdsTreeIndex()
+{
+    MemoryAccounting::sub(MemoryAccounting::ACCOUNT_STORAGE, bytes, entries);
+}
+
+unsigned long CdsTreeIndex::getGeneration()
+{
+    AutoLock lock(mutex);
+    return clock;
+}
+
+bool CdsTreeIndex::isCurrent(int containerID, unsigned long generation)
+{
+    if (clearedAt > generation)
+        return false;
+    auto it = changedAt.find(containerID);
+    return it == changedAt.end() || it->second <= generation;
+}
+
+bool CdsTreeIndex::setChildren(int containerID, const std::vector<Child>& children, unsigned long generation)
+{
+    if (children.size() > maxEntries)
+        return false;
+
+    ChildList list;
+    list.containerCount = 0;
+    list.bytes = 0;
+    list.ids.reserve(children.size());
+    list.titles.reserve(children.size());
+    list.objectTypes.reserve(children.size());
+    list.trackNumbers.reserve(children.size());
+    list.updateIDs.reserve(children.size());
+    for (const auto& child : children) {
+        list.ids.push_back(child.id);
+        list.titles.push_back(child.title);
+        list.objectTypes.push_back(child.objectType);
+        list.trackNumbers.push_back(child.trackNumber);
+        list.updateIDs.push_back(child.updateID);
+        if (IS_CDS_CONTAINER(child.objectType))
+            list.containerCount++;
+    }
+
+    AutoLock lock(mutex);
+    if (!isCurrent(containerID, generation))
+        return false;
+    for (int i = 0; i < list.containerCount; i++) {
+        auto it = updatedAt.find(list.ids[i]);
+        if (it != updatedAt.end() && it->second > generation)
+            return false;
+    }
+    dropList(containerID);
+    if (entries + children.size() > maxEntries)
+        dropAll();
+    for (int id : list.ids)
+        parents[id] = containerID;
+    account(list, list.ids.size());
+    lists[containerID] = std::move(list);
+    return true;
+}
+
+void CdsTreeIndex::setCounts(int containerID, int containers, int items, unsigned long generation)
+{
+    AutoLock lock(mutex);
+    if (isCurrent(containerID, generation))
+        counts[containerID] = { containers, items };
+}
+
+bool CdsTreeIndex::isIndexed(int containerID)
+{
+    AutoLock lock(mutex);
+    return lists.find(containerID) != lists.end();
+}
+
+bool CdsTreeIndex::getObject(int objectID, int& objectType, int& updateID)
+{
+    AutoLock lock(mutex);
+    auto parent = parents.find(objectID);
+    if (parent == parents.end())
+        return false;
+
+    const auto& list = lists.at(parent->second);
+    auto pos = std::find(list.ids.begin(), list.ids.end(), objectID) - list.ids.begin();
+    objectType = list.objectTypes[pos];
+    updateID = list.updateIDs[pos];
+    return true;
+}
+
+bool CdsTreeIndex::getCount(int containerID, bool containers, bool items, int excludeID, int& count)
+{
+    AutoLock lock(mutex);
+    auto list = lists.find(containerID);
+    if (list != lists.end()) {
+        const auto& order = list->second.ids;
+        int containerCount = list->second.containerCount;
+        count = (containers ? containerCount : 0) + (items ? static_cast<int>(order.size()) - containerCount : 0);
+        if (excludeID != INVALID_OBJECT_ID) {
+            auto pos = std::find(order.begin(), order.end(), excludeID);
+            if (pos != order.end() && (pos - order.begin() < containerCount ? containers : items))
+                count--;
+        }
+        return true;
+    }
+
+    // bare counts do not tell whether the excluded object is a child
+    auto it = counts.find(containerID);
+    if (it == counts.end() || excludeID != INVALID_OBJECT_ID)
+        return false;
+    count = (containers ? it->second.containers : 0) + (items ? it->second.items : 0);
+    return true;
+}
+
+const std::vector<int>& CdsTreeIndex::getTrackOrder(ChildList& list)
+{
+    if (list.trackOrder.size() == list.ids.size())
+        return list.trackOrder;
+
+    // ORDER BY track_number, dc_title, id: a stable sort of the title order
+    std::vector<int> positions(list.ids.size());
+    std::iota(positions.begin(), positions.end(), 0);
+    std::stable_sort(positions.begin(), positions.end(), [&list](int a, int b) {
+        bool aContainer = a < list.containerCount;
+        bool bContainer = b < list.containerCount;
+        if (aContainer != bContainer)
+            return aContainer;
+        return list.trackNumbers[a] < list.trackNumbers[b];
+    });
+    list.trackOrder.clear();
+    list.trackOrder.reserve(positions.size());
+    for (int pos : positions)
+        list.trackOrder.push_back(list.ids[pos]);
+    account(list, 0);
+    return list.trackOrder;
+}
+
+bool CdsTreeIndex::getPage(int containerID, bool containers, bool items, bool trackSort, int excludeID,
+    int start, int count, std::vector<int>& ids, int& total)
+{
+    AutoLock lock(mutex);
+    auto it = lists.find(containerID);
+    if (it == lists.end())
+        return false;
+
+    auto& list = it->second;
+    const auto& order = trackSort ? getTrackOrder(list) : list.ids;
+    auto begin = order.begin() + (containers ? 0 : list.containerCount);
+    auto end = items ? order.end() : order.begin() + list.containerCount;
+    if (!containers && !items)
+        end = begin;
+
+    auto excluded = excludeID != INVALID_OBJECT_ID ? std::find(begin, end, excludeID) : end;
+    total = static_cast<int>(end - begin) - (excluded != end ? 1 : 0);
+
+    ids.clear();
+    if (start >= total)
+        return true;
+    int size = count > 0 ? std::min(count, total - start) : total - start;
+    ids.reserve(size);
+
+    auto pos = begin + start;
+    if (excluded != end && excluded <= pos)
+        pos++;
+    for (; pos != end && static_cast<int>(ids.size()) < size; ++pos) {
+        if (pos != excluded)
+            ids.push_back(*pos);
+    }
+    return true;
+}
+
+void CdsTreeIndex::invalidate(int containerID)
+{
+    AutoLock lock(mutex);
+    _invalidate(containerID);
+}
+
+void CdsTreeIndex::touch(std::unordered_map<int, unsigned long>& changes, int containerID)
+{
+    if (changes.size() >= CDS_TREE_INDEX_MAX_CHANGES) {
+        changes.clear();
+        clearedAt = clock;
+    }
+    changes[containerID] = ++clock;
+}
+
+void CdsTreeIndex::_invalidate(int containerID)
+{
+    touch(changedAt, containerID);
+    counts.erase(containerID);
+    dropList(containerID);
+}
+
+void CdsTreeIndex::account(ChildList& list, long long items)
+{
+    size_t size = (list.ids.capacity() + list.objectTypes.capacity() + list.trackNumbers.capacity()
+                      + list.updateIDs.capacity() + list.trackOrder.capacity())
+            * sizeof(int)
+        + list.titles.capacity() * sizeof(std::string);
+    for (const auto& title : list.titles)
+        size += title.size();
+
+    long long delta = static_cast<long long>(size) - static_cast<long long>(list.bytes);
+    list.bytes = size;
+    bytes += delta;
+    entries += items;
+    MemoryAccounting::add(MemoryAccounting::ACCOUNT_STORAGE, delta, items);
+}
+
+void CdsTreeIndex::dropList(int containerID)
+{
+    auto it = lists.find(containerID);
+    if (it == lists.end())
+        return;
+
+    for (int id : it->second.ids)
+        parents.erase(id);
+    entries -= it->second.ids.size();
+    bytes -= it->second.bytes;
+    MemoryAccounting::sub(MemoryAccounting::ACCOUNT_STORAGE, it->second.bytes, it->second.ids.size());
+    lists.erase(it);
+}
+
+void CdsTreeIndex::dropAll()
+{
+    MemoryAccounting::sub(MemoryAccounting::ACCOUNT_STORAGE, bytes, entries);
+    lists.clear();
+    counts.clear();
+    parents.clear();
+    entries = 0;
+    bytes = 0;
+}
+
+void CdsTreeIndex::invalidateAll()
+{
+    clearedAt = ++clock;
+    changedAt.clear();
+    updatedAt.clear();
+}
+
+void CdsTreeIndex::objectAdded(int parentID, const Child& child)
+{
+    AutoLock lock(mutex);
+    if (IS_CDS_CONTAINER(child.objectType))
+        counts[child.id] = { 0, 0 };
+
+    auto it = lists.find(parentID);
+    // an empty title may sort before or after NULL ones
+    if (!bytewiseTitles || it == lists.end() || entries >= maxEntries
+        || child.title.empty() || parents.find(child.id) != parents.end()) {
+        _invalidate(parentID);
+        return;
+    }
+
+    touch(changedAt, parentID);
+    counts.erase(parentID);
+
+    auto& list = it->second;
+    bool container = IS_CDS_CONTAINER(child.objectType);
+    int begin = container ? 0 : list.containerCount;
+    int end = container ? list.containerCount : static_cast<int>(list.ids.size());
+    // ORDER BY dc_title, id within the containers or the items
+    while (begin < end) {
+        int mid = begin + (end - begin) / 2;
+        int cmp = list.titles[mid].compare(child.title);
+        if (cmp < 0 || (cmp == 0 && list.ids[mid] < child.id))
+            begin = mid + 1;
+        else
+            end = mid;
+    }
+
+    list.ids.insert(list.ids.begin() + begin, child.id);
+    list.titles.insert(list.titles.begin() + begin, child.title);
+    list.objectTypes.insert(list.objectTypes.begin() + begin, child.objectType);
+    list.trackNumbers.insert(list.trackNumbers.begin() + begin, child.trackNumber);
+    list.updateIDs.insert(list.updateIDs.begin() + begin, child.updateID);
+    if (container)
+        list.containerCount++;
+    list.trackOrder.clear();
+    parents[child.id] = parentID;
+    account(list, 1);
+}
+
+void CdsTreeIndex::objectChanged(int objectID, int parentID)
+{
+    AutoLock lock(mutex);
+    auto it = parents.find(objectID);
+    if (it == parents.end()) {
+        // the old parent may be counted or queried right now but is unknown
+        invalidateAll();
+        counts.clear();
+    }
+    else if (it->second != parentID)
+        _invalidate(it->second);
+    _invalidate(parentID);
+}
+
+void CdsTreeIndex::objectsRemoved(const std::vector<int>& objectIDs)
+{
+    AutoLock lock(mutex);
+    bool unknownParent = false;
+    for (int id : objectIDs) {
+        auto it = parents.find(id);
+        if (it != parents.end())
+            _invalidate(it->second);
+        else
+            unknownParent = true;
+        _invalidate(id);
+    }
+    // the parents of removed objects that were only counted are unknown
+    if (unknownParent) {
+        invalidateAll();
+        counts.clear();
+    }
+}
+
+void CdsTreeIndex::updateIDsChanged(const std::map<int, int>& updateIDs)
+{
+    AutoLock lock(mutex);
+    for (const auto& update : updateIDs) {
+        touch(updatedAt, update.first);
+        auto parent = parents.find(update.first);
+        if (parent == parents.end())
+            continue;
+        auto& list = lists.at(parent->second);
+        auto pos = std::find(list.ids.begin(), list.ids.end(), update.first) - list.ids.begin();
+        list.updateIDs[pos] = update.second;
+    }
+}
+
+void CdsTreeIndex::clear()
+{
+    AutoLock lock(mutex);
+    invalidateAll();
+    dropAll();
+}
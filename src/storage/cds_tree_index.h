@@ -0,0 +1,167 @@
+/*GRB*
+
+Gerbera - https://gerbera.io/
+
+    cds_tree_index.h - this file is part of Gerbera.
+
+    Copyright (C) 2016-2019 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file cds_tree_index.h
+/// \brief In-memory index of the children of browsed containers.
+#ifndef __CDS_TREE_INDEX_H__
+#define __CDS_TREE_INDEX_H__
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// \brief Keeps the sorted child lists of containers, so that paging
+/// through a container, counting children and looking up the type and
+/// update ID of a browsed container needs no SQL.
+///
+/// The index only holds the columns browse sorts and reports by, the
+/// objects themselves are loaded from the database by their primary key.
+/// Containers are indexed when they are browsed. Added children are
+/// sorted into the list when the titles are ordered by their bytes as the
+/// database orders them, otherwise the list is dropped, as it is whenever
+/// a child is changed or removed; the database stays the source of truth.
+class CdsTreeIndex {
+public:
+    /// \brief Child of a container as loaded from the database.
+    struct Child {
+        int id;
+        int objectType;
+        /// \brief -1 for NULL
+        int trackNumber;
+        int updateID;
+        std::string title;
+    };
+
+    /// \param maxEntries number of children kept in total, the index is
+    /// emptied when it would grow beyond
+    /// \param bytewiseTitles whether the database orders titles by their
+    /// bytes, so that added children can be sorted in
+    CdsTreeIndex(size_t maxEntries, bool bytewiseTitles);
+    ~CdsTreeIndex();
+
+    /// \brief Callers take it before querying the database, so that the
+    /// result for a container that was changed in between is not stored.
+    unsigned long getGeneration();
+
+    /// \brief Stores the children of a container.
+    /// \param children containers first, then ordered by title and ID as
+    /// the database sorts them; the track order is derived from it
+    /// \return false if the container is too large to be indexed or was
+    /// changed since generation was taken
+    bool setChildren(int containerID, const std::vector<Child>& children, unsigned long generation);
+
+    /// \brief Stores only the number of children of a container.
+    void setCounts(int containerID, int containers, int items, unsigned long generation);
+
+    bool isIndexed(int containerID);
+
+    /// \brief Type and update ID of an object held in the list of its parent.
+    /// \return false if the parent is not indexed
+    bool getObject(int objectID, int& objectType, int& updateID);
+
+    /// \return false if the children of the container are not known
+    bool getCount(int containerID, bool containers, bool items, int excludeID, int& count);
+
+    /// \brief Returns a page of children in browse order: containers
+    /// first, then ordered by title or by track number and title.
+    /// \param count 0 returns all children from start
+    /// \param excludeID child that is left out, INVALID_OBJECT_ID for none
+    /// \return false if the container is not indexed
+    bool getPage(int containerID, bool containers, bool items, bool trackSort, int excludeID,
+        int start, int count, std::vector<int>& ids, int& total);
+
+    /// \brief Drops the children of a container.
+    void invalidate(int containerID);
+
+    /// \brief A child was added to a container.
+    void objectAdded(int parentID, const Child& child);
+
+    /// \brief An object was updated, its old and new parent are dropped.
+    void objectChanged(int objectID, int parentID);
+
+    /// \brief Objects were removed, their parents and their own children are dropped.
+    void objectsRemoved(const std::vector<int>& objectIDs);
+
+    /// \brief The update IDs of containers were changed.
+    void updateIDsChanged(const std::map<int, int>& updateIDs);
+
+    void clear();
+
+protected:
+    /// \brief Children of one container in database order, one array per
+    /// column; containers come first in both orders.
+    struct ChildList {
+        std::vector<int> ids;
+        std::vector<std::string> titles;
+        std::vector<int> objectTypes;
+        std::vector<int> trackNumbers;
+        std::vector<int> updateIDs;
+        /// \brief IDs in track order, derived when first asked for
+        std::vector<int> trackOrder;
+        int containerCount;
+        size_t bytes;
+    };
+
+    struct ChildCounts {
+        int containers;
+        int items;
+    };
+
+    size_t maxEntries;
+    size_t entries;
+    size_t bytes;
+    bool bytewiseTitles;
+
+    /* every invalidation advances the clock and records it for the
+       container, or for all containers if the container is unknown */
+    unsigned long clock;
+    unsigned long clearedAt;
+    std::unordered_map<int, unsigned long> changedAt;
+    /// \brief containers whose update ID changed, a list holding them as
+    /// children with an older update ID is not stored
+    std::unordered_map<int, unsigned long> updatedAt;
+
+    std::unordered_map<int, ChildList> lists;
+    std::unordered_map<int, ChildCounts> counts;
+    /// \brief parents of all objects held in lists
+    std::unordered_map<int, int> parents;
+
+    std::mutex mutex;
+    using AutoLock = std::lock_guard<std::mutex>;
+
+    void _invalidate(int containerID);
+    void dropList(int containerID);
+    void dropAll();
+    /// \brief Rejects all results that were queried before.
+    void invalidateAll();
+    bool isCurrent(int containerID, unsigned long generation);
+    /// \brief Records a change of the container without dropping its list.
+    void touch(std::unordered_map<int, unsigned long>& changes, int containerID);
+    /// \brief Accounts the memory of a list after it changed by items children.
+    void account(ChildList& list, long long items);
+    const std::vector<int>& getTrackOrder(ChildList& list);
+};
+
+#endif // __CDS_TREE_INDEX_H__
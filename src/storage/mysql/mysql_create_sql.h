@@ -33,85 +33,109 @@
 
 #ifndef __MYSQL_CREATE_SQL_H__
 #define __MYSQL_CREATE_SQL_H__
-#define MS_CREATE_SQL_INFLATED_SIZE 4216
-#define MS_CREATE_SQL_DEFLATED_SIZE 1090
+#define MS_CREATE_SQL_INFLATED_SIZE 6072
+#define MS_CREATE_SQL_DEFLATED_SIZE 1446
 
 /* begin binary data: */
-const unsigned char mysql_create_sql[] = /* 1090 */
-{0x78,0x9C,0xC5,0x57,0x51,0x6F,0x9B,0x48,0x10,0x7E,0xCF,0xAF,0xD8,0x7B,0x02
-,0x57,0xDC,0x05,0xA2,0x44,0xEA,0xA9,0x8A,0x14,0x0E,0x6F,0x5B,0xAB,0x04,0x52
-,0xC0,0x77,0xEA,0xBD,0x2C,0x6B,0x58,0xC7,0x5C,0x30,0x58,0xB0,0x58,0xF5,0xBF
-,0xBF,0x59,0x30,0x06,0xCC,0xDA,0xB5,0xA5,0x53,0xEF,0x25,0xC1,0xC3,0xB7,0xDF
-,0x7E,0xCC,0xCC,0xCE,0xCE,0xDC,0xBE,0xFB,0xE5,0x5E,0x37,0x74,0x03,0xF9,0x38
-,0x40,0x4F,0xAE,0x3D,0x25,0xD6,0x67,0xD3,0x33,0xAD,0x00,0x7B,0x04,0x4C,0xC4
-,0xB2,0x67,0xD8,0x09,0x1E,0x9F,0x9E,0x64,0x66,0xF4,0xEE,0xF6,0xC3,0xCD,0xED
-,0x0F,0x18,0x3C,0xEC,0xCF,0xED,0xC0,0x1F,0x51,0xEC,0xED,0xA7,0x38,0x5C,0xDB
-,0x36,0x83,0x99,0xEB,0xC0,0x93,0xE3,0x60,0x4B,0x3C,0x0A,0x0A,0x89,0x79,0xCC
-,0xE0,0x98,0xCF,0xD8,0x47,0x15,0x5F,0xBE,0xEF,0xDE,0xE9,0xC6,0x7D,0xC7,0x3E
-,0x77,0x66,0x5F,0xE7,0x18,0x84,0x62,0xEB,0x8B,0x50,0x36,0xF8,0xAD,0xA1,0xE1
-,0x6B,0xFD,0x04,0xC9,0x47,0xD7,0xC3,0xB3,0x4F,0x0E,0xF9,0x82,0xBF,0x75,0x4C
-,0x63,0xA3,0x86,0x24,0x40,0xFD,0xC4,0x67,0xFB,0x5F,0x6D,0xF2,0xEC,0x4E,0x31
-,0x30,0xB5,0x8F,0x1A,0x3A,0x18,0x15,0xC7,0x25,0xE6,0x3C,0x70,0xC9,0x9F,0xA6
-,0x0D,0xFA,0xC0,0x0B,0x7F,0x63,0xCF,0x55,0x7A,0x5C,0xC6,0x11,0x97,0xE3,0x06
-,0xD8,0xDF,0x93,0xD5,0xCF,0x0D,0x5B,0x63,0x6E,0x44,0x58,0x1E,0x36,0x03,0x8C
-,0x02,0xF3,0x0F,0x1B,0xA3,0x70,0xCD,0x49,0x14,0x97,0x24,0x5F,0xFC,0xC3,0x22
-,0x1E,0x22,0xF5,0x06,0xA1,0x30,0x89,0x43,0x94,0x64,0x5C,0x35,0x8C,0x09,0x82
-,0x95,0xC8,0x99,0xDB,0x36,0xA2,0x15,0xCF,0x49,0x92,0x45,0x05,0x5B,0xB3,0x8C
-,0x6B,0x02,0x57,0xB0,0x25,0xE9,0x63,0x63,0xB6,0xA4,0x55,0xCA,0x6B,0x7C,0x0D
-,0xD8,0xD0,0x02,0xB0,0x44,0xCA,0xD7,0x82,0x15,0x5D,0xA9,0xB1,0x8D,0x02,0xC2
-,0x77,0x1B,0x16,0x22,0x9E,0x64,0x3B,0xB1,0xE2,0x7E,0x82,0xAA,0xAC,0x4C,0x5E
-,0x33,0x16,0x1F,0x56,0xD6,0xE8,0x6A,0x93,0x6D,0x48,0x94,0xD2,0xB2,0x0C,0xD1
-,0x96,0x16,0xD1,0x8A,0x16,0xEA,0x7B,0x5D,0x22,0x21,0x8E,0x08,0x4F,0x78,0xCA
-,0x3A,0xD8,0xDD,0xC3,0x83,0x04,0x97,0xE6,0x11,0xE5,0x49,0x9E,0x85,0x68,0x91
-,0xE6,0x8B,0x81,0x89,0xAC,0x68,0xB9,0xEA,0xBE,0xE0,0x20,0x68,0xC4,0xB1,0x66
-,0x9C,0xC6,0x94,0xD3,0x1E,0x07,0xAD,0xBE,0x1F,0x59,0x0A,0x56,0xE6,0x55,0x11
-,0xB1,0xB2,0x67,0xAB,0x36,0x00,0x62,0x97,0xF9,0x69,0x9D,0xAC,0xD9,0xDE,0x4B
-,0xED,0x17,0xDD,0xCB,0x3E,0x7C,0x99,0xD2,0xD7,0x52,0xA2,0x7A,0x4C,0x6C,0x34
-,0xC4,0xBC,0xA0,0xD1,0x1B,0xC9,0xAA,0xF5,0x82,0x15,0x67,0x62,0x5A,0xB2,0x62
-,0x9B,0x44,0x8D,0xD8,0xB3,0x2E,0x7D,0xF1,0x66,0xCF,0xA6,0xF7,0x0D,0xC1,0x29
-,0x40,0x48,0x15,0x49,0x35,0x11,0x66,0xF1,0x33,0xEC,0x52,0x8E,0xB4,0x49,0xA4
-,0xB6,0xE9,0x24,0x45,0xF5,0x32,0x49,0xED,0xA5,0x95,0x36,0x48,0x1B,0xAD,0x8B
-,0xB6,0x94,0x64,0x90,0x62,0xEA,0x60,0x69,0x87,0x3F,0x44,0xBD,0xD9,0x45,0x00
-,0x87,0x89,0xA0,0xF5,0xF6,0x97,0x6E,0x33,0x74,0xA4,0x3A,0x74,0xAC,0x74,0x45
-,0xDF,0xA7,0x6A,0xDF,0xC3,0x35,0x1A,0x2A,0x9F,0x1F,0x78,0xE6,0x0C,0xEA,0xEF
-,0xF0,0xB8,0x92,0x64,0xB1,0x7C,0x23,0x46,0xD8,0x16,0x9C,0x9A,0xB7,0xF3,0x23
-,0xF2,0xF0,0x47,0xEC,0x61,0xC7,0x82,0xDA,0x38,0x3A,0xE7,0x75,0x3C,0x10,0x14
-,0xD3,0x29,0xB6,0x31,0x94,0x03,0xCB,0xF4,0x2D,0x73,0x8A,0x85,0x65,0xFE,0x32
-,0x35,0x3B,0xCB,0x05,0x0A,0xEE,0x8E,0x15,0xF4,0x1C,0xF4,0xDF,0x88,0xB8,0x99
-,0x20,0xEC,0x7C,0x9A,0x39,0xF8,0xF1,0x79,0x37,0xF3,0xCD,0x67,0x24,0xAE,0x16
-,0x28,0x7C,0x8F,0xA2,0xE6,0x7F,0xB8,0x99,0x39,0x3E,0xF6,0x02,0x04,0xFA,0xDC
-,0xD1,0x26,0x75,0xE9,0xF4,0x91,0xFA,0xAB,0xA1,0xD5,0x99,0x09,0xFF,0xF5,0xE6
-,0xE9,0xFC,0x9F,0x3D,0xE8,0xF7,0xCE,0x34,0xB9,0x6C,0x23,0xFD,0xB0,0x8F,0xA1
-,0x29,0xCD,0xCB,0xDF,0xA2,0x3C,0xE3,0x34,0xC9,0x58,0xA1,0x68,0x8A,0x97,0xE7
-,0x5C,0xB9,0x72,0xDF,0xBD,0x37,0x8E,0xB7,0x14,0xA5,0x5F,0xF8,0xF0,0x11,0x8A
-,0x03,0xFA,0xEB,0x33,0xF8,0x79,0xFF,0xD3,0x50,0x2E,0xD3,0x6A,0xB4,0x7B,0xCA
-,0xA5,0xBE,0x58,0x68,0x9A,0x14,0x60,0xCD,0x8B,0xDD,0xB5,0x92,0xA5,0xD7,0x0C
-,0x8D,0x78,0xB2,0x85,0xCC,0xE6,0x6C,0x7D,0xE6,0xAE,0x69,0x2A,0x67,0xD4,0x94
-,0xE3,0x41,0x8D,0x19,0x20,0x4A,0x0E,0x45,0xF3,0x0C,0xE0,0x44,0x01,0x92,0x24
-,0x73,0x4F,0xD6,0x89,0x33,0xF5,0xD3,0x52,0x79,0xE4,0x36,0x70,0x0E,0x2B,0x32
-,0x9A,0x42,0x91,0xE0,0x70,0x2D,0xBE,0xEE,0xFD,0xF6,0xC6,0x76,0xC3,0x0B,0x60
-,0xE0,0x9A,0x2D,0x4D,0xAB,0x2B,0x5C,0x23,0xC8,0x26,0x57,0x9E,0xB1,0xB1,0xAE
-,0x36,0xA9,0x94,0x78,0x41,0xB6,0xAC,0x28,0x21,0x7C,0x90,0x43,0x0F,0x8A,0x2C
-,0x19,0x44,0x37,0x51,0x46,0x34,0xBB,0xB2,0xE3,0x00,0x77,0x9F,0xEF,0x38,0x04
-,0x27,0x49,0xD9,0x96,0xA5,0x21,0x62,0x50,0x72,0x55,0x65,0x41,0xCB,0x24,0x02
-,0x1D,0xCB,0x2A,0x4D,0x95,0xE3,0x0C,0x12,0xE8,0x75,0x1E,0xB3,0x16,0xCC,0xE1
-,0x72,0x8D,0x01,0x9C,0x64,0x39,0x4F,0x96,0xBB,0x63,0x3C,0x1C,0x85,0x0A,0xBE
-,0x6B,0x7B,0x49,0x87,0xB2,0x4A,0xE2,0x98,0x65,0x17,0x00,0x6B,0x47,0x42,0xC0
-,0x2E,0xE9,0x30,0xA0,0xE1,0xE1,0x42,0x70,0xB2,0x4C,0x18,0xB8,0x61,0x91,0xBC
-,0x8A,0x35,0x77,0xFA,0xB9,0x35,0x1B,0x11,0x8A,0x92,0xD7,0x77,0xD9,0x39,0x31
-,0xA3,0x4E,0x43,0xD2,0x12,0x6D,0x28,0x5F,0x41,0x00,0xFA,0xBD,0x0B,0xCF,0xAB
-,0x68,0x25,0xC4,0x5C,0xC6,0xDD,0x34,0x1B,0xFD,0xFC,0x0B,0x9B,0x5B,0xAF,0x3D
-,0x9E,0x4D,0x2F,0xDE,0xBC,0xE9,0x25,0x0A,0x69,0x43,0xAF,0xB6,0x49,0x20,0x3B
-,0xCC,0x07,0xB4,0xFC,0x14,0xB7,0x2B,0xFF,0x9F,0x93,0xDC,0xB5,0x87,0x57,0xE5
-,0x7C,0x53,0x95,0x4E,0x95,0xC9,0x4D,0x91,0x43,0x80,0xF9,0x8E,0x64,0x74,0x7D
-,0xEE,0xC4,0x77,0xC0,0x7D,0x6D,0xE0,0xEC,0x3B,0x3F,0x59,0x13,0x8E,0x62,0xD2
-,0x04,0x63,0x2F,0x9F,0x1C,0x04,0xA9,0x07,0x6D,0xB2,0x58,0x74,0xF8,0x78,0xF9
-,0x36,0x2E,0xA8,0xED,0xCA,0x9F,0x12,0x8B,0xC1,0xE0,0xD5,0xCD,0x5C,0xFD,0x09
-,0x6C,0x3C,0xF4,0xC9,0xE6,0x3D,0xF9,0x1C,0x38,0x5E,0x7B,0x34,0x70,0x8E,0x66
-,0xD0,0xF1,0x38,0x28,0x1F,0xC3,0x4F,0x0D,0xE8,0x3F,0x5A,0x7F,0x18,0xC2,0x4F
-,0xCE,0xE7,0x12,0x06,0xE9,0x08,0x7E,0x6A,0x38,0x1F,0x0F,0xA1,0xBD,0xF9,0x73
-,0x30,0x8E,0xD6,0xC8,0x7F,0x01,0x8E,0xC3,0xF9,0x67};
-/* end binary data. size = 1090 bytes */
+const unsigned char mysql_create_sql[] = /* 1446 */
+{0x78,0xDA,0xAD,0x58,0x5B,0x73,0x9B,0x38,0x14,0x7E,0xCF,0xAF,0xD0,0x3E,0x81
+,0x3B,0x6C,0x6B,0x32,0xE9,0x65,0xA7,0x93,0x99,0xB8,0x0E,0x6D,0xBD,0x75,0x20
+,0xB5,0x9D,0x76,0xBA,0x2F,0x42,0x06,0xD9,0xD6,0x96,0x8B,0x17,0x84,0x37,0xF9
+,0xF7,0x2B,0x21,0x6E,0x32,0x02,0xE3,0x4D,0x5F,0x12,0x23,0x3E,0x1D,0x7D,0x3A
+,0xFA,0xCE,0xD1,0xE1,0xBC,0x7A,0xF1,0xDB,0xD5,0xD8,0x1C,0x9B,0x60,0x69,0xAD
+,0xC0,0x8D,0x33,0xBF,0x85,0xD3,0xCF,0x93,0xC5,0x64,0xBA,0xB2,0x16,0x90,0x0D
+,0xC1,0xE9,0x7C,0x66,0xD9,0xAB,0xEB,0x9B,0x1B,0xD5,0x30,0x78,0xF1,0xEA,0xFD
+,0xC5,0xAB,0x13,0x16,0x16,0xD6,0xF2,0x61,0xBE,0x5A,0xB6,0x4C,0x14,0xE3,0x5D
+,0x36,0x9C,0xF9,0x7C,0xB2,0x9A,0x39,0x36,0xFB,0x65,0xDB,0xD6,0x94,0xFF,0xE4
+,0x26,0x14,0xC3,0x6D,0x0B,0xF6,0xE4,0xCE,0x5A,0x82,0x8C,0x6E,0xDE,0xD5,0xEF
+,0xC6,0xE6,0x55,0x6D,0xFD,0xC1,0x9E,0x7D,0x7D,0xB0,0x18,0x51,0x6B,0xFA,0x85
+,0x33,0x93,0x9E,0x0D,0x20,0xBF,0x1E,0x77,0x18,0xF9,0xE8,0x2C,0xAC,0xD9,0x27
+,0x1B,0x7E,0xB1,0x7E,0xD4,0x96,0xDA,0x83,0x06,0x50,0x00,0xC7,0x1D,0xDB,0x5E
+,0x7E,0x9D,0xC3,0x3B,0xE7,0xD6,0x62,0x96,0xCA,0x9F,0x06,0xA8,0x06,0x35,0xDB
+,0x81,0x93,0x87,0x95,0x03,0xBF,0x4D,0xE6,0x8C,0x1F,0xF3,0xC2,0x5F,0xD6,0xC2
+,0xD1,0x1A,0xB6,0xCC,0x23,0x5B,0xB6,0xB3,0xB2,0x96,0x85,0xB1,0xFC,0xB7,0xB0
+,0x26,0x86,0x05,0x89,0xE9,0xC2,0x9A,0xAC,0x2C,0xB0,0x9A,0x7C,0x98,0x5B,0xC0
+,0x0D,0x29,0xF4,0xFC,0x14,0xC6,0xEB,0xBF,0xB1,0x47,0x5D,0xA0,0x5F,0x00,0xE0
+,0x12,0xDF,0x05,0x24,0xA2,0xBA,0x69,0x8E,0x00,0x9B,0x09,0xEC,0x87,0xF9,0x1C
+,0xA0,0x8C,0xC6,0x90,0x44,0x5E,0x82,0x43,0x1C,0x51,0x83,0xE3,0x12,0xBC,0x81
+,0x4D,0xAC,0x8F,0x37,0x28,0x0B,0x68,0x8E,0xCF,0x01,0x7B,0x94,0x30,0x2C,0x54
+,0xDA,0x2B,0xC1,0xDA,0x58,0xCB,0xB1,0x82,0x01,0xA4,0x4F,0x7B,0xEC,0x02,0x4A
+,0xA2,0x27,0x3E,0xE3,0x6A,0x04,0xB2,0x28,0x25,0xDB,0x08,0xFB,0xD5,0xCC,0x1C
+,0x9D,0xED,0xA3,0x3D,0xF4,0x02,0x94,0xA6,0x2E,0x38,0xA0,0xC4,0xDB,0xA1,0x44
+,0x7F,0x37,0x56,0x50,0xF0,0x3D,0x48,0x09,0x0D,0x70,0x0D,0xBB,0x7C,0xFD,0x5A
+,0x81,0x0B,0x62,0x0F,0x51,0x12,0x47,0x2E,0x58,0x07,0xF1,0x5A,0x1A,0x82,0x3B
+,0x94,0xEE,0xEA,0x1D,0x54,0x84,0x5A,0x36,0x42,0x4C,0x91,0x8F,0x28,0x6A,0xD8
+,0x40,0xD9,0xE3,0xD1,0x48,0x82,0xD3,0x38,0x4B,0x3C,0x9C,0x36,0xC6,0xB2,0x3D
+,0x03,0xE1,0x61,0x7E,0x0A,0x49,0x88,0x0B,0x2F,0x95,0x3B,0xBA,0x52,0x6D,0x7C
+,0x13,0xA0,0x6D,0xAA,0x60,0xDD,0x36,0x6C,0x0A,0xC3,0x34,0x41,0xDE,0x4F,0x18
+,0x65,0xE1,0x1A,0x27,0x3D,0x67,0x9A,0xE2,0xE4,0x40,0x3C,0x41,0xB6,0xDF,0xA5
+,0xF9,0x19,0xA1,0x84,0x92,0x94,0x0E,0x83,0x06,0xEB,0x2C,0x1C,0x84,0xDC,0xE2
+,0x28,0x39,0x79,0xA2,0xEC,0xE4,0xB9,0x57,0x4F,0xC1,0xF6,0x88,0xEE,0xE0,0x4F
+,0xFC,0x54,0xE3,0xDE,0xBE,0x79,0x3B,0x02,0x55,0xEE,0xCA,0xE3,0x0B,0xA5,0x1E
+,0x21,0x40,0x24,0x23,0x4B,0x3C,0xC1,0x35,0x89,0x5A,0xD6,0xEE,0x17,0xB3,0xBB
+,0xC9,0xE2,0x07,0x60,0x91,0x0F,0x80,0xCE,0x03,0x69,0xC4,0x87,0xF9,0xA3,0x5B
+,0x87,0x19,0x2C,0x03,0x47,0x2F,0x43,0x48,0x89,0x6A,0x44,0x8F,0xDE,0x08,0x25
+,0x43,0x0A,0x15,0xA3,0x56,0xB8,0xD2,0x88,0x14,0x56,0xBA,0x34,0xB5,0xC6,0x57
+,0x4A,0x17,0xAB,0x70,0xA0,0x2C,0x7E,0xA3,0xB1,0xBE,0x72,0x19,0x59,0x3C,0xBA
+,0x2C,0x26,0xE5,0x8C,0xA6,0x8E,0xF4,0xA6,0xAA,0x94,0x68,0x49,0x4B,0xBA,0x24
+,0xAD,0x1E,0xBC,0x10,0x94,0xDE,0x94,0x57,0x37,0xBA,0x10,0x95,0xDE,0x94,0x98
+,0x12,0x5D,0x09,0x4B,0xAF,0x34,0xD6,0x71,0x7E,0xA5,0xB2,0xF4,0x5A,0x65,0xA3
+,0x8B,0x11,0xB0,0xEC,0x4F,0x33,0xDB,0xBA,0x9E,0x45,0x51,0x7C,0xFB,0x21,0x57
+,0x1A,0xD3,0xD8,0x35,0xBF,0xBE,0xDE,0x5F,0xCC,0xEC,0xA5,0xB5,0x58,0x81,0x99
+,0xBD,0x72,0x5A,0xC9,0x39,0xBF,0x05,0x96,0x40,0xFF,0xDD,0x34,0x72,0xC1,0xB1
+,0xFF,0x63,0xF1,0xAB,0xFF,0x4F,0x01,0xFA,0x63,0x00,0x76,0x34,0x8C,0xC1,0xB8
+,0x22,0x60,0x1A,0x9A,0x78,0xF9,0xD2,0x8B,0x23,0x8A,0x48,0x84,0x13,0xCD,0xD0
+,0x16,0x71,0x4C,0xB5,0x67,0x13,0x62,0x86,0x18,0x9F,0x87,0xFB,0x5B,0x1E,0x74
+,0xC7,0x54,0x78,0x58,0xF2,0x00,0xBB,0x66,0x89,0x11,0x7C,0xFF,0x6C,0x2D,0xAC
+,0xE2,0xD1,0xD4,0x86,0xED,0xC1,0x2C,0xB9,0xA8,0xB7,0x70,0x3F,0x05,0xB7,0x24
+,0x61,0xA3,0x71,0xF2,0xF4,0x2B,0xB6,0x62,0xE6,0x9B,0x51,0x5E,0xBE,0xC8,0xA3
+,0xE4,0xC0,0xB4,0x4F,0x71,0xD8,0x73,0x03,0x8B,0xFB,0xC4,0x13,0x97,0x94,0x94
+,0xD3,0x24,0x44,0x4A,0xDB,0x49,0xAF,0x09,0x50,0xA4,0xA8,0x13,0x92,0x6C,0x71
+,0x66,0xCC,0x70,0x12,0xA1,0x80,0xC5,0x30,0x65,0x37,0xF5,0xB6,0x20,0x2D,0x25
+,0x51,0x7E,0x27,0x49,0xBC,0x0E,0x28,0xC8,0xCE,0xE0,0xF5,0x7F,0x62,0xA5,0xCD
+,0xAB,0x3C,0x6B,0xCD,0x5F,0xC3,0x03,0x4E,0x52,0xE6,0x3B,0x76,0xB4,0xE6,0xA5
+,0x36,0x3A,0x6B,0x76,0x48,0xB6,0x89,0xC8,0x86,0xE5,0x15,0x0F,0x7D,0x92,0x9F
+,0x04,0xE2,0xE2,0x60,0x92,0x7B,0xB6,0x3D,0x2F,0x0E,0xB2,0x30,0x4A,0x9F,0x65
+,0xAC,0x4C,0x32,0x95,0x95,0xD6,0xC9,0xF1,0x22,0x2E,0xF5,0x50,0x74,0x66,0xA1
+,0xC7,0xC2,0xA3,0xBF,0xD0,0xE3,0x36,0x61,0x80,0x0F,0x38,0x70,0x01,0x66,0x59
+,0x5F,0xD7,0xD6,0x28,0x25,0x1E,0xE3,0xB1,0xC9,0x82,0x40,0x3B,0x96,0x28,0x47
+,0x87,0xB1,0x8F,0x4B,0x30,0x65,0x35,0x8D,0xCF,0xC0,0x24,0x8A,0x29,0xD9,0x3C
+,0x1D,0xE3,0x59,0x14,0x66,0xEC,0xEC,0x0E,0x43,0x0A,0xC3,0x1D,0xF1,0x7D,0x1C
+,0x0D,0x00,0xE6,0x1E,0x65,0xA2,0x1C,0x52,0xD8,0xB1,0x3A,0x93,0x72,0xC2,0x64
+,0x43,0x30,0x73,0xC3,0x9A,0x6C,0xF9,0x9C,0xCB,0x71,0xDF,0x9C,0x3D,0x97,0x5B
+,0x4A,0xF3,0xEB,0xB4,0x8F,0x4C,0xAB,0xC0,0x53,0x54,0xA2,0xF9,0xC1,0x12,0xBF
+,0x59,0x32,0xD2,0x38,0xF3,0x76,0x9C,0xCC,0x30,0xDB,0xA2,0xC6,0x6B,0xC6,0x98
+,0x2B,0x2E,0xDE,0xF2,0xC2,0x15,0x9F,0x40,0xE2,0x4D,0x43,0x28,0xB0,0x3C,0x7A
+,0xBD,0x14,0xC1,0xD9,0xD9,0xA2,0x92,0xF8,0x3E,0x89,0x99,0x53,0xE8,0xD3,0x99
+,0xE2,0x8B,0x50,0x38,0x34,0x6F,0xF4,0xED,0xE9,0x98,0x05,0x14,0x76,0x75,0x61
+,0xBF,0x7F,0x57,0x65,0xE5,0x97,0x3F,0xF0,0xC2,0xAF,0x6F,0x9B,0x45,0xA2,0x3B
+,0x6B,0x8F,0xF9,0x9C,0xAE,0xEF,0x0C,0x55,0x1A,0xA5,0xF8,0x91,0x3E,0xCB,0x0D
+,0xCD,0x15,0xF5,0xE6,0xFA,0x46,0xB1,0x44,0xEE,0xE9,0x5F,0xE7,0x96,0x33,0x1D
+,0xC2,0xEF,0x42,0xD8,0x79,0x0B,0x56,0x67,0xD8,0x89,0x10,0x1B,0xEA,0x7A,0xDD
+,0xE3,0x2C,0xD9,0x4B,0x15,0x0D,0xBD,0x62,0xA4,0x40,0xD5,0x8B,0xE9,0xF5,0xC2
+,0x86,0xC4,0x72,0x60,0xD4,0x7C,0x9B,0x59,0xDF,0x8F,0xD4,0x44,0xF0,0xBF,0x2E
+,0x98,0x2C,0x59,0xBD,0x33,0xB7,0xA6,0xAC,0xE4,0x09,0xDD,0x97,0x9C,0xAC,0x51
+,0xFC,0x2A,0x58,0xB1,0xC7,0x3D,0x7B,0x14,0x9A,0x66,0x68,0x57,0x96,0x39,0x7B
+,0x7D,0x60,0xAF,0x0B,0xF1,0x48,0xEF,0xC5,0x58,0x13,0x20,0x74,0xC0,0x76,0xF9
+,0x71,0xE1,0xDC,0x1D,0x1D,0x22,0x5B,0x14,0xFC,0xE9,0xCC,0xEC,0xAE,0xC8,0x66
+,0x2C,0x80,0x63,0x0B,0x32,0xDC,0x21,0xD7,0x82,0xA6,0x74,0x60,0xED,0xF9,0x05
+,0x2F,0x46,0x21,0x9F,0x7C,0x90,0x27,0x57,0x2E,0x55,0xC8,0xAB,0xFC,0x6E,0x28
+,0xAA,0x1E,0xBD,0xD1,0x49,0xE8,0xD4,0x46,0x39,0x67,0xCF,0x3E,0xBE,0xC8,0xA3
+,0x0B,0xF2,0xBC,0xD2,0x05,0x6A,0x7D,0xE6,0x4A,0x28,0x5E,0x30,0xF2,0xCF,0x22
+,0x11,0x47,0x25,0xCE,0x7C,0xA3,0xFA,0x7E,0xD7,0xEA,0xAB,0x24,0xC5,0xFC,0x8A
+,0x52,0x5D,0x23,0x5D,0xB7,0x82,0xA4,0xD8,0xC6,0x06,0xF5,0xC6,0x43,0xAD,0x4C
+,0xC9,0x2B,0xC5,0x6A,0xFA,0xF1,0xBE,0x8D,0x06,0x97,0xB3,0x93,0x7A,0x8A,0xFF
+,0xC9,0x70,0xE4,0x95,0x2E,0x97,0x73,0x74,0xAB,0xF6,0x8B,0x58,0xB6,0x1A,0x14
+,0x8C,0xC3,0xD2,0x71,0xBB,0x3C,0xAA,0xE9,0x54,0x65,0x91,0xF0,0x8B,0x66,0x5C
+,0x8E,0x06,0xC1,0x4B,0x2D,0xB2,0x42,0x5D,0x59,0xA6,0xEF,0x50,0xB4,0xC5,0x30
+,0x88,0xB7,0x67,0x26,0xB2,0xEA,0x93,0xA2,0x5B,0x8F,0x3D,0xDD,0x1F,0x61,0x22
+,0x5F,0xDB,0xEF,0x17,0xCC,0xC9,0xEE,0x43,0xB5,0x01,0x58,0xD9,0xD3,0x2B,0xD3
+,0xA7,0xFC,0x2D,0x35,0x2E,0xEB,0x9E,0x65,0xB3,0x83,0xD9,0x6E,0x9A,0xAA,0xFA
+,0xA5,0xEA,0x3E,0x6A,0x7B,0xEE,0x51,0xC3,0xB6,0xD5,0xC3,0x6D,0xB7,0x53,0xD5
+,0x6D,0xEC,0xAE,0x06,0xF7,0xA9,0xF9,0x55,0x13,0xBB,0xB3,0xBF,0xAD,0xB0,0xA0
+,0x6C,0x61,0x77,0x35,0xB7,0xDB,0x4D,0xDC,0x46,0xFF,0x56,0x6A,0xE7,0xE6,0xC8
+,0xFF,0x00,0x72,0x02,0x5A,0x44};
+/* end binary data. size = 1446 bytes */
 
 #endif // __MYSQL_CREATE_SQL_H__
 
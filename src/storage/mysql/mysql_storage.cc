@@ -40,8 +40,12 @@
 #include "config/config_manager.h"
 
 #include "mysql_create_sql.h"
+#include "util/trace.h"
 #include <zlib.h>
 
+// schema version this build creates and upgrades to
+#define MYSQL_DB_VERSION "12"
+
 // updates 1->2
 #define MYSQL_UPDATE_1_2_1 "ALTER TABLE `mt_cds_object` CHANGE `location` `location` BLOB NULL DEFAULT NULL"
 #define MYSQL_UPDATE_1_2_2 "ALTER TABLE `mt_cds_object` CHANGE `metadata` `metadata` BLOB NULL DEFAULT NULL"
@@ -71,6 +75,84 @@
   CONSTRAINT `mt_metadata_idfk1` FOREIGN KEY (`item_id`) REFERENCES `mt_cds_object` (`id`) ON DELETE CASCADE ON UPDATE CASCADE \
 ) ENGINE=MyISAM CHARSET=utf8"
 #define MYSQL_UPDATE_4_5_2 "UPDATE `mt_internal_setting` SET `value`='5' WHERE `key`='db_version' AND `value`='4'"
+
+#define MYSQL_UPDATE_5_6_1 "CREATE TABLE `mt_service_state` ( \
+  `object_id` int(11) NOT NULL, \
+  `service_prefix` char(1) NOT NULL, \
+  `service_id` varchar(255) NOT NULL, \
+  `content_hash` varchar(16) NOT NULL default '', \
+  `last_seen` bigint(20) unsigned NOT NULL default '0', \
+  PRIMARY KEY `object_id` (`object_id`), \
+  KEY `service_state_seen` (`service_prefix`,`last_seen`), \
+  CONSTRAINT `mt_service_state_ibfk_1` FOREIGN KEY (`object_id`) REFERENCES `mt_cds_object` (`id`) ON DELETE CASCADE ON UPDATE CASCADE \
+) ENGINE=MyISAM CHARSET=utf8"
+// Apple Trailers service ids used to start with the prefix as a number
+#define MYSQL_UPDATE_5_6_2 "UPDATE `mt_cds_object` SET `service_id` = CONCAT('T', SUBSTRING(`service_id`, 3)) WHERE `service_id` LIKE '84%'"
+#define MYSQL_UPDATE_5_6_3 "INSERT INTO `mt_service_state` (`object_id`, `service_prefix`, `service_id`, `content_hash`, `last_seen`) \
+  SELECT `id`, LEFT(`service_id`, 1), `service_id`, '', UNIX_TIMESTAMP() FROM `mt_cds_object` WHERE `service_id` IS NOT NULL"
+#define MYSQL_UPDATE_5_6_4 "UPDATE `mt_internal_setting` SET `value`='6' WHERE `key`='db_version' AND `value`='5'"
+#define MYSQL_UPDATE_6_7_1 "CREATE TABLE `mt_sequence` ( \
+  `name` varchar(40) NOT NULL, \
+  `next_id` int(11) NOT NULL, \
+  PRIMARY KEY  (`name`) \
+) ENGINE=MyISAM CHARSET=utf8"
+#define MYSQL_UPDATE_6_7_2 "INSERT INTO `mt_sequence` (`name`, `next_id`) SELECT 'object', MAX(`id`) + 1 FROM `mt_cds_object`"
+#define MYSQL_UPDATE_6_7_3 "INSERT INTO `mt_sequence` (`name`, `next_id`) SELECT 'metadata', IFNULL(MAX(`id`), 0) + 1 FROM `mt_metadata`"
+#define MYSQL_UPDATE_6_7_4 "UPDATE `mt_internal_setting` SET `value`='7' WHERE `key`='db_version' AND `value`='6'"
+#define MYSQL_UPDATE_7_8_1 "CREATE TABLE `mt_change_log` ( \
+  `id` int(11) NOT NULL auto_increment, \
+  `container_id` int(11) NOT NULL, \
+  `update_id` int(11) NOT NULL, \
+  `changed` bigint(20) unsigned NOT NULL, \
+  PRIMARY KEY  (`id`), \
+  KEY `change_log_changed` (`changed`) \
+) ENGINE=MyISAM CHARSET=utf8"
+#define MYSQL_UPDATE_7_8_2 "UPDATE `mt_internal_setting` SET `value`='8' WHERE `key`='db_version' AND `value`='7'"
+#define MYSQL_UPDATE_8_9_1 "RENAME TABLE `mt_metadata` TO `mt_metadata_legacy`"
+#define MYSQL_UPDATE_8_9_2 "CREATE TABLE `mt_metadata_property` ( \
+  `id` int(11) NOT NULL auto_increment, \
+  `name` varchar(255) NOT NULL, \
+  PRIMARY KEY `id` (`id`), \
+  UNIQUE KEY `metadata_property_name` (`name`) \
+) ENGINE=MyISAM CHARSET=utf8 COLLATE=utf8_bin"
+#define MYSQL_UPDATE_8_9_3 "CREATE TABLE `mt_metadata_value` ( \
+  `id` int(11) NOT NULL auto_increment, \
+  `value_hash` int(11) unsigned NOT NULL, \
+  `value` text NOT NULL, \
+  PRIMARY KEY `id` (`id`), \
+  UNIQUE KEY `metadata_value_hash` (`value_hash`,`value`(255)) \
+) ENGINE=MyISAM CHARSET=utf8 COLLATE=utf8_bin"
+#define MYSQL_UPDATE_8_9_4 "CREATE TABLE `mt_metadata` ( \
+  `id` int(11) NOT NULL auto_increment, \
+  `item_id` int(11) NOT NULL, \
+  `property_id` int(11) NOT NULL, \
+  `value_id` int(11) NOT NULL, \
+  PRIMARY KEY `id` (`id`), \
+  KEY `metadata_item_id` (`item_id`), \
+  KEY `metadata_value_id` (`value_id`,`property_id`), \
+  CONSTRAINT `mt_metadata_idfk1` FOREIGN KEY (`item_id`) REFERENCES `mt_cds_object` (`id`) ON DELETE CASCADE ON UPDATE CASCADE \
+) ENGINE=MyISAM CHARSET=utf8"
+#define MYSQL_UPDATE_8_9_5 "CREATE VIEW `mt_metadata_view` AS SELECT `m`.`id`, `m`.`item_id`, `p`.`name` AS `property_name`, `v`.`value` AS `property_value`, `v`.`value_hash` \
+  FROM `mt_metadata` `m` JOIN `mt_metadata_property` `p` ON `p`.`id` = `m`.`property_id` JOIN `mt_metadata_value` `v` ON `v`.`id` = `m`.`value_id`"
+#define MYSQL_UPDATE_8_9_6 "UPDATE `mt_internal_setting` SET `value`='9' WHERE `key`='db_version' AND `value`='8'"
+#define MYSQL_UPDATE_9_10_1 "ALTER TABLE `mt_cds_object` \
+  ADD `upnp_artist` varchar(255) default NULL, \
+  ADD `upnp_album` varchar(255) default NULL, \
+  ADD `upnp_genre` varchar(255) default NULL, \
+  ADD `dc_date` varchar(255) default NULL, \
+  ADD KEY `cds_object_upnp_artist` (`upnp_artist`), \
+  ADD KEY `cds_object_upnp_album` (`upnp_album`), \
+  ADD KEY `cds_object_upnp_genre` (`upnp_genre`), \
+  ADD KEY `cds_object_dc_date` (`dc_date`)"
+#define MYSQL_UPDATE_9_10_2 "UPDATE `mt_internal_setting` SET `value`='10' WHERE `key`='db_version' AND `value`='9'"
+#define MYSQL_UPDATE_10_11_1 "ALTER TABLE `mt_cds_object` \
+  ADD `path_key` varchar(767) CHARACTER SET ascii COLLATE ascii_bin default NULL, \
+  ADD KEY `cds_object_path_key` (`path_key`)"
+#define MYSQL_UPDATE_10_11_2 "UPDATE `mt_internal_setting` SET `value`='11' WHERE `key`='db_version' AND `value`='10'"
+// MyISAM ignores transactions, it never stored the foreign keys either
+#define MYSQL_UPDATE_11_12_TABLES { "mt_cds_object", "mt_cds_active_item", "mt_internal_setting", "mt_autoscan", \
+    "mt_metadata_property", "mt_metadata_value", "mt_metadata", "mt_service_state", "mt_sequence", "mt_change_log" }
+#define MYSQL_UPDATE_11_12_2 "UPDATE `mt_internal_setting` SET `value`='12' WHERE `key`='db_version' AND `value`='11'"
   
 
 using namespace zmm;
@@ -84,6 +166,7 @@ MysqlStorage::MysqlStorage(std::shared_ptr<ConfigManager> config)
     mysql_connection = false;
     table_quote_begin = '`';
     table_quote_end = '`';
+    profiler->setBackslashEscapes(true);
 }
 MysqlStorage::~MysqlStorage()
 {
@@ -192,6 +275,10 @@ void MysqlStorage::init()
     } catch (Exception) {
     }
 
+    // readers never write, the writer node creates and upgrades the database
+    if (isReader() && dbVersion != MYSQL_DB_VERSION)
+        throw _Exception("The database has to be created or upgraded by the writer node first (database version " + dbVersion + ")");
+
     if (dbVersion.empty()) {
         log_info("database doesn't seem to exist. automatically creating database...\n");
         unsigned char buf[MS_CREATE_SQL_INFLATED_SIZE + 1]; // + 1 for '\0' at the end of the string
@@ -267,9 +354,74 @@ void MysqlStorage::init()
         dbVersion = "5";
     }
 
+    if (dbVersion == "5") {
+        log_info("Doing an automatic database upgrade from database version 5 to version 6...\n");
+        _exec(MYSQL_UPDATE_5_6_1);
+        _exec(MYSQL_UPDATE_5_6_2);
+        _exec(MYSQL_UPDATE_5_6_3);
+        _exec(MYSQL_UPDATE_5_6_4);
+        log_info("database upgrade successful.\n");
+        dbVersion = "6";
+    }
+
+    if (dbVersion == "6") {
+        log_info("Doing an automatic database upgrade from database version 6 to version 7...\n");
+        _exec(MYSQL_UPDATE_6_7_1);
+        _exec(MYSQL_UPDATE_6_7_2);
+        _exec(MYSQL_UPDATE_6_7_3);
+        _exec(MYSQL_UPDATE_6_7_4);
+        log_info("database upgrade successful.\n");
+        dbVersion = "7";
+    }
+
+    if (dbVersion == "7") {
+        log_info("Doing an automatic database upgrade from database version 7 to version 8...\n");
+        _exec(MYSQL_UPDATE_7_8_1);
+        _exec(MYSQL_UPDATE_7_8_2);
+        log_info("database upgrade successful.\n");
+        dbVersion = "8";
+    }
+
+    if (dbVersion == "8") {
+        log_info("Doing an automatic database upgrade from database version 8 to version 9...\n");
+        _exec(MYSQL_UPDATE_8_9_1);
+        _exec(MYSQL_UPDATE_8_9_2);
+        _exec(MYSQL_UPDATE_8_9_3);
+        _exec(MYSQL_UPDATE_8_9_4);
+        _exec(MYSQL_UPDATE_8_9_5);
+        _exec(MYSQL_UPDATE_8_9_6);
+        log_info("database upgrade successful.\n");
+        dbVersion = "9";
+    }
+
+    if (dbVersion == "9") {
+        log_info("Doing an automatic database upgrade from database version 9 to version 10...\n");
+        _exec(MYSQL_UPDATE_9_10_1);
+        _exec(MYSQL_UPDATE_9_10_2);
+        log_info("database upgrade successful.\n");
+        dbVersion = "10";
+    }
+
+    if (dbVersion == "10") {
+        log_info("Doing an automatic database upgrade from database version 10 to version 11...\n");
+        _exec(MYSQL_UPDATE_10_11_1);
+        _exec(MYSQL_UPDATE_10_11_2);
+        log_info("database upgrade successful.\n");
+        dbVersion = "11";
+    }
+
+    if (dbVersion == "11") {
+        log_info("Doing an automatic database upgrade from database version 11 to version 12, converting the tables to InnoDB...\n");
+        for (const char* table : MYSQL_UPDATE_11_12_TABLES)
+            _exec(("ALTER TABLE `" + std::string(table) + "` ENGINE=InnoDB").c_str());
+        _exec(MYSQL_UPDATE_11_12_2);
+        log_info("database upgrade successful.\n");
+        dbVersion = "12";
+    }
+
     /* --- --- ---*/
 
-    if (!string_ok(dbVersion) || dbVersion != "5")
+    if (!string_ok(dbVersion) || dbVersion != MYSQL_DB_VERSION)
         throw _Exception("The database seems to be from a newer version (database version " + dbVersion + ")!");
 
     lock.unlock();
@@ -309,12 +461,13 @@ std::string MysqlStorage::getError(MYSQL* db)
     return err_buf.str();
 }
 
-Ref<SQLResult> MysqlStorage::select(const char* query, int length)
+Ref<SQLResult> MysqlStorage::doSelect(const char* query, int length)
 {
 #ifdef MYSQL_SELECT_DEBUG
     log_debug("%s\n", query);
     print_backtrace();
 #endif
+    TRACE_SPAN("sql", "select", query);
 
     int res;
 
@@ -332,15 +485,18 @@ Ref<SQLResult> MysqlStorage::select(const char* query, int length)
         std::string myError = getError(&db);
         throw _StorageException(myError, "Mysql: mysql_store_result() failed: " + myError + "; query: " + query);
     }
+    if (profiler->isEnabled())
+        profiler->addRows(SQLProfiler::normalize(query, true), mysql_num_rows(mysql_res));
     return Ref<SQLResult>(new MysqlResult(mysql_res));
 }
 
-int MysqlStorage::exec(const char* query, int length, bool getLastInsertId)
+int MysqlStorage::doExec(const char* query, int length, bool getLastInsertId)
 {
 #ifdef MYSQL_EXEC_DEBUG
     log_debug("%s\n", query);
     print_backtrace();
 #endif
+    TRACE_SPAN("sql", "exec", query);
 
     int res;
 
@@ -361,6 +517,37 @@ void MysqlStorage::shutdownDriver()
 {
 }
 
+int MysqlStorage::reserveIDs(const char* sequence, int count)
+{
+    // LAST_INSERT_ID(expr) returns the new value to this connection, which
+    // makes the reservation a single statement
+    std::ostringstream q;
+    q << "UPDATE " << QTB << SEQUENCE_TABLE << QTE
+      << " SET `next_id` = LAST_INSERT_ID(`next_id` + " << count << ")"
+      << " WHERE `name` = " << quote(sequence);
+    int next = SQLStorage::exec(q, true);
+    if (next <= 0)
+        throw _Exception(std::string("could not reserve IDs, sequence missing: ") + sequence);
+    return next - count;
+}
+
+std::string MysqlStorage::concatSQL(const std::vector<std::string>& parts)
+{
+    return "CONCAT(" + join(parts, ",") + ')';
+}
+
+// OPTIMIZE TABLE rebuilds whole tables, so free space is not reclaimed
+// here, ANALYZE TABLE only samples a few pages of InnoDB tables
+void MysqlStorage::analyzeTable(const std::string& table)
+{
+    std::ostringstream q;
+    q << "ANALYZE TABLE " << QTB << table << QTE;
+    // the statement returns a status row that has to be read
+    Ref<SQLResult> res = select(q);
+    while (res->nextRow() != nullptr) {
+    }
+}
+
 void MysqlStorage::storeInternalSetting(std::string key, std::string value)
 {
     std::string quotedValue = quote(value);
@@ -60,9 +60,14 @@ private:
     virtual inline std::string quote(bool val) { return std::to_string(val ? '1' : '0'); }
     virtual inline std::string quote(char val) { return quote(std::to_string(val)); }
     virtual inline std::string quote(long long val) { return std::to_string(val); }
-    virtual zmm::Ref<SQLResult> select(const char* query, int length);
-    virtual int exec(const char* query, int length, bool getLastInsertId = false);
+    virtual zmm::Ref<SQLResult> doSelect(const char* query, int length) override;
+    virtual int doExec(const char* query, int length, bool getLastInsertId) override;
     virtual void storeInternalSetting(std::string key, std::string value);
+    virtual int reserveIDs(const char* sequence, int count) override;
+    virtual const char* beginTransactionSQL() override { return "START TRANSACTION"; }
+    virtual const char* insertIgnoreSQL() override { return "INSERT IGNORE"; }
+    virtual std::string concatSQL(const std::vector<std::string>& parts) override;
+    virtual void analyzeTable(const std::string& table) override;
 
     void _exec(const char* query, int lenth = -1);
 
@@ -90,7 +95,6 @@ private:
     MysqlResult(MYSQL_RES* mysql_res);
     virtual ~MysqlResult();
     virtual std::unique_ptr<SQLRow> nextRow();
-    virtual unsigned long long getNumRows() { return mysql_num_rows(mysql_res); }
     MYSQL_RES* mysql_res;
 
     friend class MysqlRow;
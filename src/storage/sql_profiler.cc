@@ -0,0 +1,201 @@
+/*GRB*
+
+Gerbera - https://gerbera.io/
+
+    sql_profiler.cc - this file is part of Gerbera.
+
+    Copyright (C) 2016-2019 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file sql_profiler.cc
+
+#include "sql_profiler.h"
+
+#include <algorithm>
+#include <cctype>
+
+#include "util/logger.h"
+
+static thread_local long long lastQueueWait = 0;
+
+SQLProfiler::SQLProfiler(bool enabled, int slowThreshold)
+    : enabled(enabled)
+    , slowThreshold(slowThreshold * 1000LL)
+    , backslashEscapes(false)
+{
+}
+
+static inline bool isIdentifierChar(char c)
+{
+    return isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+// appends a placeholder, a list of placeholders is collapsed into "?..."
+static void appendPlaceholder(std::string& out)
+{
+    size_t pos = out.find_last_not_of(' ');
+    if (pos != std::string::npos && out[pos] == ',') {
+        size_t prev = out.find_last_not_of(' ', pos - 1);
+        if (prev != std::string::npos && out[prev] == '?') {
+            out.resize(prev + 1);
+            out += "...";
+            return;
+        }
+        if (prev != std::string::npos && prev >= 3 && out.compare(prev - 3, 4, "?...") == 0) {
+            out.resize(prev + 1);
+            return;
+        }
+    }
+    out += '?';
+}
+
+std::string SQLProfiler::normalize(const char* query, bool backslashEscapes)
+{
+    std::string out;
+    bool space = false;
+
+    for (const char* c = query; *c; c++) {
+        if (isspace(static_cast<unsigned char>(*c))) {
+            space = true;
+            continue;
+        }
+        if (space && !out.empty())
+            out += ' ';
+        space = false;
+
+        if (*c == '\'') {
+            // string literal, quotes are either doubled or backslash escaped
+            c++;
+            while (*c) {
+                if (backslashEscapes && *c == '\\' && c[1]) {
+                    c += 2;
+                    continue;
+                }
+                if (*c == '\'') {
+                    if (c[1] == '\'') {
+                        c += 2;
+                        continue;
+                    }
+                    break;
+                }
+                c++;
+            }
+            appendPlaceholder(out);
+            if (!*c)
+                break;
+            continue;
+        }
+
+        if (*c == '"' || *c == '`') {
+            // quoted identifier, keep it
+            char quote = *c;
+            out += *c;
+            while (c[1] && c[1] != quote)
+                out += *++c;
+            if (c[1])
+                out += *++c;
+            continue;
+        }
+
+        if (isdigit(static_cast<unsigned char>(*c)) && (out.empty() || !isIdentifierChar(out.back()))) {
+            while (isIdentifierChar(c[1]) || c[1] == '.')
+                c++;
+            appendPlaceholder(out);
+            continue;
+        }
+
+        out += *c;
+    }
+    return out;
+}
+
+bool SQLProfiler::record(const char* query, long long duration, long long queueWait)
+{
+    std::string shape = normalize(query, backslashEscapes);
+
+    AutoLock lock(mutex);
+    auto& stats = statements[shape];
+    if (stats.shape.empty())
+        stats.shape = shape;
+    stats.count++;
+    stats.totalTime += duration;
+    stats.maxTime = std::max(stats.maxTime, duration);
+    stats.queueWait += queueWait;
+
+    return slowThreshold > 0 && duration >= slowThreshold;
+}
+
+void SQLProfiler::addRows(const std::string& shape, unsigned long long rows)
+{
+    AutoLock lock(mutex);
+    auto& stats = statements[shape];
+    if (stats.shape.empty())
+        stats.shape = shape;
+    stats.rows += rows;
+}
+
+void SQLProfiler::addSlowQuery(const char* query, long long duration, std::string plan)
+{
+    log_warning("Slow query (%lld ms): %s\n", duration / 1000, query);
+    if (!plan.empty())
+        log_warning("Query plan:\n%s\n", plan.c_str());
+
+    AutoLock lock(mutex);
+    slowQueries.push_front({ time(nullptr), duration, query, plan });
+    if (slowQueries.size() > SQL_PROFILER_SLOW_LOG_SIZE)
+        slowQueries.pop_back();
+}
+
+std::vector<SQLProfiler::StatementStats> SQLProfiler::getStatements()
+{
+    std::vector<StatementStats> result;
+    {
+        AutoLock lock(mutex);
+        result.reserve(statements.size());
+        for (const auto& entry : statements)
+            result.push_back(entry.second);
+    }
+    std::sort(result.begin(), result.end(), [](const StatementStats& a, const StatementStats& b) {
+        return a.totalTime > b.totalTime;
+    });
+    return result;
+}
+
+std::vector<SQLProfiler::SlowQuery> SQLProfiler::getSlowQueries()
+{
+    AutoLock lock(mutex);
+    return std::vector<SlowQuery>(slowQueries.begin(), slowQueries.end());
+}
+
+void SQLProfiler::reset()
+{
+    AutoLock lock(mutex);
+    statements.clear();
+    slowQueries.clear();
+}
+
+void SQLProfiler::setQueueWait(long long wait)
+{
+    lastQueueWait = wait;
+}
+
+long long SQLProfiler::takeQueueWait()
+{
+    long long wait = lastQueueWait;
+    lastQueueWait = 0;
+    return wait;
+}
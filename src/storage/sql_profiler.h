@@ -0,0 +1,110 @@
+/*GRB*
+
+Gerbera - https://gerbera.io/
+
+    sql_profiler.h - this file is part of Gerbera.
+
+    Copyright (C) 2016-2019 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file sql_profiler.h
+/// \brief Per statement statistics and slow query log for SQLStorage.
+#ifndef __SQL_PROFILER_H__
+#define __SQL_PROFILER_H__
+
+#include <atomic>
+#include <ctime>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// \brief number of slow queries kept for the web UI
+#define SQL_PROFILER_SLOW_LOG_SIZE 50
+
+class SQLProfiler {
+public:
+    /// \brief Accumulated statistics of one statement shape.
+    struct StatementStats {
+        std::string shape;
+        unsigned long count = 0;
+        /// \brief execution time in microseconds, including queue wait
+        long long totalTime = 0;
+        long long maxTime = 0;
+        /// \brief time spent waiting for the database thread in microseconds
+        long long queueWait = 0;
+        unsigned long long rows = 0;
+    };
+
+    struct SlowQuery {
+        time_t timestamp;
+        long long duration;
+        std::string query;
+        std::string plan;
+    };
+
+    /// \param slowThreshold statements running at least this many
+    /// milliseconds are logged, 0 disables the slow query log
+    SQLProfiler(bool enabled, int slowThreshold);
+
+    /// \brief The driver escapes quotes inside literals with a backslash
+    /// instead of doubling them (MySQL).
+    void setBackslashEscapes(bool backslashEscapes) { this->backslashEscapes = backslashEscapes; }
+
+    bool isEnabled() const { return enabled; }
+    void setEnabled(bool enable) { enabled = enable; }
+
+    /// \brief Replaces literals by '?' and collapses whitespace and value
+    /// lists, so that all executions of one hand built query share one key.
+    static std::string normalize(const char* query, bool backslashEscapes = false);
+
+    /// \brief Accounts one execution.
+    /// \param duration microseconds from submitting the statement until the result was available
+    /// \param queueWait part of duration spent in the queue of the database thread
+    /// \return true if the statement exceeded the slow query threshold
+    bool record(const char* query, long long duration, long long queueWait);
+
+    /// \brief Accounts the rows returned by a select, reported by the driver
+    /// once they are known, which may be after the result was handed out.
+    void addRows(const std::string& shape, unsigned long long rows);
+
+    /// \brief Adds a statement to the slow query log.
+    void addSlowQuery(const char* query, long long duration, std::string plan);
+
+    /// \brief Returns statistics sorted by cumulative time, most expensive first.
+    std::vector<StatementStats> getStatements();
+    std::vector<SlowQuery> getSlowQueries();
+    void reset();
+
+    /// \brief Hands the queue wait of the statement that was just executed
+    /// by the calling thread from the driver to SQLStorage.
+    static void setQueueWait(long long wait);
+    static long long takeQueueWait();
+
+protected:
+    std::atomic_bool enabled;
+    long long slowThreshold;
+    bool backslashEscapes;
+
+    std::mutex mutex;
+    using AutoLock = std::lock_guard<std::mutex>;
+    std::unordered_map<std::string, StatementStats> statements;
+    std::deque<SlowQuery> slowQueries;
+};
+
+#endif // __SQL_PROFILER_H__
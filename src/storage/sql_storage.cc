@@ -36,10 +36,14 @@
 #include "util/tools.h"
 #include "update_manager.h"
 #include "search_handler.h"
+#include <chrono>
 #include <climits>
+#include <cstring>
+#include <deque>
 #include <algorithm>
 #include <sstream>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 using namespace zmm;
@@ -50,6 +54,51 @@ using namespace std;
 
 #define SQL_NULL "NULL"
 
+/// \brief number of objects handled by one service state statement
+#define SERVICE_STATE_BATCH_SIZE 500
+
+// change log of the writer node: rows are kept for an hour, readers
+// fetch at most CHANGE_LOG_BATCH_SIZE rows per poll
+#define CHANGE_LOG_RETENTION 3600
+#define CHANGE_LOG_PRUNE_INTERVAL 300
+#define CHANGE_LOG_BATCH_SIZE 1000
+// internal setting holding the newest change id the writer pruned
+#define CHANGE_LOG_PRUNED_SETTING "change_log_pruned"
+
+// children held by the browse index in total, each with its title
+#define BROWSE_INDEX_MAX_ENTRIES 250000
+
+// retained browse snapshots and the child IDs they hold in total
+#define BROWSE_SNAPSHOT_MAX_COUNT 64
+#define BROWSE_SNAPSHOT_MAX_ENTRIES 1000000
+
+// number of IDs a writer reserves from a sequence at once
+#define ID_BLOCK_SIZE 100
+
+// bump to run the metadata migration check again on existing databases
+#define METADATA_MIGRATION_VERSION 1
+#define METADATA_DICTIONARY_MIGRATION_VERSION 1
+#define METADATA_COLUMNS_MIGRATION_VERSION 1
+
+// length of the path_key column, deeper objects have no key
+#define PATH_KEY_MAX_LENGTH 767
+// container path keys kept in memory
+#define PATH_KEY_CACHE_SIZE 100000
+#define PATH_KEYS_MIGRATION_VERSION 1
+
+// metadata values whose dictionary ID is kept in memory
+#define METADATA_VALUE_CACHE_SIZE 50000
+// containers whose child state is kept in memory, others are looked up
+#define CHILD_STATE_CACHE_SIZE 100000
+// legacy metadata rows moved per statement by the dictionary migration
+#define METADATA_DICTIONARY_BATCH_SIZE 5000
+
+// characters held by the metadata columns of mt_cds_object
+#define METADATA_COLUMN_LENGTH 255
+
+// value IDs checked for references by one maintenance step
+#define METADATA_PRUNE_RANGE 10000
+
 #define RESOURCE_SEP '|'
 
 enum {
@@ -138,9 +187,11 @@ enum SearchCol
     location
 };
 
+// the metadata columns are only selected to be sortable with distinct
 #define SELECT_DATA_FOR_SEARCH "SELECT distinct c.id, c.ref_id, c.parent_id," \
     << " c.object_type, c.upnp_class, c.dc_title, c.metadata,"       \
-    << " c.resources, c.mime_type, c.track_number, c.location"
+    << " c.resources, c.mime_type, c.track_number, c.location,"      \
+    << " c.upnp_artist, c.upnp_album, c.upnp_genre, c.dc_date"
 
 enum MetadataCol
 {
@@ -163,8 +214,20 @@ SQLStorage::SQLStorage(std::shared_ptr<ConfigManager> config)
 {
     table_quote_begin = '\0';
     table_quote_end = '\0';
-    lastID = INVALID_OBJECT_ID;
-    lastMetadataID = INVALID_OBJECT_ID;
+    objectIDs = { INVALID_OBJECT_ID, INVALID_OBJECT_ID };
+    metadataIDs = { INVALID_OBJECT_ID, INVALID_OBJECT_ID };
+    changeLogPruned = 0;
+    maintenancePhase = MaintenancePhase::PruneValues;
+    statisticsStep = 0;
+    pruneNext = 0;
+    pruneEnd = -1;
+    pathKeyGeneration = 0;
+    transactionDepth = 0;
+    transactionFailed = false;
+    browseSnapshotWindow = config->getIntOption(CFG_SERVER_STORAGE_BROWSE_SNAPSHOT_WINDOW);
+    browseSnapshotEntries = 0;
+    profiler = std::make_shared<SQLProfiler>(config->getBoolOption(CFG_SERVER_STORAGE_PROFILING),
+        config->getIntOption(CFG_SERVER_STORAGE_SLOW_QUERY_THRESHOLD));
 }
 
 void SQLStorage::init()
@@ -177,12 +240,79 @@ void SQLStorage::init()
     this->sql_query = buf.str();
 
     sqlEmitter = std::make_shared<DefaultSQLEmitter>();
+
+    if (config->getBoolOption(CFG_SERVER_STORAGE_BROWSE_INDEX))
+        browseIndex = std::make_unique<CdsTreeIndex>(BROWSE_INDEX_MAX_ENTRIES, orderedByBytes());
+}
+
+Ref<SQLResult> SQLStorage::select(const char* query, int length)
+{
+    TransactionLock transaction(transactionMutex);
+    if (!profiler->isEnabled())
+        return doSelect(query, length);
+
+    auto start = std::chrono::steady_clock::now();
+    auto res = doSelect(query, length);
+    long long duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    if (profiler->record(query, duration, SQLProfiler::takeQueueWait()))
+        profiler->addSlowQuery(query, duration, explainQuery(query));
+    return res;
+}
+
+/// \brief Result whose rows were read from the driver up front.
+class SQLLoadedResult : public SQLResult {
+public:
+    explicit SQLLoadedResult(Ref<SQLResult> res)
+    {
+        std::unique_ptr<SQLRow> row;
+        while ((row = res->nextRow()) != nullptr)
+            rows.push_back(std::move(row));
+    }
+
+    std::unique_ptr<SQLRow> nextRow() override
+    {
+        if (rows.empty())
+            return nullptr;
+        auto row = std::move(rows.front());
+        rows.pop_front();
+        return row;
+    }
+
+private:
+    std::deque<std::unique_ptr<SQLRow>> rows;
+};
+
+Ref<SQLResult> SQLStorage::selectAll(const std::ostringstream& buf)
+{
+    Ref<SQLResult> res = select(buf);
+    if (res == nullptr)
+        return nullptr;
+    return Ref<SQLResult>(new SQLLoadedResult(res));
+}
+
+int SQLStorage::exec(const char* query, int length, bool getLastInsertId)
+{
+    if (isReader())
+        throw _Exception("Tried to write to the database on a reader node");
+
+    TransactionLock transaction(transactionMutex);
+    if (!profiler->isEnabled())
+        return doExec(query, length, getLastInsertId);
+
+    auto start = std::chrono::steady_clock::now();
+    int res = doExec(query, length, getLastInsertId);
+    long long duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    if (profiler->record(query, duration, SQLProfiler::takeQueueWait()))
+        profiler->addSlowQuery(query, duration, "");
+    return res;
 }
 
 void SQLStorage::dbReady()
 {
-    loadLastID();
-    loadLastMetadataID();
+    // the database may have been replaced, e.g. restored from a backup
+    AutoLock lock(nextIDMutex);
+    objectIDs = { INVALID_OBJECT_ID, INVALID_OBJECT_ID };
+    metadataIDs = { INVALID_OBJECT_ID, INVALID_OBJECT_ID };
 }
 
 void SQLStorage::shutdown()
@@ -190,6 +320,104 @@ void SQLStorage::shutdown()
     shutdownDriver();
 }
 
+void SQLStorage::beginTransaction()
+{
+    // released by the matching commit or rollback
+    transactionMutex.lock();
+    if (transactionDepth > 0 || isReader()) {
+        transactionDepth++;
+        return;
+    }
+    try {
+        exec(beginTransactionSQL(), strlen(beginTransactionSQL()));
+    } catch (const Exception&) {
+        transactionMutex.unlock();
+        throw;
+    }
+    transactionDepth = 1;
+    transactionFailed = false;
+}
+
+void SQLStorage::commitTransaction()
+{
+    endTransaction(true);
+}
+
+void SQLStorage::rollbackTransaction()
+{
+    endTransaction(false);
+}
+
+void SQLStorage::endTransaction(bool commit)
+{
+    // only the owning thread gets the lock while a transaction is open
+    TransactionLock lock(transactionMutex);
+    if (transactionDepth <= 0) {
+        log_warning("%s without beginTransaction()\n", commit ? "commitTransaction()" : "rollbackTransaction()");
+        return;
+    }
+    transactionMutex.unlock(); // taken by beginTransaction()
+    if (!commit)
+        transactionFailed = true;
+    if (--transactionDepth > 0 || isReader())
+        return;
+
+    if (commit && transactionFailed)
+        log_warning("Part of the transaction failed, rolling it back\n");
+    try {
+        if (transactionFailed) {
+            exec("ROLLBACK", 8);
+        } else {
+            exec("COMMIT", 6);
+        }
+    } catch (const Exception&) {
+        if (!transactionFailed) {
+            try {
+                exec("ROLLBACK", 8);
+            } catch (const Exception& e) {
+                log_error("Could not roll back transaction: %s\n", e.getMessage().c_str());
+            }
+        }
+        clearCaches();
+        transactionEnded();
+        throw;
+    }
+    if (transactionFailed)
+        clearCaches();
+    transactionEnded();
+}
+
+void SQLStorage::clearCaches()
+{
+    {
+        AutoLock lock(nextIDMutex);
+        objectIDs = { INVALID_OBJECT_ID, INVALID_OBJECT_ID };
+        metadataIDs = { INVALID_OBJECT_ID, INVALID_OBJECT_ID };
+    }
+    {
+        AutoLock lock(metadataDictionaryMutex);
+        metadataPropertyIDs.clear();
+        metadataValueIDs.clear();
+    }
+    {
+        AutoLock lock(childStateMutex);
+        nonEmptyContainers.clear();
+        emptyContainers.clear();
+    }
+    {
+        AutoLock lock(pathKeyMutex);
+        pathKeys.clear();
+        pathKeyGeneration++;
+    }
+    {
+        AutoLock lock(browseSnapshotMutex);
+        browseSnapshots.clear();
+        browseSnapshotEntries = 0;
+    }
+    if (browseIndex != nullptr)
+        browseIndex->clear();
+}
+
 std::shared_ptr<CdsObject> SQLStorage::checkRefID(std::shared_ptr<CdsObject> obj)
 {
     if (!obj->isVirtual())
@@ -270,6 +498,12 @@ Ref<Array<SQLStorage::AddUpdateTable>> SQLStorage::_addUpdateObject(std::shared_
 
 
     auto dict = obj->getMetadata();
+
+    // like the metadata rows, references only keep metadata of their own
+    if (!hasReference || dict != refObj->getMetadata())
+        setMetadataColumns(cdsObjectSql, dict, isUpdate);
+    else if (isUpdate)
+        setMetadataColumns(cdsObjectSql, {}, isUpdate);
     
     if (isUpdate)
         cdsObjectSql["auxdata"] = SQL_NULL;
@@ -374,6 +608,11 @@ Ref<Array<SQLStorage::AddUpdateTable>> SQLStorage::_addUpdateObject(std::shared_
     if (obj->getParentID() == INVALID_OBJECT_ID)
         throw _Exception("tried to create or update an object with an illegal parent id");
     cdsObjectSql["parent_id"] = std::to_string(obj->getParentID());
+    // new objects get their key once the ID is known
+    if (isUpdate) {
+        std::string pathKey = childPathKey(getPathKey(obj->getParentID()), obj->getID());
+        cdsObjectSql["path_key"] = string_ok(pathKey) ? quote(pathKey) : SQL_NULL;
+    }
 
     int returnValSize = 2;
     returnValSize += obj->getMetadata().size();
@@ -400,14 +639,23 @@ Ref<Array<SQLStorage::AddUpdateTable>> SQLStorage::_addUpdateObject(std::shared_
     return returnVal;
 }
 
-void SQLStorage::addObject(std::shared_ptr<CdsObject> obj, int* changedContainer)
+void SQLStorage::addObject(std::shared_ptr<CdsObject> obj, int* changedContainer, int* changedGrandparent)
 {
+    if (changedGrandparent != nullptr)
+        *changedGrandparent = INVALID_OBJECT_ID;
     if (obj->getID() != INVALID_OBJECT_ID)
         throw _Exception("tried to add an object with an object ID set");
     //obj->setID(INVALID_OBJECT_ID);
+    // value IDs are not pruned before the rows referring to them are written
+    TransactionLock transaction(transactionMutex);
     Ref<Array<AddUpdateTable>> data = _addUpdateObject(obj, false, changedContainer);
     if (data == nullptr)
         return;
+
+    // must be known before the insert, afterwards the parent has a child
+    int grandparentID = claimEmptyContainer(obj->getParentID());
+    if (changedGrandparent != nullptr)
+        *changedGrandparent = grandparentID;
     // int lastInsertID = INVALID_OBJECT_ID;
     // int lastMetadataInsertID = INVALID_OBJECT_ID;
     for (int i = 0; i < data->size(); i++) {
@@ -416,10 +664,56 @@ void SQLStorage::addObject(std::shared_ptr<CdsObject> obj, int* changedContainer
         log_debug("insert_query: %s\n", qb->str().c_str());
         exec(*qb);
     }
+    if (browseIndex != nullptr) {
+        int trackNumber = -1;
+        if (IS_CDS_ITEM(obj->getObjectType()) && std::static_pointer_cast<CdsItem>(obj)->getTrackNumber() > 0)
+            trackNumber = std::static_pointer_cast<CdsItem>(obj)->getTrackNumber();
+        browseIndex->objectAdded(obj->getParentID(), { obj->getID(), obj->getObjectType(), trackNumber, 0, obj->getTitle() });
+    }
+}
+
+int SQLStorage::claimEmptyContainer(int containerID)
+{
+    {
+        AutoLock lock(childStateMutex);
+        if (nonEmptyContainers.find(containerID) != nonEmptyContainers.end())
+            return INVALID_OBJECT_ID;
+
+        auto it = emptyContainers.find(containerID);
+        if (it != emptyContainers.end()) {
+            int parentID = it->second;
+            emptyContainers.erase(it);
+            if (nonEmptyContainers.size() < CHILD_STATE_CACHE_SIZE)
+                nonEmptyContainers.insert(containerID);
+            return parentID;
+        }
+    }
+
+    // container from an earlier run, look it up once
+    std::ostringstream q;
+    q << "SELECT " << TQ("parent_id") << ", EXISTS(SELECT 1 FROM " << TQ(CDS_OBJECT_TABLE)
+      << " WHERE " << TQ("parent_id") << '=' << containerID << ')'
+      << " FROM " << TQ(CDS_OBJECT_TABLE)
+      << " WHERE " << TQ("id") << '=' << containerID;
+    Ref<SQLResult> res = select(q);
+    std::unique_ptr<SQLRow> row;
+    if (res == nullptr || (row = res->nextRow()) == nullptr)
+        return INVALID_OBJECT_ID;
+
+    int parentID = row->col_int64(0, INVALID_OBJECT_ID);
+    bool hasChildren = remapBool(row->col(1));
+
+    AutoLock lock(childStateMutex);
+    if (nonEmptyContainers.size() < CHILD_STATE_CACHE_SIZE)
+        nonEmptyContainers.insert(containerID);
+    if (hasChildren || parentID < 0)
+        return INVALID_OBJECT_ID;
+    return parentID;
 }
 
 void SQLStorage::updateObject(std::shared_ptr<CdsObject> obj, int* changedContainer)
 {
+    TransactionLock transaction(transactionMutex);
     Ref<Array<AddUpdateTable>> data;
     if (obj->getID() == CDS_ID_FS_ROOT) {
         std::map<std::string,std::string> cdsObjectSql;
@@ -437,6 +731,12 @@ void SQLStorage::updateObject(std::shared_ptr<CdsObject> obj, int* changedContai
         if (data == nullptr)
             return;
     }
+
+    // a moved container takes the keys of its descendants along
+    std::string oldPathKey;
+    if (IS_CDS_CONTAINER(obj->getObjectType()) && obj->getID() != CDS_ID_FS_ROOT)
+        oldPathKey = getPathKey(obj->getID());
+
     for (int i = 0; i < data->size(); i++) {
         Ref<AddUpdateTable> addUpdateTable = data->get(i);
         std::string operation = addUpdateTable->getOperation();
@@ -452,6 +752,13 @@ void SQLStorage::updateObject(std::shared_ptr<CdsObject> obj, int* changedContai
         log_debug("upd_query: %s\n", qb->str().c_str());
         exec(*qb);
     }
+    if (string_ok(oldPathKey)) {
+        std::string newPathKey = childPathKey(getPathKey(obj->getParentID()), obj->getID());
+        if (newPathKey != oldPathKey)
+            movePathKeys(oldPathKey, newPathKey);
+    }
+    if (browseIndex != nullptr)
+        browseIndex->objectChanged(obj->getID(), obj->getParentID());
 }
 
 std::shared_ptr<CdsObject> SQLStorage::loadObject(int objectID)
@@ -498,8 +805,126 @@ std::unique_ptr<std::vector<int>> SQLStorage::getServiceObjectIDs(char servicePr
 
     std::unique_ptr<SQLRow> row;
     while ((row = res->nextRow()) != nullptr) {
-        objectIDs->push_back(std::stoi(row->col(0)));
+        objectIDs->push_back(row->col_int64(0));
+    }
+
+    return objectIDs;
+}
+
+std::unique_ptr<std::vector<int>> SQLStorage::getFileItemIDs(std::string mimeTypePrefix)
+{
+    auto objectIDs = std::make_unique<std::vector<int>>();
+
+    std::ostringstream qb;
+    qb << "SELECT " << TQ("id")
+        << " FROM " << TQ(CDS_OBJECT_TABLE)
+        << " WHERE " << TQ("object_type") << '=' << OBJECT_TYPE_ITEM
+        << " AND " << TQ("ref_id") << " IS NULL"
+        << " AND " << TQ("mime_type") << " LIKE " << quote(mimeTypePrefix + '%')
+        << " ORDER BY " << TQ("location");
+
+    Ref<SQLResult> res = select(qb);
+    if (res == nullptr)
+        throw _Exception("db error");
+
+    std::unique_ptr<SQLRow> row;
+    while ((row = res->nextRow()) != nullptr) {
+        objectIDs->push_back(row->col_int64(0));
+    }
+
+    return objectIDs;
+}
+
+std::unique_ptr<std::unordered_map<std::string, Storage::ServiceState>> SQLStorage::getServiceState(char servicePrefix)
+{
+    auto state = std::make_unique<std::unordered_map<std::string, ServiceState>>();
+
+    std::ostringstream qb;
+    qb << "SELECT " << TQD('o', "id") << ',' << TQD('o', "service_id") << ',' << TQD('s', "content_hash")
+       << " FROM " << TQ(CDS_OBJECT_TABLE) << " o"
+       << " LEFT JOIN " << TQ(SERVICE_STATE_TABLE) << " s"
+       << " ON " << TQD('s', "object_id") << '=' << TQD('o', "id")
+       << " WHERE " << TQD('o', "service_id")
+       << " LIKE " << quote(std::string(1, servicePrefix) + '%');
+
+    Ref<SQLResult> res = select(qb);
+    if (res == nullptr)
+        throw _Exception("db error");
+
+    std::unique_ptr<SQLRow> row;
+    while ((row = res->nextRow()) != nullptr) {
+        auto& entry = (*state)[row->col(1)];
+        std::string hash = row->col(2);
+        // objects of one item with differing state force an update
+        if (entry.objectIDs.empty())
+            entry.contentHash = hash;
+        else if (entry.contentHash != hash)
+            entry.contentHash.clear();
+        entry.objectIDs.push_back(row->col_int64(0));
+    }
+
+    return state;
+}
+
+void SQLStorage::touchServiceObjects(const std::vector<int>& objectIDs, time_t seen)
+{
+    for (size_t start = 0; start < objectIDs.size(); start += SERVICE_STATE_BATCH_SIZE) {
+        auto end = std::min(objectIDs.size(), start + SERVICE_STATE_BATCH_SIZE);
+        std::vector<int> batch(objectIDs.begin() + start, objectIDs.begin() + end);
+
+        std::ostringstream qb;
+        qb << "UPDATE " << TQ(SERVICE_STATE_TABLE)
+           << " SET " << TQ("last_seen") << '=' << quote(static_cast<long long>(seen))
+           << " WHERE " << TQ("object_id") << " IN (" << join(batch, ',') << ')';
+        exec(qb);
+    }
+}
+
+void SQLStorage::storeServiceState(char servicePrefix, const std::map<std::string, std::string>& hashes, time_t seen)
+{
+    auto it = hashes.begin();
+    while (it != hashes.end()) {
+        std::ostringstream hashCase;
+        std::ostringstream ids;
+        for (int count = 0; it != hashes.end() && count < SERVICE_STATE_BATCH_SIZE; ++it, count++) {
+            auto serviceID = quote(it->first);
+            hashCase << " WHEN " << serviceID << " THEN " << quote(it->second);
+            if (count > 0)
+                ids << ',';
+            ids << serviceID;
+        }
+
+        // replaces the state of objects that were imported before
+        std::ostringstream qb;
+        qb << "REPLACE INTO " << TQ(SERVICE_STATE_TABLE) << " ("
+           << TQ("object_id") << ',' << TQ("service_prefix") << ',' << TQ("service_id") << ','
+           << TQ("content_hash") << ',' << TQ("last_seen")
+           << ") SELECT " << TQ("id") << ',' << quote(std::string(1, servicePrefix)) << ',' << TQ("service_id") << ','
+           << "CASE " << TQ("service_id") << hashCase.str() << " END,"
+           << quote(static_cast<long long>(seen))
+           << " FROM " << TQ(CDS_OBJECT_TABLE)
+           << " WHERE " << TQ("service_id") << " IN (" << ids.str() << ')';
+        exec(qb);
     }
+}
+
+std::unique_ptr<std::unordered_set<int>> SQLStorage::getStaleServiceObjects(char servicePrefix, time_t seenBefore)
+{
+    auto objectIDs = std::make_unique<std::unordered_set<int>>();
+
+    std::ostringstream qb;
+    qb << "SELECT " << TQ("object_id")
+       << " FROM " << TQ(SERVICE_STATE_TABLE)
+       << " WHERE " << TQ("service_prefix") << '=' << quote(std::string(1, servicePrefix))
+       << " AND " << TQ("last_seen") << " < " << quote(static_cast<long long>(seenBefore));
+
+    Ref<SQLResult> res = select(qb);
+    if (res == nullptr)
+        throw _Exception("db error");
+
+    std::unique_ptr<SQLRow> row;
+    while ((row = res->nextRow()) != nullptr)
+        objectIDs->insert(row->col_int64(0));
 
     return objectIDs;
 }
@@ -508,6 +933,7 @@ std::vector<std::shared_ptr<CdsObject>> SQLStorage::browse(const std::unique_ptr
 {
     int objectID;
     int objectType = 0;
+    int updateID = 0;
 
     bool getContainers = param->getFlag(BROWSE_CONTAINERS);
     bool getItems = param->getFlag(BROWSE_ITEMS);
@@ -517,17 +943,16 @@ std::vector<std::shared_ptr<CdsObject>> SQLStorage::browse(const std::unique_ptr
     Ref<SQLResult> res;
     std::unique_ptr<SQLRow> row;
 
-    bool haveObjectType = false;
-
-    if (!haveObjectType) {
+    // containers browsed below an indexed one are known to the index
+    if (browseIndex == nullptr || !browseIndex->getObject(objectID, objectType, updateID)) {
         std::ostringstream qb;
-        qb << "SELECT " << TQ("object_type")
+        qb << "SELECT " << TQ("object_type") << ',' << TQ("update_id")
             << " FROM " << TQ(CDS_OBJECT_TABLE)
             << " WHERE " << TQ("id") << '=' << objectID;
         res = select(qb);
         if (res != nullptr && (row = res->nextRow()) != nullptr) {
-            objectType = std::stoi(row->col(0));
-            haveObjectType = true;
+            objectType = row->col_int64(0);
+            updateID = row->col_int64(1);
         } else {
             throw _ObjectNotFoundException("Object not found: " + std::to_string(objectID));
         }
@@ -535,24 +960,39 @@ std::vector<std::shared_ptr<CdsObject>> SQLStorage::browse(const std::unique_ptr
         row = nullptr;
         res = nullptr;
     }
+    param->setUpdateID(updateID);
 
     bool hideFsRoot = param->getFlag(BROWSE_HIDE_FS_ROOT);
 
+    if (browseSnapshotWindow > 0 && param->getFlag(BROWSE_DIRECT_CHILDREN) && IS_CDS_CONTAINER(objectType)) {
+        std::vector<int> ids;
+        int total;
+        if (getSnapshotPage(param, updateID, ids, total)) {
+            param->setTotalMatches(total);
+            return browseObjects(ids, getContainers, getItems);
+        }
+    }
+
+    if (browseIndex != nullptr && param->getFlag(BROWSE_DIRECT_CHILDREN) && IS_CDS_CONTAINER(objectType)) {
+        std::vector<int> ids;
+        int total;
+        int excludeID = (objectID == CDS_ID_ROOT && hideFsRoot) ? CDS_ID_FS_ROOT : INVALID_OBJECT_ID;
+        bool trackSort = param->getFlag(BROWSE_TRACK_SORT);
+        // the container may be dropped from the index by a concurrent write
+        if ((browseIndex->isIndexed(objectID) || indexChildren(objectID))
+            && browseIndex->getPage(objectID, getContainers, getItems, trackSort, excludeID,
+                   param->getStartingIndex(), param->getRequestedCount(), ids, total)) {
+            param->setTotalMatches(total);
+            return browseObjects(ids, getContainers, getItems);
+        }
+    }
+
     if (param->getFlag(BROWSE_DIRECT_CHILDREN) && IS_CDS_CONTAINER(objectType)) {
         param->setTotalMatches(getChildCount(objectID, getContainers, getItems, hideFsRoot));
     } else {
         param->setTotalMatches(1);
     }
 
-    // order by code..
-    auto orderByCode = [&]() {
-        std::ostringstream qb;
-        if (param->getFlag(BROWSE_TRACK_SORT))
-            qb << TQD('f', "track_number") << ',';
-        qb << TQD('f', "dc_title");
-        return qb.str();
-    };
-
     std::ostringstream qb;
     qb << SQL_QUERY << " WHERE ";
 
@@ -566,28 +1006,7 @@ std::vector<std::shared_ptr<CdsObject>> SQLStorage::browse(const std::unique_ptr
                 doLimit = false;
         }
 
-        qb << TQD('f', "parent_id") << '=' << objectID;
-
-        if (objectID == CDS_ID_ROOT && hideFsRoot)
-            qb << " AND " << TQD('f', "id") << "!="
-                << quote(CDS_ID_FS_ROOT);
-
-        if (!getContainers && !getItems) {
-            qb << " AND 0=1";
-        } else if (getContainers && !getItems) {
-            qb << " AND " << TQD('f', "object_type") << '='
-                << quote(OBJECT_TYPE_CONTAINER)
-                << " ORDER BY " << orderByCode();
-        } else if (!getContainers && getItems) {
-            qb << " AND (" << TQD('f', "object_type") << " & "
-                << quote(OBJECT_TYPE_ITEM) << ") = "
-                << quote(OBJECT_TYPE_ITEM)
-                << " ORDER BY " << orderByCode();
-        } else {
-            qb << " ORDER BY ("
-                << TQD('f', "object_type") << '=' << quote(OBJECT_TYPE_CONTAINER)
-                << ") DESC, " << orderByCode();
-        }
+        appendChildrenClause(qb, param);
         if (doLimit)
             qb << " LIMIT " << count << " OFFSET " << param->getStartingIndex();
     } else // metadata
@@ -620,6 +1039,181 @@ std::vector<std::shared_ptr<CdsObject>> SQLStorage::browse(const std::unique_ptr
     return arr;
 }
 
+void SQLStorage::appendChildrenClause(std::ostringstream& qb, const std::unique_ptr<BrowseParam>& param)
+{
+    int objectID = param->getObjectID();
+    bool getContainers = param->getFlag(BROWSE_CONTAINERS);
+    bool getItems = param->getFlag(BROWSE_ITEMS);
+
+    auto orderByCode = [&]() {
+        return childOrder(param->getFlag(BROWSE_TRACK_SORT));
+    };
+
+    qb << TQD('f', "parent_id") << '=' << objectID;
+
+    if (objectID == CDS_ID_ROOT && param->getFlag(BROWSE_HIDE_FS_ROOT))
+        qb << " AND " << TQD('f', "id") << "!="
+            << quote(CDS_ID_FS_ROOT);
+
+    if (!getContainers && !getItems) {
+        qb << " AND 0=1";
+    } else if (getContainers && !getItems) {
+        qb << " AND " << TQD('f', "object_type") << '='
+            << quote(OBJECT_TYPE_CONTAINER)
+            << " ORDER BY " << orderByCode();
+    } else if (!getContainers && getItems) {
+        qb << " AND (" << TQD('f', "object_type") << " & "
+            << quote(OBJECT_TYPE_ITEM) << ") = "
+            << quote(OBJECT_TYPE_ITEM)
+            << " ORDER BY " << orderByCode();
+    } else {
+        qb << " ORDER BY ("
+            << TQD('f', "object_type") << '=' << quote(OBJECT_TYPE_CONTAINER)
+            << ") DESC, " << orderByCode();
+    }
+}
+
+std::string SQLStorage::childOrder(bool trackSort)
+{
+    std::ostringstream qb;
+    if (trackSort)
+        qb << TQD('f', "track_number") << ',';
+    qb << TQD('f', "dc_title") << ',' << TQD('f', "id");
+    return qb.str();
+}
+
+std::vector<int> SQLStorage::getChildIDs(const std::unique_ptr<BrowseParam>& param)
+{
+    std::vector<int> ids;
+    int objectID = param->getObjectID();
+
+    if (browseIndex != nullptr) {
+        int total;
+        int excludeID = (objectID == CDS_ID_ROOT && param->getFlag(BROWSE_HIDE_FS_ROOT)) ? CDS_ID_FS_ROOT : INVALID_OBJECT_ID;
+        if ((browseIndex->isIndexed(objectID) || indexChildren(objectID))
+            && browseIndex->getPage(objectID, param->getFlag(BROWSE_CONTAINERS), param->getFlag(BROWSE_ITEMS),
+                   param->getFlag(BROWSE_TRACK_SORT), excludeID, 0, 0, ids, total))
+            return ids;
+    }
+
+    std::ostringstream qb;
+    qb << "SELECT " << TQD('f', "id") << " FROM " << TQ(CDS_OBJECT_TABLE) << ' ' << TQ('f') << " WHERE ";
+    appendChildrenClause(qb, param);
+    Ref<SQLResult> res = select(qb);
+    if (res == nullptr)
+        throw _Exception("db error");
+
+    std::unique_ptr<SQLRow> row;
+    while ((row = res->nextRow()) != nullptr)
+        ids.push_back(row->col_int64(0));
+    return ids;
+}
+
+bool SQLStorage::getSnapshotPage(const std::unique_ptr<BrowseParam>& param, int updateID, std::vector<int>& ids, int& total)
+{
+    // flags that change the result, BROWSE_EXACT_CHILDCOUNT etc. do not
+    unsigned int flags = param->getFlag(BROWSE_CONTAINERS | BROWSE_ITEMS | BROWSE_TRACK_SORT | BROWSE_HIDE_FS_ROOT);
+    auto key = std::make_tuple(param->getClient(), param->getObjectID(), flags);
+    time_t now = time(nullptr);
+
+    auto takePage = [&](const BrowseSnapshot& snapshot) {
+        total = snapshot.ids.size();
+        int start = std::min(param->getStartingIndex(), total);
+        int count = param->getRequestedCount() > 0 ? std::min(param->getRequestedCount(), total - start) : total - start;
+        ids.assign(snapshot.ids.begin() + start, snapshot.ids.begin() + start + count);
+        param->setUpdateID(snapshot.updateID);
+    };
+
+    {
+        AutoLock lock(browseSnapshotMutex);
+        auto it = browseSnapshots.find(key);
+        // later pages stay on the snapshot of the first page, a new first
+        // page only does so while the container is unchanged
+        if (it != browseSnapshots.end() && now - it->second.created < browseSnapshotWindow
+            && (param->getStartingIndex() > 0 || it->second.updateID == updateID)) {
+            takePage(it->second);
+            return true;
+        }
+    }
+
+    // a request for all children is not followed by further pages
+    if (param->getStartingIndex() == 0 && param->getRequestedCount() == 0)
+        return false;
+
+    BrowseSnapshot snapshot;
+    snapshot.updateID = updateID;
+    snapshot.created = now;
+    snapshot.ids = getChildIDs(param);
+    takePage(snapshot);
+
+    AutoLock lock(browseSnapshotMutex);
+    auto it = browseSnapshots.find(key);
+    if (it != browseSnapshots.end()) {
+        browseSnapshotEntries -= it->second.ids.size();
+        browseSnapshots.erase(it);
+    }
+
+    // expired snapshots go first, then the oldest until the new one fits
+    for (auto old = browseSnapshots.begin(); old != browseSnapshots.end();) {
+        if (now - old->second.created >= browseSnapshotWindow) {
+            browseSnapshotEntries -= old->second.ids.size();
+            old = browseSnapshots.erase(old);
+        } else {
+            ++old;
+        }
+    }
+    while (!browseSnapshots.empty()
+        && (browseSnapshots.size() >= BROWSE_SNAPSHOT_MAX_COUNT || browseSnapshotEntries + snapshot.ids.size() > BROWSE_SNAPSHOT_MAX_ENTRIES)) {
+        auto oldest = std::min_element(browseSnapshots.begin(), browseSnapshots.end(),
+            [](const auto& a, const auto& b) { return a.second.created < b.second.created; });
+        browseSnapshotEntries -= oldest->second.ids.size();
+        browseSnapshots.erase(oldest);
+    }
+
+    if (snapshot.ids.size() <= BROWSE_SNAPSHOT_MAX_ENTRIES) {
+        browseSnapshotEntries += snapshot.ids.size();
+        browseSnapshots[key] = std::move(snapshot);
+    }
+    return true;
+}
+
+// maps UPnP SortCriteria to columns of the search query, properties that
+// have no column are ignored
+static std::string searchSortOrder(const std::string& sortCriteria)
+{
+    std::ostringstream order;
+    for (auto criterion : split_string(sortCriteria, ',')) {
+        criterion = trim_string(criterion);
+        bool descending = false;
+        if (!criterion.empty() && (criterion[0] == '+' || criterion[0] == '-')) {
+            descending = criterion[0] == '-';
+            criterion.erase(0, 1);
+        }
+
+        std::string column;
+        if (criterion == "dc:title")
+            column = "dc_title";
+        else if (criterion == "upnp:originalTrackNumber")
+            column = "track_number";
+        else
+            column = metadataColumn(criterion);
+        if (column.empty())
+            continue;
+
+        if (order.tellp() > 0)
+            order << ", ";
+        order << "c." << column << (descending ? " desc" : " asc");
+    }
+    return order.str();
+}
+
+// keys of all descendants lie between the key of an object and this bound,
+// ',' is followed by '-' and both sort before the digits
+static std::string pathKeyUpperBound(const std::string& pathKey)
+{
+    return pathKey.substr(0, pathKey.length() - 1) + '-';
+}
+
 std::vector<std::shared_ptr<CdsObject>> SQLStorage::search(const std::unique_ptr<SearchParam>& param, int* numMatches)
 {
     std::unique_ptr<SearchParser> searchParser = std::make_unique<SearchParser>(*sqlEmitter, param->searchCriteria());
@@ -628,21 +1222,26 @@ std::vector<std::shared_ptr<CdsObject>> SQLStorage::search(const std::unique_ptr
     if (!searchSQL.length())
         throw _Exception("failed to generate SQL for search");
 
+    // an object matches once for every metadata row it is joined with
     std::ostringstream countSQL;
-    countSQL << "select count(*) " << searchSQL << ';';
+    countSQL << "select count(distinct c.id) " << searchSQL << ';';
     zmm::Ref<SQLResult> sqlResult;
     sqlResult = select(countSQL);
     std::unique_ptr<SQLRow> countRow = sqlResult->nextRow();
     if (countRow != nullptr) {
-        *numMatches = std::stoi(countRow->col(0));
+        *numMatches = countRow->col_int64(0);
     }
     
     std::ostringstream retrievalSQL;
     retrievalSQL << SELECT_DATA_FOR_SEARCH << " " << searchSQL;
     int startingIndex = param->getStartingIndex(), requestedCount = param->getRequestedCount();
+    std::string sortOrder = searchSortOrder(param->sortCriteria());
+    if (!sortOrder.empty())
+        retrievalSQL << " order by " << sortOrder << ", c.id";
+    else if (startingIndex > 0 || requestedCount > 0)
+        retrievalSQL << " order by c.id";
     if (startingIndex > 0 || requestedCount > 0) {
-        retrievalSQL << " order by c.id"
-                     << " limit " << (requestedCount == 0 ? 10000000000 : requestedCount)
+        retrievalSQL << " limit " << (requestedCount == 0 ? 10000000000 : requestedCount)
                      << " offset " << startingIndex;
     }
     retrievalSQL << ';';
@@ -664,11 +1263,121 @@ std::vector<std::shared_ptr<CdsObject>> SQLStorage::search(const std::unique_ptr
     return arr;
 }
 
+std::vector<std::shared_ptr<CdsObject>> SQLStorage::browseObjects(const std::vector<int>& ids, bool containers, bool items)
+{
+    std::vector<std::shared_ptr<CdsObject>> arr;
+    if (ids.empty())
+        return arr;
+
+    std::ostringstream qb;
+    qb << SQL_QUERY << " WHERE " << TQD('f', "id") << " IN (" << join(ids, ',') << ')';
+    Ref<SQLResult> res = select(qb);
+    if (res == nullptr)
+        throw _Exception("db error");
+
+    std::unordered_map<int, std::shared_ptr<CdsObject>> objects;
+    std::unique_ptr<SQLRow> row;
+    while ((row = res->nextRow()) != nullptr) {
+        auto obj = createObjectFromRow(row);
+        objects[obj->getID()] = obj;
+    }
+
+    // objects removed since the page was taken from the index are skipped
+    std::vector<int> containerIDs;
+    arr.reserve(ids.size());
+    for (int id : ids) {
+        auto it = objects.find(id);
+        if (it == objects.end())
+            continue;
+        arr.push_back(it->second);
+        if (IS_CDS_CONTAINER(it->second->getObjectType()))
+            containerIDs.push_back(id);
+    }
+
+    // snapshots fetch their pages here without the browse index
+    if (browseIndex != nullptr)
+        indexChildCounts(containerIDs);
+    for (const auto& obj : arr) {
+        if (IS_CDS_CONTAINER(obj->getObjectType())) {
+            auto cont = std::static_pointer_cast<CdsContainer>(obj);
+            cont->setChildCount(getChildCount(cont->getID(), containers, items, false));
+        }
+    }
+    return arr;
+}
+
+bool SQLStorage::indexChildren(int containerID)
+{
+    unsigned long generation = browseIndex->getGeneration();
+    std::ostringstream qb;
+    // titles are ordered by the database, so the collation of the driver applies
+    qb << "SELECT " << TQD('f', "id") << ',' << TQD('f', "object_type") << ',' << TQD('f', "track_number")
+       << ',' << TQD('f', "update_id") << ',' << TQD('f', "dc_title")
+       << " FROM " << TQ(CDS_OBJECT_TABLE) << ' ' << TQ('f')
+       << " WHERE " << TQD('f', "parent_id") << '=' << containerID
+       << " ORDER BY (" << TQD('f', "object_type") << '=' << quote(OBJECT_TYPE_CONTAINER) << ") DESC, "
+       << childOrder(false);
+    Ref<SQLResult> res = select(qb);
+    if (res == nullptr)
+        throw _Exception("db error");
+
+    std::vector<CdsTreeIndex::Child> children;
+    std::unique_ptr<SQLRow> row;
+    while ((row = res->nextRow()) != nullptr) {
+        // NULL track numbers sort first, as in SQL
+        children.push_back({ static_cast<int>(row->col_int64(0)), static_cast<int>(row->col_int64(1)),
+            static_cast<int>(row->col_int64(2, -1)), static_cast<int>(row->col_int64(3)), row->col(4) });
+    }
+    return browseIndex->setChildren(containerID, children, generation);
+}
+
+void SQLStorage::indexChildCounts(const std::vector<int>& containerIDs)
+{
+    std::vector<int> missing;
+    int count;
+    for (int id : containerIDs) {
+        if (!browseIndex->getCount(id, true, true, INVALID_OBJECT_ID, count))
+            missing.push_back(id);
+    }
+    if (missing.empty())
+        return;
+
+    unsigned long generation = browseIndex->getGeneration();
+    std::ostringstream qb;
+    qb << "SELECT " << TQ("parent_id") << ',' << TQ("object_type") << ",COUNT(*)"
+       << " FROM " << TQ(CDS_OBJECT_TABLE)
+       << " WHERE " << TQ("parent_id") << " IN (" << join(missing, ',') << ')'
+       << " GROUP BY " << TQ("parent_id") << ',' << TQ("object_type");
+    Ref<SQLResult> res = select(qb);
+    if (res == nullptr)
+        throw _Exception("db error");
+
+    std::unordered_map<int, std::pair<int, int>> counts;
+    for (int id : missing)
+        counts[id] = { 0, 0 };
+    std::unique_ptr<SQLRow> row;
+    while ((row = res->nextRow()) != nullptr) {
+        auto& entry = counts[row->col_int64(0)];
+        int objectType = row->col_int64(1);
+        if (objectType == OBJECT_TYPE_CONTAINER)
+            entry.first += row->col_int64(2);
+        else if ((objectType & OBJECT_TYPE_ITEM) == OBJECT_TYPE_ITEM)
+            entry.second += row->col_int64(2);
+    }
+    for (const auto& entry : counts)
+        browseIndex->setCounts(entry.first, entry.second.first, entry.second.second, generation);
+}
+
 int SQLStorage::getChildCount(int contId, bool containers, bool items, bool hideFsRoot)
 {
     if (!containers && !items)
         return 0;
 
+    int count;
+    if (browseIndex != nullptr
+        && browseIndex->getCount(contId, containers, items, (contId == CDS_ID_ROOT && hideFsRoot) ? CDS_ID_FS_ROOT : INVALID_OBJECT_ID, count))
+        return count;
+
     std::unique_ptr<SQLRow> row;
     Ref<SQLResult> res;
     std::ostringstream qb;
@@ -684,7 +1393,7 @@ int SQLStorage::getChildCount(int contId, bool containers, bool items, bool hide
     }
     res = select(qb);
     if (res != nullptr && (row = res->nextRow()) != nullptr) {
-        int childCount = std::stoi(row->col(0));
+        int childCount = row->col_int64(0);
         return childCount;
     }
     return 0;
@@ -815,6 +1524,10 @@ int SQLStorage::createContainer(int parentID, std::string name, std::string path
 
     int newID = getNextID();
 
+    std::map<std::string,std::string> metadataColumns;
+    setMetadataColumns(metadataColumns, itemMetadata, false);
+    std::string pathKey = childPathKey(getPathKey(parentID), newID);
+
     std::ostringstream qb;
     qb << "INSERT INTO "
         << TQ(CDS_OBJECT_TABLE)
@@ -826,7 +1539,11 @@ int SQLStorage::createContainer(int parentID, std::string name, std::string path
         << TQ("dc_title") << ','
         << TQ("location") << ','
         << TQ("location_hash") << ','
-        << TQ("ref_id") << ") VALUES ("
+        << TQ("ref_id") << ','
+        << TQ("path_key");
+    for (const auto& column : metadataColumns)
+        qb << ',' << TQ(column.first);
+    qb << ") VALUES ("
         << newID << ','
         << parentID << ','
         << OBJECT_TYPE_CONTAINER << ','
@@ -839,28 +1556,31 @@ int SQLStorage::createContainer(int parentID, std::string name, std::string path
         } else {
             qb << SQL_NULL;
         }
+        qb << ',' << (string_ok(pathKey) ? quote(pathKey) : SQL_NULL);
+        for (const auto& column : metadataColumns)
+            qb << ',' << column.second;
         qb << ')';
 
     exec(qb);
 
+    if (string_ok(pathKey)) {
+        AutoLock lock(pathKeyMutex);
+        if (pathKeys.size() < PATH_KEY_CACHE_SIZE)
+            pathKeys[newID] = pathKey;
+    }
+    {
+        AutoLock lock(childStateMutex);
+        if (emptyContainers.size() < CHILD_STATE_CACHE_SIZE)
+            emptyContainers[newID] = parentID;
+        if (nonEmptyContainers.size() < CHILD_STATE_CACHE_SIZE)
+            nonEmptyContainers.insert(parentID);
+        emptyContainers.erase(parentID);
+    }
+    if (browseIndex != nullptr)
+        browseIndex->objectAdded(parentID, { newID, OBJECT_TYPE_CONTAINER, -1, 0, name });
+
     if (!itemMetadata.empty()) {
-        for (auto it = itemMetadata.begin(); it != itemMetadata.end(); it++) {
-            int newMetadataID = getNextMetadataID();
-            std::ostringstream ib;
-            ib << "INSERT INTO"
-                << TQ(METADATA_TABLE)
-                << " ("
-                << TQ("id") << ','
-                << TQ("item_id") << ','
-                << TQ("property_name") << ','
-                << TQ("property_value") << ") VALUES ("
-                << newMetadataID << ','
-                << newID << ","
-                << quote(it->first) << ","
-                << quote(it->second)
-                << ")";
-            exec(ib);
-        }
+        insertMetadata(newID, itemMetadata);
         log_debug("Wrote metadata for cds_object %d", newID);
     }
 
@@ -913,7 +1633,7 @@ void SQLStorage::addContainerChain(std::string path, std::string lastClass, int
         std::unique_ptr<SQLRow> row = res->nextRow();
         if (row != nullptr) {
             if (containerID != nullptr)
-                *containerID = std::stoi(row->col(0));
+                *containerID = row->col_int64(0);
             return;
         }
     }
@@ -952,18 +1672,18 @@ std::string SQLStorage::stripLocationPrefix(std::string path)
 
 std::shared_ptr<CdsObject> SQLStorage::createObjectFromRow(const std::unique_ptr<SQLRow>& row)
 {
-    int objectType = std::stoi(row->col(_object_type));
+    int objectType = row->col_int64(_object_type);
     auto self = getSelf();
     auto obj = CdsObject::createObject(self, objectType);
 
     /* set common properties */
-    obj->setID(std::stoi(row->col(_id)));
-    obj->setRefID(stoi_string(row->col(_ref_id)));
+    obj->setID(row->col_int64(_id));
+    obj->setRefID(row->col_int64(_ref_id));
 
-    obj->setParentID(std::stoi(row->col(_parent_id)));
+    obj->setParentID(row->col_int64(_parent_id));
     obj->setTitle(row->col(_dc_title));
     obj->setClass(fallbackString(row->col(_upnp_class), row->col(_ref_upnp_class)));
-    obj->setFlags(std::stoi(row->col(_flags)));
+    obj->setFlags(row->col_int64(_flags));
 
     auto meta = retrieveMetadataForObject(obj->getID());
     if (!meta.empty())
@@ -1007,7 +1727,7 @@ std::shared_ptr<CdsObject> SQLStorage::createObjectFromRow(const std::unique_ptr
 
     if (IS_CDS_CONTAINER(objectType)) {
         auto cont = std::static_pointer_cast<CdsContainer>(obj);
-        cont->setUpdateID(std::stoi(row->col(_update_id)));
+        cont->setUpdateID(row->col_int64(_update_id));
         char locationPrefix;
         cont->setLocation(stripLocationPrefix(&locationPrefix, row->col(_location)));
         if (locationPrefix == LOC_VIRT_PREFIX)
@@ -1077,15 +1797,15 @@ std::shared_ptr<CdsObject> SQLStorage::createObjectFromRow(const std::unique_ptr
 
 std::shared_ptr<CdsObject> SQLStorage::createObjectFromSearchRow(const std::unique_ptr<SQLRow>& row)
 {
-    int objectType = std::stoi(row->col(_object_type));
+    int objectType = row->col_int64(_object_type);
     auto self = getSelf();
     auto obj = CdsObject::createObject(self, objectType);
 
     /* set common properties */
-    obj->setID(std::stoi(row->col(SearchCol::id)));
-    obj->setRefID(std::stoi(row->col(SearchCol::ref_id)));
+    obj->setID(row->col_int64(SearchCol::id));
+    obj->setRefID(row->col_int64(SearchCol::ref_id));
 
-    obj->setParentID(std::stoi(row->col(SearchCol::parent_id)));
+    obj->setParentID(row->col_int64(SearchCol::parent_id));
     obj->setTitle(row->col(SearchCol::dc_title));
     obj->setClass(row->col(SearchCol::upnp_class));
 
@@ -1116,7 +1836,7 @@ std::shared_ptr<CdsObject> SQLStorage::createObjectFromSearchRow(const std::uniq
             item->setLocation(row->col(SearchCol::location));
         }
 
-        item->setTrackNumber(std::stoi(row->col(SearchCol::track_number)));
+        item->setTrackNumber(row->col_int64(SearchCol::track_number));
     } else {
         throw _StorageException("", "unknown object type: " + std::to_string(objectType));
     }
@@ -1128,7 +1848,7 @@ std::map<std::string,std::string> SQLStorage::retrieveMetadataForObject(int obje
 {
     std::ostringstream qb;
     qb << SELECT_METADATA
-        << " FROM " << TQ(METADATA_TABLE)
+        << " FROM " << TQ(METADATA_VIEW)
         << " WHERE " << TQ("item_id")
         << " = " << objectId;
     Ref<SQLResult> res = select(qb);
@@ -1154,7 +1874,7 @@ int SQLStorage::getTotalFiles()
     Ref<SQLResult> res = select(query);
     std::unique_ptr<SQLRow> row;
     if (res != nullptr && (row = res->nextRow()) != nullptr) {
-        return std::stoi(row->col(0));
+        return row->col_int64(0);
     }
     return 0;
 }
@@ -1162,7 +1882,7 @@ int SQLStorage::getTotalFiles()
 std::string SQLStorage::incrementUpdateIDs(const unique_ptr<unordered_set<int>>& ids)
 {
     if (ids->empty())
-        return nullptr;
+        return "";
     std::ostringstream inBuf;
 
     bool first = true;
@@ -1191,16 +1911,146 @@ std::string SQLStorage::incrementUpdateIDs(const unique_ptr<unordered_set<int>>&
         throw _Exception("Error while fetching update ids");
     std::unique_ptr<SQLRow> row;
     std::list<std::string> rows;
+    std::map<int, int> updateIDs;
+    std::ostringstream changes;
+    time_t now = time(nullptr);
     while ((row = res->nextRow()) != nullptr) {
         std::ostringstream s;
         s << row->col(0) << ',' << row->col(1);
         rows.emplace_back(s.str());
+        updateIDs[row->col_int64(0)] = row->col_int64(1);
+        if (isWriter())
+            changes << (rows.size() > 1 ? "," : "") << '(' << row->col(0) << ',' << row->col(1) << ',' << now << ')';
     }
     if (rows.empty())
-        return nullptr;
+        return "";
+    if (browseIndex != nullptr)
+        browseIndex->updateIDsChanged(updateIDs);
+
+    if (isWriter()) {
+        std::ostringstream bufLog;
+        bufLog << "INSERT INTO " << TQ(CHANGE_LOG_TABLE)
+               << " (" << TQ("container_id") << ',' << TQ("update_id") << ',' << TQ("changed") << ")"
+               << " VALUES " << changes.str();
+        exec(bufLog);
+
+        if (now - changeLogPruned >= CHANGE_LOG_PRUNE_INTERVAL) {
+            pruneChangeLog(now - CHANGE_LOG_RETENTION);
+            changeLogPruned = now;
+        }
+    }
     return join(rows, ",");
 }
 
+void SQLStorage::pruneChangeLog(time_t changedBefore)
+{
+    std::ostringstream q;
+    q << "SELECT MAX(" << TQ("id") << ") FROM " << TQ(CHANGE_LOG_TABLE)
+      << " WHERE " << TQ("changed") << " < " << changedBefore;
+    Ref<SQLResult> res = select(q);
+    std::unique_ptr<SQLRow> row;
+    int prunedID = (res != nullptr && (row = res->nextRow()) != nullptr) ? row->col_int64(0, 0) : 0;
+    if (prunedID <= 0)
+        return;
+
+    // the marker is stored before the rows are deleted, a reader that
+    // finds the rows gone therefore always finds the marker as well
+    storeInternalSetting(CHANGE_LOG_PRUNED_SETTING, std::to_string(prunedID));
+
+    std::ostringstream qDelete;
+    qDelete << "DELETE FROM " << TQ(CHANGE_LOG_TABLE)
+            << " WHERE " << TQ("id") << " <= " << prunedID;
+    exec(qDelete);
+}
+
+int SQLStorage::getChangeLogPruned()
+{
+    std::string pruned = getInternalSetting(CHANGE_LOG_PRUNED_SETTING);
+    return stoi_string(pruned);
+}
+
+std::string SQLStorage::getChangesSince(int& lastChangeID)
+{
+    if (lastChangeID < 0) {
+        std::ostringstream q;
+        q << "SELECT MAX(" << TQ("id") << ") FROM " << TQ(CHANGE_LOG_TABLE);
+        Ref<SQLResult> res = select(q);
+        std::unique_ptr<SQLRow> row;
+        lastChangeID = (res != nullptr && (row = res->nextRow()) != nullptr) ? row->col_int64(0, 0) : 0;
+        // ids are not reused, after a prune of the whole log they continue
+        // above the pruned ones
+        lastChangeID = std::max(lastChangeID, getChangeLogPruned());
+        return "";
+    }
+
+    int seen = lastChangeID;
+    std::ostringstream q;
+    q << "SELECT " << TQ("id") << ',' << TQ("container_id") << ',' << TQ("update_id")
+      << " FROM " << TQ(CHANGE_LOG_TABLE)
+      << " WHERE " << TQ("id") << " > " << lastChangeID
+      << " ORDER BY " << TQ("id")
+      << " LIMIT " << CHANGE_LOG_BATCH_SIZE;
+    Ref<SQLResult> res = select(q);
+    if (res == nullptr)
+        throw _Exception("Error while fetching the change log");
+
+    // a container may be logged several times, the newest update ID wins
+    std::map<int, int> updates;
+    std::unique_ptr<SQLRow> row;
+    while ((row = res->nextRow()) != nullptr) {
+        updates[row->col_int64(1)] = row->col_int64(2);
+        lastChangeID = row->col_int64(0);
+    }
+
+    // ids need not be consecutive, so pruned changes are only recognised by
+    // the marker of the writer; it is read after the rows so that a prune
+    // between both queries is not missed
+    bool lost = getChangeLogPruned() > seen;
+
+    if (lost) {
+        log_warning("Missed changes of the writer node, announcing an update of the whole tree\n");
+        std::ostringstream qRoot;
+        qRoot << "SELECT " << TQ("update_id") << " FROM " << TQ(CDS_OBJECT_TABLE)
+              << " WHERE " << TQ("id") << '=' << CDS_ID_ROOT;
+        Ref<SQLResult> resRoot = select(qRoot);
+        if (resRoot != nullptr && (row = resRoot->nextRow()) != nullptr)
+            updates[CDS_ID_ROOT] = row->col_int64(0);
+    }
+    if (updates.empty())
+        return "";
+
+    {
+        AutoLock lock(childStateMutex);
+        for (const auto& update : updates)
+            nonEmptyContainers.erase(update.first);
+    }
+    {
+        // the writer may have moved or removed containers
+        AutoLock lock(pathKeyMutex);
+        pathKeys.clear();
+        pathKeyGeneration++;
+    }
+    if (browseIndex != nullptr) {
+        if (lost) {
+            browseIndex->clear();
+        } else {
+            browseIndex->updateIDsChanged(updates);
+            for (const auto& update : updates)
+                browseIndex->invalidate(update.first);
+        }
+    }
+    if (updates.find(CDS_ID_FS_ROOT) != updates.end())
+        setFsRootName();
+
+    std::ostringstream buf;
+    for (auto it = updates.begin(); it != updates.end(); it++) {
+        if (it != updates.begin())
+            buf << ',';
+        buf << it->first << ',' << it->second;
+    }
+    return buf.str();
+}
+
 // id is the parent_id for cover media to find, and if set, trackArtBase is the case-folded
 // name of the track to try as artwork; we rely on LIKE being case-insensitive
 
@@ -1283,17 +2133,12 @@ unique_ptr<unordered_set<int>> SQLStorage::getObjects(int parentID, bool without
         throw _Exception("db error");
     std::unique_ptr<SQLRow> row;
 
-    if (res->getNumRows() <= 0)
-        return nullptr;
-
-    unsigned long long capacity = res->getNumRows() * 5 + 1;
-    if (capacity < 521)
-        capacity = 521;
-
     auto ret = make_unique<unordered_set<int>>();
     while ((row = res->nextRow()) != nullptr) {
-        ret->insert(std::stoi(row->col(0)));
+        ret->insert(row->col_int64(0));
     }
+    if (ret->empty())
+        return nullptr;
     return ret;
 }
 
@@ -1321,11 +2166,11 @@ std::unique_ptr<Storage::ChangedContainers> SQLStorage::removeObjects(const uniq
     std::vector<int32_t> containers;
     std::unique_ptr<SQLRow> row;
     while ((row = res->nextRow()) != nullptr) {
-        int objectType = std::stoi(row->col(1));
+        int objectType = row->col_int64(1);
         if (IS_CDS_CONTAINER(objectType))
-            containers.push_back(std::stol(row->col(0)));
+            containers.push_back(row->col_int64(0));
         else
-            items.push_back(std::stol(row->col(0)));
+            items.push_back(row->col_int64(0));
     }
 
     auto rr = _recursiveRemove(items, containers, all);
@@ -1347,7 +2192,7 @@ void SQLStorage::_removeObjects(const std::vector<int32_t> &objectIDs) {
 
     log_debug("%s\n", sel.str().c_str());
 
-    Ref<SQLResult> res = select(sel);
+    Ref<SQLResult> res = selectAll(sel);
     if (res != nullptr) {
         log_debug("relevant autoscans!\n");
         std::vector<std::string> delete_as;
@@ -1379,6 +2224,12 @@ void SQLStorage::_removeObjects(const std::vector<int32_t> &objectIDs) {
         }
     }
 
+    std::ostringstream qServiceState;
+    qServiceState << "DELETE FROM " << TQ(SERVICE_STATE_TABLE)
+                  << " WHERE " << TQ("object_id")
+                  << " IN (" << objectIdsStr << ')';
+    exec(qServiceState);
+
     std::ostringstream qActiveItem;
     qActiveItem << "DELETE FROM " << TQ(CDS_ACTIVE_ITEM_TABLE)
                 << " WHERE " << TQ("id")
@@ -1390,6 +2241,21 @@ void SQLStorage::_removeObjects(const std::vector<int32_t> &objectIDs) {
             << " WHERE " << TQ("id")
             << " IN (" << objectIdsStr << ')';
     exec(qObject);
+
+    if (browseIndex != nullptr)
+        browseIndex->objectsRemoved(objectIDs);
+    {
+        AutoLock lock(pathKeyMutex);
+        for (int32_t id : objectIDs)
+            pathKeys.erase(id);
+    }
+
+    // parents left without children are recorded by _purgeEmptyContainers
+    AutoLock lock(childStateMutex);
+    for (int32_t id : objectIDs) {
+        nonEmptyContainers.erase(id);
+        emptyContainers.erase(id);
+    }
 }
 
 std::unique_ptr<Storage::ChangedContainers> SQLStorage::removeObject(int objectID, bool all)
@@ -1405,16 +2271,12 @@ std::unique_ptr<Storage::ChangedContainers> SQLStorage::removeObject(int objectI
     if (row == nullptr)
         return nullptr;
 
-    int objectType = std::stoi(row->col(0));
+    int objectType = row->col_int64(0);
     bool isContainer = IS_CDS_CONTAINER(objectType);
     if (all && !isContainer) {
-        std::string ref_id_str = row->col(1);
-        int ref_id;
-        if (string_ok(ref_id_str)) {
-            ref_id = std::stoi(ref_id_str);
-            if (!IS_FORBIDDEN_CDS_ID(ref_id))
-                objectID = ref_id;
-        }
+        int ref_id = row->col_int64(1, INVALID_OBJECT_ID);
+        if (ref_id != INVALID_OBJECT_ID && !IS_FORBIDDEN_CDS_ID(ref_id))
+            objectID = ref_id;
     }
     if (IS_FORBIDDEN_CDS_ID(objectID))
         throw _Exception("tried to delete a forbidden ID (" + std::to_string(objectID) + ")!");
@@ -1469,7 +2331,7 @@ std::unique_ptr<Storage::ChangedContainers> SQLStorage::_recursiveRemove(
             throw _StorageException("", "sql error");
         parentIds.clear();
         while ((row = res->nextRow()) != nullptr) {
-            changedContainers->ui.push_back(std::stoi(row->col(0)));
+            changedContainers->ui.push_back(row->col_int64(0));
         }
     }
 
@@ -1485,7 +2347,7 @@ std::unique_ptr<Storage::ChangedContainers> SQLStorage::_recursiveRemove(
                 throw _StorageException("", std::string("sql error: ") + sql.str());
             parentIds.clear();
             while ((row = res->nextRow()) != nullptr) {
-                changedContainers->upnp.push_back(std::stoi(row->col(0)));
+                changedContainers->upnp.push_back(row->col_int64(0));
             }
         }
 
@@ -1497,8 +2359,8 @@ std::unique_ptr<Storage::ChangedContainers> SQLStorage::_recursiveRemove(
                 throw _StorageException("", std::string("sql error: ") + sql.str());
             itemIds.clear();
             while ((row = res->nextRow()) != nullptr) {
-                removeIds.push_back(std::stoi(row->col(0)));
-                changedContainers->upnp.push_back(std::stoi(row->col(1)));
+                removeIds.push_back(row->col_int64(0));
+                changedContainers->upnp.push_back(row->col_int64(1));
             }
         }
 
@@ -1510,24 +2372,24 @@ std::unique_ptr<Storage::ChangedContainers> SQLStorage::_recursiveRemove(
                 throw _StorageException("", std::string("sql error: ") + sql.str());
             containerIds.clear();
             while ((row = res->nextRow()) != nullptr) {
-                int objectType = std::stoi(row->col(1));
+                int objectType = row->col_int64(1);
                 if (IS_CDS_CONTAINER(objectType)) {
-                    containerIds.push_back(std::stoi(row->col(0)));
-                    removeIds.push_back(std::stoi(row->col(0)));
+                    containerIds.push_back(row->col_int64(0));
+                    removeIds.push_back(row->col_int64(0));
                 } else {
                     if (all) {
                         std::string refId = row->col(2);
                         if (string_ok(refId)) {
-                            parentIds.push_back(std::stoi(row->col(2)));
-                            itemIds.push_back(std::stoi(row->col(2)));
-                            removeIds.push_back(std::stoi(row->col(2)));
+                            parentIds.push_back(row->col_int64(2));
+                            itemIds.push_back(row->col_int64(2));
+                            removeIds.push_back(row->col_int64(2));
                         } else {
-                            removeIds.push_back(std::stoi(row->col(0)));
-                            itemIds.push_back(std::stoi(row->col(0)));
+                            removeIds.push_back(row->col_int64(0));
+                            itemIds.push_back(row->col_int64(0));
                         }
                     } else {
-                        removeIds.push_back(std::stoi(row->col(0)));
-                        itemIds.push_back(std::stoi(row->col(0)));
+                        removeIds.push_back(row->col_int64(0));
+                        itemIds.push_back(row->col_int64(0));
                     }
                 }
             }
@@ -1577,6 +2439,8 @@ std::unique_ptr<Storage::ChangedContainers> SQLStorage::_purgeEmptyContainers(st
     bufSelUpnp << selectSql.str();
 
     std::vector<int32_t> del;
+    // persistent containers left without children, with their parents
+    std::vector<std::pair<int32_t, int32_t>> emptied;
 
     Ref<SQLResult> res;
     std::unique_ptr<SQLRow> row;
@@ -1602,14 +2466,16 @@ std::unique_ptr<Storage::ChangedContainers> SQLStorage::_purgeEmptyContainers(st
             if (res == nullptr)
                 throw _Exception("db error");
             while ((row = res->nextRow()) != nullptr) {
-                int flags = std::stoi(row->col(3));
-                if (flags & OBJECT_FLAG_PERSISTENT_CONTAINER)
-                    changedContainers->upnp.push_back(std::stoi(row->col(0)));
-                else if (row->col(1) == "0") {
-                    del.push_back(std::stoi(row->col(0)));
-                    selUi.push_back(std::stoi(row->col(2)));
+                int flags = row->col_int64(3);
+                if (flags & OBJECT_FLAG_PERSISTENT_CONTAINER) {
+                    changedContainers->upnp.push_back(row->col_int64(0));
+                    if (row->col(1) == "0")
+                        emptied.emplace_back(row->col_int64(0), row->col_int64(2));
+                } else if (row->col(1) == "0") {
+                    del.push_back(row->col_int64(0));
+                    selUi.push_back(row->col_int64(2));
                 } else {
-                    selUpnp.push_back(std::stoi(row->col(0)));
+                    selUpnp.push_back(row->col_int64(0));
                 }
             }
         }
@@ -1623,15 +2489,17 @@ std::unique_ptr<Storage::ChangedContainers> SQLStorage::_purgeEmptyContainers(st
             if (res == nullptr)
                 throw _Exception("db error");
             while ((row = res->nextRow()) != nullptr) {
-                int flags = std::stoi(row->col(3));
+                int flags = row->col_int64(3);
                 if (flags & OBJECT_FLAG_PERSISTENT_CONTAINER) {
-                    changedContainers->ui.push_back(std::stoi(row->col(0)));
-                    changedContainers->upnp.push_back(std::stoi(row->col(0)));
+                    changedContainers->ui.push_back(row->col_int64(0));
+                    changedContainers->upnp.push_back(row->col_int64(0));
+                    if (row->col(1) == "0")
+                        emptied.emplace_back(row->col_int64(0), row->col_int64(2));
                 } else if (row->col(1) == "0") {
-                    del.push_back(std::stoi(row->col(0)));
-                    selUi.push_back(std::stoi(row->col(2)));
+                    del.push_back(row->col_int64(0));
+                    selUi.push_back(row->col_int64(2));
                 } else {
-                    selUi.push_back(std::stoi(row->col(0)));
+                    selUi.push_back(row->col_int64(0));
                 }
             }
         }
@@ -1647,6 +2515,15 @@ std::unique_ptr<Storage::ChangedContainers> SQLStorage::_purgeEmptyContainers(st
             throw _Exception("there seems to be an infinite loop...");
     } while (again);
 
+    if (!emptied.empty()) {
+        AutoLock lock(childStateMutex);
+        for (const auto& container : emptied) {
+            nonEmptyContainers.erase(container.first);
+            if (emptyContainers.size() < CHILD_STATE_CACHE_SIZE)
+                emptyContainers[container.first] = container.second;
+        }
+    }
+
     auto &changedUi = changedContainers->ui;
     auto &changedUpnp = changedContainers->upnp;
     if (!selUi.empty()) {
@@ -1671,13 +2548,24 @@ std::string SQLStorage::getInternalSetting(std::string key)
        << quote(key) << " LIMIT 1";
     Ref<SQLResult> res = select(q);
     if (res == nullptr)
-        return nullptr;
+        return "";
     std::unique_ptr<SQLRow> row = res->nextRow();
     if (row == nullptr)
-        return nullptr;
+        return "";
     return row->col(0);
 }
 
+bool SQLStorage::isMigrationDone(std::string name, int version)
+{
+    std::string done = getInternalSetting("migration_" + name);
+    return stoi_string(done, -1) >= version;
+}
+
+void SQLStorage::setMigrationDone(std::string name, int version)
+{
+    storeInternalSetting("migration_" + name, std::to_string(version));
+}
+
 void SQLStorage::updateAutoscanPersistentList(ScanMode scanmode, std::shared_ptr<AutoscanList> list)
 {
 
@@ -1723,7 +2611,7 @@ void SQLStorage::updateAutoscanPersistentList(ScanMode scanmode, std::shared_ptr
             throw _StorageException("", "query error while selecting from autoscan list");
         std::unique_ptr<SQLRow> row;
         if ((row = res->nextRow()) != nullptr) {
-            ad->setStorageID(std::stoi(row->col(0)));
+            ad->setStorageID(row->col_int64(0));
             updateAutoscanDirectory(ad);
         } else
             addAutoscanDirectory(ad);
@@ -1746,7 +2634,8 @@ Ref<AutoscanList> SQLStorage::getAutoscanList(ScanMode scanmode)
        << " LEFT JOIN " << TQ(CDS_OBJECT_TABLE) << ' ' << TQ('t')
        << " ON " FLD("obj_id") '=' << TQD('t', "id")
        << " WHERE " FLD("scan_mode") '=' << quote(AutoscanDirectory::mapScanmode(scanmode));
-    Ref<SQLResult> res = select(q);
+    // invalid entries are removed while the list is built
+    Ref<SQLResult> res = selectAll(q);
     if (res == nullptr)
         throw _StorageException("", "query error while fetching autoscan list");
 
@@ -1756,7 +2645,7 @@ Ref<AutoscanList> SQLStorage::getAutoscanList(ScanMode scanmode)
     while ((row = res->nextRow()) != nullptr) {
         Ref<AutoscanDirectory> dir = _fillAutoscanDirectory(row);
         if (dir == nullptr)
-            removeAutoscanDirectory(std::stoi(row->col(0)));
+            removeAutoscanDirectory(row->col_int64(0));
         else
             ret->add(dir);
     }
@@ -1787,11 +2676,8 @@ Ref<AutoscanDirectory> SQLStorage::getAutoscanDirectory(int objectID)
 
 Ref<AutoscanDirectory> SQLStorage::_fillAutoscanDirectory(const std::unique_ptr<SQLRow>& row)
 {
-    int objectID = INVALID_OBJECT_ID;
-    std::string objectIDstr = row->col(1);
-    if (string_ok(objectIDstr))
-        objectID = std::stoi(objectIDstr);
-    int storageID = std::stoi(row->col(0));
+    int objectID = stoi_string(row->col(1), INVALID_OBJECT_ID);
+    int storageID = row->col_int64(0);
 
     std::string location;
     if (objectID == INVALID_OBJECT_ID) {
@@ -1810,8 +2696,8 @@ Ref<AutoscanDirectory> SQLStorage::_fillAutoscanDirectory(const std::unique_ptr<
     bool persistent = remapBool(row->col(8));
     int interval = 0;
     if (mode == ScanMode::Timed)
-        interval = std::stoi(row->col(6));
-    time_t last_modified = std::stol(row->col(7));
+        interval = row->col_int64(6);
+    time_t last_modified = row->col_int64(7);
 
     //log_debug("adding autoscan location: %s; recursive: %d\n", location.c_str(), recursive);
 
@@ -1966,7 +2852,7 @@ int SQLStorage::_getAutoscanObjectID(int autoscanID)
         throw _StorageException("", "error while doing select on ");
     std::unique_ptr<SQLRow> row;
     if ((row = res->nextRow()) != nullptr && string_ok(row->col(0)))
-        return std::stoi(row->col(0));
+        return row->col_int64(0);
     return INVALID_OBJECT_ID;
 }
 
@@ -2006,12 +2892,26 @@ void SQLStorage::autoscanUpdateLM(Ref<AutoscanDirectory> adir)
 int SQLStorage::isAutoscanChild(int objectID)
 {
     auto pathIDs = getPathIDs(objectID);
-    if (pathIDs == nullptr)
+    if (pathIDs == nullptr || pathIDs->empty())
+        return INVALID_OBJECT_ID;
+
+    // one lookup for all ancestors, the nearest recursive autoscan owns the object
+    std::ostringstream q;
+    q << "SELECT " << TQ("obj_id")
+       << " FROM " << TQ(AUTOSCAN_TABLE)
+       << " WHERE " << TQ("obj_id") << " IN (" << toCSV(*pathIDs) << ')'
+       << " AND " << TQ("recursive") << '=' << mapBool(true);
+    Ref<SQLResult> res = select(q);
+    if (res == nullptr)
         return INVALID_OBJECT_ID;
 
+    std::unordered_set<int> owners;
+    std::unique_ptr<SQLRow> row;
+    while ((row = res->nextRow()) != nullptr)
+        owners.insert(row->col_int64(0, INVALID_OBJECT_ID));
+
     for (int pathId : *pathIDs) {
-        int recursive = isAutoscanDirectoryRecursive(pathId);
-        if (recursive == 2)
+        if (owners.find(pathId) != owners.end())
             return pathId;
     }
     return INVALID_OBJECT_ID;
@@ -2055,13 +2955,26 @@ std::unique_ptr<std::vector<int>> SQLStorage::_checkOverlappingAutoscans(Ref<Aut
     }
 
     if (adir->getRecursive()) {
+        std::string pathKey = getPathKey(checkObjectID);
         std::ostringstream q;
-        q << "SELECT " << TQ("obj_id")
-           << " FROM " << TQ(AUTOSCAN_TABLE)
-           << " WHERE " << TQ("path_ids") << " LIKE "
-           << quote("%," + std::to_string(checkObjectID) + ",%");
-        if (storageID >= 0)
-            q << " AND " << TQ("id") << " != " << quote(storageID);
+        if (string_ok(pathKey)) {
+            // autoscans on objects in the key range below the new one
+            q << "SELECT " << TQD("a", "obj_id")
+               << " FROM " << TQ(AUTOSCAN_TABLE) << ' ' << TQ("a")
+               << " JOIN " << TQ(CDS_OBJECT_TABLE) << ' ' << TQ("o")
+               << " ON " << TQD("o", "id") << '=' << TQD("a", "obj_id")
+               << " WHERE " << TQD("o", "path_key") << " > " << quote(pathKey)
+               << " AND " << TQD("o", "path_key") << " < " << quote(pathKeyUpperBound(pathKey));
+            if (storageID >= 0)
+                q << " AND " << TQD("a", "id") << " != " << quote(storageID);
+        } else {
+            q << "SELECT " << TQ("obj_id")
+               << " FROM " << TQ(AUTOSCAN_TABLE)
+               << " WHERE " << TQ("path_ids") << " LIKE "
+               << quote("%," + std::to_string(checkObjectID) + ",%");
+            if (storageID >= 0)
+                q << " AND " << TQ("id") << " != " << quote(storageID);
+        }
         q << " LIMIT 1";
 
         log_debug("------------ %s\n", q.str().c_str());
@@ -2070,7 +2983,7 @@ std::unique_ptr<std::vector<int>> SQLStorage::_checkOverlappingAutoscans(Ref<Aut
         if (res == nullptr)
             throw _Exception("SQL error");
         if ((row = res->nextRow()) != nullptr) {
-            int objectID = std::stoi(row->col(0));
+            int objectID = row->col_int64(0);
             log_debug("-------------- %d\n", objectID);
             auto obj = loadObject(objectID);
             if (obj == nullptr)
@@ -2099,7 +3012,7 @@ std::unique_ptr<std::vector<int>> SQLStorage::_checkOverlappingAutoscans(Ref<Aut
     if ((row = res->nextRow()) == nullptr)
         return pathIDs;
     else {
-        int objectID = std::stoi(row->col(0));
+        int objectID = row->col_int64(0);
         auto obj = loadObject(objectID);
         if (obj == nullptr)
             throw _Exception("Referenced object (by Autoscan) not found.");
@@ -2115,6 +3028,16 @@ std::unique_ptr<std::vector<int>> SQLStorage::getPathIDs(int objectID)
 
     auto pathIDs = make_unique<std::vector<int>>();
 
+    std::string pathKey = getPathKey(objectID);
+    if (string_ok(pathKey)) {
+        for (const auto& id : split_string(pathKey, ','))
+            pathIDs->push_back(stoi_string(id, INVALID_OBJECT_ID));
+        std::reverse(pathIDs->begin(), pathIDs->end());
+        return pathIDs;
+    }
+
+    // no key, walk up the parents
+
     std::ostringstream sel;
     sel << "SELECT " << TQ("parent_id") << " FROM " << TQ(CDS_OBJECT_TABLE) << " WHERE ";
     sel << TQ("id") << '=';
@@ -2128,11 +3051,82 @@ std::unique_ptr<std::vector<int>> SQLStorage::getPathIDs(int objectID)
         res = select(q);
         if (res == nullptr || (row = res->nextRow()) == nullptr)
             break;
-        objectID = std::stoi(row->col(0));
+        objectID = row->col_int64(0);
     }
     return pathIDs;
 }
 
+std::string SQLStorage::getPathKey(int objectID)
+{
+    unsigned long generation;
+    {
+        AutoLock lock(pathKeyMutex);
+        auto it = pathKeys.find(objectID);
+        if (it != pathKeys.end())
+            return it->second;
+        generation = pathKeyGeneration;
+    }
+
+    std::ostringstream q;
+    q << "SELECT " << TQ("path_key") << ',' << TQ("object_type")
+      << " FROM " << TQ(CDS_OBJECT_TABLE)
+      << " WHERE " << TQ("id") << '=' << objectID;
+    Ref<SQLResult> res = select(q);
+    std::unique_ptr<SQLRow> row;
+    if (res == nullptr || (row = res->nextRow()) == nullptr)
+        return "";
+
+    std::string pathKey = row->col(0);
+    if (IS_CDS_CONTAINER(row->col_int64(1, 0))) {
+        AutoLock lock(pathKeyMutex);
+        if (generation == pathKeyGeneration) {
+            if (pathKeys.size() >= PATH_KEY_CACHE_SIZE)
+                pathKeys.clear();
+            pathKeys[objectID] = pathKey;
+        }
+    }
+    return pathKey;
+}
+
+std::string SQLStorage::childPathKey(const std::string& parentKey, int objectID)
+{
+    if (!string_ok(parentKey))
+        return "";
+    std::string pathKey = parentKey + std::to_string(objectID) + ',';
+    return pathKey.length() <= PATH_KEY_MAX_LENGTH ? pathKey : "";
+}
+
+void SQLStorage::movePathKeys(const std::string& oldKey, const std::string& newKey)
+{
+    std::ostringstream column;
+    column << TQ("path_key");
+
+    std::ostringstream qb;
+    qb << "UPDATE " << TQ(CDS_OBJECT_TABLE) << " SET " << column.str() << '=';
+    if (string_ok(newKey)) {
+        // keys that would outgrow the column become unknown
+        long growth = static_cast<long>(newKey.length()) - static_cast<long>(oldKey.length());
+        qb << "CASE WHEN LENGTH(" << column.str() << ") + " << growth << " > " << PATH_KEY_MAX_LENGTH
+           << " THEN NULL ELSE "
+           << concatSQL({ quote(newKey), "SUBSTR(" + column.str() + ',' + std::to_string(oldKey.length() + 1) + ')' })
+           << " END";
+    } else {
+        qb << SQL_NULL;
+    }
+    qb << " WHERE " << column.str() << " > " << quote(oldKey)
+       << " AND " << column.str() << " < " << quote(pathKeyUpperBound(oldKey));
+    exec(qb);
+
+    AutoLock lock(pathKeyMutex);
+    pathKeys.clear();
+    pathKeyGeneration++;
+}
+
+std::string SQLStorage::concatSQL(const std::vector<std::string>& parts)
+{
+    return '(' + join(parts, " || ") + ')';
+}
+
 std::string SQLStorage::getFsRootName()
 {
     if (string_ok(fsRootName))
@@ -2151,68 +3145,224 @@ void SQLStorage::setFsRootName(std::string rootName)
     }
 }
 
-int SQLStorage::getNextID()
+int SQLStorage::takeID(IDBlock& block, const char* sequence)
 {
-    log_debug("NextId: %d\n", lastID + 1);
-    if (lastID < CDS_ID_FS_ROOT)
-        throw _Exception("SQLStorage::getNextID() called, but lastID hasn't been loaded correctly yet");
+    TransactionLock transaction(transactionMutex);
     AutoLock lock(nextIDMutex);
-    return ++lastID;
+    if (block.next == INVALID_OBJECT_ID || block.next >= block.end) {
+        block.next = reserveIDs(sequence, ID_BLOCK_SIZE);
+        block.end = block.next + ID_BLOCK_SIZE;
+        log_debug("Reserved %s IDs %d to %d\n", sequence, block.next, block.end - 1);
+    }
+    return block.next++;
 }
 
-void SQLStorage::loadLastID()
+int SQLStorage::getNextID()
 {
-    AutoLock lock(nextIDMutex);
+    int id = takeID(objectIDs, "object");
+    if (id <= CDS_ID_FS_ROOT)
+        throw _Exception("got an invalid object ID from the sequence (db not initialized?)");
+    return id;
+}
 
-    // we don't rely on automatic db generated ids, because of our caching
-    std::ostringstream qb;
-    qb << "SELECT MAX(" << TQ("id") << ')'
-        << " FROM " << TQ(CDS_OBJECT_TABLE);
-    Ref<SQLResult> res = select(qb);
-    if (res == nullptr)
-        throw _Exception("could not load lastID (res==nullptr)");
+int SQLStorage::getNextMetadataID()
+{
+    return takeID(metadataIDs, "metadata");
+}
 
-    std::unique_ptr<SQLRow> row = res->nextRow();
-    if (row == nullptr)
-        throw _Exception("could not load lastID (row==nullptr)");
+int SQLStorage::getMetadataPropertyID(const std::string& name)
+{
+    TransactionLock transaction(transactionMutex);
+    AutoLock lock(metadataDictionaryMutex);
+    auto it = metadataPropertyIDs.find(name);
+    if (it != metadataPropertyIDs.end())
+        return it->second;
 
-    lastID = std::stoi(row->col(0));
-    if (lastID < CDS_ID_FS_ROOT)
-        throw _Exception("could not load correct lastID (db not initialized?)");
+    std::ostringstream q;
+    q << "SELECT " << TQ("id")
+      << " FROM " << TQ(METADATA_PROPERTY_TABLE)
+      << " WHERE " << TQ("name") << '=' << quote(name);
+
+    int id = INVALID_OBJECT_ID;
+    for (int attempt = 0; attempt < 2 && id == INVALID_OBJECT_ID; attempt++) {
+        {
+            Ref<SQLResult> res = select(q);
+            std::unique_ptr<SQLRow> row;
+            if (res != nullptr && (row = res->nextRow()) != nullptr)
+                id = row->col_int64(0, INVALID_OBJECT_ID);
+        }
+        if (id != INVALID_OBJECT_ID)
+            break;
+
+        std::ostringstream ins;
+        ins << "INSERT INTO " << TQ(METADATA_PROPERTY_TABLE)
+            << " (" << TQ("name") << ") VALUES (" << quote(name) << ')';
+        try {
+            id = exec(ins, true);
+        } catch (const StorageException&) {
+            // another writer added the same name, look it up again
+            if (attempt > 0)
+                throw;
+        }
+    }
 
-    log_debug("LoadedId: %d\n", lastID);
+    metadataPropertyIDs[name] = id;
+    return id;
 }
 
-int SQLStorage::getNextMetadataID()
+int SQLStorage::getMetadataValueID(const std::string& value)
 {
-    if (lastMetadataID < CDS_ID_ROOT)
-        throw _Exception("SQLStorage::getNextMetadataID() called, but lastMetadataID hasn't been loaded correctly yet");
+    TransactionLock transaction(transactionMutex);
+    AutoLock lock(metadataDictionaryMutex);
+    auto it = metadataValueIDs.find(value);
+    if (it != metadataValueIDs.end())
+        return it->second;
 
-    AutoLock lock(nextIDMutex);
-    return ++lastMetadataID;
+    unsigned int hash = metadataValueHash(value);
+    std::ostringstream q;
+    q << "SELECT " << TQ("id")
+      << " FROM " << TQ(METADATA_VALUE_TABLE)
+      << " WHERE " << TQ("value_hash") << '=' << hash
+      << " AND " << TQ("value") << '=' << quote(value);
+    auto find = [&]() {
+        Ref<SQLResult> res = select(q);
+        std::unique_ptr<SQLRow> row;
+        if (res != nullptr && (row = res->nextRow()) != nullptr)
+            return int(row->col_int64(0, INVALID_OBJECT_ID));
+        return INVALID_OBJECT_ID;
+    };
+    int id = find();
+    if (id == INVALID_OBJECT_ID) {
+        // (value_hash, value) is unique, when another writer added the value
+        // meanwhile the insert is skipped and its ID is looked up instead
+        std::ostringstream ins;
+        ins << insertIgnoreSQL() << " INTO " << TQ(METADATA_VALUE_TABLE)
+            << " (" << TQ("value_hash") << ',' << TQ("value")
+            << ") VALUES (" << hash << ',' << quote(value) << ')';
+        exec(ins);
+        id = find();
+        if (id == INVALID_OBJECT_ID)
+            throw _StorageException("", "could not add metadata value " + value);
+    }
+
+    if (metadataValueIDs.size() >= METADATA_VALUE_CACHE_SIZE)
+        metadataValueIDs.clear();
+    metadataValueIDs[value] = id;
+    return id;
 }
 
-// if metadata table becomes first-class then should have a parameterized loadLastID()
-// to be called for either mt_cds_object or mt_metadata
-void SQLStorage::loadLastMetadataID()
+// cuts a value to the given number of UTF-8 characters, as the width of a
+// varchar column counts characters, not bytes
+static std::string truncateUTF8(const std::string& value, size_t length)
 {
-    AutoLock lock(nextIDMutex);
+    size_t chars = 0;
+    for (size_t pos = 0; pos < value.length(); pos++) {
+        // continuation bytes belong to the character before
+        if ((value[pos] & 0xc0) != 0x80 && chars++ == length)
+            return value.substr(0, pos);
+    }
+    return value;
+}
+
+void SQLStorage::setMetadataColumns(std::map<std::string,std::string>& cdsObjectSql,
+    const std::map<std::string,std::string>& metadata, bool isUpdate)
+{
+    for (const auto& column : getMetadataColumns()) {
+        auto it = metadata.find(column.first);
+        if (it != metadata.end() && string_ok(it->second))
+            cdsObjectSql[column.second] = quote(truncateUTF8(it->second, METADATA_COLUMN_LENGTH));
+        else if (isUpdate)
+            cdsObjectSql[column.second] = SQL_NULL;
+    }
+}
+
+void SQLStorage::insertMetadata(int objectID, const std::map<std::string,std::string>& metadata)
+{
+    // containers created while an object is added have no metadata, the
+    // lock of addObject() is not taken twice
+    if (metadata.empty())
+        return;
 
-    // we don't rely on automatic db generated ids, because of our caching
+    TransactionLock transaction(transactionMutex);
     std::ostringstream qb;
-    qb << "SELECT MAX(" << TQ("id") << ')'
-        << " FROM " << TQ(METADATA_TABLE);
-    Ref<SQLResult> res = select(qb);
-    if (res == nullptr)
-        throw _Exception("could not load lastMetadataID (res==nullptr)");
+    qb << "INSERT INTO " << TQ(METADATA_TABLE) << " ("
+       << TQ("id") << ','
+       << TQ("item_id") << ','
+       << TQ("property_id") << ','
+       << TQ("value_id") << ") VALUES ";
+    for (auto it = metadata.begin(); it != metadata.end(); it++) {
+        if (it != metadata.begin())
+            qb << ',';
+        qb << '(' << getNextMetadataID() << ','
+           << objectID << ','
+           << getMetadataPropertyID(it->first) << ','
+           << getMetadataValueID(it->second) << ')';
+    }
+    exec(qb);
+}
 
-    std::unique_ptr<SQLRow> row = res->nextRow();
-    if (row == nullptr)
-        throw _Exception("could not load lastMetadataID (row==nullptr)");
+bool SQLStorage::maintenanceStep()
+{
+    switch (maintenancePhase) {
+    case MaintenancePhase::PruneValues:
+        if (!pruneMetadataValues())
+            maintenancePhase = MaintenancePhase::ReclaimSpace;
+        return true;
+    case MaintenancePhase::ReclaimSpace:
+        if (!reclaimSpace()) {
+            maintenancePhase = MaintenancePhase::UpdateStatistics;
+            statisticsStep = 0;
+        }
+        return true;
+    case MaintenancePhase::UpdateStatistics:
+        if (updateStatistics(statisticsStep++))
+            return true;
+        break;
+    }
+    maintenancePhase = MaintenancePhase::PruneValues;
+    return false;
+}
+
+bool SQLStorage::pruneMetadataValues()
+{
+    if (pruneEnd < 0) {
+        std::ostringstream q;
+        q << "SELECT MAX(" << TQ("id") << ") FROM " << TQ(METADATA_VALUE_TABLE);
+        Ref<SQLResult> res = select(q);
+        std::unique_ptr<SQLRow> row;
+        pruneEnd = (res != nullptr && (row = res->nextRow()) != nullptr) ? row->col_int64(0, 0) : 0;
+        pruneNext = 0;
+    }
+    if (pruneNext >= pruneEnd) {
+        pruneEnd = -1;
+        return false;
+    }
 
-    lastMetadataID = stoi_string(row->col(0));
-    if (lastMetadataID < CDS_ID_ROOT)
-        throw _Exception("could not load correct lastMetadataID (db not initialized?)");
+    int last = std::min(pruneNext + METADATA_PRUNE_RANGE, pruneEnd);
+    std::ostringstream del;
+    del << "DELETE FROM " << TQ(METADATA_VALUE_TABLE)
+        << " WHERE " << TQ("id") << " > " << pruneNext << " AND " << TQ("id") << " <= " << last
+        << " AND NOT EXISTS (SELECT 1 FROM " << TQ(METADATA_TABLE)
+        << " WHERE " << TQ(METADATA_TABLE) << '.' << TQ("value_id") << '=' << TQ(METADATA_VALUE_TABLE) << '.' << TQ("id") << ')';
+    {
+        // no writer holds a value ID it has not written yet; the cache is
+        // cleared with the rows, so a pruned ID is never handed out again
+        TransactionLock transaction(transactionMutex);
+        AutoLock lock(metadataDictionaryMutex);
+        exec(del);
+        metadataValueIDs.clear();
+    }
+    pruneNext = last;
+    return true;
+}
+
+bool SQLStorage::updateStatistics(int step)
+{
+    static const char* tables[] = { CDS_OBJECT_TABLE, METADATA_TABLE, METADATA_VALUE_TABLE, METADATA_PROPERTY_TABLE, AUTOSCAN_TABLE };
+    if (step < 0 || size_t(step) >= sizeof(tables) / sizeof(tables[0]))
+        return false;
+    analyzeTable(tables[step]);
+    return size_t(step) + 1 < sizeof(tables) / sizeof(tables[0]);
 }
 
 void SQLStorage::clearFlagInDB(int flag)
@@ -2238,26 +3388,29 @@ void SQLStorage::generateMetadataDBOperations(std::shared_ptr<CdsObject> obj, bo
     if (!isUpdate) {
         for (auto it = dict.begin(); it != dict.end(); it++) {
             std::map<std::string,std::string> metadataSql;
-            metadataSql["property_name"] = quote(it->first);
-            metadataSql["property_value"] = quote(it->second);
+            metadataSql["property_id"] = quote(getMetadataPropertyID(it->first));
+            metadataSql["value_id"] = quote(getMetadataValueID(it->second));
             operations->append(Ref<AddUpdateTable>(new AddUpdateTable(METADATA_TABLE, metadataSql, "insert")));
         }
     } else {
         // get current metadata from DB: if only it really was a dictionary...
         auto dbMetadata = retrieveMetadataForObject(obj->getID());
         for (auto it = dict.begin(); it != dict.end(); it++) {
-            std::string operation = dbMetadata.find(it->first) == dbMetadata.end() ? "insert" : "update";
+            auto dbValue = dbMetadata.find(it->first);
+            if (dbValue != dbMetadata.end() && dbValue->second == it->second)
+                continue;
+            std::string operation = dbValue == dbMetadata.end() ? "insert" : "update";
             std::map<std::string,std::string> metadataSql;
-            metadataSql["property_name"] = quote(it->first);
-            metadataSql["property_value"] = quote(it->second);
+            metadataSql["property_id"] = quote(getMetadataPropertyID(it->first));
+            metadataSql["value_id"] = quote(getMetadataValueID(it->second));
             operations->append(Ref<AddUpdateTable>(new AddUpdateTable(METADATA_TABLE, metadataSql, operation)));
         }
         for (auto it = dbMetadata.begin(); it != dbMetadata.end(); it++) {
             if (dict.find(it->first) == dict.end()) {
                 // key in db metadata but not obj metadata, so needs a delete
                 std::map<std::string,std::string> metadataSql;
-                metadataSql["property_name"] = quote(it->first);
-                metadataSql["property_value"] = quote(it->second);
+                metadataSql["property_id"] = quote(getMetadataPropertyID(it->first));
+                metadataSql["value_id"] = quote(INVALID_OBJECT_ID);
                 operations->append(Ref<AddUpdateTable>(new AddUpdateTable(METADATA_TABLE, metadataSql, "delete")));
             }
         }
@@ -2296,6 +3449,10 @@ std::unique_ptr<std::ostringstream> SQLStorage::sqlForInsert(std::shared_ptr<Cds
         obj->setID(lastInsertID);
         fields << ',' << TQ("id");
         values << ',' << quote(lastInsertID);
+
+        std::string pathKey = childPathKey(getPathKey(obj->getParentID()), lastInsertID);
+        fields << ',' << TQ("path_key");
+        values << ',' << (string_ok(pathKey) ? quote(pathKey) : SQL_NULL);
     }
     if (tableName == METADATA_TABLE) {
         lastMetadataInsertID = getNextMetadataID();
@@ -2322,6 +3479,15 @@ std::unique_ptr<std::ostringstream> SQLStorage::sqlForUpdate(std::shared_ptr<Cds
 
     auto qb = std::make_unique<std::ostringstream>();
     *qb << "UPDATE " << TQ(tableName) << " SET ";
+
+    // metadata rows are identified by object and property
+    if (tableName == METADATA_TABLE) {
+        *qb << TQ("value_id") << '=' << dict["value_id"]
+            << " WHERE " << TQ("item_id") << " = " << obj->getID()
+            << " AND " << TQ("property_id") << " = " << dict["property_id"];
+        return qb;
+    }
+
     for (auto it = dict.begin(); it != dict.end(); it++) {
         if (it != dict.begin())
             *qb << ',';
@@ -2330,10 +3496,6 @@ std::unique_ptr<std::ostringstream> SQLStorage::sqlForUpdate(std::shared_ptr<Cds
     }
     *qb << " WHERE " << TQ("id") << " = " << obj->getID();
 
-    // relying on only one element when table is mt_metadata
-    if (tableName == METADATA_TABLE)
-        *qb << " AND " << TQ("property_name") << " = " <<  dict.begin()->first;
-
     return qb;
 }
 
@@ -2347,18 +3509,30 @@ std::unique_ptr<std::ostringstream> SQLStorage::sqlForDelete(std::shared_ptr<Cds
     auto dict = addUpdateTable->getDict();
 
     auto qb = std::make_unique<std::ostringstream>();
-    *qb << "DELETE FROM " << TQ(tableName)
-        << " WHERE " << TQ("id") << " = " << obj->getID();
-    
-    // relying on only one element when table is mt_metadata
+    *qb << "DELETE FROM " << TQ(tableName);
+
+    // metadata rows are identified by object and property
     if (tableName == METADATA_TABLE)
-        *qb << " AND " << TQ("property_name") << " = " <<  dict.begin()->first;
-    
+        *qb << " WHERE " << TQ("item_id") << " = " << obj->getID()
+            << " AND " << TQ("property_id") << " = " << dict["property_id"];
+    else
+        *qb << " WHERE " << TQ("id") << " = " << obj->getID();
+
     return qb;
 }
 
 void SQLStorage::doMetadataMigration()
 {
+    migrateMetadataDictionary();
+    migrateMetadataColumns();
+    migratePathKeys();
+
+    // counting the rows is a full scan on large databases, do it only once
+    if (isMigrationDone("metadata", METADATA_MIGRATION_VERSION)) {
+        log_debug("Metadata migration already done\n");
+        return;
+    }
+
     log_debug("Checking if metadata migration is required\n");
     std::ostringstream qbCountNotNull;
     qbCountNotNull << "SELECT COUNT(*)"
@@ -2366,18 +3540,19 @@ void SQLStorage::doMetadataMigration()
        << " WHERE " << TQ("metadata")
        << " is not null";
     Ref<SQLResult> res = select(qbCountNotNull);
-    int expectedConversionCount = std::stoi(res->nextRow()->col(0));
+    int expectedConversionCount = res->nextRow()->col_int64(0);
     log_debug("mt_cds_object rows having metadata: %d\n", expectedConversionCount);
 
     std::ostringstream qbCountMetadata;
     qbCountMetadata << "SELECT COUNT(*)"
        << " FROM " << TQ(METADATA_TABLE);
     res = select(qbCountMetadata);
-    int metadataRowCount = std::stoi(res->nextRow()->col(0));
+    int metadataRowCount = res->nextRow()->col_int64(0);
     log_debug("mt_metadata rows having metadata: %d\n", metadataRowCount);
 
     if (expectedConversionCount > 0 && metadataRowCount > 0) {
         log_info("No metadata migration required\n");
+        setMigrationDone("metadata", METADATA_MIGRATION_VERSION);
         return;
     }
 
@@ -2389,16 +3564,17 @@ void SQLStorage::doMetadataMigration()
        << " FROM " << TQ(CDS_OBJECT_TABLE)
        << " WHERE " << TQ("metadata")
        << " is not null";
-    Ref<SQLResult> resIds = select(qbRetrieveIDs);
+    Ref<SQLResult> resIds = selectAll(qbRetrieveIDs);
     std::unique_ptr<SQLRow> row;
 
     int objectsUpdated = 0;
     while ((row = resIds->nextRow()) != nullptr) {
-        auto cdsObject = loadObject(std::stoi(row->col(0)));
+        auto cdsObject = loadObject(row->col_int64(0));
         migrateMetadata(cdsObject);
         ++objectsUpdated;
     }
     log_info("Migrated metadata - object count: %d\n", objectsUpdated);
+    setMigrationDone("metadata", METADATA_MIGRATION_VERSION);
 }
 
 void SQLStorage::migrateMetadata(std::shared_ptr<CdsObject> object)
@@ -2409,30 +3585,177 @@ void SQLStorage::migrateMetadata(std::shared_ptr<CdsObject> object)
     auto dict = object->getMetadata();
     if (!dict.empty()) {
         log_debug("Migrating metadata for cds object %d\n", object->getID());
-        std::map<std::string,std::string> metadataSQLVals;
-        for (auto it = dict.begin(); it != dict.end(); it++) {
-            metadataSQLVals[quote(it->first)] = quote(it->second);
+        insertMetadata(object->getID(), dict);
+    } else {
+        log_debug("Skipping migration - no metadata for cds object %d\n", object->getID());
+    }
+}
+
+void SQLStorage::migrateMetadataDictionary()
+{
+    if (isMigrationDone("metadata_dictionary", METADATA_DICTIONARY_MIGRATION_VERSION))
+        return;
+
+    log_info("Moving metadata into the property and value dictionary, this may take a while\n");
+
+    // rows copied by an interrupted run are copied again
+    std::ostringstream del;
+    del << "DELETE FROM " << TQ(METADATA_TABLE);
+    exec(del);
+
+    struct LegacyRow {
+        int id;
+        int itemID;
+        std::string name;
+        std::string value;
+    };
+    std::vector<LegacyRow> batch;
+    batch.reserve(METADATA_DICTIONARY_BATCH_SIZE);
+    int lastID = -1;
+    long long moved = 0;
+
+    while (true) {
+        batch.clear();
+        {
+            std::ostringstream q;
+            q << "SELECT " << TQ("id") << ',' << TQ("item_id") << ','
+              << TQ("property_name") << ',' << TQ("property_value")
+              << " FROM " << TQ(METADATA_LEGACY_TABLE)
+              << " WHERE " << TQ("id") << '>' << lastID
+              << " ORDER BY " << TQ("id")
+              << " LIMIT " << METADATA_DICTIONARY_BATCH_SIZE;
+            Ref<SQLResult> res = select(q);
+            std::unique_ptr<SQLRow> row;
+            while (res != nullptr && (row = res->nextRow()) != nullptr) {
+                batch.push_back({ static_cast<int>(row->col_int64(0, INVALID_OBJECT_ID)),
+                    static_cast<int>(row->col_int64(1, INVALID_OBJECT_ID)),
+                    row->col(2), row->col(3) });
+            }
+        }
+        if (batch.empty())
+            break;
+
+        // the IDs are kept, the metadata sequence already covers them
+        TransactionLock transaction(transactionMutex);
+        std::ostringstream ins;
+        ins << "INSERT INTO " << TQ(METADATA_TABLE) << " ("
+            << TQ("id") << ','
+            << TQ("item_id") << ','
+            << TQ("property_id") << ','
+            << TQ("value_id") << ") VALUES ";
+        for (size_t i = 0; i < batch.size(); i++) {
+            if (i > 0)
+                ins << ',';
+            ins << '(' << batch[i].id << ','
+                << batch[i].itemID << ','
+                << getMetadataPropertyID(batch[i].name) << ','
+                << getMetadataValueID(batch[i].value) << ')';
         }
+        exec(ins);
+
+        lastID = batch.back().id;
+        moved += batch.size();
+        log_debug("Moved %lld metadata rows\n", moved);
+    }
+
+    std::ostringstream drop;
+    drop << "DROP TABLE " << TQ(METADATA_LEGACY_TABLE);
+    exec(drop);
+
+    setMigrationDone("metadata_dictionary", METADATA_DICTIONARY_MIGRATION_VERSION);
+    log_info("Moved %lld metadata rows into the dictionary\n", moved);
+}
+
+void SQLStorage::migrateMetadataColumns()
+{
+    if (isMigrationDone("metadata_columns", METADATA_COLUMNS_MIGRATION_VERSION))
+        return;
+
+    log_info("Copying searched metadata into columns of %s\n", CDS_OBJECT_TABLE);
+    for (const auto& column : getMetadataColumns()) {
+        int propertyID = getMetadataPropertyID(column.first);
+        std::ostringstream qb;
+        qb << "UPDATE " << TQ(CDS_OBJECT_TABLE)
+           << " SET " << TQ(column.second) << "=(SELECT SUBSTR(" << TQD('v', "value") << ",1," << METADATA_COLUMN_LENGTH << ')'
+           << " FROM " << TQ(METADATA_TABLE) << ' ' << TQ('m')
+           << " JOIN " << TQ(METADATA_VALUE_TABLE) << ' ' << TQ('v')
+           << " ON " << TQD('v', "id") << '=' << TQD('m', "value_id")
+           << " WHERE " << TQD('m', "item_id") << '=' << TQD(CDS_OBJECT_TABLE, "id")
+           << " AND " << TQD('m', "property_id") << '=' << propertyID
+           << " LIMIT 1)"
+           << " WHERE " << TQ("id") << " IN (SELECT " << TQ("item_id")
+           << " FROM " << TQ(METADATA_TABLE)
+           << " WHERE " << TQ("property_id") << '=' << propertyID << ')';
+        exec(qb);
+    }
+    setMigrationDone("metadata_columns", METADATA_COLUMNS_MIGRATION_VERSION);
+}
+
+void SQLStorage::migratePathKeys()
+{
+    if (isMigrationDone("path_keys", PATH_KEYS_MIGRATION_VERSION))
+        return;
 
-        for (auto it = metadataSQLVals.begin(); it != metadataSQLVals.end(); it++) {
-            std::ostringstream fields, values;
-            fields << TQ("id") << ','
-                    << TQ("item_id") << ','
-                    << TQ("property_name") << ','
-                    << TQ("property_value");
-            values << getNextMetadataID() << ','
-                    << object->getID() << ','
-                    << it->first << ','
-                    << it->second;
-            std::ostringstream qb;
-            qb << "INSERT INTO " << TQ(METADATA_TABLE)
-               << " (" << fields.str()
-               << ") VALUES (" << values.str() << ')';
-
-
-            exec(qb);
+    log_info("Computing the path keys of all objects, this may take a while\n");
+
+    // containers are few compared to items, their keys are computed in memory
+    std::unordered_map<int, int> parents;
+    {
+        std::ostringstream q;
+        q << "SELECT " << TQ("id") << ',' << TQ("parent_id")
+          << " FROM " << TQ(CDS_OBJECT_TABLE)
+          << " WHERE (" << TQ("object_type") << " & " << quote(OBJECT_TYPE_CONTAINER) << ") = "
+          << quote(OBJECT_TYPE_CONTAINER);
+        Ref<SQLResult> res = select(q);
+        std::unique_ptr<SQLRow> row;
+        while (res != nullptr && (row = res->nextRow()) != nullptr)
+            parents[row->col_int64(0, INVALID_OBJECT_ID)] = row->col_int64(1, INVALID_OBJECT_ID);
+    }
+
+    std::unordered_map<int, std::string> keys;
+    keys[CDS_ID_ROOT] = ",";
+    auto keyOf = [&](int containerID) {
+        std::vector<int> chain;
+        int id = containerID;
+        while (keys.find(id) == keys.end()) {
+            auto parent = parents.find(id);
+            // orphans and cycles get no key
+            if (parent == parents.end() || chain.size() > parents.size()) {
+                keys[id] = "";
+                break;
+            }
+            chain.push_back(id);
+            id = parent->second;
         }
-    } else {
-        log_debug("Skipping migration - no metadata for cds object %d\n", object->getID());
+        std::string pathKey = keys[id];
+        for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+            pathKey = childPathKey(pathKey, *it);
+            keys[*it] = pathKey;
+        }
+        return keys[containerID];
+    };
+
+    std::ostringstream root;
+    root << "UPDATE " << TQ(CDS_OBJECT_TABLE)
+         << " SET " << TQ("path_key") << '=' << quote(keys[CDS_ID_ROOT])
+         << " WHERE " << TQ("id") << '=' << CDS_ID_ROOT;
+    exec(root);
+
+    std::ostringstream idColumn;
+    idColumn << TQ("id");
+    for (const auto& container : parents) {
+        std::string pathKey = keyOf(container.first);
+        // children whose key might not fit stay unknown
+        if (!string_ok(pathKey) || pathKey.length() + 11 > PATH_KEY_MAX_LENGTH)
+            continue;
+        std::ostringstream q;
+        q << "UPDATE " << TQ(CDS_OBJECT_TABLE)
+          << " SET " << TQ("path_key") << '=' << concatSQL({ quote(pathKey), idColumn.str(), quote(",") })
+          << " WHERE " << TQ("parent_id") << '=' << container.first
+          << " AND " << TQ("id") << "!=" << container.first;
+        exec(q);
     }
+
+    setMigrationDone("path_keys", PATH_KEYS_MIGRATION_VERSION);
+    log_info("Computed the path keys below %zu containers\n", parents.size());
 }
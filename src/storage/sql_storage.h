@@ -35,10 +35,16 @@
 #include "zmm/zmmf.h"
 #include "cds_objects.h"
 #include "storage.h"
+#include "sql_profiler.h"
+#include "cds_tree_index.h"
 
+#include <cstdlib>
+#include <unordered_map>
 #include <unordered_set>
 #include <mutex>
 #include <sstream>
+#include <string_view>
+#include <tuple>
 
 #define QTB                 table_quote_begin
 #define QTE                 table_quote_end
@@ -48,6 +54,13 @@
 #define INTERNAL_SETTINGS_TABLE     "mt_internal_setting"
 #define AUTOSCAN_TABLE              "mt_autoscan"
 #define METADATA_TABLE              "mt_metadata"
+#define METADATA_PROPERTY_TABLE     "mt_metadata_property"
+#define METADATA_VALUE_TABLE        "mt_metadata_value"
+#define METADATA_VIEW               "mt_metadata_view"
+#define METADATA_LEGACY_TABLE       "mt_metadata_legacy"
+#define SERVICE_STATE_TABLE         "mt_service_state"
+#define SEQUENCE_TABLE              "mt_sequence"
+#define CHANGE_LOG_TABLE            "mt_change_log"
 
 class SQLResult;
 class SQLEmitter;
@@ -64,6 +77,20 @@ public:
         return std::string(c);
     }
     virtual char* col_c_str(int index) = 0;
+    /// \brief column value without copying, valid as long as the row; empty for NULL
+    virtual std::string_view col_view(int index)
+    {
+        char* c = col_c_str(index);
+        if (c == 0) return std::string_view();
+        return std::string_view(c);
+    }
+    /// \brief column value as integer, defaultValue for NULL
+    virtual long long col_int64(int index, long long defaultValue = 0)
+    {
+        char* c = col_c_str(index);
+        if (c == 0) return defaultValue;
+        return std::strtoll(c, nullptr, 10);
+    }
 protected:
     zmm::Ref<SQLResult> sqlResult;
 };
@@ -74,7 +101,6 @@ public:
     //SQLResult();
     //virtual ~SQLResult();
     virtual std::unique_ptr<SQLRow> nextRow() = 0;
-    virtual unsigned long long getNumRows() = 0;
 };
 
 class SQLStorage : public Storage
@@ -90,8 +116,9 @@ public:
     virtual std::string quote(bool val) = 0;
     virtual std::string quote(char val) = 0;
     virtual std::string quote(long long val) = 0;
-    virtual zmm::Ref<SQLResult> select(const char *query, int length) = 0;
-    virtual int exec(const char *query, int length, bool getLastInsertId = false) = 0;
+    /// \brief run a query through the driver, timed by the profiler if enabled
+    zmm::Ref<SQLResult> select(const char *query, int length);
+    int exec(const char *query, int length, bool getLastInsertId = false);
     
     void dbReady();
     
@@ -102,12 +129,15 @@ public:
         auto s = buf.str();
         return select(s.c_str(), s.length());
     }
+    /// \brief like select(), but reads all rows before it returns, for loops
+    /// that write to the database while they iterate over the result
+    zmm::Ref<SQLResult> selectAll(const std::ostringstream &buf);
     int exec(const std::ostringstream &buf, bool getLastInsertId = false) {
         auto s = buf.str();
         return exec(s.c_str(), s.length(), getLastInsertId);
     }
     
-    virtual void addObject(std::shared_ptr<CdsObject> object, int *changedContainer) override;
+    virtual void addObject(std::shared_ptr<CdsObject> object, int *changedContainer, int *changedGrandparent = nullptr) override;
     virtual void updateObject(std::shared_ptr<CdsObject> object, int *changedContainer) override;
     
     virtual std::shared_ptr<CdsObject> loadObject(int objectID) override;
@@ -120,6 +150,11 @@ public:
     
     virtual std::shared_ptr<CdsObject> loadObjectByServiceID(std::string serviceID) override;
     virtual std::unique_ptr<std::vector<int>> getServiceObjectIDs(char servicePrefix) override;
+    virtual std::unique_ptr<std::vector<int>> getFileItemIDs(std::string mimeTypePrefix) override;
+    virtual std::unique_ptr<std::unordered_map<std::string, ServiceState>> getServiceState(char servicePrefix) override;
+    virtual void touchServiceObjects(const std::vector<int>& objectIDs, time_t seen) override;
+    virtual void storeServiceState(char servicePrefix, const std::map<std::string, std::string>& hashes, time_t seen) override;
+    virtual std::unique_ptr<std::unordered_set<int>> getStaleServiceObjects(char servicePrefix, time_t seenBefore) override;
 
     virtual std::string findFolderImage(int id, std::string trackArtBase) override;
     
@@ -135,6 +170,7 @@ public:
     virtual std::shared_ptr<CdsObject> findObjectByPath(std::string fullpath) override;
     virtual int findObjectIDByPath(std::string fullpath) override;
     virtual std::string incrementUpdateIDs(const std::unique_ptr<std::unordered_set<int>>& ids) override;
+    virtual std::string getChangesSince(int& lastChangeID) override;
 
     virtual std::string buildContainerPath(int parentID, std::string title) override;
     virtual void addContainerChain(std::string path, std::string lastClass, int lastRefID, int *containerID, int *updateID, const std::map<std::string,std::string>& lastMetadata) override;
@@ -165,13 +201,81 @@ public:
     
     virtual void clearFlagInDB(int flag) override;
 
+    virtual std::shared_ptr<SQLProfiler> getProfiler() override { return profiler; }
+
+    virtual bool maintenanceStep() override;
+
+    virtual void beginTransaction() override;
+    virtual void commitTransaction() override;
+    virtual void rollbackTransaction() override;
+
 protected:
     SQLStorage(std::shared_ptr<ConfigManager> config);
     //virtual ~SQLStorage();
     virtual void init();
 
+    /* driver implementations of select and exec */
+    virtual zmm::Ref<SQLResult> doSelect(const char *query, int length) = 0;
+    virtual int doExec(const char *query, int length, bool getLastInsertId) = 0;
+
+    /// \brief returns the query plan for the slow query log, empty if unsupported
+    virtual std::string explainQuery(const char *query) { return ""; }
+
+    /// \brief SQL expression concatenating the given expressions as text
+    virtual std::string concatSQL(const std::vector<std::string>& parts);
+
+    /// \brief whether text columns are ordered by their bytes, so that the
+    /// browse index can sort added children in as the database would
+    virtual bool orderedByBytes() { return false; }
+
+    /// \brief statement starting a transaction
+    virtual const char *beginTransactionSQL() { return "BEGIN TRANSACTION"; }
+    /// \brief start of an INSERT that skips rows violating a unique key
+    virtual const char *insertIgnoreSQL() { return "INSERT OR IGNORE"; }
+    /// \brief Called by the thread of a transaction after its outermost
+    /// commit or rollback, before other threads may run statements.
+    virtual void transactionEnded() { }
+
+    /// \brief Reserves count consecutive IDs of a sequence in mt_sequence,
+    /// atomically with regard to other writers. Called with the transaction
+    /// lock held.
+    /// \return the first reserved ID
+    virtual int reserveIDs(const char *sequence, int count) = 0;
+
+    std::shared_ptr<SQLProfiler> profiler;
+
     void doMetadataMigration() override;
     void migrateMetadata(std::shared_ptr<CdsObject> object);
+    /// \brief Moves the rows of mt_metadata_legacy, left by the schema
+    /// upgrade, into the property and value dictionary.
+    void migrateMetadataDictionary();
+    /// \brief Fills the metadata columns of mt_cds_object added by the
+    /// schema upgrade from the metadata rows.
+    void migrateMetadataColumns();
+    /// \brief Computes the path keys of all objects after the schema upgrade.
+    void migratePathKeys();
+
+    /// \brief One time migrations record their version as
+    /// "migration_<name>" in the internal settings, so they are skipped on
+    /// the next start.
+    bool isMigrationDone(std::string name, int version);
+    void setMigrationDone(std::string name, int version);
+
+    /* maintenance steps of the drivers, each one must return quickly */
+    /// \brief Returns a batch of free pages to the file system.
+    /// \return true if more free pages are left
+    virtual bool reclaimSpace() { return false; }
+    /// \brief Refreshes the planner statistics, one table per step.
+    /// \param step number of the call in this round, starting at 0
+    /// \return true if more tables are left
+    virtual bool updateStatistics(int step);
+    virtual void analyzeTable(const std::string& table) = 0;
+
+    /// \brief Deletes the change log entries older than the given time and
+    /// records the newest deleted id for the reader nodes.
+    void pruneChangeLog(time_t changedBefore);
+    /// \brief Returns the newest change id pruned by the writer, 0 if none.
+    int getChangeLogPruned();
     
     char table_quote_begin;
     char table_quote_end;
@@ -251,20 +355,145 @@ private:
     
     std::string fsRootName;
     
-    int lastID;
-    
+    /// \brief IDs are taken from blocks reserved in the database, so
+    /// several writers can insert into the same tables
+    struct IDBlock {
+        int next;
+        int end;
+    };
+    IDBlock objectIDs;
+    IDBlock metadataIDs;
+
+    int takeID(IDBlock& block, const char *sequence);
     int getNextID();
-    void loadLastID();
+    int getNextMetadataID();
 
-    int lastMetadataID;
+    /* metadata rows reference their property name and value by ID, both
+       are looked up or added to the dictionary tables on write */
+    std::unordered_map<std::string, int> metadataPropertyIDs;
+    /// \brief recently used values, emptied when full
+    std::unordered_map<std::string, int> metadataValueIDs;
+    std::mutex metadataDictionaryMutex;
 
-    int getNextMetadataID();
-    void loadLastMetadataID();
+    int getMetadataPropertyID(const std::string& name);
+    int getMetadataValueID(const std::string& value);
+    /// \brief Inserts all metadata of an object with a single statement.
+    void insertMetadata(int objectID, const std::map<std::string,std::string>& metadata);
+    /// \brief Sets the columns of mt_cds_object that hold a copy of the
+    /// searched and sorted metadata, missing ones are cleared on update.
+    void setMetadataColumns(std::map<std::string,std::string>& cdsObjectSql,
+        const std::map<std::string,std::string>& metadata, bool isUpdate);
 
     std::shared_ptr<SQLEmitter> sqlEmitter;
 
+    /* child state of containers, so adding an object can tell whether its
+       parent was empty without counting the children on every insert;
+       both are bounded, containers missing from them are looked up */
+    std::unordered_set<int> nonEmptyContainers;
+    /// \brief containers created without children, mapped to their parent
+    std::unordered_map<int, int> emptyContainers;
+    std::mutex childStateMutex;
+
+    /// \brief Marks the container as having children.
+    /// \return the parent of the container if it was empty before,
+    /// INVALID_OBJECT_ID otherwise
+    int claimEmptyContainer(int containerID);
+
+    /* every object stores the IDs from below the root down to itself as
+       ",1,5,23,", so ancestors are read and descendants found by a range
+       scan with one indexed lookup; keys of containers are cached */
+    std::unordered_map<int, std::string> pathKeys;
+    /// \brief changes whenever keys are moved, stale keys are not cached
+    unsigned long pathKeyGeneration;
+    std::mutex pathKeyMutex;
+
+    /// \brief Returns the path key of an object, empty if it is unknown.
+    std::string getPathKey(int objectID);
+    /// \brief Returns the key of a child, empty if the parent key is
+    /// unknown or the key would be too long to be indexed.
+    std::string childPathKey(const std::string& parentKey, int objectID);
+    /// \brief Rewrites the keys below a container that was moved.
+    void movePathKeys(const std::string& oldKey, const std::string& newKey);
+
+    /// \brief last time the writer pruned the change log
+    time_t changeLogPruned;
+
+    enum class MaintenancePhase {
+        PruneValues,
+        ReclaimSpace,
+        UpdateStatistics,
+    };
+    MaintenancePhase maintenancePhase;
+    int statisticsStep;
+    /// \brief range of value IDs still to be checked by pruneMetadataValues(),
+    /// pruneEnd is negative before the first step of a round
+    int pruneNext;
+    int pruneEnd;
+
+    /// \brief Deletes the metadata values of one range of IDs that no
+    /// metadata row refers to any more. Safe while objects are written,
+    /// writers hold the transaction lock from looking up value IDs until
+    /// the metadata rows referring to them are written.
+    /// \return true if more ranges are left
+    bool pruneMetadataValues();
+
+    /// \brief optional index answering browse requests, nullptr if disabled
+    std::unique_ptr<CdsTreeIndex> browseIndex;
+
+    /// \brief Loads the objects of a page taken from the browse index,
+    /// in the order of the index.
+    std::vector<std::shared_ptr<CdsObject>> browseObjects(const std::vector<int>& ids, bool containers, bool items);
+    /// \brief Ordered child IDs of a container as seen by the first page of
+    /// a paged browse, so that later pages neither repeat nor skip children
+    /// while the container changes.
+    struct BrowseSnapshot {
+        int updateID;
+        time_t created;
+        std::vector<int> ids;
+    };
+    /// \brief snapshots by client, container and browse flags
+    std::map<std::tuple<std::string, int, unsigned int>, BrowseSnapshot> browseSnapshots;
+    size_t browseSnapshotEntries;
+    /// \brief seconds a snapshot is used, 0 disables snapshots
+    int browseSnapshotWindow;
+    std::mutex browseSnapshotMutex;
+
+    /// \brief Takes a page from the snapshot of the container, creating it
+    /// if needed, and sets the update ID the snapshot was taken at.
+    /// \return false if the browse is answered without a snapshot
+    bool getSnapshotPage(const std::unique_ptr<BrowseParam>& param, int updateID, std::vector<int>& ids, int& total);
+    /// \brief All children matching a browse, in browse order.
+    std::vector<int> getChildIDs(const std::unique_ptr<BrowseParam>& param);
+    /// \brief Appends the WHERE and ORDER BY conditions of a browse of
+    /// direct children.
+    void appendChildrenClause(std::ostringstream& qb, const std::unique_ptr<BrowseParam>& param);
+    /// \brief ORDER BY terms of a browse of direct children, the ID breaks
+    /// ties so that pages are stable. The browse index relies on them.
+    std::string childOrder(bool trackSort);
+
+    /// \brief Loads the children of a container into the browse index.
+    bool indexChildren(int containerID);
+    /// \brief Loads the child counts of the given containers into the
+    /// browse index with a single query.
+    void indexChildCounts(const std::vector<int>& containerIDs);
+
     std::mutex nextIDMutex;
     using AutoLock = std::lock_guard<std::mutex>;
+
+    /* a transaction belongs to the thread that began it: the lock is held
+       from the outermost begin until its commit or rollback, so statements
+       of other threads neither become part of it nor see rows that may
+       still be rolled back. The other mutexes are only taken after it. */
+    std::recursive_mutex transactionMutex;
+    using TransactionLock = std::lock_guard<std::recursive_mutex>;
+    int transactionDepth;
+    /// \brief an inner level was rolled back, so is the whole transaction
+    bool transactionFailed;
+
+    void endTransaction(bool commit);
+    /// \brief Forgets cached IDs and container states, which may refer to
+    /// rows that were rolled back.
+    void clearCaches();
 };
 
 #endif // __SQL_STORAGE_H__
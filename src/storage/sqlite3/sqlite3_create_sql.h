@@ -33,66 +33,98 @@
 
 #ifndef __SQLITE3_CREATE_SQL_H__
 #define __SQLITE3_CREATE_SQL_H__
-#define SL3_CREATE_SQL_INFLATED_SIZE 3283
-#define SL3_CREATE_SQL_DEFLATED_SIZE 804
+#define SL3_CREATE_SQL_INFLATED_SIZE 5804
+#define SL3_CREATE_SQL_DEFLATED_SIZE 1279
 
 /* begin binary data: */
-const unsigned char sqlite3_create_sql[] = /* 804 */
-{0x78,0x9C,0xB5,0x56,0x5B,0x6F,0xDA,0x30,0x14,0x7E,0xE7,0x57,0x58,0x79,0x49
-,0x2A,0xB1,0x09,0xAA,0x55,0xDA,0xD4,0xA7,0x14,0xDC,0x2A,0x1A,0x0D,0x5B,0x08
-,0xD3,0xF6,0x64,0x99,0xC4,0x80,0x47,0x6E,0x72,0x1C,0x54,0xFE,0xFD,0xEC,0xDC
-,0x43,0x2E,0x44,0x53,0x2B,0x21,0x04,0xE7,0x7C,0xE7,0x7E,0xF3,0x13,0x7C,0x31
-,0x4C,0x60,0x5B,0xBA,0xB9,0xD1,0x17,0xB6,0xB1,0x36,0x1F,0x27,0x0B,0x0B,0xEA
-,0x36,0x04,0xB6,0xFE,0xB4,0x82,0x40,0xF1,0x39,0x72,0xDC,0x18,0x85,0xBB,0xBF
-,0xC4,0xE1,0x0A,0xD0,0x26,0x00,0x28,0xD4,0x55,0x00,0x0D,0x38,0x39,0x10,0x06
-,0x22,0x46,0x7D,0xCC,0x2E,0xE0,0x44,0x2E,0x53,0xC9,0x63,0x64,0x8F,0xEA,0x7C
-,0x97,0xEC,0x71,0xE2,0x71,0x60,0x6E,0x57,0xAB,0x14,0x10,0x61,0x46,0x02,0xDE
-,0xC0,0x98,0x6B,0x3B,0xE5,0x97,0xE0,0x59,0x8A,0xCC,0x6C,0x22,0x7E,0x89,0x88
-,0x02,0x38,0x0D,0x2E,0x02,0x0F,0x92,0x20,0xA6,0x87,0x80,0xB8,0xA5,0x50,0x0A
-,0x4D,0xA2,0x20,0x42,0x8E,0x87,0xE3,0x58,0x01,0x67,0xCC,0x9C,0x23,0x66,0xDA
-,0xD7,0xD9,0x5D,0xDB,0xBA,0xEB,0x20,0x4E,0xB9,0x47,0x2A,0xD8,0xFD,0xC3,0x43
-,0x07,0xCE,0x0B,0x1D,0xCC,0x69,0x18,0x08,0xC3,0xE4,0x8D,0xF7,0xF3,0xD1,0x11
-,0xC7,0xC7,0x2A,0x92,0xD2,0xBB,0x96,0x80,0x4F,0x38,0x76,0x31,0xC7,0x7D,0x0A
-,0x71,0xF2,0x36,0xC4,0x66,0x24,0x0E,0x13,0xE6,0x90,0xB8,0x0F,0x90,0x44,0x42
-,0x9C,0x8C,0x49,0xAB,0x4F,0x7D,0x92,0x27,0xB5,0xC8,0xC1,0x97,0xAE,0x54,0xED
-,0x3D,0x7C,0x88,0x3B,0x42,0x6B,0xA9,0x9D,0xA7,0x70,0xCE,0xB0,0x73,0x42,0x41
-,0xE2,0xEF,0x08,0x1B,0x28,0x7F,0x4C,0xD8,0x99,0x3A,0x99,0xA3,0x83,0x25,0x58
-,0xAC,0xCD,0x8D,0xE8,0x4B,0xC3,0xB4,0x81,0x52,0x75,0x20,0xA2,0xBB,0xFD,0x09
-,0xCD,0x15,0xF0,0xBC,0xB6,0xA0,0xF1,0x62,0x82,0xEF,0xF0,0x0F,0xD0,0x8A,0xAE
-,0xBB,0x03,0x16,0x7C,0x86,0x16,0x34,0x17,0x70,0xD3,0x6E,0x5D,0x25,0x45,0xAC
-,0x4D,0xB0,0x84,0x2B,0x28,0x3A,0x7C,0xA1,0x6F,0x16,0xFA,0x12,0x4A,0xCA,0xF6
-,0xC7,0x52,0xAF,0x28,0xB7,0xCC,0xDF,0x5F,0x9B,0xAF,0x7A,0xFA,0x9D,0x3C,0x98
-,0xDC,0x3D,0x4E,0x0C,0x73,0x03,0x2D,0x1B,0x08,0x0F,0xD6,0x2D,0x4D,0xBF,0xF4
-,0xD5,0x16,0x6E,0xB4,0x4F,0xF3,0x69,0x96,0x2F,0x20,0x7F,0xCD,0x8A,0x3F,0x63
-,0xBE,0x4B,0xF0,0xB7,0x3A,0x7D,0x9C,0xD9,0x59,0xDD,0xAA,0xF8,0xA8,0x19,0xFF
-,0xB3,0x13,0x06,0x1C,0xD3,0x80,0x30,0x55,0xD0,0xAC,0x30,0xE4,0xEA,0x47,0x7A
-,0x31,0xAF,0x29,0xE9,0x73,0xE2,0xC7,0x02,0x2C,0x29,0x13,0xE4,0x90,0x5D,0xFE
-,0xDF,0x99,0xCE,0x8D,0x88,0x1D,0x4E,0xCF,0xA2,0x8F,0x39,0xF1,0x47,0xAC,0x45
-,0x89,0x96,0xDB,0xA4,0xD1,0xF2,0x8D,0x15,0x16,0x73,0x31,0xBF,0x03,0x80,0x7A
-,0x43,0xB6,0x5D,0xE8,0x99,0x8B,0xF7,0xED,0xC8,0x56,0x1E,0x64,0xB4,0x2C,0xC0
-,0x1E,0x8A,0x09,0x17,0x0B,0xFA,0x90,0x27,0x42,0x04,0xDD,0xDC,0x2D,0xB5,0x6C
-,0x34,0x83,0x3E,0x63,0x2F,0xE9,0x0B,0xBA,0x6B,0x06,0xDA,0x06,0xF3,0x66,0x50
-,0xDD,0x1D,0x3A,0x13,0x16,0x8B,0x24,0xCB,0xBA,0x3F,0xA8,0x5D,0xEE,0xE2,0x84
-,0x87,0xB1,0x83,0x83,0x11,0xF5,0x12,0x09,0x1A,0x3E,0x63,0x52,0x0F,0xF2,0xC8
-,0x99,0x78,0x95,0xFB,0xF3,0xD9,0x75,0x4D,0x25,0xC8,0x0F,0x5D,0x32,0x80,0x11
-,0xDD,0x99,0x08,0xBF,0xCF,0x37,0x6F,0xDC,0x91,0xBA,0x2E,0x09,0x6E,0xA1,0xD2
-,0x0C,0x89,0xB4,0x8E,0xB9,0x49,0xE2,0x5E,0x72,0xE9,0x1E,0xDD,0x53,0xE2,0x8E
-,0x11,0x88,0x64,0x86,0x63,0x2E,0x76,0xDD,0x80,0x1B,0xA5,0x98,0x3A,0x53,0x47
-,0xDD,0xD2,0x08,0xF3,0xA3,0x48,0x76,0xEF,0x69,0xE3,0x61,0xE2,0x1C,0xA5,0x83
-,0x23,0x4C,0xCE,0xD5,0x8E,0x59,0x29,0xEA,0x9E,0x56,0xB4,0x39,0x20,0x79,0x9D
-,0x3F,0x72,0x48,0xAA,0xCB,0x7F,0xB3,0xEB,0xB2,0x49,0xEE,0x38,0xE1,0x59,0x9E
-,0x58,0x28,0x0A,0xC0,0x2F,0x28,0xC0,0xFE,0xD0,0xA6,0xA8,0x80,0xF9,0x78,0xA5
-,0x69,0x1D,0xD8,0x25,0x85,0x87,0xC2,0xF4,0xFE,0xD4,0xDE,0x21,0xB9,0x53,0xEF
-,0x9F,0x23,0xC3,0x5C,0xC2,0xDF,0xA0,0xA1,0x09,0x65,0x97,0x5C,0x8A,0x35,0xE8
-,0x5A,0x46,0x1F,0x96,0x2D,0xCF,0x70,0x5B,0xBC,0x64,0x4D,0x6B,0xAF,0xCA,0x69
-,0xF1,0x1A,0xEC,0x50,0x5B,0x83,0xB5,0xB5,0xD5,0x98,0x1D,0xA2,0xE5,0xDB,0x30
-,0x33,0xDA,0x16,0x6F,0x3C,0x1E,0xA7,0xA5,0x6B,0x1D,0xAA,0xEA,0x8F,0xAA,0xB6
-,0x9E,0x3A,0xB7,0x43,0xF8,0x7A,0x59,0x22,0xB9,0x7E,0x33,0x25,0xD7,0x2C,0x4D
-,0xB0,0x2A,0x0D,0x5B,0xD3,0xF8,0xB9,0xAD,0x29,0x2A,0xE7,0x27,0x9B,0x96,0x5C
-,0x47,0x41,0xD5,0x32,0xEA,0x70,0x69,0xAA,0x67,0x5F,0x3B,0x8C,0x8A,0xD7,0xA1
-,0xA3,0xEA,0xCD,0xAC,0x0D,0x73,0xF1,0x82,0xAC,0xE5,0x64,0x29,0xB9,0x7E,0x7D
-,0x35,0xEC,0xC7,0xC9,0x3F,0x2B,0x86,0xFE,0x65};
-/* end binary data. size = 804 bytes */
+const unsigned char sqlite3_create_sql[] = /* 1279 */
+{0x78,0xDA,0xB5,0x58,0xDD,0x6F,0xE3,0x36,0x0C,0x7F,0xEF,0x5F,0x21,0xF8,0xC5
+,0x2E,0xE0,0x15,0x49,0xB1,0xBB,0xDB,0x50,0xEC,0x21,0x97,0xBA,0x87,0x6C,0xA9
+,0x7D,0xCB,0xC7,0x6D,0x7B,0x32,0x54,0x5B,0x49,0xB4,0xFA,0x6B,0xB2,0x9C,0x35
+,0xFF,0xFD,0xF4,0x61,0xCB,0x76,0x2C,0x3B,0xEE,0xAE,0x05,0x8A,0xC0,0x15,0xC9
+,0x1F,0x29,0x92,0x22,0x29,0x7D,0x76,0xBE,0x2C,0x5C,0xB0,0x59,0xCD,0xDC,0xF5
+,0x6C,0xBE,0x59,0x78,0xEE,0xDD,0xD5,0x7C,0xE5,0xCC,0x36,0x0E,0xD8,0xCC,0x3E
+,0x2F,0x1D,0x60,0xC4,0xD4,0x0F,0xC2,0xDC,0x4F,0x9F,0xFE,0x46,0x01,0x35,0x80
+,0x75,0x05,0x80,0x81,0x43,0x03,0xE0,0x84,0xA2,0x3D,0x22,0x20,0x23,0x38,0x86
+,0xE4,0x04,0x9E,0xD1,0xC9,0xE6,0x34,0x82,0x76,0x7E,0x93,0x1E,0xA2,0x1D,0x2C
+,0x22,0x0A,0xDC,0xED,0x72,0x29,0x18,0x32,0x48,0x50,0x42,0x5B,0x3C,0xAE,0xB7
+,0x11,0x74,0xC5,0x3C,0x11,0x9C,0x52,0xA7,0x4F,0x4F,0x19,0x32,0x00,0xC5,0xC9
+,0x89,0xF1,0x83,0x22,0xC9,0xF1,0x3E,0x41,0xA1,0x12,0x12,0xAC,0x45,0x96,0x64
+,0x7E,0x10,0xC1,0x3C,0x37,0xC0,0x11,0x92,0xE0,0x00,0x89,0xF5,0xD3,0xE4,0xBA
+,0xAB,0x3D,0x0C,0x7C,0x8A,0x69,0x84,0x6A,0xB6,0xDB,0x0F,0x1F,0x34,0x7C,0x51
+,0x1A,0x40,0x8A,0xD3,0x84,0x29,0x46,0x2F,0xB4,0x9F,0xEE,0x1F,0x60,0x7E,0xA8
+,0x77,0xA2,0xAC,0xEB,0x08,0xC4,0x88,0xC2,0x10,0x52,0xD8,0x07,0x08,0x8B,0x97
+,0x21,0x32,0x41,0x79,0x5A,0x90,0x00,0xE5,0x7D,0x0C,0x45,0xC6,0xC4,0xD1,0x18
+,0xB7,0xC6,0x38,0x46,0xA5,0x53,0x2B,0x1F,0xFC,0xA8,0x73,0xD5,0x2E,0x82,0xFB
+,0x5C,0xB3,0xB5,0x0E,0xEC,0x54,0xB0,0x53,0x02,0x83,0x67,0x3F,0x29,0xE2,0x27
+,0x44,0x06,0xC2,0x9F,0x23,0x72,0xC4,0x81,0x34,0x74,0x38,0x04,0x22,0xA6,0x90
+,0x50,0x9C,0xD3,0x01,0x56,0x30,0xF7,0x96,0x4B,0x9E,0xAF,0xAE,0x37,0x9F,0xAD
+,0x9D,0x86,0x64,0xF4,0x54,0xC4,0xFF,0x47,0x70,0x8F,0x12,0x82,0x5E,0x29,0xC8
+,0xD2,0x8A,0xBB,0xFF,0x95,0x52,0x19,0xA4,0x07,0x9F,0x1D,0x9C,0x5A,0xEC,0xD3
+,0xC7,0x4F,0x5D,0x4F,0xCC,0x3D,0x77,0xCD,0x4E,0xE8,0xC2,0xDD,0x00,0xA3,0x3E
+,0x8B,0x3E,0x7E,0xDA,0x3D,0xFB,0x53,0x03,0x3C,0x78,0x2B,0x67,0xF1,0xC5,0x05
+,0xBF,0x39,0x7F,0x01,0xAB,0x3A,0x7F,0xD7,0x60,0xE5,0x3C,0x38,0x2B,0xC7,0x9D
+,0x3B,0xEB,0xEE,0x21,0x36,0x04,0x87,0xE7,0x82,0x7B,0x67,0xE9,0x30,0x9B,0x98
+,0x45,0xF3,0xD9,0xBD,0xC3,0x57,0xB6,0x5F,0xEF,0x67,0xF5,0xCA,0x25,0xF5,0xB7
+,0xE7,0xEA,0xEB,0xD3,0xFD,0x46,0x16,0x5C,0x5D,0xDF,0x5D,0x2D,0xDC,0xB5,0xB3
+,0xDA,0x00,0x66,0x81,0xD7,0x41,0xFA,0x36,0x5B,0x6E,0x9D,0xB5,0xF5,0xC3,0xD4
+,0x96,0xFE,0x02,0xFC,0x6B,0x52,0xFD,0x33,0xE6,0x57,0x31,0xFF,0x3C,0x5E,0x6A
+,0x9C,0x51,0x93,0xA6,0x4D,0xEC,0xCF,0x94,0xF4,0x9B,0x20,0x4D,0x28,0xC4,0x09
+,0x22,0x26,0x5B,0x5B,0xA5,0x29,0x35,0xDF,0xDA,0x46,0xD3,0x36,0xC7,0x99,0x38
+,0x6D,0x68,0xE8,0xB3,0xF0,0xEB,0x1C,0xDC,0x63,0xC2,0x96,0x53,0x72,0x7A,0x07
+,0x4B,0xA7,0xC2,0x56,0x6D,0xD7,0x81,0x01,0xC5,0x47,0x56,0x2B,0x28,0x8A,0x47
+,0xB4,0x1E,0xCE,0xCD,0x2B,0x76,0xEB,0x0C,0xB6,0xDA,0x44,0x4E,0xBB,0x87,0xB4
+,0xC9,0xD0,0x4C,0xF5,0xAE,0x09,0x3D,0x27,0xEE,0x6D,0x73,0xBD,0xE3,0x07,0xBE
+,0x5B,0x92,0xC0,0xC8,0xCF,0x11,0x65,0x4D,0x70,0x5F,0x3A,0xA2,0x55,0x36,0x78
+,0xFD,0x6E,0x78,0xA3,0xBD,0xE9,0x23,0x8C,0x8A,0xBE,0x4D,0xEB,0x4E,0x57,0x57
+,0x61,0x99,0x2B,0x66,0xF8,0xE4,0x1F,0x11,0xC9,0x99,0x93,0x79,0x5A,0x4C,0xA7
+,0xE6,0xAB,0xA4,0x63,0xBC,0x27,0xB2,0x67,0x56,0xBD,0xD0,0x0F,0xB1,0x08,0x19
+,0x14,0x79,0x65,0x7E,0x3F,0x5E,0x90,0x46,0x45,0x9C,0xE4,0xDF,0x05,0x56,0x15
+,0xE5,0x1A,0xA5,0x13,0x12,0x58,0xD0,0x34,0x0F,0x60,0x32,0x22,0x27,0x59,0x12
+,0x0C,0x8F,0x43,0x1C,0xC7,0x8F,0xD0,0x11,0x45,0x75,0x88,0xA6,0x93,0xF3,0xBC
+,0xE5,0x4C,0x71,0x1A,0xA2,0x01,0x1E,0x76,0x40,0x0B,0x16,0x9B,0xE3,0xC5,0x59
+,0xE9,0x80,0xC3,0x10,0x25,0x97,0xB8,0x84,0xAB,0x58,0xEA,0x8C,0x99,0x6D,0xD8
+,0xDC,0x45,0xB9,0x79,0x78,0x87,0x51,0x38,0x46,0x20,0xE3,0x59,0x94,0x53,0xD6
+,0x29,0x06,0xCC,0x50,0x62,0xE6,0xC4,0x1C,0x35,0x93,0x89,0xC8,0xE1,0xB0,0x77
+,0x44,0xA2,0x69,0x11,0x1C,0xB8,0x81,0x23,0x54,0x4E,0x4D,0x4D,0x3D,0xA8,0xE2
+,0x2E,0x22,0xDA,0x2E,0x02,0x65,0x9C,0xDF,0xB3,0x10,0xA8,0x2C,0xCF,0x48,0xCA
+,0x1C,0x48,0x4F,0x23,0xD2,0x2F,0x81,0xF1,0xD0,0xD1,0xEF,0xD7,0x51,0x16,0x8D
+,0x8B,0x0A,0x04,0x5F,0xDF,0x10,0xAC,0x2B,0x43,0x22,0x34,0xA3,0x6C,0x18,0xA1
+,0x5D,0x56,0x65,0xCD,0xC8,0x2B,0xF3,0xA1,0xF4,0x53,0x3F,0x87,0xB4,0xBE,0x8F
+,0x7C,0x16,0x7D,0xE5,0x1B,0x1C,0xEE,0x9E,0xBB,0x5D,0xA0,0x34,0xE5,0xED,0x33
+,0xE0,0xDB,0xC2,0xF9,0xE3,0x2C,0x38,0x18,0xFD,0x6B,0x80,0xD9,0x1A,0xAC,0x19
+,0xCA,0x7C,0x03,0xE2,0x1B,0x1C,0xDA,0xFC,0x57,0xDA,0x60,0x83,0xEC,0x86,0x07
+,0x9E,0x73,0x28,0x1F,0xF0,0x05,0x1B,0x1C,0x6F,0xC4,0x96,0x5B,0x14,0xB1,0xA2
+,0x48,0x22,0x96,0x6C,0xF3,0x0F,0x2B,0xEF,0x11,0x34,0x94,0x82,0x18,0xFC,0xEA
+,0xB1,0xAB,0xA2,0x2E,0x11,0x41,0xC6,0x37,0x90,0x31,0x2B,0xC0,0x2F,0xCC,0x8C
+,0x86,0xDF,0xBB,0x32,0x52,0xFF,0x91,0x0B,0x1C,0x2B,0x81,0x2A,0x0C,0x9A,0x64
+,0xA8,0xAE,0x0B,0x65,0xE7,0xB6,0x1A,0xF7,0xC2,0xA1,0xC4,0xA8,0xC4,0x32,0x36
+,0x0E,0xE3,0x17,0x03,0xC8,0x92,0x79,0x5E,0x55,0xFB,0xAE,0x22,0x2D,0x2E,0x3E
+,0x0A,0xF1,0x91,0x56,0xE6,0xB8,0x2A,0xBF,0x1F,0xAF,0x35,0x55,0xC3,0xAC,0xCB
+,0x61,0x8E,0x78,0x8D,0xBD,0x7C,0x79,0x9A,0x68,0x32,0xAD,0xB5,0xE9,0x9E,0xA9
+,0xA3,0x76,0xC2,0x7B,0xD6,0x9C,0x1C,0xFD,0x53,0xA0,0x24,0xA8,0x3C,0xDF,0x2E
+,0x27,0x83,0x53,0x47,0xC2,0xCE,0xB9,0xF6,0x64,0xE9,0x46,0x8E,0x5A,0x4D,0xD5
+,0x8F,0xA5,0xFD,0xAC,0x05,0xDF,0x8E,0x62,0xAF,0xD2,0x8B,0x09,0x4C,0xB5,0xC3
+,0xE4,0x01,0x26,0x7B,0xE4,0x47,0xE9,0x7E,0xB8,0xAA,0x00,0x5E,0xE2,0x71,0x12
+,0x10,0x14,0xB3,0x98,0xAB,0xF8,0x8B,0x51,0xB8,0xBF,0x8C,0x0C,0xDC,0xBD,0x25
+,0x84,0xD0,0x1E,0x0E,0xA4,0x43,0xC3,0xF9,0x0B,0xF7,0xDE,0xF9,0x13,0xB4,0xC2
+,0xE8,0xCB,0x4B,0x1D,0x8F,0x59,0x6B,0xDD,0x92,0xEB,0xC3,0xB2,0xEA,0x46,0xD6
+,0x15,0x57,0x24,0xBB,0xF1,0xD4,0x62,0x57,0x4F,0x24,0x1A,0xD8,0x06,0x5B,0x17
+,0xAD,0x41,0xD4,0x88,0xAA,0x07,0x13,0xA9,0xB4,0x2B,0xDE,0x7A,0x51,0xB1,0x95
+,0x69,0x1A,0xA8,0xE6,0x4B,0x43,0x17,0xA7,0x49,0xD5,0x08,0x9F,0x8F,0x80,0x7C
+,0xD4,0x2B,0x41,0xCE,0x49,0x16,0x23,0xD5,0x08,0x5B,0x77,0xF1,0xFB,0xB6,0x01
+,0xA4,0x86,0x01,0xD9,0xFA,0x4B,0x8C,0x6A,0xD5,0x92,0xAB,0xC3,0xA1,0xA9,0x0B
+,0x50,0x77,0x1B,0x35,0x6D,0x18,0xA3,0xF1,0x4A,0xD2,0x05,0x69,0x10,0xC7,0xA0
+,0xF0,0x17,0x93,0x3E,0x10,0x4E,0x1B,0x81,0x21,0x1E,0x4F,0x7A,0x30,0x04,0x6D
+,0x18,0xA3,0x7C,0x47,0xE9,0x02,0x94,0x84,0x4B,0xA9,0x2E,0x47,0x77,0x5D,0xA6
+,0x4B,0x8A,0x46,0xBE,0x6E,0xEB,0xB2,0x7B,0x96,0xC2,0xD5,0xB2,0x55,0x2E,0x0F
+,0x49,0x56,0xFD,0xEB,0x5C,0xB4,0x5A,0xB7,0x1B,0x1D,0xB1,0x3F,0xA1,0x3A,0x6D
+,0x55,0xF4,0xEC,0x33,0x4C,0x45,0xB4,0x38,0x71,0x04,0x58,0xDD,0xD4,0xCF,0x91
+,0x04,0xC5,0xAA,0xE9,0xB6,0xF8,0xD4,0xEC,0xB3,0xDD,0x8E,0x78,0x63,0x2B,0xA1
+,0x5A,0x04,0xAB,0xDD,0x73,0x6D,0xD5,0x05,0x75,0x31,0x53,0xE5,0xB8,0xFC,0x54
+,0x07,0x40,0x11,0xAC,0x92,0xC0,0xA5,0xBD,0xC7,0xC7,0xC5,0xE6,0xEE,0xEA,0x3F
+,0x80,0xEC,0x2E,0xF6};
+/* end binary data. size = 1279 bytes */
 
 #endif // __SQLITE3_CREATE_SQL_H__
 
@@ -36,6 +36,7 @@
 #include "common.h"
 #include "config/config_manager.h"
 #include "sqlite3_create_sql.h"
+#include "util/trace.h"
 
 
 // updates 1->2
@@ -99,8 +100,89 @@ CREATE INDEX mt_track_number on mt_cds_object (track_number); \
 PRAGMA foreign_keys = ON;"
 #define SQLITE3_UPDATE_4_5_2 "UPDATE mt_internal_setting SET value='5' WHERE key='db_version' AND value='4'"
 
+// updates 5->6: Online service refresh state
+#define SQLITE3_UPDATE_5_6_1 "CREATE TABLE \"mt_service_state\" ( \
+  \"object_id\" integer primary key, \
+  \"service_prefix\" char(1) NOT NULL, \
+  \"service_id\" varchar(255) NOT NULL, \
+  \"content_hash\" varchar(16) NOT NULL default '', \
+  \"last_seen\" integer unsigned NOT NULL default 0, \
+  CONSTRAINT \"mt_service_state_ibfk_1\" FOREIGN KEY (\"object_id\") REFERENCES \"mt_cds_object\" (\"id\") \
+  ON DELETE CASCADE ON UPDATE CASCADE )"
+#define SQLITE3_UPDATE_5_6_2 "CREATE INDEX mt_service_state_seen ON mt_service_state(service_prefix,last_seen)"
+// Apple Trailers service ids used to start with the prefix as a number
+#define SQLITE3_UPDATE_5_6_3 "UPDATE mt_cds_object SET service_id = 'T' || substr(service_id, 3) WHERE service_id LIKE '84%'"
+#define SQLITE3_UPDATE_5_6_4 "INSERT INTO mt_service_state (object_id, service_prefix, service_id, content_hash, last_seen) \
+  SELECT id, substr(service_id, 1, 1), service_id, '', strftime('%s', 'now') FROM mt_cds_object WHERE service_id IS NOT NULL"
+#define SQLITE3_UPDATE_5_6_5 "UPDATE mt_internal_setting SET value='6' WHERE key='db_version' AND value='5'"
+
+// updates 6->7: ID sequences
+#define SQLITE3_UPDATE_6_7_1 "CREATE TABLE \"mt_sequence\" ( \
+  \"name\" varchar(40) primary key NOT NULL, \
+  \"next_id\" integer NOT NULL )"
+#define SQLITE3_UPDATE_6_7_2 "INSERT INTO mt_sequence (name, next_id) SELECT 'object', MAX(id) + 1 FROM mt_cds_object"
+#define SQLITE3_UPDATE_6_7_3 "INSERT INTO mt_sequence (name, next_id) SELECT 'metadata', IFNULL(MAX(id), 0) + 1 FROM mt_metadata"
+#define SQLITE3_UPDATE_6_7_4 "UPDATE mt_internal_setting SET value='7' WHERE key='db_version' AND value='6'"
+
+// updates 7->8: change log for reader nodes, ids are not reused after a prune
+#define SQLITE3_UPDATE_7_8_1 "CREATE TABLE \"mt_change_log\" ( \
+  \"id\" integer primary key autoincrement, \
+  \"container_id\" integer NOT NULL, \
+  \"update_id\" integer NOT NULL, \
+  \"changed\" integer unsigned NOT NULL )"
+#define SQLITE3_UPDATE_7_8_2 "CREATE INDEX mt_change_log_changed ON mt_change_log(changed)"
+#define SQLITE3_UPDATE_7_8_3 "UPDATE mt_internal_setting SET value='8' WHERE key='db_version' AND value='7'"
+
+// updates 8->9: metadata property and value dictionary, the rows are
+// moved from mt_metadata_legacy by SQLStorage::migrateMetadataDictionary()
+#define SQLITE3_UPDATE_8_9_1 "DROP INDEX mt_metadata_item_id"
+#define SQLITE3_UPDATE_8_9_2 "ALTER TABLE mt_metadata RENAME TO mt_metadata_legacy"
+#define SQLITE3_UPDATE_8_9_3 "CREATE TABLE \"mt_metadata_property\" ( \
+  \"id\" integer primary key, \
+  \"name\" varchar(255) NOT NULL )"
+#define SQLITE3_UPDATE_8_9_4 "CREATE TABLE \"mt_metadata_value\" ( \
+  \"id\" integer primary key, \
+  \"value_hash\" integer unsigned NOT NULL, \
+  \"value\" text NOT NULL )"
+#define SQLITE3_UPDATE_8_9_5 "CREATE TABLE \"mt_metadata\" ( \
+  \"id\" integer primary key, \
+  \"item_id\" integer NOT NULL, \
+  \"property_id\" integer NOT NULL, \
+  \"value_id\" integer NOT NULL, \
+  CONSTRAINT \"mt_metadata_idfk1\" FOREIGN KEY (\"item_id\") REFERENCES \"mt_cds_object\" (\"id\") ON DELETE CASCADE ON UPDATE CASCADE )"
+#define SQLITE3_UPDATE_8_9_6 "CREATE VIEW \"mt_metadata_view\" AS SELECT m.id, m.item_id, p.name AS property_name, v.value AS property_value, v.value_hash \
+  FROM mt_metadata m JOIN mt_metadata_property p ON p.id = m.property_id JOIN mt_metadata_value v ON v.id = m.value_id"
+#define SQLITE3_UPDATE_8_9_7 "CREATE INDEX mt_metadata_item_id ON mt_metadata(item_id)"
+#define SQLITE3_UPDATE_8_9_8 "CREATE INDEX mt_metadata_value_id ON mt_metadata(value_id,property_id)"
+#define SQLITE3_UPDATE_8_9_9 "CREATE UNIQUE INDEX mt_metadata_property_name ON mt_metadata_property(name)"
+#define SQLITE3_UPDATE_8_9_10 "CREATE UNIQUE INDEX mt_metadata_value_hash ON mt_metadata_value(value_hash,value)"
+#define SQLITE3_UPDATE_8_9_11 "UPDATE mt_internal_setting SET value='9' WHERE key='db_version' AND value='8'"
+#define SQLITE3_UPDATE_9_10_1 "ALTER TABLE \"mt_cds_object\" ADD COLUMN \"upnp_artist\" varchar(255) default NULL COLLATE NOCASE"
+#define SQLITE3_UPDATE_9_10_2 "ALTER TABLE \"mt_cds_object\" ADD COLUMN \"upnp_album\" varchar(255) default NULL COLLATE NOCASE"
+#define SQLITE3_UPDATE_9_10_3 "ALTER TABLE \"mt_cds_object\" ADD COLUMN \"upnp_genre\" varchar(255) default NULL COLLATE NOCASE"
+#define SQLITE3_UPDATE_9_10_4 "ALTER TABLE \"mt_cds_object\" ADD COLUMN \"dc_date\" varchar(255) default NULL COLLATE NOCASE"
+#define SQLITE3_UPDATE_9_10_5 "CREATE INDEX mt_cds_object_upnp_artist ON mt_cds_object(upnp_artist)"
+#define SQLITE3_UPDATE_9_10_6 "CREATE INDEX mt_cds_object_upnp_album ON mt_cds_object(upnp_album)"
+#define SQLITE3_UPDATE_9_10_7 "CREATE INDEX mt_cds_object_upnp_genre ON mt_cds_object(upnp_genre)"
+#define SQLITE3_UPDATE_9_10_8 "CREATE INDEX mt_cds_object_dc_date ON mt_cds_object(dc_date)"
+#define SQLITE3_UPDATE_9_10_9 "UPDATE mt_internal_setting SET value='10' WHERE key='db_version' AND value='9'"
+#define SQLITE3_UPDATE_10_11_1 "ALTER TABLE \"mt_cds_object\" ADD COLUMN \"path_key\" varchar(767) default NULL"
+#define SQLITE3_UPDATE_10_11_2 "CREATE INDEX mt_cds_object_path_key ON mt_cds_object(path_key)"
+#define SQLITE3_UPDATE_10_11_3 "UPDATE mt_internal_setting SET value='11' WHERE key='db_version' AND value='10'"
+
 #define SL3_INITITAL_QUEUE_SIZE 20
 
+// value of PRAGMA auto_vacuum on databases created by this version
+#define SQLITE3_AUTO_VACUUM_INCREMENTAL 2
+// free pages returned to the file system by one maintenance step
+#define SQLITE3_VACUUM_PAGES 512
+// rows examined per index by ANALYZE, keeps a maintenance step short
+#define SQLITE3_ANALYSIS_LIMIT 1000
+
+// indexes only used to browse and search, adding objects does not look them up
+#define SQLITE3_BULK_LOAD_INDEXES "'mt_object_type','mt_track_number','mt_cds_object_service_id','mt_cds_object_upnp_artist'," \
+                                  "'mt_cds_object_upnp_album','mt_cds_object_upnp_genre','mt_cds_object_dc_date','mt_metadata_value_id','mt_change_log_changed'"
+
 using namespace zmm;
 using namespace mxml;
 using namespace std;
@@ -114,6 +196,8 @@ Sqlite3Storage::Sqlite3Storage(std::shared_ptr<ConfigManager> config, std::share
     table_quote_end = '"';
     startupError = "";
     dirty = false;
+    backupPending = false;
+    bulkLoad = false;
 }
 
 void Sqlite3Storage::init()
@@ -205,6 +289,8 @@ void Sqlite3Storage::init()
     std::ostringstream buf;
     buf << "PRAGMA synchronous = " << synchronousOption;
     SQLStorage::exec(buf);
+    // ignored by versions before 3.32, ANALYZE reads whole tables there
+    _exec("PRAGMA analysis_limit = " + std::to_string(SQLITE3_ANALYSIS_LIMIT));
 
     log_debug("db_version: %s\n", dbVersion.c_str());
 
@@ -246,9 +332,80 @@ void Sqlite3Storage::init()
         dbVersion = "5";
     }
 
+    if (dbVersion == "5") {
+        log_info("Running an automatic database upgrade from database version 5 to version 6...\n");
+        _exec(SQLITE3_UPDATE_5_6_1);
+        _exec(SQLITE3_UPDATE_5_6_2);
+        _exec(SQLITE3_UPDATE_5_6_3);
+        _exec(SQLITE3_UPDATE_5_6_4);
+        _exec(SQLITE3_UPDATE_5_6_5);
+        log_info("Database upgrade successful.\n");
+        dbVersion = "6";
+    }
+
+    if (dbVersion == "6") {
+        log_info("Running an automatic database upgrade from database version 6 to version 7...\n");
+        _exec(SQLITE3_UPDATE_6_7_1);
+        _exec(SQLITE3_UPDATE_6_7_2);
+        _exec(SQLITE3_UPDATE_6_7_3);
+        _exec(SQLITE3_UPDATE_6_7_4);
+        log_info("Database upgrade successful.\n");
+        dbVersion = "7";
+    }
+
+    if (dbVersion == "7") {
+        log_info("Running an automatic database upgrade from database version 7 to version 8...\n");
+        _exec(SQLITE3_UPDATE_7_8_1);
+        _exec(SQLITE3_UPDATE_7_8_2);
+        _exec(SQLITE3_UPDATE_7_8_3);
+        log_info("Database upgrade successful.\n");
+        dbVersion = "8";
+    }
+
+    if (dbVersion == "8") {
+        log_info("Running an automatic database upgrade from database version 8 to version 9...\n");
+        _exec(SQLITE3_UPDATE_8_9_1);
+        _exec(SQLITE3_UPDATE_8_9_2);
+        _exec(SQLITE3_UPDATE_8_9_3);
+        _exec(SQLITE3_UPDATE_8_9_4);
+        _exec(SQLITE3_UPDATE_8_9_5);
+        _exec(SQLITE3_UPDATE_8_9_6);
+        _exec(SQLITE3_UPDATE_8_9_7);
+        _exec(SQLITE3_UPDATE_8_9_8);
+        _exec(SQLITE3_UPDATE_8_9_9);
+        _exec(SQLITE3_UPDATE_8_9_10);
+        _exec(SQLITE3_UPDATE_8_9_11);
+        log_info("Database upgrade successful.\n");
+        dbVersion = "9";
+    }
+
+    if (dbVersion == "9") {
+        log_info("Running an automatic database upgrade from database version 9 to version 10...\n");
+        _exec(SQLITE3_UPDATE_9_10_1);
+        _exec(SQLITE3_UPDATE_9_10_2);
+        _exec(SQLITE3_UPDATE_9_10_3);
+        _exec(SQLITE3_UPDATE_9_10_4);
+        _exec(SQLITE3_UPDATE_9_10_5);
+        _exec(SQLITE3_UPDATE_9_10_6);
+        _exec(SQLITE3_UPDATE_9_10_7);
+        _exec(SQLITE3_UPDATE_9_10_8);
+        _exec(SQLITE3_UPDATE_9_10_9);
+        log_info("Database upgrade successful.\n");
+        dbVersion = "10";
+    }
+
+    if (dbVersion == "10") {
+        log_info("Running an automatic database upgrade from database version 10 to version 11...\n");
+        _exec(SQLITE3_UPDATE_10_11_1);
+        _exec(SQLITE3_UPDATE_10_11_2);
+        _exec(SQLITE3_UPDATE_10_11_3);
+        log_info("Database upgrade successful.\n");
+        dbVersion = "11";
+    }
+
     /* --- --- ---*/
 
-    if (!string_ok(dbVersion) || dbVersion != "5")
+    if (!string_ok(dbVersion) || dbVersion != "11")
         throw _Exception("The database seems to be from a newer version!");
 
     // add timer for backups
@@ -262,6 +419,17 @@ void Sqlite3Storage::init()
         btask->waitForTask();
     }
 
+    MemoryAccounting::setSampler(MemoryAccounting::ACCOUNT_STORAGE, [this]() {
+        AutoLock lock(sqliteMutex);
+        // statements and the page cache are allocated by sqlite, result batches are accounted separately
+        return MemoryAccounting::Usage { sqlite3_memory_used(), taskQueue->size() };
+    });
+    MemoryAccounting::setShrinker(MemoryAccounting::ACCOUNT_STORAGE, [this]() {
+        Ref<SLReleaseMemoryTask> rtask(new SLReleaseMemoryTask());
+        addTask(RefCast(rtask, SLTask));
+        rtask->waitForTask();
+    });
+
     dbReady();
 }
 
@@ -275,6 +443,93 @@ void Sqlite3Storage::_exec(const char* query)
     exec(query, strlen(query), false);
 }
 
+void Sqlite3Storage::transactionEnded()
+{
+    if (backupPending.exchange(false)) {
+        Ref<SLBackupTask> btask(new SLBackupTask(config, false));
+        this->addTask(RefCast(btask, SLTask), true);
+    }
+}
+
+void Sqlite3Storage::beginBulkLoad()
+{
+    if (bulkLoad)
+        return;
+    bulkLoad = true;
+
+    // nothing is written twice, a crash only loses the file being built
+    _exec("PRAGMA synchronous = OFF");
+    _exec("PRAGMA journal_mode = OFF");
+
+    // the definitions are kept to create the indexes again after the load
+    std::ostringstream q;
+    q << "SELECT name, sql FROM sqlite_master WHERE type='index' AND sql IS NOT NULL"
+      << " AND name IN (" << SQLITE3_BULK_LOAD_INDEXES << ')';
+    auto res = select(q);
+    std::vector<std::string> names;
+    std::unique_ptr<SQLRow> row;
+    while ((row = res->nextRow()) != nullptr) {
+        names.push_back(row->col(0));
+        bulkLoadIndexes.push_back(row->col(1));
+    }
+    for (const auto& name : names)
+        _exec(("DROP INDEX " + name).c_str());
+    log_debug("bulk load: dropped %d indexes\n", (int)names.size());
+}
+
+void Sqlite3Storage::endBulkLoad()
+{
+    if (!bulkLoad)
+        return;
+
+    // one sorted build per index is much cheaper than updating it per row
+    for (const auto& sql : bulkLoadIndexes)
+        _exec(sql.c_str());
+    bulkLoadIndexes.clear();
+
+    _exec("PRAGMA journal_mode = DELETE");
+    std::ostringstream buf;
+    buf << "PRAGMA synchronous = " << config->getIntOption(CFG_SERVER_STORAGE_SQLITE_SYNCHRONOUS);
+    SQLStorage::exec(buf);
+    bulkLoad = false;
+}
+
+// only databases created with auto_vacuum = INCREMENTAL can give pages
+// back without a full VACUUM, which would lock the database for minutes
+bool Sqlite3Storage::reclaimSpace()
+{
+    auto pragma = [this](const char* query) {
+        auto res = _select(query, "");
+        std::unique_ptr<SQLRow> row = res->nextRow();
+        return row != nullptr ? row->col_int64(0, 0) : 0;
+    };
+    if (pragma("PRAGMA auto_vacuum") != SQLITE3_AUTO_VACUUM_INCREMENTAL)
+        return false;
+    long long freePages = pragma("PRAGMA freelist_count");
+    if (freePages == 0)
+        return false;
+    _exec("PRAGMA incremental_vacuum(" + std::to_string(SQLITE3_VACUUM_PAGES) + ")");
+    return freePages > SQLITE3_VACUUM_PAGES;
+}
+
+bool Sqlite3Storage::updateStatistics(int step)
+{
+    // once the statistics exist, sqlite knows best which tables need them again
+    if (step == 0) {
+        auto res = _select("SELECT 1 FROM sqlite_master WHERE name='sqlite_stat1'", "");
+        if (res->nextRow() != nullptr) {
+            _exec("PRAGMA optimize");
+            return false;
+        }
+    }
+    return SQLStorage::updateStatistics(step);
+}
+
+void Sqlite3Storage::analyzeTable(const std::string& table)
+{
+    _exec("ANALYZE " + table);
+}
+
 std::string Sqlite3Storage::quote(std::string value)
 {
     char* q = sqlite3_mprintf("'%q'", value.c_str());
@@ -289,28 +544,69 @@ std::string Sqlite3Storage::getError(std::string query, std::string error, sqlit
         + sqlite3_errmsg(db) + "\nQuery:" + (query.empty() ? "unknown" : query) + "\nerror: " + (error.empty() ? "unknown" : error);
 }
 
-Ref<SQLResult> Sqlite3Storage::select(const char* query, int length)
+Ref<SQLResult> Sqlite3Storage::doSelect(const char* query, int length)
 {
     //fprintf(stdout, "%s\n",query);
     //fflush(stdout);
-    Ref<SLSelectTask> ptask(new SLSelectTask(query));
+    TRACE_SPAN("sql", "select", query);
+    std::string shape = profiler->isEnabled() ? SQLProfiler::normalize(query) : "";
+    return RefCast(_select(query, shape), SQLResult);
+}
+
+Ref<Sqlite3Result> Sqlite3Storage::_select(const char* query, std::string shape)
+{
+    Ref<SLSelectTask> ptask(new SLSelectTask(query, shape));
     addTask(RefCast(ptask, SLTask));
     ptask->waitForTask();
-    return ptask->getResult();
+    SQLProfiler::setQueueWait(ptask->getQueueWait());
+    Ref<Sqlite3Result> res = ptask->takeResult();
+    res->storage = std::static_pointer_cast<Sqlite3Storage>(shared_from_this());
+    return res;
 }
 
-int Sqlite3Storage::exec(const char* query, int length, bool getLastInsertId)
+int Sqlite3Storage::doExec(const char* query, int length, bool getLastInsertId)
 {
     log_debug("Adding query to Queue: %s\n", query);
+    TRACE_SPAN("sql", "exec", query);
     Ref<SLExecTask> ptask(new SLExecTask(query, getLastInsertId));
     addTask(RefCast(ptask, SLTask));
     ptask->waitForTask();
+    SQLProfiler::setQueueWait(ptask->getQueueWait());
     if (getLastInsertId)
         return ptask->getLastInsertId();
     else
         return -1;
 }
 
+int Sqlite3Storage::reserveIDs(const char* sequence, int count)
+{
+    if (isReader())
+        throw _Exception("Tried to write to the database on a reader node");
+    Ref<SLReserveIDsTask> ptask(new SLReserveIDsTask(sequence, count));
+    addTask(RefCast(ptask, SLTask));
+    ptask->waitForTask();
+    return ptask->getFirstID();
+}
+
+std::string Sqlite3Storage::explainQuery(const char* query)
+{
+    std::string plan;
+    try {
+        // columns are id, parent, notused and detail
+        std::string explain = "EXPLAIN QUERY PLAN " + std::string(query);
+        auto res = _select(explain.c_str(), "");
+        std::unique_ptr<SQLRow> row;
+        while ((row = res->nextRow()) != nullptr) {
+            if (!plan.empty())
+                plan += '\n';
+            plan += row->col(3);
+        }
+    } catch (const Exception& e) {
+        log_debug("could not explain query: %s\n", e.getMessage().c_str());
+    }
+    return plan;
+}
+
 void* Sqlite3Storage::staticThreadProc(void* arg)
 {
     auto* inst = (Sqlite3Storage*)arg;
@@ -344,6 +640,7 @@ void Sqlite3Storage::threadProc()
         }
         lock.unlock();
         try {
+            task->setStarted();
             task->run(&db, this);
             if (task->didContamination())
                 dirty = true;
@@ -360,10 +657,71 @@ void Sqlite3Storage::threadProc()
     while ((task = taskQueue->dequeue()) != nullptr) {
         task->sendSignal("Sorry, sqlite3 thread is shutting down");
     }
+    closeCursors();
     if (db)
         sqlite3_close(db);
 }
 
+std::shared_ptr<Sqlite3Batch> Sqlite3Storage::fetchBatch(sqlite3* db, const std::shared_ptr<SLCursor>& cursor)
+{
+    auto batch = std::make_shared<Sqlite3Batch>();
+    batch->ncolumn = cursor->ncolumn;
+    if (cursor->done)
+        return batch;
+
+    while (batch->getRowCount() < SQLITE3_CURSOR_BATCH_ROWS && batch->data.size() < SQLITE3_CURSOR_BATCH_BYTES) {
+        int ret = sqlite3_step(cursor->stmt);
+        if (ret == SQLITE_DONE) {
+            closeCursor(cursor);
+            break;
+        }
+        if (ret != SQLITE_ROW) {
+            std::string error = getError(sqlite3_sql(cursor->stmt), "", db);
+            closeCursor(cursor);
+            throw _StorageException("", error);
+        }
+
+        for (int i = 0; i < cursor->ncolumn; i++) {
+            Sqlite3Batch::Cell cell = { batch->data.size(), -1, false, 0 };
+            int type = sqlite3_column_type(cursor->stmt, i);
+            if (type != SQLITE_NULL) {
+                if (type == SQLITE_INTEGER) {
+                    cell.isInt = true;
+                    cell.intValue = sqlite3_column_int64(cursor->stmt, i);
+                }
+                auto text = reinterpret_cast<const char*>(sqlite3_column_text(cursor->stmt, i));
+                cell.length = sqlite3_column_bytes(cursor->stmt, i);
+                if (text != nullptr)
+                    batch->data.append(text, cell.length);
+            }
+            batch->data += '\0';
+            batch->cells.push_back(cell);
+        }
+        cursor->rows++;
+    }
+    batch->accounted = batch->data.capacity() + batch->cells.capacity() * sizeof(Sqlite3Batch::Cell);
+    MemoryAccounting::add(MemoryAccounting::ACCOUNT_STORAGE, batch->accounted);
+    return batch;
+}
+
+void Sqlite3Storage::closeCursor(const std::shared_ptr<SLCursor>& cursor)
+{
+    if (cursor->stmt != nullptr) {
+        sqlite3_finalize(cursor->stmt);
+        cursor->stmt = nullptr;
+    }
+    cursor->done = true;
+    if (!cursor->shape.empty())
+        profiler->addRows(cursor->shape, cursor->rows);
+    cursors.erase(cursor);
+}
+
+void Sqlite3Storage::closeCursors()
+{
+    while (!cursors.empty())
+        closeCursor(*cursors.begin());
+}
+
 void Sqlite3Storage::addTask(zmm::Ref<SLTask> task, bool onlyIfDirty)
 {
     if (!taskQueueOpen)
@@ -381,6 +739,8 @@ void Sqlite3Storage::addTask(zmm::Ref<SLTask> task, bool onlyIfDirty)
 void Sqlite3Storage::shutdownDriver()
 {
     log_debug("start\n");
+    MemoryAccounting::setSampler(MemoryAccounting::ACCOUNT_STORAGE, nullptr);
+    MemoryAccounting::setShrinker(MemoryAccounting::ACCOUNT_STORAGE, nullptr);
     AutoLockU lock(sqliteMutex);
     shutdownFlag = true;
     if (config->getBoolOption(CFG_SERVER_STORAGE_SQLITE_BACKUP_ENABLED)) {
@@ -412,6 +772,8 @@ SLTask::SLTask()
     error = "";
     contamination = false;
     decontamination = false;
+    created = std::chrono::steady_clock::now();
+    started = created;
 }
 bool SLTask::is_running()
 {
@@ -456,6 +818,7 @@ void SLInitTask::run(sqlite3** db, Sqlite3Storage* sl)
 {
     std::string dbFilePath = config->getOption(CFG_SERVER_STORAGE_SQLITE_DATABASE_FILE);
 
+    sl->closeCursors();
     sqlite3_close(*db);
 
     if (unlink(dbFilePath.c_str()) != 0)
@@ -465,6 +828,9 @@ void SLInitTask::run(sqlite3** db, Sqlite3Storage* sl)
     if (res != SQLITE_OK)
         throw _StorageException("", "error while autocreating sqlite3 database: could not create new database");
 
+    // only takes effect before the first table is created
+    sqlite3_exec(*db, "PRAGMA auto_vacuum = INCREMENTAL", nullptr, nullptr, nullptr);
+
     unsigned char buf[SL3_CREATE_SQL_INFLATED_SIZE + 1]; // +1 for '\0' at the end of the string
     unsigned long uncompressed_size = SL3_CREATE_SQL_INFLATED_SIZE;
     int ret = uncompress(buf, &uncompressed_size, sqlite3_create_sql, SL3_CREATE_SQL_DEFLATED_SIZE);
@@ -492,36 +858,70 @@ void SLInitTask::run(sqlite3** db, Sqlite3Storage* sl)
 
 /* SLSelectTask */
 
-SLSelectTask::SLSelectTask(const char* query)
+SLSelectTask::SLSelectTask(const char* query, std::string shape)
     : SLTask()
+    , shape(shape)
 {
     this->query = query;
 }
 
 void SLSelectTask::run(sqlite3** db, Sqlite3Storage* sl)
 {
-    pres = Ref<Sqlite3Result>(new Sqlite3Result());
+    auto cursor = std::make_shared<SLCursor>();
+    cursor->shape = shape;
 
-    char* err = nullptr;;
-    int ret = sqlite3_get_table(
-        *db,
-        query,
-        &pres->table,
-        &pres->nrow,
-        &pres->ncolumn,
-        &err);
-    std::string error = "";
-    if (err != nullptr) {
-        log_debug(err);
-        error = err;
-        sqlite3_free(err);
-    }
+    int ret = sqlite3_prepare_v2(*db, query, -1, &cursor->stmt, nullptr);
     if (ret != SQLITE_OK) {
-        throw _StorageException("", sl->getError(query, error, *db));
+        if (cursor->stmt != nullptr)
+            sqlite3_finalize(cursor->stmt);
+        throw _StorageException("", sl->getError(query, "", *db));
     }
 
-    pres->row = pres->table;
-    pres->cur_row = 0;
+    if (cursor->stmt == nullptr) {
+        // query consisted of whitespace or comments only
+        cursor->done = true;
+    } else {
+        cursor->ncolumn = sqlite3_column_count(cursor->stmt);
+        sl->cursors.insert(cursor);
+    }
+
+    // the first batch is fetched right away, small results never need a second round trip
+    auto batch = sl->fetchBatch(*db, cursor);
+    pres = Ref<Sqlite3Result>(new Sqlite3Result(cursor, batch));
+}
+
+Ref<Sqlite3Result> SLSelectTask::takeResult()
+{
+    Ref<Sqlite3Result> res = pres;
+    pres = nullptr;
+    return res;
+}
+
+/* SLFetchTask */
+
+SLFetchTask::SLFetchTask(std::shared_ptr<SLCursor> cursor)
+    : SLTask()
+    , cursor(cursor)
+{
+}
+
+void SLFetchTask::run(sqlite3** db, Sqlite3Storage* sl)
+{
+    batch = sl->fetchBatch(*db, cursor);
+}
+
+/* SLFinalizeTask */
+
+SLFinalizeTask::SLFinalizeTask(std::shared_ptr<SLCursor> cursor)
+    : SLTask()
+    , cursor(cursor)
+{
+}
+
+void SLFinalizeTask::run(sqlite3** db, Sqlite3Storage* sl)
+{
+    if (!cursor->done)
+        sl->closeCursor(cursor);
 }
 
 /* SLExecTask */
@@ -556,6 +956,59 @@ void SLExecTask::run(sqlite3** db, Sqlite3Storage* sl)
     contamination = true;
 }
 
+/* SLReserveIDsTask */
+
+SLReserveIDsTask::SLReserveIDsTask(std::string sequence, int count)
+    : SLTask()
+    , sequence(sequence)
+    , count(count)
+    , firstID(INVALID_OBJECT_ID)
+{
+}
+
+void SLReserveIDsTask::run(sqlite3** db, Sqlite3Storage* sl)
+{
+    auto execute = [&](const std::string& query) {
+        char* err = nullptr;
+        int res = sqlite3_exec(*db, query.c_str(), nullptr, nullptr, &err);
+        std::string error = err != nullptr ? err : "";
+        sqlite3_free(err);
+        if (res != SQLITE_OK)
+            throw _StorageException("", sl->getError(query, error, *db));
+    };
+
+    std::string where = " WHERE \"name\"=" + sl->quote(sequence);
+    execute("SAVEPOINT reserve_ids");
+    try {
+        execute("UPDATE \"" SEQUENCE_TABLE "\" SET \"next_id\"=\"next_id\"+" + std::to_string(count) + where);
+
+        std::string query = "SELECT \"next_id\" FROM \"" SEQUENCE_TABLE "\"" + where;
+        sqlite3_stmt* stmt = nullptr;
+        if (sqlite3_prepare_v2(*db, query.c_str(), -1, &stmt, nullptr) != SQLITE_OK)
+            throw _StorageException("", sl->getError(query, "", *db));
+        bool found = sqlite3_step(stmt) == SQLITE_ROW;
+        int next = found ? sqlite3_column_int(stmt, 0) : INVALID_OBJECT_ID;
+        sqlite3_finalize(stmt);
+        if (!found)
+            throw _Exception("could not reserve IDs, sequence missing: " + sequence);
+
+        execute("RELEASE reserve_ids");
+        firstID = next - count;
+    } catch (const Exception&) {
+        execute("ROLLBACK TO reserve_ids");
+        execute("RELEASE reserve_ids");
+        throw;
+    }
+    contamination = true;
+}
+
+/* SLReleaseMemoryTask */
+
+void SLReleaseMemoryTask::run(sqlite3** db, Sqlite3Storage* sl)
+{
+    sqlite3_db_release_memory(*db);
+}
+
 /* SLBackupTask */
 SLBackupTask::SLBackupTask(std::shared_ptr<ConfigManager> config, bool restore) :
     config(config)
@@ -568,6 +1021,13 @@ void SLBackupTask::run(sqlite3** db, Sqlite3Storage* sl)
     std::string dbFilePath = config->getOption(CFG_SERVER_STORAGE_SQLITE_DATABASE_FILE);
 
     if (!restore) {
+        if (!sqlite3_get_autocommit(*db)) {
+            // the database file may hold uncommitted pages, the backup is
+            // queued again when the transaction has ended
+            log_debug("transaction in progress, postponing sqlite3 backup\n");
+            sl->backupPending = true;
+            return;
+        }
         try {
             copy_file(
                 dbFilePath,
@@ -579,6 +1039,7 @@ void SLBackupTask::run(sqlite3** db, Sqlite3Storage* sl)
         }
     } else {
         log_info("trying to restore sqlite3 database from backup...\n");
+        sl->closeCursors();
         sqlite3_close(*db);
         try {
             copy_file(
@@ -598,39 +1059,74 @@ void SLBackupTask::run(sqlite3** db, Sqlite3Storage* sl)
 
 /* Sqlite3Result */
 
-Sqlite3Result::Sqlite3Result()
+Sqlite3Result::Sqlite3Result(std::shared_ptr<SLCursor> cursor, std::shared_ptr<Sqlite3Batch> batch)
     : SQLResult()
+    , cursor(cursor)
+    , batch(batch)
 {
-    table = nullptr;
+    cur_row = 0;
 }
 Sqlite3Result::~Sqlite3Result()
 {
-    if (table) {
-        sqlite3_free_table(table);
-        table = nullptr;
+    if (cursor->done || storage == nullptr)
+        return;
+    // not read to the end, the statement still holds its read lock
+    try {
+        Ref<SLFinalizeTask> ftask(new SLFinalizeTask(cursor));
+        storage->addTask(RefCast(ftask, SLTask));
+    } catch (const Exception& e) {
+        // queue already closed, the sqlite3 thread finalizes all cursors on shutdown
     }
 }
 std::unique_ptr<SQLRow> Sqlite3Result::nextRow()
 {
-    if (nrow) {
-        row += ncolumn;
-        cur_row++;
-        if (cur_row <= nrow) {
-            auto p = std::make_unique<Sqlite3Row>(row, Ref<SQLResult>(this));
-            p->res = Ref<Sqlite3Result>(this);
-            return p;
-        } else
+    if (cur_row >= batch->getRowCount()) {
+        if (cursor->done || storage == nullptr)
+            return nullptr;
+        Ref<SLFetchTask> ftask(new SLFetchTask(cursor));
+        storage->addTask(RefCast(ftask, SLTask));
+        ftask->waitForTask();
+        batch = ftask->getBatch();
+        cur_row = 0;
+        if (batch->getRowCount() == 0)
             return nullptr;
     }
-    return nullptr;
+    return std::make_unique<Sqlite3Row>(batch, batch->ncolumn * cur_row++, Ref<SQLResult>(this));
 }
 
 /* Sqlite3Row */
 
-Sqlite3Row::Sqlite3Row(char** row, Ref<SQLResult> sqlResult)
+Sqlite3Row::Sqlite3Row(std::shared_ptr<Sqlite3Batch> batch, size_t first, Ref<SQLResult> sqlResult)
     : SQLRow(sqlResult)
+    , batch(batch)
+    , first(first)
+{
+}
+
+char* Sqlite3Row::col_c_str(int index)
+{
+    const auto& cell = batch->cells[first + index];
+    if (cell.length < 0)
+        return nullptr;
+    return &batch->data[cell.offset];
+}
+
+std::string_view Sqlite3Row::col_view(int index)
+{
+    const auto& cell = batch->cells[first + index];
+    if (cell.length < 0)
+        return std::string_view();
+    return std::string_view(batch->data.data() + cell.offset, cell.length);
+}
+
+long long Sqlite3Row::col_int64(int index, long long defaultValue)
 {
-    this->row = row;
+    const auto& cell = batch->cells[first + index];
+    if (cell.length < 0)
+        return defaultValue;
+    if (cell.isInt)
+        return cell.intValue;
+    return std::strtoll(batch->data.data() + cell.offset, nullptr, 10);
 }
 
 /* Sqlite3BackupTimerSubscriber */
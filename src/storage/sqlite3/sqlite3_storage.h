@@ -35,12 +35,17 @@
 #ifndef __SQLITE3_STORAGE_H__
 #define __SQLITE3_STORAGE_H__
 
+#include <chrono>
+#include <atomic>
 #include <condition_variable>
 #include <mutex>
 #include <sqlite3.h>
 #include <sstream>
+#include <unordered_set>
+#include <vector>
 
 #include "storage/sql_storage.h"
+#include "util/memory_accounting.h"
 #include "util/timer.h"
 
 class Sqlite3Storage;
@@ -72,6 +77,12 @@ public:
 
     std::string getError() { return error; }
 
+    /// \brief called by the sqlite3 thread right before run()
+    void setStarted() { started = std::chrono::steady_clock::now(); }
+
+    /// \brief time the task spent in the queue in microseconds
+    long long getQueueWait() { return std::chrono::duration_cast<std::chrono::microseconds>(started - created).count(); }
+
 protected:
     /// \brief true as long as the task is not finished
     ///
@@ -88,6 +99,9 @@ protected:
     std::mutex mutex;
 
     std::string error;
+
+    std::chrono::steady_clock::time_point created;
+    std::chrono::steady_clock::time_point started;
 };
 
 /// \brief A task for the sqlite3 thread to inititally create the database.
@@ -101,22 +115,92 @@ protected:
     std::shared_ptr<ConfigManager> config;
 };
 
+/// \brief maximum number of rows copied out of a statement per round trip to the sqlite3 thread
+#define SQLITE3_CURSOR_BATCH_ROWS 256
+/// \brief a batch is also closed once its values exceed this size
+#define SQLITE3_CURSOR_BATCH_BYTES (256 * 1024)
+
+/// \brief A prepared statement that is stepped by the sqlite3 thread in batches.
+///
+/// stmt is only touched by the sqlite3 thread, the Sqlite3Result owning
+/// the cursor only reads done.
+class SLCursor {
+public:
+    sqlite3_stmt* stmt = nullptr;
+    int ncolumn = 0;
+    std::atomic_bool done { false };
+    /// \brief number of rows stepped so far
+    unsigned long long rows = 0;
+    /// \brief normalised query for the profiler, empty if not profiling
+    std::string shape;
+};
+
+/// \brief Column values of consecutive rows, copied out of a statement.
+///
+/// All values share one buffer and are '\0' terminated, so rows can hand
+/// out pointers and views without copying.
+class Sqlite3Batch {
+public:
+    struct Cell {
+        size_t offset;
+        /// \brief -1 for NULL
+        int length;
+        bool isInt;
+        long long intValue;
+    };
+
+    int ncolumn = 0;
+    std::string data;
+    std::vector<Cell> cells;
+    /// \brief bytes reported to MemoryAccounting
+    long long accounted = 0;
+
+    ~Sqlite3Batch() { MemoryAccounting::sub(MemoryAccounting::ACCOUNT_STORAGE, accounted); }
+
+    size_t getRowCount() const { return ncolumn > 0 ? cells.size() / ncolumn : 0; }
+};
+
 /// \brief A task for the sqlite3 thread to do a SQL select.
 class SLSelectTask : public SLTask {
 public:
     /// \brief Constructor for the sqlite3 select task
     /// \param query The SQL query string
-    SLSelectTask(const char* query);
+    /// \param shape normalised query for the profiler, empty if not profiling
+    SLSelectTask(const char* query, std::string shape);
     virtual void run(sqlite3** db, Sqlite3Storage* sl);
-    inline zmm::Ref<SQLResult> getResult() { return RefCast(pres, SQLResult); };
+    /// \brief hands the result over to the calling thread, the task keeps no reference
+    zmm::Ref<Sqlite3Result> takeResult();
 
 protected:
     /// \brief The SQL query string
     const char* query;
+    std::string shape;
     /// \brief The Sqlite3Result
     zmm::Ref<Sqlite3Result> pres;
 };
 
+/// \brief A task for the sqlite3 thread to fetch the next batch of a cursor.
+class SLFetchTask : public SLTask {
+public:
+    SLFetchTask(std::shared_ptr<SLCursor> cursor);
+    virtual void run(sqlite3** db, Sqlite3Storage* sl);
+    std::shared_ptr<Sqlite3Batch> getBatch() { return batch; }
+
+protected:
+    std::shared_ptr<SLCursor> cursor;
+    std::shared_ptr<Sqlite3Batch> batch;
+};
+
+/// \brief A task for the sqlite3 thread to finalize a cursor that was not read to the end.
+class SLFinalizeTask : public SLTask {
+public:
+    SLFinalizeTask(std::shared_ptr<SLCursor> cursor);
+    virtual void run(sqlite3** db, Sqlite3Storage* sl);
+
+protected:
+    std::shared_ptr<SLCursor> cursor;
+};
+
 /// \brief A task for the sqlite3 thread to do a SQL exec.
 class SLExecTask : public SLTask {
 public:
@@ -146,6 +230,29 @@ protected:
     bool restore;
 };
 
+/// \brief A task for the sqlite3 thread to reserve IDs of a sequence.
+///
+/// The update and the select run back to back in a savepoint, so no other
+/// statement comes between them and a failure undoes the update, whether
+/// a transaction is open or not.
+class SLReserveIDsTask : public SLTask {
+public:
+    SLReserveIDsTask(std::string sequence, int count);
+    virtual void run(sqlite3** db, Sqlite3Storage* sl);
+    inline int getFirstID() { return firstID; }
+
+protected:
+    std::string sequence;
+    int count;
+    int firstID;
+};
+
+/// \brief A task for the sqlite3 thread to release the page cache.
+class SLReleaseMemoryTask : public SLTask {
+public:
+    virtual void run(sqlite3** db, Sqlite3Storage* sl);
+};
+
 /// \brief The Storage class for using SQLite3
 class Sqlite3Storage : public Timer::Subscriber, public SQLStorage, public std::enable_shared_from_this<SQLStorage> {
 public:
@@ -166,11 +273,23 @@ private:
     inline std::string quote(bool val) override { return std::string(val ? "1" : "0"); }
     inline std::string quote(char val) override { return quote(std::string(1, val)); }
     inline std::string quote(long long val) override { return std::to_string(val); }
-    zmm::Ref<SQLResult> select(const char* query, int length) override;
-    int exec(const char* query, int length, bool getLastInsertId = false) override;
+    zmm::Ref<SQLResult> doSelect(const char* query, int length) override;
+    int doExec(const char* query, int length, bool getLastInsertId) override;
+    std::string explainQuery(const char* query) override;
+    // dc_title uses the default BINARY collation
+    bool orderedByBytes() override { return true; }
     void storeInternalSetting(std::string key, std::string value) override;
+    int reserveIDs(const char* sequence, int count) override;
+    void transactionEnded() override;
+    void beginBulkLoad() override;
+    void endBulkLoad() override;
+    bool reclaimSpace() override;
+    bool updateStatistics(int step) override;
+    void analyzeTable(const std::string& table) override;
 
     void _exec(const char* query);
+    void _exec(const std::string& query) { _exec(query.c_str()); }
+    zmm::Ref<Sqlite3Result> _select(const char* query, std::string shape);
 
     std::string startupError;
 
@@ -201,27 +320,49 @@ private:
 
     bool dirty;
 
+    /// \brief set between beginBulkLoad() and endBulkLoad()
+    bool bulkLoad;
+    /// \brief definitions of the indexes dropped by beginBulkLoad()
+    std::vector<std::string> bulkLoadIndexes;
+
+    /// \brief a backup was due while a transaction was open, it is taken
+    /// once the transaction has ended
+    std::atomic_bool backupPending;
+
+    /// \brief statements not yet stepped to the end, only used by the sqlite3 thread
+    std::unordered_set<std::shared_ptr<SLCursor>> cursors;
+
+    /// \brief copies the next rows of a cursor, the cursor is closed when it is exhausted
+    std::shared_ptr<Sqlite3Batch> fetchBatch(sqlite3* db, const std::shared_ptr<SLCursor>& cursor);
+    void closeCursor(const std::shared_ptr<SLCursor>& cursor);
+    /// \brief finalizes all open statements, required before the database is closed
+    void closeCursors();
+
     friend class SLSelectTask;
+    friend class SLFetchTask;
+    friend class SLFinalizeTask;
+    friend class SLBackupTask;
+    friend class Sqlite3Result;
     friend class SLExecTask;
+    friend class SLReserveIDsTask;
     friend class SLInitTask;
     friend class Sqlite3BackupTimerSubscriber;
 };
 
 /// \brief Represents a result of a sqlite3 select
+///
+/// Rows are streamed from the sqlite3 thread in batches, the statement is
+/// finalized when the result is exhausted or destroyed.
 class Sqlite3Result : public SQLResult {
 private:
-    Sqlite3Result();
+    Sqlite3Result(std::shared_ptr<SLCursor> cursor, std::shared_ptr<Sqlite3Batch> batch);
     virtual ~Sqlite3Result();
     virtual std::unique_ptr<SQLRow> nextRow() override;
-    virtual unsigned long long getNumRows() override { return nrow; }
-
-    char** table;
-    char** row;
 
-    int cur_row;
-
-    int nrow;
-    int ncolumn;
+    std::shared_ptr<Sqlite3Storage> storage;
+    std::shared_ptr<SLCursor> cursor;
+    std::shared_ptr<Sqlite3Batch> batch;
+    size_t cur_row;
 
     friend class SLSelectTask;
     friend class Sqlite3Row;
@@ -231,12 +372,16 @@ private:
 /// \brief Represents a row of a result of a sqlite3 select
 class Sqlite3Row : public SQLRow {
 public:
-    Sqlite3Row(char** row, zmm::Ref<SQLResult> sqlResult);
+    Sqlite3Row(std::shared_ptr<Sqlite3Batch> batch, size_t first, zmm::Ref<SQLResult> sqlResult);
 
 private:
-    inline virtual char* col_c_str(int index) { return row[index]; }
-    char** row;
-    zmm::Ref<Sqlite3Result> res;
+    virtual char* col_c_str(int index) override;
+    virtual std::string_view col_view(int index) override;
+    virtual long long col_int64(int index, long long defaultValue) override;
+
+    /// \brief keeps the values alive as long as the row, also beyond the next batch
+    std::shared_ptr<Sqlite3Batch> batch;
+    size_t first;
 
     friend class Sqlite3Result;
 };
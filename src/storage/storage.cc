@@ -45,6 +45,9 @@ using namespace zmm;
 Storage::Storage(std::shared_ptr<ConfigManager> config)
     : config(config)
 {
+    std::string role = config->getOption(CFG_SERVER_STORAGE_ROLE);
+    reader = (role == STORAGE_ROLE_READER);
+    writer = (role == STORAGE_ROLE_WRITER);
 }
 
 std::shared_ptr<Storage> Storage::createInstance(std::shared_ptr<ConfigManager> config, std::shared_ptr<Timer> timer)
@@ -71,7 +74,8 @@ std::shared_ptr<Storage> Storage::createInstance(std::shared_ptr<ConfigManager>
     } while (false);
 
     storage->init();
-    storage->doMetadataMigration();
+    if (!storage->isReader())
+        storage->doMetadataMigration();
 
     return storage;
 }
@@ -32,8 +32,10 @@
 #ifndef __STORAGE_H__
 #define __STORAGE_H__
 
+#include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -56,8 +58,11 @@ protected:
     int startingIndex;
     int requestedCount;
 
+    std::string client;
+
     // output parameters
     int totalMatches;
+    int updateID;
 
 public:
     inline BrowseParam(int objectID, unsigned int flags)
@@ -66,6 +71,7 @@ public:
         this->flags = flags;
         startingIndex = 0;
         requestedCount = 0;
+        updateID = -1;
     }
 
     inline int getFlags() { return flags; }
@@ -101,12 +107,21 @@ public:
     inline int getStartingIndex() { return startingIndex; }
     inline int getRequestedCount() { return requestedCount; }
 
+    /// \brief Address of the client paging through the container, browse
+    /// snapshots are kept per client.
+    inline std::string getClient() { return client; }
+    inline void setClient(const std::string& client) { this->client = client; }
+
     inline int getTotalMatches() { return totalMatches; }
 
     inline void setTotalMatches(int totalMatches)
     {
         this->totalMatches = totalMatches;
     }
+
+    /// \brief Update ID of the browsed object the result belongs to.
+    inline int getUpdateID() { return updateID; }
+    inline void setUpdateID(int updateID) { this->updateID = updateID; }
 };
 
 class SearchParam {
@@ -115,23 +130,28 @@ protected:
     std::string searchCrit;
     int startingIndex;
     int requestedCount;
+    std::string sortCrit;
 
 public:
     SearchParam(const std::string& containerID, const std::string& searchCriteria, int startingIndex,
-        int requestedCount)
+        int requestedCount, const std::string& sortCriteria = "")
         : containerID(containerID)
         , searchCrit(searchCriteria)
         , startingIndex(startingIndex)
         , requestedCount(requestedCount)
+        , sortCrit(sortCriteria)
     {
     }
     const std::string& searchCriteria() const { return searchCrit; };
+    /// \brief UPnP SortCriteria, e.g. "+upnp:artist,-dc:date"
+    const std::string& sortCriteria() const { return sortCrit; };
     int getStartingIndex() { return startingIndex; };
     int getRequestedCount() { return requestedCount; };
 };
 
 // forward declaration
 class ConfigManager;
+class SQLProfiler;
 class Timer;
 
 class Storage {
@@ -142,7 +162,13 @@ public:
     /// \brief shutdown the Storage with its possible threads
     virtual void shutdown() = 0;
 
-    virtual void addObject(std::shared_ptr<CdsObject> object, int* changedContainer) = 0;
+    /// \brief Adds an object to the database.
+    /// \param changedContainer returns the ID of the container that got a
+    /// new child when the parent path had to be created
+    /// \param changedGrandparent returns the parent ID of the object's
+    /// parent if that parent had no children before, since the child count
+    /// shown in the grandparent's listing changed; INVALID_OBJECT_ID otherwise
+    virtual void addObject(std::shared_ptr<CdsObject> object, int* changedContainer, int* changedGrandparent = nullptr) = 0;
 
     /// \brief Adds a virtual container chain specified by path.
     /// \param path container path separated by '/'. Slashes in container
@@ -202,6 +228,19 @@ public:
     ///  "id,update_id"
     virtual std::string incrementUpdateIDs(const std::unique_ptr<std::unordered_set<int>>& ids) = 0;
 
+    /// \brief Returns the container updates recorded in the change log by
+    /// the writer node, in the same format as incrementUpdateIDs().
+    /// \param lastChangeID newest change already seen, updated to the newest
+    /// change returned; a negative value starts at the current end of the log
+    virtual std::string getChangesSince(int& lastChangeID) = 0;
+
+    /// \brief This server only reads a database that is maintained by a
+    /// writer node, see the role attribute of the storage configuration.
+    bool isReader() const { return reader; }
+
+    /// \brief This server records its container updates for reader nodes.
+    bool isWriter() const { return writer; }
+
     /* utility methods */
     virtual std::shared_ptr<CdsObject> loadObject(int objectID) = 0;
     virtual int getChildCount(int contId, bool containers = true, bool items = true, bool hideFsRoot = false) = 0;
@@ -247,6 +286,58 @@ public:
     /// In the database, the service is identified by a service id prefix.
     virtual std::unique_ptr<std::vector<int>> getServiceObjectIDs(char servicePrefix) = 0;
 
+    /// \brief Return the object ID's of the imported files whose mime type
+    /// starts with the given prefix, ordered by location.
+    virtual std::unique_ptr<std::vector<int>> getFileItemIDs(std::string mimeTypePrefix) = 0;
+
+    /// \brief Refresh state of one online service item.
+    class ServiceState {
+    public:
+        /// \brief all objects carrying the service id, the layout may
+        /// add the same item in several places
+        std::vector<int> objectIDs;
+        /// \brief content hash stored by the last refresh, empty if unknown
+        std::string contentHash;
+    };
+
+    /// \brief Loads the refresh state of all objects of a service, keyed
+    /// by service id.
+    virtual std::unique_ptr<std::unordered_map<std::string, ServiceState>> getServiceState(char servicePrefix) = 0;
+
+    /// \brief Marks unchanged service objects as seen by the current refresh.
+    virtual void touchServiceObjects(const std::vector<int>& objectIDs, time_t seen) = 0;
+
+    /// \brief Stores the content hash of added or updated service items,
+    /// keyed by service id, for all objects carrying the service id.
+    virtual void storeServiceState(char servicePrefix, const std::map<std::string, std::string>& hashes, time_t seen) = 0;
+
+    /// \brief Returns the objects of a service that were not seen by any
+    /// refresh since the given time.
+    virtual std::unique_ptr<std::unordered_set<int>> getStaleServiceObjects(char servicePrefix, time_t seenBefore) = 0;
+
+    /// \brief Groups the following statements of the calling thread into one
+    /// transaction, if the database supports it. Statements of other threads
+    /// wait until the transaction has ended. Calls may be nested, only the
+    /// outermost commit or rollback ends the transaction, if an inner level
+    /// was rolled back the whole transaction is rolled back.
+    virtual void beginTransaction() { }
+    virtual void commitTransaction() { }
+    virtual void rollbackTransaction() { }
+
+    /// \brief Prepares the database for adding a large number of objects
+    /// at once, if the database supports it. Durability is given up and
+    /// indexes that are not needed to add objects are dropped until
+    /// endBulkLoad() is called. Only used on a database no one else
+    /// has opened, see Server::index().
+    virtual void beginBulkLoad() { }
+    virtual void endBulkLoad() { }
+
+    /// \brief Runs the next short step of the database maintenance, see
+    /// StorageMaintenance. Requests are answered between the steps.
+    /// \return false when a round of maintenance is complete, the next
+    /// call starts a new round
+    virtual bool maintenanceStep() { return false; }
+
     /* accounting methods */
     virtual int getTotalFiles() = 0;
 
@@ -312,6 +403,9 @@ public:
 
     virtual void doMetadataMigration() = 0;
 
+    /// \brief returns the statement profiler or nullptr if the driver has none
+    virtual std::shared_ptr<SQLProfiler> getProfiler() { return nullptr; }
+
 protected:
     /* helper for addContainerChain */
     static void stripAndUnescapeVirtualContainerFromPath(std::string path, std::string& first, std::string& last);
@@ -323,6 +417,8 @@ protected:
 
 protected:
     std::shared_ptr<ConfigManager> config;
+    bool reader;
+    bool writer;
 };
 
 #endif // __STORAGE_H__
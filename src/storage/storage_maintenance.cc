@@ -0,0 +1,88 @@
+/*GRB*
+
+Gerbera - https://gerbera.io/
+
+    storage_maintenance.cc - this file is part of Gerbera.
+
+    Copyright (C) 2016-2019 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+
+/// \file storage_maintenance.cc
+
+#include "storage_maintenance.h"
+
+#include <chrono>
+
+#include "config/config_manager.h"
+#include "storage/storage.h"
+
+StorageMaintenance::StorageMaintenance(std::shared_ptr<ConfigManager> config, std::shared_ptr<Storage> storage,
+    std::shared_ptr<Timer> timer, std::function<bool()> isIdle)
+    : storage(storage)
+    , timer(timer)
+    , isIdle(isIdle)
+    , running(false)
+    , nextRound(0)
+{
+    interval = config->getIntOption(CFG_SERVER_STORAGE_MAINTENANCE_INTERVAL);
+    slice = config->getIntOption(CFG_SERVER_STORAGE_MAINTENANCE_SLICE);
+    // the writer maintains a shared database
+    if (storage->isReader())
+        interval = 0;
+}
+
+void StorageMaintenance::init()
+{
+    if (interval > 0)
+        timer->addTimerSubscriber(this, STORAGE_MAINTENANCE_CHECK_INTERVAL, nullptr);
+}
+
+void StorageMaintenance::shutdown()
+{
+    if (interval > 0)
+        timer->removeTimerSubscriber(this, nullptr, true);
+}
+
+void StorageMaintenance::timerNotify(std::shared_ptr<Timer::Parameter> parameter)
+{
+    if (!running && time(nullptr) < nextRound)
+        return;
+    if (!isIdle())
+        return;
+    if (!running) {
+        log_debug("Starting database maintenance\n");
+        running = true;
+    }
+
+    auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(slice);
+    do {
+        bool more;
+        try {
+            more = storage->maintenanceStep();
+        } catch (const Exception& e) {
+            log_error("Database maintenance failed: %s\n", e.getMessage().c_str());
+            more = false;
+        }
+        if (!more) {
+            running = false;
+            nextRound = time(nullptr) + interval;
+            log_info("Database maintenance done\n");
+            return;
+        }
+    } while (std::chrono::steady_clock::now() < end && isIdle());
+}
@@ -0,0 +1,76 @@
+/*GRB*
+
+Gerbera - https://gerbera.io/
+
+    storage_maintenance.h - this file is part of Gerbera.
+
+    Copyright (C) 2016-2019 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+
+/// \file storage_maintenance.h
+#ifndef __STORAGE_MAINTENANCE_H__
+#define __STORAGE_MAINTENANCE_H__
+
+#include <ctime>
+#include <functional>
+#include <memory>
+
+#include "util/timer.h"
+
+// forward declarations
+class ConfigManager;
+class Storage;
+
+/// \brief seconds between two checks whether maintenance can run
+#define STORAGE_MAINTENANCE_CHECK_INTERVAL 60
+
+/// \brief Keeps the database small and its planner statistics current.
+///
+/// A round of maintenance prunes unused metadata values, returns free
+/// pages to the file system and refreshes the statistics of the query
+/// planner, see Storage::maintenanceStep(). It starts once per configured
+/// interval and only works while the server is idle. Each check runs
+/// steps for at most one time slice, a round may take many checks.
+class StorageMaintenance : public Timer::Subscriber {
+public:
+    /// \param isIdle tells if no media is served and no import is running,
+    /// it keeps maintenance out of the way, storage stays consistent
+    /// when objects are written during a step
+    StorageMaintenance(std::shared_ptr<ConfigManager> config, std::shared_ptr<Storage> storage,
+        std::shared_ptr<Timer> timer, std::function<bool()> isIdle);
+
+    void init();
+    void shutdown();
+
+    void timerNotify(std::shared_ptr<Timer::Parameter> parameter) override;
+
+protected:
+    std::shared_ptr<Storage> storage;
+    std::shared_ptr<Timer> timer;
+    std::function<bool()> isIdle;
+
+    /// \brief seconds between the start of two rounds, 0 disables maintenance
+    int interval;
+    /// \brief milliseconds of work per check
+    int slice;
+
+    bool running;
+    time_t nextRound;
+};
+
+#endif // __STORAGE_MAINTENANCE_H__
@@ -52,6 +52,7 @@
 #include "iohandler/file_io_handler.h"
 #include "iohandler/io_handler_chainer.h"
 #include "metadata/metadata_handler.h"
+#include "util/seek_index.h"
 #include "util/tools.h"
 #include "transcoding_process_executor.h"
 #include "iohandler/io_handler_chainer.h"
@@ -144,7 +145,7 @@ std::unique_ptr<IOHandler> TranscodeExternalHandler::open(Ref<TranscodingProfile
         int p1 = find_local_port(45000,65500);
         int p2 = find_local_port(45000,65500);
         sop_args = parseCommandLine(location + " " + std::to_string(p1) + " " +
-                   std::to_string(p2), nullptr, nullptr, nullptr);
+                   std::to_string(p2), "", "", "", "");
         auto spsc = std::make_shared<ProcessExecutor>("sp-sc-auth", sop_args);
         auto pr_item = std::make_shared<ProcListItem>(spsc);
         proc_list.push_back(pr_item);
@@ -231,7 +232,20 @@ std::unique_ptr<IOHandler> TranscodeExternalHandler::open(Ref<TranscodingProfile
         
     chmod(fifo_name.c_str(), S_IWUSR | S_IRUSR);
    
-    arglist = parseCommandLine(profile->getArguments(), location, fifo_name, range);
+    // start at the key frame before the requested time, the transcoder can
+    // seek to it in the input instead of decoding everything up to it
+    std::string offset = "0";
+    double start = string_ok(range) ? SeekIndex::parseNptStart(range) : -1;
+    if (start > 0) {
+        auto index = isURL ? nullptr : content->getSeekIndex(location);
+        SeekIndex::Point point;
+        if (index != nullptr && index->find(start, point))
+            start = point.time;
+        offset = SeekIndex::formatNpt(start);
+        log_debug("Transcoding from %s s for range %s\n", offset.c_str(), range.c_str());
+    }
+
+    arglist = parseCommandLine(profile->getArguments(), location, fifo_name, range, offset);
 
     log_debug("Command: %s\n", profile->getCommand().c_str());
     log_debug("Arguments: %s\n", profile->getArguments().c_str());
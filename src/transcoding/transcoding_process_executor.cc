@@ -31,9 +31,11 @@
 
 #include <unistd.h>
 #include "transcoding_process_executor.h"
+#include "util/scheduling.h"
 
 TranscodingProcessExecutor::TranscodingProcessExecutor(std::string command, std::vector<std::string> arglist) : ProcessExecutor(command, arglist)
 {
+    Scheduling::applyToProcess(Scheduling::GROUP_TRANSCODE, process_id);
 };
 
 void TranscodingProcessExecutor::removeFile(std::string filename)
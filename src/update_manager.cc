@@ -31,6 +31,7 @@
 
 #include "update_manager.h"
 
+#include "config/config_manager.h"
 #include "server.h"
 #include "storage/storage.h"
 #include "util/tools.h"
@@ -50,8 +51,9 @@
 using namespace zmm;
 using namespace std;
 
-UpdateManager::UpdateManager(std::shared_ptr<Storage> storage, std::shared_ptr<Server> server)
-    : storage(storage)
+UpdateManager::UpdateManager(std::shared_ptr<ConfigManager> config, std::shared_ptr<Storage> storage, std::shared_ptr<Server> server)
+    : config(config)
+    , storage(storage)
     , server(server)
     , objectIDHash(make_unique<unordered_set<int>>())
     , shutdownFlag(false)
@@ -97,6 +99,8 @@ void UpdateManager::shutdown()
 
 void UpdateManager::containersChanged(const std::vector<int>& objectIDs, int flushPolicy)
 {
+    if (storage->isReader())
+        return;
     AutoLockU lock(mutex);
     // signalling thread if it could have been idle, because
     // there were no unprocessed updates
@@ -135,7 +139,7 @@ void UpdateManager::containersChanged(const std::vector<int>& objectIDs, int flu
 
 void UpdateManager::containerChanged(int objectID, int flushPolicy)
 {
-    if (objectID == INVALID_OBJECT_ID)
+    if (objectID == INVALID_OBJECT_ID || storage->isReader())
         return;
     AutoLock lock(mutex);
     if (objectID != lastContainerChanged || flushPolicy > this->flushPolicy) {
@@ -211,16 +215,19 @@ void UpdateManager::threadProc()
                 flushPolicy = FLUSH_SPEC;
                 std::string updateString;
 
+                // the storage may wait for the transaction of a thread that
+                // reports further changes meanwhile
+                auto changed = std::move(objectIDHash);
+                objectIDHash = make_unique<unordered_set<int>>();
+                lock.unlock(); // we don't need to hold the lock during the sending of the updates
                 try {
-                    updateString = storage->incrementUpdateIDs(objectIDHash);
-                    objectIDHash->clear(); // hash_data_array will be invalid after clear()
+                    updateString = storage->incrementUpdateIDs(changed);
                 } catch (const Exception& e) {
                     e.printStackTrace();
                     log_error("Fatal error when sending updates: %s\n", e.getMessage().c_str());
                     log_error("Forcing MediaTomb shutdown.\n");
                     kill(0, SIGINT);
                 }
-                lock.unlock(); // we don't need to hold the lock during the sending of the updates
                 if (string_ok(updateString)) {
                     try {
                         log_debug("updates sent: \"%s\"\n", updateString.c_str());
@@ -245,11 +252,42 @@ void UpdateManager::threadProc()
     storage->threadCleanup();
 }
 
+void UpdateManager::readerThreadProc()
+{
+    auto interval = chrono::seconds(config->getIntOption(CFG_SERVER_STORAGE_CHANGE_POLL_INTERVAL));
+    int lastChangeID = -1;
+
+    AutoLockU lock(mutex);
+    while (!shutdownFlag) {
+        lock.unlock();
+        std::string updateString;
+        try {
+            updateString = storage->getChangesSince(lastChangeID);
+            if (string_ok(updateString)) {
+                log_debug("updates sent: \"%s\"\n", updateString.c_str());
+                server->sendCDSSubscriptionUpdate(updateString);
+            }
+        } catch (const Exception& e) {
+            // the writer may be restarting, keep polling
+            log_error("Error while polling the change log: %s\n", e.getMessage().c_str());
+        }
+        lock.lock();
+        if (!shutdownFlag)
+            cond.wait_for(lock, interval);
+    }
+    lock.unlock();
+
+    storage->threadCleanup();
+}
+
 void* UpdateManager::staticThreadProc(void* arg)
 {
     log_debug("starting update thread... thread: %d\n", pthread_self());
     auto* inst = (UpdateManager*)arg;
-    inst->threadProc();
+    if (inst->storage->isReader())
+        inst->readerThreadProc();
+    else
+        inst->threadProc();
 
     log_debug("update thread shut down. thread: %d\n", pthread_self());
     return nullptr;
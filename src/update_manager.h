@@ -43,12 +43,13 @@
 #define FLUSH_SPEC 1
 
 // forward declaration
+class ConfigManager;
 class Storage;
 class Server;
 
 class UpdateManager {
 public:
-    UpdateManager(std::shared_ptr<Storage> storage, std::shared_ptr<Server> server);
+    UpdateManager(std::shared_ptr<ConfigManager> config, std::shared_ptr<Storage> storage, std::shared_ptr<Server> server);
     void init();
     virtual ~UpdateManager();
     void shutdown();
@@ -57,6 +58,7 @@ public:
     void containersChanged(const std::vector<int>& objectIDs, int flushPolicy = FLUSH_SPEC);
 
 protected:
+    std::shared_ptr<ConfigManager> config;
     std::shared_ptr<Storage> storage;
     std::shared_ptr<Server> server;
 
@@ -76,6 +78,9 @@ protected:
 
     static void* staticThreadProc(void* arg);
     void threadProc();
+    /// \brief Reader nodes do not change the database, they announce the
+    /// changes the writer node recorded in the change log instead.
+    void readerThreadProc();
 
     inline bool haveUpdates() { return (objectIDHash->size() > 0); }
 };
@@ -34,6 +34,7 @@
 #include "search_handler.h"
 #include "server.h"
 #include "storage/storage.h"
+#include "util/trace.h"
 #include <memory>
 #include <string>
 #include <vector>
@@ -95,6 +96,7 @@ void ContentDirectoryService::doBrowse(const std::unique_ptr<ActionRequest>& req
 
     param->setStartingIndex(std::stoi(StartingIndex));
     param->setRequestedCount(std::stoi(RequestedCount));
+    param->setClient(request->getClient());
 
     std::vector<std::shared_ptr<CdsObject>> arr;
     try {
@@ -138,7 +140,9 @@ void ContentDirectoryService::doBrowse(const std::unique_ptr<ActionRequest>& req
     response->appendTextChild("Result", didl_lite->print());
     response->appendTextChild("NumberReturned", std::to_string(arr.size()));
     response->appendTextChild("TotalMatches", std::to_string(param->getTotalMatches()));
-    response->appendTextChild("UpdateID", std::to_string(systemUpdateID));
+    // the update ID of the browsed container, pages taken from a browse
+    // snapshot carry the one the snapshot was taken at
+    response->appendTextChild("UpdateID", std::to_string(param->getUpdateID()));
 
     request->setResponse(response);
     log_debug("end\n");
@@ -153,8 +157,9 @@ void ContentDirectoryService::doSearch(const std::unique_ptr<ActionRequest>& req
     std::string searchCriteria(req->getChildText("SearchCriteria").c_str());
     std::string startingIndex(req->getChildText("StartingIndex").c_str());
     std::string requestedCount(req->getChildText("RequestedCount").c_str());
-    log_debug("Search received parameters: ContainerID [%s] SearchCriteria [%s] StartingIndex [%s] RequestedCount [%s]\n",
-        containerID.c_str(), searchCriteria.c_str(), startingIndex.c_str(), requestedCount.c_str());
+    std::string sortCriteria(req->getChildText("SortCriteria").c_str());
+    log_debug("Search received parameters: ContainerID [%s] SearchCriteria [%s] StartingIndex [%s] RequestedCount [%s] SortCriteria [%s]\n",
+        containerID.c_str(), searchCriteria.c_str(), startingIndex.c_str(), requestedCount.c_str(), sortCriteria.c_str());
 
     Ref<Element> didl_lite(new Element("DIDL-Lite"));
     didl_lite->setAttribute(XML_NAMESPACE_ATTR,
@@ -170,7 +175,7 @@ void ContentDirectoryService::doSearch(const std::unique_ptr<ActionRequest>& req
     }
 
     auto searchParam = std::make_unique<SearchParam>(containerID, searchCriteria,
-        std::stoi(startingIndex.c_str(), nullptr), std::stoi(requestedCount.c_str(), nullptr));
+        std::stoi(startingIndex.c_str(), nullptr), std::stoi(requestedCount.c_str(), nullptr), sortCriteria);
 
     std::vector<std::shared_ptr<CdsObject>> results;
     int numMatches = 0;
@@ -214,7 +219,7 @@ void ContentDirectoryService::doGetSearchCapabilities(const std::unique_ptr<Acti
 
     Ref<Element> response;
     response = xmlBuilder->createResponse(request->getActionName(), DESC_CDS_SERVICE_TYPE);
-    response->appendTextChild("SearchCaps", "dc:title,upnp:class,upnp:artist,upnp:album");
+    response->appendTextChild("SearchCaps", "dc:title,upnp:class,upnp:artist,upnp:album,upnp:genre,dc:date");
 
     request->setResponse(response);
 
@@ -250,6 +255,7 @@ void ContentDirectoryService::doGetSystemUpdateID(const std::unique_ptr<ActionRe
 void ContentDirectoryService::processActionRequest(const std::unique_ptr<ActionRequest>& request)
 {
     log_debug("start\n");
+    TRACE_SPAN("upnp", "ContentDirectory", request->getActionName());
 
     if (request->getActionName() == "Browse") {
         doBrowse(request);
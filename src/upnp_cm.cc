@@ -34,6 +34,7 @@
 #include "storage/storage.h"
 #include "server.h"
 #include "util/tools.h"
+#include "util/trace.h"
 
 using namespace zmm;
 using namespace mxml;
@@ -95,6 +96,7 @@ void ConnectionManagerService::doGetProtocolInfo(const std::unique_ptr<ActionReq
 void ConnectionManagerService::processActionRequest(const std::unique_ptr<ActionRequest>& request)
 {
     log_debug("start\n");
+    TRACE_SPAN("upnp", "ConnectionManager", request->getActionName());
 
     if (request->getActionName() == "GetCurrentConnectionIDs") {
         doGetCurrentConnectionIDs(request);
@@ -35,6 +35,7 @@
 #include "server.h"
 #include "storage/storage.h"
 #include "util/tools.h"
+#include "util/trace.h"
 #include "upnp_xml.h"
 
 using namespace zmm;
@@ -90,6 +91,7 @@ void MRRegistrarService::doIsValidated(const std::unique_ptr<ActionRequest>& req
 void MRRegistrarService::processActionRequest(const std::unique_ptr<ActionRequest>& request)
 {
     log_debug("start\n");
+    TRACE_SPAN("upnp", "MediaReceiverRegistrar", request->getActionName());
 
     if (request->getActionName() == "IsAuthorized") {
         doIsAuthorized(request);
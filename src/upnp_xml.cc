@@ -35,6 +35,7 @@
 #include "metadata/metadata_handler.h"
 #include "server.h"
 #include "storage/storage.h"
+#include "util/headers.h"
 
 using namespace zmm;
 using namespace mxml;
@@ -458,20 +459,16 @@ Ref<Element> UpnpXMLBuilder::renderResource(std::string URL, const std::map<std:
     return res;
 }
 
-Ref<Element> UpnpXMLBuilder::renderCaptionInfo(std::string URL)
+Ref<Element> UpnpXMLBuilder::renderCaptionInfo(std::string URL, std::string type)
 {
     Ref<Element> cap(new Element("sec:CaptionInfoEx"));
 
     // Samsung DLNA clients don't follow this URL and
     // obtain subtitle location from video HTTP headers.
-    // We don't need to know here what the subtitle type
-    // is and even if there is a subtitle.
     // This tag seems to be only a hint for Samsung devices,
     // though it's necessary.
-
-    size_t endp = URL.rfind('.');
-    cap->setText(URL.substr(0, endp) + ".srt");
-    cap->setAttribute("sec:type", "srt");
+    cap->setText(URL);
+    cap->setAttribute("sec:type", type);
 
     return cap;
 }
@@ -572,6 +569,21 @@ std::string UpnpXMLBuilder::getFirstResourcePath(std::shared_ptr<CdsItem> item)
     return result;
 }
 
+std::string UpnpXMLBuilder::getSubtitleURL(std::shared_ptr<CdsItem> item)
+{
+    auto urlBase = getPathBase(item);
+    if (!urlBase->addResID)
+        return "";
+
+    int resCount = item->getResourceCount();
+    for (int i = 1; i < resCount; i++) {
+        auto res = item->getResource(i);
+        if (res->getHandlerType() == CH_SUBTITLE)
+            return virtualURL + urlBase->pathBase + std::to_string(i) + renderExtension("", res->getOption(RESOURCE_OPTION_SUBTITLE_EXT));
+    }
+    return "";
+}
+
 std::string UpnpXMLBuilder::getArtworkUrl(std::shared_ptr<CdsItem> item) {
     // FIXME: This is temporary until we do artwork properly.
     log_debug("Building Art url for %d\n", item->getID());
@@ -645,6 +657,7 @@ void UpnpXMLBuilder::addResources(std::shared_ptr<CdsItem> item, Ref<Element> el
     // this will be used to count only the "real" resources, omitting the
     // transcoded ones
     int realCount = 0;
+    bool captionRendered = false;
     bool hide_original_resource = false;
     int original_resource = 0;
 
@@ -875,7 +888,9 @@ void UpnpXMLBuilder::addResources(std::shared_ptr<CdsItem> item, Ref<Element> el
             // content type here and that we will not limit ourselves to the
             // first resource
             if (!skipURL) {
-                if (transcoded)
+                if (res->getHandlerType() == CH_SUBTITLE)
+                    url = url + renderExtension("", res->getOption(RESOURCE_OPTION_SUBTITLE_EXT));
+                else if (transcoded)
                     url = url + renderExtension(contentType, nullptr);
                 else
                     url = url + renderExtension(contentType, item->getLocation());
@@ -905,18 +920,21 @@ void UpnpXMLBuilder::addResources(std::shared_ptr<CdsItem> item, Ref<Element> el
                     extend = extend + ";";
             }
 
-            // we do not support seeking at all, so 00
-            // and the media is converted, so set CI to 1
+            // a transcoded stream has no byte positions to seek to, profiles
+            // that start at %offset seek by time, and the media is converted,
+            // so set CI to 1
             if (!isExtThumbnail && transcoded) {
-                extend = extend + D_OP + "=" + D_OP_SEEK_DISABLED + ";" + D_CONVERSION_INDICATOR + "=" D_CONVERSION;
+                auto tp = tlist->getByName(getValueOrDefault(res_params, URL_PARAM_TRANSCODE_PROFILE_NAME));
+                bool timeSeek = tp != nullptr && config->getBoolOption(CFG_SERVER_EXTEND_PROTOCOLINFO_DLNA_SEEK)
+                    && Headers::hasRequestHeaders() && tp->getArguments().find("%offset") != std::string::npos;
+                extend = extend + D_OP + "=" + (timeSeek ? D_OP_SEEK_TIME : D_OP_SEEK_DISABLED) + ";" + D_CONVERSION_INDICATOR + "=" D_CONVERSION;
 
                 if (startswith(mimeType, "audio") || startswith(mimeType, "video"))
                     extend = extend + ";" D_FLAGS "=" D_TR_FLAGS_AV;
             } else {
-                if (config->getBoolOption(CFG_SERVER_EXTEND_PROTOCOLINFO_DLNA_SEEK))
-                    extend = extend + D_OP + "=" + D_OP_SEEK_ENABLED + ";";
-                else
-                    extend = extend + D_OP + "=" + D_OP_SEEK_DISABLED + ";";
+                // only local files are served through the key frame index
+                bool local = !IS_CDS_ITEM_EXTERNAL_URL(item->getObjectType());
+                extend = extend + D_OP + "=" + getDLNASeekOperation(config, local ? contentType : "") + ";";
                 extend = extend + D_CONVERSION_INDICATOR + "=" + D_NO_CONVERSION;
             }
 
@@ -924,8 +942,12 @@ void UpnpXMLBuilder::addResources(std::shared_ptr<CdsItem> item, Ref<Element> el
             res_attrs[MetadataHandler::getResAttrName(R_PROTOCOLINFO)] = protocolInfo;
 
             if (config->getBoolOption(CFG_SERVER_EXTEND_PROTOCOLINFO_SM_HACK)) {
-                if (startswith(mimeType, "video")) {
-                    element->appendElementChild(renderCaptionInfo(url));
+                // the subtitles were found on import, the first one is announced
+                if (res->getHandlerType() == CH_SUBTITLE && !captionRendered) {
+                    std::string type = res->getOption(RESOURCE_OPTION_SUBTITLE_EXT);
+                    type = type.substr(type.rfind('.') + 1);
+                    element->appendElementChild(renderCaptionInfo(virtualURL + url, type));
+                    captionRendered = true;
                 }
             }
 
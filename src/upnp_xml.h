@@ -88,8 +88,9 @@ public:
     zmm::Ref<mxml::Element> renderResource(std::string URL, const std::map<std::string,std::string>& attributes);
 
     /// \brief Renders a subtitle resource tag (Samsung proprietary extension)
-    /// \param URL download location of the video item
-    zmm::Ref<mxml::Element> renderCaptionInfo(std::string URL);
+    /// \param URL download location of the subtitle
+    /// \param type subtitle format, e.g. "srt"
+    zmm::Ref<mxml::Element> renderCaptionInfo(std::string URL, std::string type);
 
     zmm::Ref<mxml::Element> renderCreator(std::string creator);
 
@@ -108,6 +109,10 @@ public:
     // FIXME: This needs to go, once we sort a nicer way for the webui code to access this
     static std::string getFirstResourcePath(std::shared_ptr<CdsItem> item);
 
+    /// \brief Returns the URL of the first subtitle resource of an item,
+    /// empty if no subtitle was found on import.
+    std::string getSubtitleURL(std::shared_ptr<CdsItem> item);
+
 protected:
     std::shared_ptr<ConfigManager> config;
     std::shared_ptr<Storage> storage;
@@ -38,6 +38,7 @@
 #include "util/tools.h"
 #include <pthread.h>
 
+#include <exception>
 #include <sstream>
 
 using namespace zmm;
@@ -45,6 +46,38 @@ using namespace zmm;
 std::string URL::download(std::string URL, long* HTTP_retcode,
     CURL* curl_handle, bool only_header,
     bool verbose, bool redirect)
+{
+    std::ostringstream buffer;
+    perform(URL, HTTP_retcode, curl_handle, only_header, verbose, redirect, URL::dl, &buffer);
+    return buffer.str();
+}
+
+namespace {
+struct StreamState {
+    URL::DataSink sink;
+    std::exception_ptr error;
+};
+} // namespace
+
+void URL::downloadStream(std::string URL, long* HTTP_retcode,
+    DataSink sink, CURL* curl_handle,
+    bool verbose, bool redirect)
+{
+    StreamState state { sink, nullptr };
+    try {
+        perform(URL, HTTP_retcode, curl_handle, false, verbose, redirect, URL::dlStream, &state);
+    } catch (const Exception& ex) {
+        // the transfer was aborted by the sink
+        if (state.error != nullptr)
+            std::rethrow_exception(state.error);
+        throw;
+    }
+}
+
+void URL::perform(std::string URL, long* HTTP_retcode,
+    CURL* curl_handle, bool only_header,
+    bool verbose, bool redirect,
+    size_t (*writer)(void*, size_t, size_t, void*), void* writerData)
 {
     CURLcode res;
     bool cleanup = false;
@@ -57,8 +90,6 @@ std::string URL::download(std::string URL, long* HTTP_retcode,
             throw _Exception("Invalid curl handle!\n");
     }
 
-    std::ostringstream buffer;
-
     curl_easy_reset(curl_handle);
 
     if (verbose) {
@@ -83,11 +114,11 @@ std::string URL::download(std::string URL, long* HTTP_retcode,
     /// the headers and data in one go when needed
     if (only_header) {
         curl_easy_setopt(curl_handle, CURLOPT_NOBODY, 1);
-        curl_easy_setopt(curl_handle, CURLOPT_HEADERFUNCTION, URL::dl);
-        curl_easy_setopt(curl_handle, CURLOPT_HEADERDATA, &buffer);
+        curl_easy_setopt(curl_handle, CURLOPT_HEADERFUNCTION, writer);
+        curl_easy_setopt(curl_handle, CURLOPT_HEADERDATA, writerData);
     } else {
-        curl_easy_setopt(curl_handle, CURLOPT_WRITEFUNCTION, URL::dl);
-        curl_easy_setopt(curl_handle, CURLOPT_WRITEDATA, &buffer);
+        curl_easy_setopt(curl_handle, CURLOPT_WRITEFUNCTION, writer);
+        curl_easy_setopt(curl_handle, CURLOPT_WRITEDATA, writerData);
     }
 
     if (redirect) {
@@ -113,8 +144,6 @@ std::string URL::download(std::string URL, long* HTTP_retcode,
 
     if (cleanup)
         curl_easy_cleanup(curl_handle);
-
-    return buffer.str();
 }
 
 Ref<URL::Stat> URL::getInfo(std::string URL, CURL* curl_handle)
@@ -241,4 +270,21 @@ size_t URL::dl(void* buf, size_t size, size_t nmemb, void* data)
     return s;
 }
 
+size_t URL::dlStream(void* buf, size_t size, size_t nmemb, void* data)
+{
+    auto& state = *reinterpret_cast<StreamState*>(data);
+
+    size_t s = size * nmemb;
+    try {
+        state.sink(reinterpret_cast<const char*>(buf), s);
+    } catch (...) {
+        // exceptions must not pass through libcurl, returning less than
+        // requested aborts the transfer
+        state.error = std::current_exception();
+        return 0;
+    }
+
+    return s;
+}
+
 #endif //HAVE_CURL
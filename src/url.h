@@ -36,6 +36,7 @@
 #define __URL_H__
 
 #include <curl/curl.h>
+#include <functional>
 #include <string>
 
 #include "zmm/zmm.h"
@@ -87,12 +88,41 @@ public:
         bool verbose = false,
         bool redirect = false);
 
+    /// \brief Receives the body of a download chunk by chunk.
+    using DataSink = std::function<void(const char* data, size_t length)>;
+
+    /// \brief downloads the content and passes it to the sink as it
+    /// arrives instead of collecting it in a buffer.
+    ///
+    /// Exceptions thrown by the sink abort the transfer and are rethrown.
+    /// \param sink called for every received chunk
+    void downloadStream(std::string URL,
+        long* HTTP_retcode,
+        DataSink sink,
+        CURL* curl_handle = NULL,
+        bool verbose = false,
+        bool redirect = false);
+
     zmm::Ref<Stat> getInfo(std::string URL, CURL* curl_handle = NULL);
 
 protected:
+    /// \brief Sets up the transfer and runs it, data is handed to the
+    /// given libcurl write function.
+    void perform(std::string URL,
+        long* HTTP_retcode,
+        CURL* curl_handle,
+        bool only_header,
+        bool verbose,
+        bool redirect,
+        size_t (*writer)(void*, size_t, size_t, void*),
+        void* writerData);
+
     /// \brief This function is installed as a callback for libcurl, when
     /// we download data from a remote site.
     static size_t dl(void* buf, size_t size, size_t nmemb, void* data);
+
+    /// \brief libcurl callback for downloadStream()
+    static size_t dlStream(void* buf, size_t size, size_t nmemb, void* data);
 };
 
 #endif //__URL_H__
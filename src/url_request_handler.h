@@ -48,6 +48,7 @@ public:
     virtual std::unique_ptr<IOHandler> open(const char* filename,
         enum UpnpOpenFileMode mode,
         std::string range);
+    bool servesMedia() const override { return true; }
 
 protected:
     std::shared_ptr<ContentManager> content;
@@ -12,7 +12,9 @@ enum task_type_t {
     RemoveObject,
     LoadAccounting,
     RescanDirectory,
-    FetchOnlineContent
+    FetchOnlineContent,
+    DeferredInit,
+    BulkObjects
 };
 
 enum task_owner_t {
@@ -44,6 +46,8 @@ public:
     inline bool isCancellable() { return cancellable; };
     inline void invalidate() { valid = false; };
     inline task_owner_t getOwner() { return taskOwner; };
+    /// \brief Bytes held by the task while it is queued.
+    virtual size_t getMemoryUsage() { return sizeof(GenericTask) + description.size(); };
 };
 
 #endif //__GENERIC_TASK_H__
@@ -25,6 +25,7 @@ Gerbera - https://gerbera.io/
 
 #include "headers.h"
 #include <string>
+#include <strings.h>
 #include "tools.h"
 
 std::string Headers::stripInvalid(std::string value) {
@@ -94,3 +95,29 @@ void Headers::writeHeaders(UpnpFileInfo *fileInfo) const
 #endif
 }
 
+std::string Headers::getRequestHeader(UpnpFileInfo* fileInfo, const std::string& header)
+{
+#ifdef UPNP_HAS_EXTRA_HEADERS_LIST
+    auto head = const_cast<list_head*>(UpnpFileInfo_get_ExtraHeadersList(fileInfo));
+    list_head* pos;
+    list_for_each(pos, head) {
+        // the list node is the first member of the headers
+        auto extra = reinterpret_cast<UpnpExtraHeaders*>(pos);
+        const char* name = UpnpExtraHeaders_get_name_cstr(extra);
+        if (name != nullptr && strcasecmp(name, header.c_str()) == 0) {
+            const char* value = UpnpExtraHeaders_get_value_cstr(extra);
+            return value != nullptr ? value : "";
+        }
+    }
+#endif
+    return "";
+}
+
+bool Headers::hasRequestHeaders()
+{
+#ifdef UPNP_HAS_EXTRA_HEADERS_LIST
+    return true;
+#else
+    return false;
+#endif
+}
@@ -38,6 +38,15 @@ public:
     void addHeader(const std::string& header, const std::string& value);
     void writeHeaders(UpnpFileInfo *fileInfo) const;
 
+    /// \brief Returns the value of a header the client sent with the request,
+    /// empty if it is missing or libupnp does not pass request headers on,
+    /// which needs libupnp 1.8.5 (UPNP_HAS_EXTRA_HEADERS_LIST).
+    static std::string getRequestHeader(UpnpFileInfo* fileInfo, const std::string& header);
+
+    /// \brief Returns whether libupnp passes request headers on, without
+    /// them no TimeSeekRange request can be answered.
+    static bool hasRequestHeaders();
+
 private:
     std::unique_ptr<std::map<std::string,std::string>> headers;
     static std::string formatHeader(const std::pair<std::string, std::string>& header, bool crlf);
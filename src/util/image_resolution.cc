@@ -0,0 +1,323 @@
+/*GRB*
+
+Gerbera - https://gerbera.io/
+
+    image_resolution.cc - this file is part of Gerbera.
+
+    Copyright (C) 2016-2019 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file image_resolution.cc
+
+#include "image_resolution.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define M_SOI 0xD8 // Start Of Image
+#define M_EOI 0xD9 // End Of Image
+#define M_SOS 0xDA // Start Of Scan, compressed data follows
+#define M_DHT 0xC4 // C4, C8 and CC are not SOF markers
+#define M_JPG 0xC8
+#define M_DAC 0xCC
+
+// boxes looked at on one level of a HEIF file
+#define HEIF_MAX_BOXES 1024
+
+/// \brief Gives access to the bytes of an image in memory or in a file.
+/// File data is read one block at a time, a block is only read again when
+/// a requested range lies outside of it.
+class ImageSource {
+public:
+    ImageSource(const char* data, size_t length)
+        : fd(-1)
+        , data(reinterpret_cast<const unsigned char*>(data))
+        , size(length)
+        , blockOffset(0)
+        , blockLength(length)
+    {
+    }
+
+    ImageSource(int fd, uint64_t size)
+        : fd(fd)
+        , data(block)
+        , size(size)
+        , blockOffset(0)
+        , blockLength(0)
+    {
+    }
+
+    uint64_t getSize() const { return size; }
+
+    /// \return pointer to count bytes at offset, nullptr if they lie beyond the end
+    const unsigned char* get(uint64_t offset, size_t count)
+    {
+        if (count > IMAGE_PROBE_BLOCK_SIZE || offset + count > size)
+            return nullptr;
+        if (offset >= blockOffset && offset + count <= blockOffset + blockLength)
+            return data + (offset - blockOffset);
+        if (fd < 0)
+            return nullptr;
+
+        ssize_t ret;
+        do {
+            ret = pread(fd, block, IMAGE_PROBE_BLOCK_SIZE, offset);
+        } while (ret < 0 && errno == EINTR);
+        if (ret < 0)
+            return nullptr;
+        blockOffset = offset;
+        blockLength = ret;
+        return blockLength >= count ? data : nullptr;
+    }
+
+protected:
+    int fd;
+    const unsigned char* data;
+    uint64_t size;
+    uint64_t blockOffset;
+    uint64_t blockLength;
+    unsigned char block[IMAGE_PROBE_BLOCK_SIZE];
+};
+
+static inline uint32_t be16(const unsigned char* p) { return (p[0] << 8) | p[1]; }
+static inline uint32_t be32(const unsigned char* p) { return (uint32_t(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3]; }
+static inline uint32_t le16(const unsigned char* p) { return p[0] | (p[1] << 8); }
+static inline uint32_t le24(const unsigned char* p) { return p[0] | (p[1] << 8) | (p[2] << 16); }
+static inline uint32_t le32(const unsigned char* p) { return le24(p) | (uint32_t(p[3]) << 24); }
+
+static bool setResolution(uint32_t w, uint32_t h, int* width, int* height)
+{
+    if (w == 0 || h == 0 || w > INT32_MAX || h > INT32_MAX)
+        return false;
+    *width = w;
+    *height = h;
+    return true;
+}
+
+// walks the segments up to the first start of frame, APP1 with EXIF data and
+// its thumbnail is skipped as a whole
+static bool probeJPEG(ImageSource& src, int* width, int* height)
+{
+    uint64_t offset = 2;
+    for (;;) {
+        const unsigned char* p = src.get(offset, 1);
+        if (p == nullptr || p[0] != 0xFF)
+            return false;
+        // 0xFF may be repeated as padding
+        while (p != nullptr && p[0] == 0xFF)
+            p = src.get(++offset, 1);
+        if (p == nullptr)
+            return false;
+        int marker = p[0];
+        offset++;
+
+        if (marker == M_SOI || marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7))
+            continue; // no length
+        if (marker == M_EOI || marker == M_SOS)
+            return false;
+
+        p = src.get(offset, 2);
+        if (p == nullptr || be16(p) < 2)
+            return false;
+        if (marker >= 0xC0 && marker <= 0xCF && marker != M_DHT && marker != M_JPG && marker != M_DAC) {
+            p = src.get(offset, 7);
+            return p != nullptr && setResolution(be16(p + 5), be16(p + 3), width, height);
+        }
+        offset += be16(p);
+    }
+}
+
+static bool probePNG(ImageSource& src, int* width, int* height)
+{
+    const unsigned char* p = src.get(8, 16);
+    if (p == nullptr || memcmp(p + 4, "IHDR", 4) != 0)
+        return false;
+    return setResolution(be32(p + 8), be32(p + 12), width, height);
+}
+
+static bool probeGIF(ImageSource& src, int* width, int* height)
+{
+    const unsigned char* p = src.get(6, 4);
+    return p != nullptr && setResolution(le16(p), le16(p + 2), width, height);
+}
+
+static bool probeWebP(ImageSource& src, int* width, int* height)
+{
+    const unsigned char* p = src.get(12, 18);
+    if (p == nullptr)
+        return false;
+    if (memcmp(p, "VP8 ", 4) == 0) {
+        // lossy, the key frame header follows the frame tag
+        if (p[11] != 0x9D || p[12] != 0x01 || p[13] != 0x2A)
+            return false;
+        return setResolution(le16(p + 14) & 0x3FFF, le16(p + 16) & 0x3FFF, width, height);
+    }
+    if (memcmp(p, "VP8L", 4) == 0) {
+        if (p[8] != 0x2F)
+            return false;
+        uint32_t bits = le32(p + 9);
+        return setResolution((bits & 0x3FFF) + 1, ((bits >> 14) & 0x3FFF) + 1, width, height);
+    }
+    if (memcmp(p, "VP8X", 4) == 0)
+        return setResolution(le24(p + 12) + 1, le24(p + 15) + 1, width, height);
+    return false;
+}
+
+struct Box {
+    uint64_t offset;
+    uint64_t size;
+    uint64_t header;
+    char type[4];
+};
+
+static bool readBox(ImageSource& src, uint64_t offset, uint64_t end, Box& box)
+{
+    const unsigned char* p = src.get(offset, 8);
+    if (p == nullptr)
+        return false;
+    box.offset = offset;
+    box.size = be32(p);
+    box.header = 8;
+    memcpy(box.type, p + 4, 4);
+    if (box.size == 1) {
+        p = src.get(offset + 8, 8);
+        if (p == nullptr)
+            return false;
+        box.size = (uint64_t(be32(p)) << 32) | be32(p + 4);
+        box.header = 16;
+    } else if (box.size == 0) {
+        box.size = end - offset;
+    }
+    return box.size >= box.header && box.size <= end - offset;
+}
+
+// finds the first child box of the given type
+static bool findBox(ImageSource& src, uint64_t begin, uint64_t end, const char* type, Box& box)
+{
+    uint64_t offset = begin;
+    for (int i = 0; i < HEIF_MAX_BOXES && offset < end; i++) {
+        if (!readBox(src, offset, end, box))
+            return false;
+        if (memcmp(box.type, type, 4) == 0)
+            return true;
+        offset += box.size;
+    }
+    return false;
+}
+
+static bool isHEIFBrand(const unsigned char* brand)
+{
+    static const char* brands[] = { "heic", "heix", "heim", "heis", "hevc", "hevx", "mif1", "msf1", "avif", "avis" };
+    for (const char* b : brands) {
+        if (memcmp(brand, b, 4) == 0)
+            return true;
+    }
+    return false;
+}
+
+// reads the image spatial extents of meta/iprp/ipco, the primary image is
+// taken to be the largest one, thumbnails and grid tiles are smaller
+static bool probeHEIF(ImageSource& src, int* width, int* height)
+{
+    uint64_t end = src.getSize();
+    Box ftyp;
+    if (!readBox(src, 0, end, ftyp) || memcmp(ftyp.type, "ftyp", 4) != 0 || ftyp.size < 16)
+        return false;
+    bool heif = false;
+    for (uint64_t offset = 8; offset + 4 <= ftyp.size && offset < 8 + 4 * 64 && !heif; offset += 4) {
+        if (offset == 12)
+            continue; // minor version
+        const unsigned char* p = src.get(offset, 4);
+        heif = p != nullptr && isHEIFBrand(p);
+    }
+    if (!heif)
+        return false;
+
+    Box meta, iprp, ipco;
+    // meta is a full box, version and flags precede its children
+    if (!findBox(src, ftyp.size, end, "meta", meta)
+        || !findBox(src, meta.offset + meta.header + 4, meta.offset + meta.size, "iprp", iprp)
+        || !findBox(src, iprp.offset + iprp.header, iprp.offset + iprp.size, "ipco", ipco))
+        return false;
+
+    uint64_t best = 0;
+    uint64_t offset = ipco.offset + ipco.header;
+    uint64_t ipcoEnd = ipco.offset + ipco.size;
+    Box box;
+    for (int i = 0; i < HEIF_MAX_BOXES && offset < ipcoEnd && readBox(src, offset, ipcoEnd, box); i++) {
+        if (memcmp(box.type, "ispe", 4) == 0) {
+            const unsigned char* p = src.get(box.offset + box.header + 4, 8);
+            if (p != nullptr && uint64_t(be32(p)) * be32(p + 4) > best) {
+                best = uint64_t(be32(p)) * be32(p + 4);
+                setResolution(be32(p), be32(p + 4), width, height);
+            }
+        }
+        offset += box.size;
+    }
+    return best > 0;
+}
+
+static bool probe(ImageSource& src, int* width, int* height)
+{
+    const unsigned char* p = src.get(0, 12);
+    if (p == nullptr)
+        return false;
+    if (p[0] == 0xFF && p[1] == M_SOI)
+        return probeJPEG(src, width, height);
+    if (memcmp(p, "\x89PNG\r\n\x1A\n", 8) == 0)
+        return probePNG(src, width, height);
+    if (memcmp(p, "GIF87a", 6) == 0 || memcmp(p, "GIF89a", 6) == 0)
+        return probeGIF(src, width, height);
+    if (memcmp(p, "RIFF", 4) == 0 && memcmp(p + 8, "WEBP", 4) == 0)
+        return probeWebP(src, width, height);
+    if (memcmp(p + 4, "ftyp", 4) == 0)
+        return probeHEIF(src, width, height);
+    return false;
+}
+
+bool probeImageResolution(const char* data, size_t length, int* width, int* height)
+{
+    ImageSource src(data, length);
+    return probe(src, width, height);
+}
+
+bool probeImageResolution(const std::string& path, int* width, int* height)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    struct stat statbuf;
+    bool found = false;
+    if (fstat(fd, &statbuf) == 0) {
+        ImageSource src(fd, statbuf.st_size);
+        found = probe(src, width, height);
+    }
+    close(fd);
+    return found;
+}
+
+std::string getImageResolution(const std::string& path)
+{
+    int width, height;
+    if (!probeImageResolution(path, &width, &height))
+        return "";
+    return std::to_string(width) + "x" + std::to_string(height);
+}
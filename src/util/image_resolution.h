@@ -0,0 +1,49 @@
+/*GRB*
+
+Gerbera - https://gerbera.io/
+
+    image_resolution.h - this file is part of Gerbera.
+
+    Copyright (C) 2016-2019 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file image_resolution.h
+/// \brief Reads image dimensions from the file header.
+#ifndef __IMAGE_RESOLUTION_H__
+#define __IMAGE_RESOLUTION_H__
+
+#include <cstddef>
+#include <string>
+
+/// \brief bytes read at once while probing a file
+#define IMAGE_PROBE_BLOCK_SIZE 4096
+
+/// \brief Reads the dimensions of a JPEG, PNG, GIF, WebP or HEIF/AVIF
+/// image held in memory.
+/// \return false if the format is unknown or the header is damaged
+bool probeImageResolution(const char* data, size_t length, int* width, int* height);
+
+/// \brief Reads the dimensions of an image file. Usually only the first
+/// block is read, JPEG segments and HEIF boxes beyond it are skipped
+/// with seeks.
+bool probeImageResolution(const std::string& path, int* width, int* height);
+
+/// \brief Returns the resolution of an image file as "WxH", empty if it
+/// can not be determined.
+std::string getImageResolution(const std::string& path);
+
+#endif // __IMAGE_RESOLUTION_H__
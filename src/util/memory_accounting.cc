@@ -0,0 +1,224 @@
+/*GRB*
+
+Gerbera - https://gerbera.io/
+
+    memory_accounting.cc - this file is part of Gerbera.
+
+    Copyright (C) 2016-2019 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file memory_accounting.cc
+
+#include "memory_accounting.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+
+#include "config/config_manager.h"
+#include "util/logger.h"
+
+namespace {
+
+struct Account {
+    Account(const char* name)
+        : name(name)
+    {
+    }
+
+    const char* name;
+    std::atomic_llong bytes { 0 };
+    std::atomic_llong peak { 0 };
+    std::atomic_llong items { 0 };
+    std::shared_ptr<MemoryAccounting::Sampler> sampler;
+    std::shared_ptr<MemoryAccounting::Shrinker> shrinker;
+    /// \brief samplers and shrinkers of the account that are running
+    int calls = 0;
+};
+
+Account accounts[MemoryAccounting::ACCOUNT_COUNT] = {
+    { "storage" },
+    { "io_buffers" },
+    { "scripting" },
+    { "task_queues" },
+};
+
+// guards samplers, shrinkers and their calls, counters are atomic
+std::mutex accountsMutex;
+std::condition_variable callsDone;
+
+void updatePeak(Account& account, long long value)
+{
+    long long peak = account.peak.load(std::memory_order_relaxed);
+    while (value > peak && !account.peak.compare_exchange_weak(peak, value, std::memory_order_relaxed))
+        ;
+}
+
+// the subsystem may be going away once its callback is removed, so the
+// removal waits for the calls that are still running
+template <typename F>
+void setCallback(MemoryAccounting::account_t account, std::shared_ptr<F> Account::*callback, F function)
+{
+    std::unique_lock<std::mutex> lock(accountsMutex);
+    Account& acc = accounts[account];
+    if (function) {
+        acc.*callback = std::make_shared<F>(std::move(function));
+        return;
+    }
+    acc.*callback = nullptr;
+    callsDone.wait(lock, [&]() { return acc.calls == 0; });
+}
+
+// marks a sampler or shrinker call of an account as running until destroyed
+class RunningCall {
+public:
+    RunningCall() = default;
+    RunningCall(const RunningCall&) = delete;
+    RunningCall& operator=(const RunningCall&) = delete;
+
+    ~RunningCall()
+    {
+        if (account == nullptr)
+            return;
+        std::lock_guard<std::mutex> lock(accountsMutex);
+        if (--account->calls == 0)
+            callsDone.notify_all();
+    }
+
+    /// \brief Must be called with accountsMutex held.
+    void start(Account& acc)
+    {
+        account = &acc;
+        acc.calls++;
+    }
+
+private:
+    Account* account = nullptr;
+};
+
+} // namespace
+
+void MemoryAccounting::add(account_t account, long long bytes, long long items)
+{
+    Account& acc = accounts[account];
+    long long now = acc.bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    if (items != 0)
+        acc.items.fetch_add(items, std::memory_order_relaxed);
+    if (bytes > 0)
+        updatePeak(acc, now);
+}
+
+void MemoryAccounting::setSampler(account_t account, Sampler sampler)
+{
+    setCallback(account, &Account::sampler, std::move(sampler));
+}
+
+void MemoryAccounting::setShrinker(account_t account, Shrinker shrinker)
+{
+    setCallback(account, &Account::shrinker, std::move(shrinker));
+}
+
+std::vector<MemoryAccounting::Report> MemoryAccounting::getReport()
+{
+    // samplers take the locks of their subsystem, which may in turn account
+    // memory, so they are called unlocked like the shrinkers
+    std::shared_ptr<Sampler> samplers[ACCOUNT_COUNT];
+    RunningCall calls[ACCOUNT_COUNT];
+    bool shrinkable[ACCOUNT_COUNT];
+    {
+        std::lock_guard<std::mutex> lock(accountsMutex);
+        for (int i = 0; i < ACCOUNT_COUNT; i++) {
+            samplers[i] = accounts[i].sampler;
+            if (samplers[i] != nullptr)
+                calls[i].start(accounts[i]);
+            shrinkable[i] = accounts[i].shrinker != nullptr;
+        }
+    }
+
+    std::vector<Report> report;
+    for (int i = 0; i < ACCOUNT_COUNT; i++) {
+        Account& acc = accounts[i];
+        long long bytes = acc.bytes.load(std::memory_order_relaxed);
+        long long items = acc.items.load(std::memory_order_relaxed);
+        if (samplers[i] != nullptr) {
+            Usage usage = (*samplers[i])();
+            bytes += usage.bytes;
+            items += usage.items;
+            updatePeak(acc, bytes);
+        }
+        report.push_back({ acc.name, bytes, std::max(bytes, acc.peak.load(std::memory_order_relaxed)), items, shrinkable[i] });
+    }
+    return report;
+}
+
+long long MemoryAccounting::getTotal()
+{
+    long long total = 0;
+    for (const auto& entry : getReport())
+        total += entry.bytes;
+    return total;
+}
+
+void MemoryAccounting::shrink()
+{
+    std::shared_ptr<Shrinker> shrinkers[ACCOUNT_COUNT];
+    RunningCall calls[ACCOUNT_COUNT];
+    {
+        std::lock_guard<std::mutex> lock(accountsMutex);
+        for (int i = 0; i < ACCOUNT_COUNT; i++) {
+            shrinkers[i] = accounts[i].shrinker;
+            if (shrinkers[i] != nullptr)
+                calls[i].start(accounts[i]);
+        }
+    }
+    // shrinkers may block on their subsystem, so they are called unlocked
+    for (auto& shrinker : shrinkers) {
+        if (shrinker != nullptr)
+            (*shrinker)();
+    }
+}
+
+MemorySoftLimit::MemorySoftLimit(std::shared_ptr<ConfigManager> config, std::shared_ptr<Timer> timer)
+    : timer(timer)
+{
+    limit = config->getIntOption(CFG_SERVER_MEMORY_SOFT_LIMIT) * 1024LL * 1024LL;
+    interval = config->getIntOption(CFG_SERVER_MEMORY_CHECK_INTERVAL);
+}
+
+void MemorySoftLimit::init()
+{
+    if (limit > 0)
+        timer->addTimerSubscriber(this, interval, nullptr);
+}
+
+void MemorySoftLimit::shutdown()
+{
+    if (limit > 0)
+        timer->removeTimerSubscriber(this, nullptr, true);
+}
+
+void MemorySoftLimit::timerNotify(std::shared_ptr<Timer::Parameter> parameter)
+{
+    long long total = MemoryAccounting::getTotal();
+    if (total <= limit)
+        return;
+
+    log_info("Accounted memory %lld MB exceeds soft limit of %lld MB, shrinking caches\n",
+        total / (1024 * 1024), limit / (1024 * 1024));
+    MemoryAccounting::shrink();
+    log_debug("Accounted memory after shrinking: %lld MB\n", MemoryAccounting::getTotal() / (1024 * 1024));
+}
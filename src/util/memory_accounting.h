@@ -0,0 +1,118 @@
+/*GRB*
+
+Gerbera - https://gerbera.io/
+
+    memory_accounting.h - this file is part of Gerbera.
+
+    Copyright (C) 2016-2019 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file memory_accounting.h
+/// \brief Memory usage per subsystem and soft limit enforcement.
+#ifndef __MEMORY_ACCOUNTING_H__
+#define __MEMORY_ACCOUNTING_H__
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "util/timer.h"
+
+// forward declaration
+class ConfigManager;
+
+/// \brief Byte and item counters for the subsystems that hold most of
+/// the memory of a running server.
+///
+/// Subsystems either account their allocations with add() and sub() or
+/// register a sampler that is asked when a report is built, for memory
+/// that is owned by a library. Subsystems holding caches can register a
+/// shrinker that is invoked when the soft limit is exceeded.
+class MemoryAccounting {
+public:
+    enum account_t {
+        /// \brief storage driver: result sets, page cache, task queue and browse index
+        ACCOUNT_STORAGE = 0,
+        /// \brief IOHandlerBufferHelper ring buffers
+        ACCOUNT_IO_BUFFERS,
+        /// \brief Duktape heap
+        ACCOUNT_SCRIPTING,
+        /// \brief pending content manager tasks
+        ACCOUNT_TASK_QUEUES,
+        ACCOUNT_COUNT
+    };
+
+    struct Usage {
+        long long bytes;
+        long long items;
+    };
+
+    struct Report {
+        std::string name;
+        long long bytes;
+        long long peak;
+        long long items;
+        bool shrinkable;
+    };
+
+    using Sampler = std::function<Usage()>;
+    using Shrinker = std::function<void()>;
+
+    static void add(account_t account, long long bytes, long long items = 0);
+    static void sub(account_t account, long long bytes, long long items = 0)
+    {
+        add(account, -bytes, -items);
+    }
+
+    /// \brief Sets or, with nullptr, removes the sampler of the account.
+    ///
+    /// Samplers and shrinkers are called without a lock held. Removing one
+    /// waits until its running calls have returned, so the subsystem may
+    /// be destroyed afterwards; it must not hold a lock its callback takes.
+    static void setSampler(account_t account, Sampler sampler);
+    /// \brief Sets or, with nullptr, removes the shrinker of the account.
+    static void setShrinker(account_t account, Shrinker shrinker);
+
+    static std::vector<Report> getReport();
+    static long long getTotal();
+
+    /// \brief Asks all subsystems with a shrinker to release memory.
+    static void shrink();
+};
+
+/// \brief Checks the accounted memory periodically and shrinks caches
+/// when the configured soft limit is exceeded.
+class MemorySoftLimit : public Timer::Subscriber {
+public:
+    MemorySoftLimit(std::shared_ptr<ConfigManager> config, std::shared_ptr<Timer> timer);
+
+    void init();
+    void shutdown();
+
+    void timerNotify(std::shared_ptr<Timer::Parameter> parameter) override;
+
+    long long getLimit() const { return limit; }
+
+protected:
+    std::shared_ptr<Timer> timer;
+    long long limit;
+    int interval;
+};
+
+#endif // __MEMORY_ACCOUNTING_H__
@@ -0,0 +1,149 @@
+/*GRB*
+
+Gerbera - https://gerbera.io/
+
+    mime_detector.cc - this file is part of Gerbera.
+
+    Copyright (C) 2016-2019 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file mime_detector.cc
+
+#ifdef HAVE_MAGIC
+
+#include "mime_detector.h"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "util/logger.h"
+
+MimeDetector::MimeDetector(std::string magicFile, size_t cacheSize)
+    : magicFile(std::move(magicFile))
+    , cacheSize(cacheSize)
+    , loadFailed(false)
+{
+}
+
+MimeDetector::~MimeDetector()
+{
+    for (magic_t cookie : idle)
+        magic_close(cookie);
+}
+
+magic_t MimeDetector::acquire()
+{
+    {
+        AutoLock lock(mutex);
+        if (!idle.empty()) {
+            magic_t cookie = idle.back();
+            idle.pop_back();
+            return cookie;
+        }
+        if (loadFailed)
+            return nullptr;
+    }
+
+    /* MAGIC_MIME_TYPE tells magic to return ONLY the mimetype */
+    magic_t cookie = magic_open(MAGIC_MIME_TYPE);
+    if (cookie == nullptr) {
+        log_warning("Failed to initialize libmagic\n");
+        return nullptr;
+    }
+    if (magic_load(cookie, magicFile.empty() ? nullptr : magicFile.c_str()) != 0) {
+        log_warning("Failed to load magic database: %s\n", magic_error(cookie));
+        magic_close(cookie);
+        AutoLock lock(mutex);
+        loadFailed = true;
+        return nullptr;
+    }
+    return cookie;
+}
+
+void MimeDetector::release(magic_t cookie)
+{
+    AutoLock lock(mutex);
+    idle.push_back(cookie);
+}
+
+std::string MimeDetector::detect(const char* path, const void* buffer, size_t length)
+{
+    magic_t cookie = acquire();
+    if (cookie == nullptr)
+        return "";
+
+    const char* mime = path != nullptr ? magic_file(cookie, path) : magic_buffer(cookie, buffer, length);
+    std::string out = mime != nullptr ? mime : "";
+    release(cookie);
+    return out;
+}
+
+std::string MimeDetector::fromBuffer(const void* buffer, size_t length)
+{
+    return detect(nullptr, buffer, length);
+}
+
+std::string MimeDetector::fromFile(const std::string& path)
+{
+    return detect(path.c_str(), nullptr, 0);
+}
+
+std::string MimeDetector::fromFile(const std::string& path, const struct stat& statbuf)
+{
+    FileKey key = { statbuf.st_dev, statbuf.st_ino, statbuf.st_mtime };
+    if (cacheSize > 0) {
+        AutoLock lock(mutex);
+        auto it = cache.find(key);
+        if (it != cache.end())
+            return it->second;
+    }
+
+    std::string mime;
+    if (S_ISREG(statbuf.st_mode) && statbuf.st_size > 0) {
+        // the head covers the offsets the magic database looks at for media
+        // files and saves libmagic from reading up to its own, larger limit
+        static thread_local std::vector<char> head(MIME_DETECTOR_HEAD_SIZE);
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return fromFile(path);
+        ssize_t length = 0;
+        while (length < MIME_DETECTOR_HEAD_SIZE) {
+            ssize_t ret = read(fd, head.data() + length, MIME_DETECTOR_HEAD_SIZE - length);
+            if (ret < 0 && errno == EINTR)
+                continue;
+            if (ret <= 0)
+                break;
+            length += ret;
+        }
+        close(fd);
+        mime = fromBuffer(head.data(), length);
+    } else {
+        // fifos and devices must not be read here, libmagic names empty files itself
+        mime = fromFile(path);
+    }
+
+    if (cacheSize > 0 && !mime.empty()) {
+        AutoLock lock(mutex);
+        if (cache.size() >= cacheSize)
+            cache.clear();
+        cache[key] = mime;
+    }
+    return mime;
+}
+
+#endif // HAVE_MAGIC
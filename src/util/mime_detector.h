@@ -0,0 +1,103 @@
+/*GRB*
+
+Gerbera - https://gerbera.io/
+
+    mime_detector.h - this file is part of Gerbera.
+
+    Copyright (C) 2016-2019 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file mime_detector.h
+/// \brief MIME type detection with libmagic sessions that are kept loaded.
+#ifndef __MIME_DETECTOR_H__
+#define __MIME_DETECTOR_H__
+
+#ifdef HAVE_MAGIC
+
+#include <mutex>
+#include <string>
+#include <sys/stat.h>
+#include <unordered_map>
+#include <vector>
+
+// for older versions of filemagic
+extern "C" {
+#include <magic.h>
+}
+
+/// \brief bytes read from the start of a regular file for detection
+#define MIME_DETECTOR_HEAD_SIZE 65536
+
+/// \brief Detects MIME types with libmagic.
+///
+/// Loading the magic database takes far longer than looking at a file, so
+/// sessions are opened once and handed from one caller to the next. A
+/// session is only used by one thread at a time, as libmagic requires.
+class MimeDetector {
+public:
+    /// \param magicFile alternative magic database, empty for the system default
+    /// \param cacheSize number of file results kept, 0 disables the cache
+    MimeDetector(std::string magicFile, size_t cacheSize);
+    ~MimeDetector();
+
+    /// \brief Detects the type of data that was already read, e.g. the
+    /// head of a file or embedded album art.
+    /// \return empty string if the type could not be detected
+    std::string fromBuffer(const void* buffer, size_t length);
+
+    std::string fromFile(const std::string& path);
+
+    /// \brief Regular files are detected from their first bytes. Results
+    /// are cached by device, inode and modification time.
+    std::string fromFile(const std::string& path, const struct stat& statbuf);
+
+protected:
+    struct FileKey {
+        dev_t device;
+        ino_t inode;
+        time_t mtime;
+        bool operator==(const FileKey& other) const
+        {
+            return device == other.device && inode == other.inode && mtime == other.mtime;
+        }
+    };
+    struct FileKeyHash {
+        size_t operator()(const FileKey& key) const
+        {
+            return std::hash<ino_t>()(key.inode) ^ (std::hash<dev_t>()(key.device) << 1) ^ (std::hash<time_t>()(key.mtime) << 2);
+        }
+    };
+
+    /// \brief Takes an idle session or opens a new one.
+    /// \return nullptr if the magic database can not be loaded
+    magic_t acquire();
+    void release(magic_t cookie);
+    std::string detect(const char* path, const void* buffer, size_t length);
+
+    std::string magicFile;
+    size_t cacheSize;
+    bool loadFailed;
+
+    std::mutex mutex;
+    using AutoLock = std::lock_guard<std::mutex>;
+    std::vector<magic_t> idle;
+    std::unordered_map<FileKey, std::string, FileKeyHash> cache;
+};
+
+#endif // HAVE_MAGIC
+
+#endif // __MIME_DETECTOR_H__
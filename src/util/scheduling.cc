@@ -0,0 +1,238 @@
+/*GRB*
+
+Gerbera - https://gerbera.io/
+
+    scheduling.cc - this file is part of Gerbera.
+
+    Copyright (C) 2016-2019 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file scheduling.cc
+
+#include "scheduling.h"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#ifdef __linux__
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "config/config_manager.h"
+#include "util/logger.h"
+#include "util/tools.h"
+
+// values of linux/ioprio.h, which is not installed everywhere
+#define IOPRIO_CLASS_SHIFT 13
+#define IOPRIO_CLASS_BE 2
+#define IOPRIO_CLASS_IDLE 3
+#define IOPRIO_WHO_PROCESS 1
+
+namespace {
+
+struct SchedulingClass {
+    int nice = 0;
+    int ioPriority = 0; // 0 keeps the inherited class
+    std::string cgroup;
+};
+
+SchedulingClass classes[Scheduling::GROUP_COUNT];
+
+std::atomic_int streams { 0 };
+std::atomic_llong latency { 0 };
+std::atomic_bool throttled { false };
+int throttleDelay = 0;
+int throttleStreams = 0;
+long long throttleLatency = 0;
+
+int ioPriority(const std::string& ioClass, int level)
+{
+    if (ioClass == SCHEDULING_IO_CLASS_BEST_EFFORT)
+        return (IOPRIO_CLASS_BE << IOPRIO_CLASS_SHIFT) | level;
+    if (ioClass == SCHEDULING_IO_CLASS_IDLE)
+        return IOPRIO_CLASS_IDLE << IOPRIO_CLASS_SHIFT;
+    return 0;
+}
+
+#ifdef __linux__
+void setNice(pid_t id, int nice)
+{
+    if (nice <= 0)
+        return;
+    // raising the priority again would fail without privileges
+    errno = 0;
+    int current = getpriority(PRIO_PROCESS, id);
+    if (errno == 0 && current >= nice)
+        return;
+    if (setpriority(PRIO_PROCESS, id, nice) != 0)
+        log_warning("Could not set nice value %d of %d: %s\n", nice, id, mt_strerror(errno).c_str());
+}
+
+int getIOPriority(pid_t id)
+{
+    return int(syscall(SYS_ioprio_get, IOPRIO_WHO_PROCESS, id));
+}
+
+void setIOPriority(pid_t id, int priority)
+{
+    if (priority <= 0)
+        return;
+    if (syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, id, priority) != 0)
+        log_warning("Could not set I/O priority of %d: %s\n", id, mt_strerror(errno).c_str());
+}
+
+// file is cgroup.threads for threads and cgroup.procs for processes
+void joinCgroup(const std::string& cgroup, const char* file, pid_t id)
+{
+    if (cgroup.empty())
+        return;
+    std::string path = cgroup + "/" + file;
+    FILE* f = fopen(path.c_str(), "w");
+    bool ok = f != nullptr && fprintf(f, "%d\n", id) > 0;
+    // the kernel only checks the id when the buffer is written
+    if (f != nullptr && fclose(f) != 0)
+        ok = false;
+    if (!ok)
+        log_warning("Could not move %d to %s: %s\n", id, path.c_str(), mt_strerror(errno).c_str());
+}
+#endif
+
+} // namespace
+
+bool Scheduling::isIOClass(const std::string& ioClass)
+{
+    return ioClass == SCHEDULING_IO_CLASS_NONE || ioClass == SCHEDULING_IO_CLASS_BEST_EFFORT || ioClass == SCHEDULING_IO_CLASS_IDLE;
+}
+
+void Scheduling::init(const std::shared_ptr<ConfigManager>& config)
+{
+    classes[GROUP_IMPORT].nice = config->getIntOption(CFG_SERVER_SCHEDULING_IMPORT_NICE);
+    classes[GROUP_IMPORT].ioPriority = ioPriority(config->getOption(CFG_SERVER_SCHEDULING_IMPORT_IO_CLASS),
+        config->getIntOption(CFG_SERVER_SCHEDULING_IMPORT_IO_LEVEL));
+    classes[GROUP_IMPORT].cgroup = config->getOption(CFG_SERVER_SCHEDULING_IMPORT_CGROUP);
+
+    classes[GROUP_THUMBNAIL].ioPriority = ioPriority(config->getOption(CFG_SERVER_SCHEDULING_THUMBNAIL_IO_CLASS),
+        config->getIntOption(CFG_SERVER_SCHEDULING_THUMBNAIL_IO_LEVEL));
+
+    classes[GROUP_TRANSCODE].nice = config->getIntOption(CFG_SERVER_SCHEDULING_TRANSCODE_NICE);
+    classes[GROUP_TRANSCODE].ioPriority = ioPriority(config->getOption(CFG_SERVER_SCHEDULING_TRANSCODE_IO_CLASS),
+        config->getIntOption(CFG_SERVER_SCHEDULING_TRANSCODE_IO_LEVEL));
+    classes[GROUP_TRANSCODE].cgroup = config->getOption(CFG_SERVER_SCHEDULING_TRANSCODE_CGROUP);
+
+    throttleDelay = config->getIntOption(CFG_SERVER_SCHEDULING_THROTTLE_DELAY);
+    throttleStreams = config->getIntOption(CFG_SERVER_SCHEDULING_THROTTLE_MAX_STREAMS);
+    throttleLatency = config->getIntOption(CFG_SERVER_SCHEDULING_THROTTLE_MAX_LATENCY) * 1000LL;
+
+#ifndef __linux__
+    for (const auto& cls : classes) {
+        if (cls.nice > 0 || cls.ioPriority > 0 || !cls.cgroup.empty()) {
+            log_warning("Scheduling classes are only supported on Linux, ignoring them\n");
+            break;
+        }
+    }
+#endif
+}
+
+void Scheduling::applyToThread(group_t group)
+{
+#ifdef __linux__
+    const SchedulingClass& cls = classes[group];
+    auto tid = pid_t(syscall(SYS_gettid));
+    joinCgroup(cls.cgroup, "cgroup.threads", tid);
+    setNice(tid, cls.nice);
+    setIOPriority(tid, cls.ioPriority);
+#endif
+}
+
+void Scheduling::applyToProcess(group_t group, pid_t pid)
+{
+#ifdef __linux__
+    const SchedulingClass& cls = classes[group];
+    joinCgroup(cls.cgroup, "cgroup.procs", pid);
+    setNice(pid, cls.nice);
+    setIOPriority(pid, cls.ioPriority);
+#endif
+}
+
+Scheduling::IOPriorityScope::IOPriorityScope(group_t group)
+    : previous(-1)
+{
+#ifdef __linux__
+    int priority = classes[group].ioPriority;
+    if (priority > 0) {
+        previous = getIOPriority(0);
+        setIOPriority(0, priority);
+    }
+#endif
+}
+
+Scheduling::IOPriorityScope::~IOPriorityScope()
+{
+#ifdef __linux__
+    if (previous >= 0)
+        syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, previous);
+#endif
+}
+
+void ImportThrottle::streamOpened()
+{
+    streams++;
+}
+
+void ImportThrottle::streamClosed()
+{
+    if (--streams == 0)
+        latency.store(0, std::memory_order_relaxed);
+}
+
+void ImportThrottle::recordRead(long long micros)
+{
+    // moving average over roughly the last eight reads
+    long long average = latency.load(std::memory_order_relaxed);
+    latency.store(average + (micros - average) / 8, std::memory_order_relaxed);
+}
+
+void ImportThrottle::pause()
+{
+    if (throttleDelay <= 0)
+        return;
+
+    int active = streams.load();
+    bool slow = active > 0
+        && ((throttleStreams > 0 && active >= throttleStreams)
+            || (throttleLatency > 0 && latency.load(std::memory_order_relaxed) >= throttleLatency));
+    if (slow != throttled.exchange(slow)) {
+        log_debug("Import throttle %s: %d streams, read latency %lld us\n", slow ? "on" : "off", active, getLatency());
+    }
+    if (slow)
+        std::this_thread::sleep_for(std::chrono::milliseconds(throttleDelay));
+}
+
+int ImportThrottle::getStreams()
+{
+    return streams.load();
+}
+
+long long ImportThrottle::getLatency()
+{
+    return latency.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,104 @@
+/*GRB*
+
+Gerbera - https://gerbera.io/
+
+    scheduling.h - this file is part of Gerbera.
+
+    Copyright (C) 2016-2019 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file scheduling.h
+/// \brief CPU and I/O priorities of background work and the import throttle.
+#ifndef __SCHEDULING_H__
+#define __SCHEDULING_H__
+
+#include <memory>
+#include <string>
+#include <sys/types.h>
+
+// forward declaration
+class ConfigManager;
+
+#define SCHEDULING_IO_CLASS_NONE "none"
+#define SCHEDULING_IO_CLASS_BEST_EFFORT "best-effort"
+#define SCHEDULING_IO_CLASS_IDLE "idle"
+
+/// \brief Moves import, thumbnail and transcoding work out of the way of
+/// the threads serving streams.
+///
+/// Each group can get a nice value, an I/O scheduling class and a cgroup v2
+/// directory. Priorities are only ever lowered, so no privileges are needed.
+/// Only supported on Linux, elsewhere the settings are ignored.
+class Scheduling {
+public:
+    enum group_t {
+        /// \brief content manager task thread: imports and rescans
+        GROUP_IMPORT = 0,
+        /// \brief thumbnail generation, I/O class only
+        GROUP_THUMBNAIL,
+        /// \brief transcoder child processes
+        GROUP_TRANSCODE,
+        GROUP_COUNT
+    };
+
+    /// \brief Checks an io-class value of the configuration.
+    static bool isIOClass(const std::string& ioClass);
+
+    /// \brief Reads the scheduling classes and the throttle settings.
+    static void init(const std::shared_ptr<ConfigManager>& config);
+
+    /// \brief Applies the class of the group to the calling thread.
+    static void applyToThread(group_t group);
+
+    /// \brief Applies the class of the group to a child process.
+    static void applyToProcess(group_t group, pid_t pid);
+
+    /// \brief Lowers the I/O class of the calling thread for the lifetime of
+    /// the object; the nice value can not be raised again without privileges.
+    class IOPriorityScope {
+    public:
+        explicit IOPriorityScope(group_t group);
+        ~IOPriorityScope();
+
+    protected:
+        int previous;
+    };
+};
+
+/// \brief Slows imports down while streams are being served.
+///
+/// Media streams served by StreamIOHandler report when they are opened
+/// and closed and the time their reads take. While a stream is open and either the number of streams or
+/// the average read latency reaches its threshold, every imported file is
+/// delayed.
+class ImportThrottle {
+public:
+    static void streamOpened();
+    static void streamClosed();
+
+    /// \param micros time a read of a media handle took
+    static void recordRead(long long micros);
+
+    /// \brief Called by import loops before each file.
+    static void pause();
+
+    static int getStreams();
+    /// \return average read latency in microseconds
+    static long long getLatency();
+};
+
+#endif // __SCHEDULING_H__
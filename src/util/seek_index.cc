@@ -0,0 +1,795 @@
+/*GRB*
+
+Gerbera - https://gerbera.io/
+
+    seek_index.cc - this file is part of Gerbera.
+
+    Copyright (C) 2016-2019 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file seek_index.cc
+
+#include "seek_index.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// boxes or elements looked at on one level
+#define SEEK_INDEX_MAX_CHILDREN 4096
+// samples of one MP4 track, larger tables are taken to be damaged
+#define MP4_MAX_SAMPLES (1 << 24)
+
+#define MKV_ID_EBML 0x1A45DFA3
+#define MKV_ID_SEGMENT 0x18538067
+#define MKV_ID_SEEK_HEAD 0x114D9B74
+#define MKV_ID_SEEK 0x4DBB
+#define MKV_ID_SEEK_ID 0x53AB
+#define MKV_ID_SEEK_POSITION 0x53AC
+#define MKV_ID_INFO 0x1549A966
+#define MKV_ID_TIMECODE_SCALE 0x2AD7B1
+#define MKV_ID_DURATION 0x4489
+#define MKV_ID_CUES 0x1C53BB6B
+#define MKV_ID_CUE_POINT 0xBB
+#define MKV_ID_CUE_TIME 0xB3
+#define MKV_ID_CUE_TRACK_POSITIONS 0xB7
+#define MKV_ID_CUE_CLUSTER_POSITION 0xF1
+#define MKV_ID_CLUSTER 0x1F43B675
+
+#define TS_PACKET_SIZE 188
+#define TS_SYNC_BYTE 0x47
+// places a transport stream is sampled at
+#define TS_SAMPLES 256
+// packets looked at from each place for a PCR
+#define TS_SCAN_PACKETS 2048
+// packets looked at after a PCR for a random access point
+#define TS_RAI_PACKETS 512
+#define TS_PCR_CLOCK 90000.0
+#define TS_PCR_WRAP (uint64_t(1) << 33)
+
+/// \brief Gives access to the bytes of a media file in memory or on disk,
+/// a block is only read again when a requested range lies outside of it.
+class SeekSource {
+public:
+    SeekSource(const char* data, size_t length)
+        : fd(-1)
+        , data(reinterpret_cast<const unsigned char*>(data))
+        , size(length)
+        , blockOffset(0)
+        , blockLength(length)
+    {
+    }
+
+    SeekSource(int fd, uint64_t size)
+        : fd(fd)
+        , block(SEEK_INDEX_BLOCK_SIZE)
+        , data(block.data())
+        , size(size)
+        , blockOffset(0)
+        , blockLength(0)
+    {
+    }
+
+    uint64_t getSize() const { return size; }
+
+    /// \return pointer to count bytes at offset, nullptr if they lie beyond the end
+    const unsigned char* get(uint64_t offset, size_t count)
+    {
+        if (count > SEEK_INDEX_BLOCK_SIZE || offset > size || count > size - offset)
+            return nullptr;
+        if (offset >= blockOffset && offset + count <= blockOffset + blockLength)
+            return data + (offset - blockOffset);
+        if (fd < 0)
+            return nullptr;
+
+        ssize_t ret;
+        do {
+            ret = pread(fd, block.data(), SEEK_INDEX_BLOCK_SIZE, offset);
+        } while (ret < 0 && errno == EINTR);
+        if (ret < 0)
+            return nullptr;
+        blockOffset = offset;
+        blockLength = ret;
+        return blockLength >= count ? data : nullptr;
+    }
+
+protected:
+    int fd;
+    std::vector<unsigned char> block;
+    const unsigned char* data;
+    uint64_t size;
+    uint64_t blockOffset;
+    uint64_t blockLength;
+};
+
+static inline uint32_t be32(const unsigned char* p) { return (uint32_t(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3]; }
+static inline uint64_t be64(const unsigned char* p) { return (uint64_t(be32(p)) << 32) | be32(p + 4); }
+
+// adds a point unless it is too close to the previous one or goes back in time
+static void addPoint(std::vector<SeekIndex::Point>& points, double time, uint64_t offset, double minDistance)
+{
+    if (!points.empty() && (time <= points.back().time || time < points.back().time + minDistance))
+        return;
+    points.push_back({ time, off_t(offset) });
+}
+
+/* MP4 */
+
+struct Box {
+    uint64_t offset;
+    uint64_t size;
+    uint64_t header;
+    char type[4];
+
+    uint64_t begin() const { return offset + header; }
+    uint64_t end() const { return offset + size; }
+};
+
+static bool readBox(SeekSource& src, uint64_t offset, uint64_t end, Box& box)
+{
+    const unsigned char* p = src.get(offset, 8);
+    if (p == nullptr)
+        return false;
+    box.offset = offset;
+    box.size = be32(p);
+    box.header = 8;
+    memcpy(box.type, p + 4, 4);
+    if (box.size == 1) {
+        p = src.get(offset + 8, 8);
+        if (p == nullptr)
+            return false;
+        box.size = be64(p);
+        box.header = 16;
+    } else if (box.size == 0) {
+        box.size = end - offset;
+    }
+    return box.size >= box.header && box.size <= end - offset;
+}
+
+// finds the first child box of the given type
+static bool findBox(SeekSource& src, uint64_t begin, uint64_t end, const char* type, Box& box)
+{
+    uint64_t offset = begin;
+    for (int i = 0; i < SEEK_INDEX_MAX_CHILDREN && offset < end; i++) {
+        if (!readBox(src, offset, end, box))
+            return false;
+        if (memcmp(box.type, type, 4) == 0)
+            return true;
+        offset += box.size;
+    }
+    return false;
+}
+
+/// \brief A sample table of a track, entries follow a full box header
+/// and the entry count.
+struct Mp4Table {
+    uint64_t entries;
+    uint64_t count;
+    uint32_t entrySize;
+
+    bool read(SeekSource& src, const Box& box, uint32_t size, uint32_t skip = 0)
+    {
+        const unsigned char* p = src.get(box.begin() + 4 + skip, 4);
+        if (p == nullptr)
+            return false;
+        entries = box.begin() + 8 + skip;
+        count = be32(p);
+        entrySize = size;
+        return entries <= box.end() && count <= (box.end() - entries) / size;
+    }
+
+    const unsigned char* get(SeekSource& src, uint64_t index) const
+    {
+        return index < count ? src.get(entries + index * entrySize, entrySize) : nullptr;
+    }
+};
+
+struct Mp4Track {
+    uint32_t timescale;
+    uint64_t duration;
+    Mp4Table stts;
+    Mp4Table stss;
+    Mp4Table stsc;
+    Mp4Table stsz;
+    Mp4Table chunks;
+    uint32_t sampleSize;
+    uint64_t samples;
+    bool allSync;
+    bool co64;
+};
+
+static bool readTrack(SeekSource& src, const Box& trak, char* handler, Mp4Track& track)
+{
+    Box mdia, hdlr, mdhd, minf, stbl, box;
+    if (!findBox(src, trak.begin(), trak.end(), "mdia", mdia)
+        || !findBox(src, mdia.begin(), mdia.end(), "hdlr", hdlr)
+        || !findBox(src, mdia.begin(), mdia.end(), "mdhd", mdhd)
+        || !findBox(src, mdia.begin(), mdia.end(), "minf", minf)
+        || !findBox(src, minf.begin(), minf.end(), "stbl", stbl))
+        return false;
+
+    const unsigned char* p = src.get(hdlr.begin() + 8, 4);
+    if (p == nullptr)
+        return false;
+    memcpy(handler, p, 4);
+
+    p = src.get(mdhd.begin(), 1);
+    if (p == nullptr)
+        return false;
+    if (p[0] == 1) {
+        p = src.get(mdhd.begin() + 20, 12);
+        if (p == nullptr)
+            return false;
+        track.timescale = be32(p);
+        track.duration = be64(p + 4);
+    } else {
+        p = src.get(mdhd.begin() + 12, 8);
+        if (p == nullptr)
+            return false;
+        track.timescale = be32(p);
+        track.duration = be32(p + 4);
+    }
+    if (track.timescale == 0)
+        return false;
+
+    if (!findBox(src, stbl.begin(), stbl.end(), "stts", box) || !track.stts.read(src, box, 8))
+        return false;
+    if (!findBox(src, stbl.begin(), stbl.end(), "stsc", box) || !track.stsc.read(src, box, 12))
+        return false;
+    // sizes are only listed when they differ, the count is always there
+    if (!findBox(src, stbl.begin(), stbl.end(), "stsz", box) || (p = src.get(box.begin() + 4, 8)) == nullptr)
+        return false;
+    track.sampleSize = be32(p);
+    track.samples = be32(p + 4);
+    if (track.sampleSize == 0 && !track.stsz.read(src, box, 4, 4))
+        return false;
+
+    track.co64 = !findBox(src, stbl.begin(), stbl.end(), "stco", box);
+    if (track.co64 && !findBox(src, stbl.begin(), stbl.end(), "co64", box))
+        return false;
+    if (!track.chunks.read(src, box, track.co64 ? 8 : 4))
+        return false;
+
+    // without a sync sample table every sample is a key frame
+    track.allSync = !findBox(src, stbl.begin(), stbl.end(), "stss", box);
+    if (!track.allSync && !track.stss.read(src, box, 4))
+        return false;
+    return true;
+}
+
+// walks all samples of the track in decoding order and keeps the sync
+// samples, their file offsets follow from the chunk offsets and sizes
+static bool indexTrack(SeekSource& src, const Mp4Track& track, std::vector<SeekIndex::Point>& points)
+{
+    uint64_t samples = track.samples;
+    if (samples == 0 || samples > MP4_MAX_SAMPLES)
+        return false;
+
+    uint64_t sttsIndex = 0, sttsLeft = 0, delta = 0, time = 0;
+    uint64_t stscIndex = 0, samplesPerChunk = 0;
+    uint64_t chunk = 0, chunkLeft = 0, offset = 0;
+    uint64_t stssIndex = 0;
+
+    for (uint64_t sample = 1; sample <= samples; sample++) {
+        while (sttsLeft == 0 && sttsIndex < track.stts.count) {
+            const unsigned char* p = track.stts.get(src, sttsIndex++);
+            if (p == nullptr)
+                return false;
+            sttsLeft = be32(p);
+            delta = be32(p + 4);
+        }
+
+        while (chunkLeft == 0) {
+            if (chunk >= track.chunks.count)
+                return !points.empty();
+            chunk++;
+            // stsc entries name the first chunk they apply to
+            const unsigned char* p;
+            while ((p = track.stsc.get(src, stscIndex)) != nullptr && be32(p) <= chunk) {
+                samplesPerChunk = be32(p + 4);
+                stscIndex++;
+            }
+            p = track.chunks.get(src, chunk - 1);
+            if (p == nullptr)
+                return false;
+            offset = track.co64 ? be64(p) : be32(p);
+            chunkLeft = samplesPerChunk;
+        }
+
+        bool sync = track.allSync;
+        if (!sync) {
+            const unsigned char* p;
+            while ((p = track.stss.get(src, stssIndex)) != nullptr && be32(p) < sample)
+                stssIndex++;
+            sync = p != nullptr && be32(p) == sample;
+        }
+        if (sync && offset < src.getSize())
+            addPoint(points, double(time) / track.timescale, offset, SEEK_INDEX_MIN_DISTANCE);
+
+        uint64_t size = track.sampleSize;
+        if (size == 0) {
+            const unsigned char* p = track.stsz.get(src, sample - 1);
+            if (p == nullptr)
+                return false;
+            size = be32(p);
+        }
+        offset += size;
+        chunkLeft--;
+        time += delta;
+        if (sttsLeft > 0)
+            sttsLeft--;
+    }
+    return !points.empty();
+}
+
+static bool indexMP4(SeekSource& src, std::vector<SeekIndex::Point>& points, double& duration)
+{
+    Box moov, box;
+    if (!findBox(src, 0, src.getSize(), "moov", moov))
+        return false;
+    // fragmented files carry their sample tables in the fragments
+    if (findBox(src, moov.begin(), moov.end(), "mvex", box))
+        return false;
+
+    bool haveAudio = false;
+    Mp4Track audio;
+    uint64_t offset = moov.begin();
+    for (int i = 0; i < SEEK_INDEX_MAX_CHILDREN && findBox(src, offset, moov.end(), "trak", box); i++) {
+        offset = box.end();
+        char handler[4];
+        Mp4Track track;
+        if (!readTrack(src, box, handler, track))
+            continue;
+        if (memcmp(handler, "vide", 4) == 0) {
+            duration = double(track.duration) / track.timescale;
+            return indexTrack(src, track, points);
+        }
+        if (!haveAudio && memcmp(handler, "soun", 4) == 0) {
+            audio = track;
+            haveAudio = true;
+        }
+    }
+    if (!haveAudio)
+        return false;
+    duration = double(audio.duration) / audio.timescale;
+    return indexTrack(src, audio, points);
+}
+
+/* Matroska */
+
+struct Element {
+    uint32_t id;
+    uint64_t data;
+    uint64_t size;
+    bool unknownSize;
+
+    uint64_t end() const { return data + size; }
+};
+
+// reads the id and the size of an EBML element, an unknown size extends to the end
+static bool readElement(SeekSource& src, uint64_t offset, uint64_t end, Element& el)
+{
+    const unsigned char* p = src.get(offset, 1);
+    if (p == nullptr || p[0] < 0x10)
+        return false;
+    int length = 1;
+    while (!(p[0] & (0x80 >> (length - 1))))
+        length++;
+    p = src.get(offset, length);
+    if (p == nullptr)
+        return false;
+    el.id = 0;
+    for (int i = 0; i < length; i++)
+        el.id = (el.id << 8) | p[i];
+    offset += length;
+
+    p = src.get(offset, 1);
+    if (p == nullptr || p[0] == 0)
+        return false;
+    length = 1;
+    while (!(p[0] & (0x80 >> (length - 1))))
+        length++;
+    p = src.get(offset, length);
+    if (p == nullptr)
+        return false;
+    uint64_t mask = (uint64_t(1) << (7 * length)) - 1;
+    el.size = p[0] & (0xFF >> length);
+    for (int i = 1; i < length; i++)
+        el.size = (el.size << 8) | p[i];
+    el.data = offset + length;
+    el.unknownSize = el.size == mask;
+    if (el.data > end)
+        return false;
+    // truncated files still index what they hold
+    if (el.unknownSize || el.size > end - el.data)
+        el.size = end - el.data;
+    return true;
+}
+
+static uint64_t readUInt(SeekSource& src, const Element& el)
+{
+    const unsigned char* p = el.size <= 8 ? src.get(el.data, el.size) : nullptr;
+    uint64_t value = 0;
+    for (uint64_t i = 0; p != nullptr && i < el.size; i++)
+        value = (value << 8) | p[i];
+    return value;
+}
+
+static double readFloat(SeekSource& src, const Element& el)
+{
+    const unsigned char* p = src.get(el.data, el.size);
+    if (p != nullptr && el.size == 4) {
+        uint32_t bits = be32(p);
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    if (p != nullptr && el.size == 8) {
+        uint64_t bits = be64(p);
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    return 0;
+}
+
+static void readInfo(SeekSource& src, const Element& info, uint64_t& timecodeScale, double& durationTicks)
+{
+    Element el;
+    uint64_t offset = info.data;
+    for (int i = 0; i < SEEK_INDEX_MAX_CHILDREN && offset < info.end() && readElement(src, offset, info.end(), el); i++) {
+        if (el.id == MKV_ID_TIMECODE_SCALE && readUInt(src, el) > 0)
+            timecodeScale = readUInt(src, el);
+        else if (el.id == MKV_ID_DURATION)
+            durationTicks = readFloat(src, el);
+        offset = el.end();
+    }
+}
+
+// the seek head tells where the cues are when they follow the clusters
+static void readSeekHead(SeekSource& src, const Element& seekHead, uint64_t segment, uint64_t& infoOffset, uint64_t& cuesOffset)
+{
+    Element seek, el;
+    uint64_t offset = seekHead.data;
+    for (int i = 0; i < SEEK_INDEX_MAX_CHILDREN && offset < seekHead.end() && readElement(src, offset, seekHead.end(), seek); i++) {
+        offset = seek.end();
+        if (seek.id != MKV_ID_SEEK)
+            continue;
+        uint64_t id = 0, position = 0;
+        for (uint64_t child = seek.data; child < seek.end() && readElement(src, child, seek.end(), el); child = el.end()) {
+            if (el.id == MKV_ID_SEEK_ID)
+                id = readUInt(src, el);
+            else if (el.id == MKV_ID_SEEK_POSITION)
+                position = segment + readUInt(src, el);
+        }
+        if (id == MKV_ID_CUES)
+            cuesOffset = position;
+        else if (id == MKV_ID_INFO)
+            infoOffset = position;
+    }
+}
+
+static void readCues(SeekSource& src, const Element& cues, uint64_t segment, std::vector<std::pair<uint64_t, uint64_t>>& cuePoints)
+{
+    Element point, el, pos;
+    uint64_t offset = cues.data;
+    // files have one cue point per key frame or cluster, far more than children of other elements
+    while (offset < cues.end() && readElement(src, offset, cues.end(), point)) {
+        offset = point.end();
+        if (point.id != MKV_ID_CUE_POINT)
+            continue;
+        uint64_t time = 0, cluster = 0;
+        bool haveCluster = false;
+        for (uint64_t child = point.data; child < point.end() && readElement(src, child, point.end(), el); child = el.end()) {
+            if (el.id == MKV_ID_CUE_TIME) {
+                time = readUInt(src, el);
+            } else if (el.id == MKV_ID_CUE_TRACK_POSITIONS && !haveCluster) {
+                for (uint64_t p = el.data; p < el.end() && readElement(src, p, el.end(), pos); p = pos.end()) {
+                    if (pos.id == MKV_ID_CUE_CLUSTER_POSITION) {
+                        cluster = segment + readUInt(src, pos);
+                        haveCluster = true;
+                    }
+                }
+            }
+        }
+        if (haveCluster)
+            cuePoints.emplace_back(time, cluster);
+    }
+}
+
+static bool indexMKV(SeekSource& src, std::vector<SeekIndex::Point>& points, double& duration)
+{
+    uint64_t end = src.getSize();
+    Element el;
+    if (!readElement(src, 0, end, el) || el.id != MKV_ID_EBML)
+        return false;
+    uint64_t offset = el.end();
+    Element segment;
+    do {
+        if (!readElement(src, offset, end, segment))
+            return false;
+        offset = segment.end();
+    } while (segment.id != MKV_ID_SEGMENT);
+
+    uint64_t timecodeScale = 1000000;
+    double durationTicks = 0;
+    uint64_t infoOffset = 0, cuesOffset = 0;
+    bool haveInfo = false;
+    std::vector<std::pair<uint64_t, uint64_t>> cuePoints;
+
+    offset = segment.data;
+    for (int i = 0; i < SEEK_INDEX_MAX_CHILDREN && offset < segment.end() && cuePoints.empty(); i++) {
+        if (!readElement(src, offset, segment.end(), el))
+            break;
+        if (el.id == MKV_ID_SEEK_HEAD) {
+            readSeekHead(src, el, segment.data, infoOffset, cuesOffset);
+        } else if (el.id == MKV_ID_INFO) {
+            readInfo(src, el, timecodeScale, durationTicks);
+            haveInfo = true;
+        } else if (el.id == MKV_ID_CUES) {
+            readCues(src, el, segment.data, cuePoints);
+        } else if (el.id == MKV_ID_CLUSTER) {
+            // skip the clusters when the seek head points past them
+            if (!haveInfo && infoOffset > offset) {
+                Element info;
+                if (readElement(src, infoOffset, segment.end(), info) && info.id == MKV_ID_INFO) {
+                    readInfo(src, info, timecodeScale, durationTicks);
+                    haveInfo = true;
+                }
+            }
+            if (cuesOffset > offset) {
+                offset = cuesOffset;
+                continue;
+            }
+            if (el.unknownSize)
+                break;
+        }
+        offset = el.end();
+    }
+
+    for (const auto& cue : cuePoints) {
+        if (cue.second < end)
+            addPoint(points, double(cue.first) * timecodeScale / 1e9, cue.second, 0);
+    }
+    duration = durationTicks * timecodeScale / 1e9;
+    return !points.empty();
+}
+
+/* MPEG transport stream */
+
+// reads the PCR of a packet
+static bool readPCR(const unsigned char* p, int pid, int& packetPid, uint64_t& pcr, bool& randomAccess)
+{
+    if (p[0] != TS_SYNC_BYTE)
+        return false;
+    packetPid = ((p[1] & 0x1F) << 8) | p[2];
+    bool adaptation = (p[3] & 0x20) != 0;
+    if (!adaptation || p[4] == 0 || (pid >= 0 && packetPid != pid))
+        return false;
+    randomAccess = (p[5] & 0x40) != 0;
+    if (!(p[5] & 0x10) || p[4] < 7)
+        return false;
+    pcr = (uint64_t(p[6]) << 25) | (p[7] << 17) | (p[8] << 9) | (p[9] << 1) | (p[10] >> 7);
+    return true;
+}
+
+static bool indexTS(SeekSource& src, std::vector<SeekIndex::Point>& points, double& duration)
+{
+    // M2TS prefixes each packet with a four byte time code
+    uint64_t packetSize = 0, sync = 0;
+    for (uint64_t size : { TS_PACKET_SIZE, TS_PACKET_SIZE + 4 }) {
+        uint64_t start = size - TS_PACKET_SIZE;
+        bool found = true;
+        for (int i = 0; i < 5 && found; i++) {
+            const unsigned char* p = src.get(start + i * size, 1);
+            found = p != nullptr && p[0] == TS_SYNC_BYTE;
+        }
+        if (found) {
+            packetSize = size;
+            sync = start;
+            break;
+        }
+    }
+    if (packetSize == 0)
+        return false;
+
+    uint64_t packets = (src.getSize() - sync) / packetSize;
+    int pid = -1;
+    uint64_t firstPCR = 0;
+    double lastTime = -1;
+
+    for (uint64_t sample = 0; sample <= TS_SAMPLES; sample++) {
+        // the last place lies close to the end, its last PCR gives the duration
+        bool last = sample == TS_SAMPLES;
+        uint64_t packet = !last ? sample * packets / TS_SAMPLES : (packets > TS_SCAN_PACKETS ? packets - TS_SCAN_PACKETS : 0);
+        uint64_t limit = std::min(packets, packet + TS_SCAN_PACKETS);
+        bool havePCR = false;
+        uint64_t pcr = 0, pointPacket = 0, lastPCR = 0;
+        for (; packet < limit; packet++) {
+            const unsigned char* p = src.get(sync + packet * packetSize, TS_PACKET_SIZE);
+            int packetPid;
+            bool randomAccess = false;
+            uint64_t value;
+            if (p == nullptr)
+                break;
+            bool isPCR = readPCR(p, pid, packetPid, value, randomAccess);
+            if (isPCR) {
+                if (pid < 0) {
+                    pid = packetPid;
+                    firstPCR = value;
+                }
+                lastPCR = value;
+                if (!havePCR && !last)
+                    limit = std::min(packets, packet + TS_RAI_PACKETS);
+                if (!havePCR) {
+                    havePCR = true;
+                    pcr = value;
+                    pointPacket = packet;
+                }
+            }
+            if (randomAccess && havePCR && packetPid == pid && !last) {
+                // the key frame starts here, its time is that of the latest PCR
+                pcr = lastPCR;
+                pointPacket = packet;
+                break;
+            }
+        }
+        if (!havePCR)
+            continue;
+        if (last) {
+            lastTime = std::max(lastTime, double((lastPCR - firstPCR) % TS_PCR_WRAP) / TS_PCR_CLOCK);
+            break;
+        }
+        double time = double((pcr - firstPCR) % TS_PCR_WRAP) / TS_PCR_CLOCK;
+        addPoint(points, time, sync + pointPacket * packetSize, 0);
+        lastTime = std::max(lastTime, time);
+    }
+    duration = std::max(lastTime, 0.0);
+    return !points.empty();
+}
+
+/* SeekIndex */
+
+static std::shared_ptr<SeekIndex> build(SeekSource& src)
+{
+    const unsigned char* p = src.get(0, 8);
+    if (p == nullptr)
+        return nullptr;
+
+    std::vector<SeekIndex::Point> points;
+    double duration = 0;
+    bool found = false;
+    if (memcmp(p + 4, "ftyp", 4) == 0 || memcmp(p + 4, "moov", 4) == 0)
+        found = indexMP4(src, points, duration);
+    else if (be32(p) == MKV_ID_EBML)
+        found = indexMKV(src, points, duration);
+    else
+        found = indexTS(src, points, duration);
+
+    if (!found)
+        return nullptr;
+    return std::make_shared<SeekIndex>(std::move(points), duration);
+}
+
+SeekIndex::SeekIndex(std::vector<Point> points, double duration)
+    : points(std::move(points))
+    , duration(duration)
+{
+}
+
+std::shared_ptr<SeekIndex> SeekIndex::build(const char* data, size_t length)
+{
+    SeekSource src(data, length);
+    return ::build(src);
+}
+
+std::shared_ptr<SeekIndex> SeekIndex::build(const std::string& path)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return nullptr;
+    struct stat statbuf;
+    std::shared_ptr<SeekIndex> index;
+    if (fstat(fd, &statbuf) == 0 && S_ISREG(statbuf.st_mode)) {
+        SeekSource src(fd, statbuf.st_size);
+        index = ::build(src);
+    }
+    close(fd);
+    return index;
+}
+
+bool SeekIndex::find(double time, Point& point) const
+{
+    if (points.empty())
+        return false;
+    auto it = std::upper_bound(points.begin(), points.end(), time,
+        [](double t, const Point& p) { return t < p.time; });
+    point = it == points.begin() ? *it : *(it - 1);
+    return true;
+}
+
+double SeekIndex::parseNptStart(const std::string& range)
+{
+    std::string value = range;
+    size_t pos = value.find("npt=");
+    if (pos != std::string::npos)
+        value = value.substr(pos + 4);
+    pos = value.find('-');
+    if (pos == std::string::npos || pos == 0)
+        return -1;
+    value = value.substr(0, pos);
+
+    // either seconds or hours:minutes:seconds
+    double start = 0;
+    const char* p = value.c_str();
+    for (int i = 0; i < 3; i++) {
+        char* end;
+        double part = strtod(p, &end);
+        if (end == p || part < 0)
+            return -1;
+        start = start * 60 + part;
+        if (*end == '\0')
+            return start;
+        if (*end != ':')
+            return -1;
+        p = end + 1;
+    }
+    return -1;
+}
+
+std::string SeekIndex::formatNpt(double time)
+{
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.3f", time);
+    return buf;
+}
+
+/* SeekIndexCache */
+
+SeekIndexCache::SeekIndexCache(size_t cacheSize)
+    : cacheSize(cacheSize)
+{
+}
+
+std::shared_ptr<SeekIndex> SeekIndexCache::get(const std::string& path)
+{
+    struct stat statbuf;
+    if (stat(path.c_str(), &statbuf) != 0 || !S_ISREG(statbuf.st_mode))
+        return nullptr;
+
+    {
+        AutoLock lock(mutex);
+        auto it = cache.find(path);
+        if (it != cache.end() && it->second.size == statbuf.st_size && it->second.mtime == statbuf.st_mtime)
+            return it->second.index;
+    }
+
+    // building reads the file, other requests must not wait for it
+    auto index = SeekIndex::build(path);
+
+    AutoLock lock(mutex);
+    if (cache.size() >= cacheSize)
+        cache.clear();
+    cache[path] = { statbuf.st_size, statbuf.st_mtime, index };
+    return index;
+}
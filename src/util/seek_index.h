@@ -0,0 +1,111 @@
+/*GRB*
+
+Gerbera - https://gerbera.io/
+
+    seek_index.h - this file is part of Gerbera.
+
+    Copyright (C) 2016-2019 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file seek_index.h
+/// \brief Maps playback times of MP4, Matroska and MPEG-TS files to byte offsets.
+#ifndef __SEEK_INDEX_H__
+#define __SEEK_INDEX_H__
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <sys/types.h>
+#include <unordered_map>
+#include <vector>
+
+/// \brief bytes read at once while building an index
+#define SEEK_INDEX_BLOCK_SIZE 65536
+
+/// \brief minimum distance of two index points in seconds
+#define SEEK_INDEX_MIN_DISTANCE 0.5
+
+/// \brief Key frame positions of a media file.
+///
+/// The index is read from the tables the container already carries: the
+/// sample tables of the first MP4 video track, the Matroska cues, or the
+/// PCRs found at evenly spread places of an MPEG transport stream.
+class SeekIndex {
+public:
+    struct Point {
+        double time;
+        off_t offset;
+    };
+
+    SeekIndex(std::vector<Point> points, double duration);
+
+    /// \brief Reads the index of a file held in memory.
+    /// \return nullptr if the container is unknown or has no key frames
+    static std::shared_ptr<SeekIndex> build(const char* data, size_t length);
+
+    static std::shared_ptr<SeekIndex> build(const std::string& path);
+
+    /// \brief Finds the last key frame at or before the given time, the
+    /// first one if the time lies before it.
+    bool find(double time, Point& point) const;
+
+    /// \return duration in seconds, 0 if unknown
+    double getDuration() const { return duration; }
+
+    const std::vector<Point>& getPoints() const { return points; }
+
+    /// \brief Parses the start of a DLNA npt range like "npt=10.5-" or
+    /// "npt=0:01:10-0:02:00".
+    /// \return start in seconds, negative if the range is invalid
+    static double parseNptStart(const std::string& range);
+
+    static std::string formatNpt(double time);
+
+protected:
+    std::vector<Point> points;
+    double duration;
+};
+
+/// \brief Keeps the seek indexes of recently played files.
+///
+/// Indexes are built on the first seek into a file and rebuilt when its
+/// size or modification time changes. Files without an index are
+/// remembered as well, so they are not parsed again on every request.
+class SeekIndexCache {
+public:
+    /// \param cacheSize number of files kept
+    explicit SeekIndexCache(size_t cacheSize);
+
+    /// \return nullptr if the file has no usable index
+    std::shared_ptr<SeekIndex> get(const std::string& path);
+
+protected:
+    struct Entry {
+        off_t size;
+        time_t mtime;
+        std::shared_ptr<SeekIndex> index;
+    };
+
+    size_t cacheSize;
+
+    std::mutex mutex;
+    using AutoLock = std::lock_guard<std::mutex>;
+    std::unordered_map<std::string, Entry> cache;
+};
+
+#endif // __SEEK_INDEX_H__
@@ -193,8 +193,6 @@ void TPFetchOnlineContentTask::run()
                 );
                 task_processor->addTask(t);
             }
-        } else {
-            content->cleanupOnlineServiceObjects(service);
         }
     } catch (const Exception& ex) {
         log_error("%s\n", ex.getMessage().c_str());
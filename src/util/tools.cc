@@ -33,6 +33,7 @@
 #include <cerrno>
 #include <climits>
 #include <cctype>
+#include <cstdlib>
 #include <iterator>
 #include <netdb.h>
 #include <netinet/in.h>
@@ -60,8 +61,11 @@
 #include "contrib/md5.h"
 #include "iohandler/file_io_handler.h"
 #include "metadata/metadata_handler.h"
+#include "headers.h"
 #include "tools.h"
 #include "string_tokenizer.h"
+#include "trace.h"
+#include "util/mime_detector.h"
 
 #define WHITE_SPACE " \t\r\n"
 
@@ -159,12 +163,17 @@ std::string tolower_string(std::string str)
     return str;
 }
 
-int stoi_string(std::string str, int def)
+int stoi_string(const std::string& str, int def)
 {
     if (str.empty())
         return def;
 
-    return std::stoi(str);
+    char* end;
+    errno = 0;
+    long value = std::strtol(str.c_str(), &end, 10);
+    if (end == str.c_str() || *end != '\0' || errno == ERANGE || value < INT_MIN || value > INT_MAX)
+        return def;
+    return value;
 }
 
 std::string reduce_string(std::string str, char ch)
@@ -797,49 +806,16 @@ std::string getMIMETypeFromBuffer(const void *buffer, size_t length)
 
 std::string getMIME(std::string filepath, const void *buffer, size_t length)
 {
-    /* MAGIC_MIME_TYPE tells magic to return ONLY the mimetype */
-    magic_t magic_cookie = magic_open(MAGIC_MIME_TYPE);
-
-    if (magic_cookie == NULL) {
-        log_warning("Failed to initialize libmagic\n");
-        return "";
-    }
+    TRACE_SPAN("import", "libmagic");
+    // sessions stay loaded for the lifetime of the process
+    static MimeDetector detector("", 0);
 
-    if (magic_load(magic_cookie, NULL) != 0) {
-        log_warning("Failed to load magic database: %s\n", magic_error(magic_cookie));
-        magic_close(magic_cookie);
-        return "";
-    }
-
-    const char* mime;
-    if (!string_ok(filepath)) {
-        mime = magic_buffer(magic_cookie, buffer, length);
-    } else {
-        mime = magic_file(magic_cookie, filepath.c_str());
-    }
-
-    std::string out = mime;
-    magic_close(magic_cookie);
-    return out;
+    if (!string_ok(filepath))
+        return detector.fromBuffer(buffer, length);
+    return detector.fromFile(filepath);
 }
 #endif
 
-void set_jpeg_resolution_resource(std::shared_ptr<CdsItem> item, int res_num)
-{
-    try {
-        std::unique_ptr<IOHandler> fio_h = std::make_unique<FileIOHandler>(item->getLocation());
-        fio_h->open(UPNP_READ);
-        std::string resolution = get_jpeg_resolution(fio_h);
-
-        if (res_num >= item->getResourceCount())
-            throw _Exception("Invalid resource index");
-
-        item->getResource(res_num)->addAttribute(MetadataHandler::getResAttrName(R_RESOLUTION), resolution);
-    } catch (const Exception& e) {
-        e.printStackTrace();
-    }
-}
-
 bool check_resolution(std::string resolution, int* x, int* y)
 {
     if (x != nullptr)
@@ -1256,23 +1232,27 @@ bool validateYesNo(std::string value)
         return true;
 }
 
-std::vector<std::string> parseCommandLine(std::string line, std::string in, std::string out, std::string range)
+static void replaceToken(std::string& param, const std::string& token, const std::string& value)
+{
+    size_t pos = 0;
+    while ((pos = param.find(token, pos)) != std::string::npos) {
+        param.replace(pos, token.length(), value);
+        pos += value.length();
+    }
+}
+
+std::vector<std::string> parseCommandLine(std::string line, std::string in, std::string out, std::string range, std::string offset)
 {
     std::vector<std::string> params = split_string(line, ' ');
     if (in.empty() && out.empty())
         return params;
 
-    for (size_t i = 0; i < params.size(); i++) {
-        std::string param = params[i];
-        std::string newParam = param.replace(param.find("%in"), 3, in);
-
-        newParam = param.replace(param.find("%out"), 3, out);
-        if (!range.empty()) {
-            newParam = param.replace(param.find("%range"), 6, out);
-        }
-        if (param != newParam) {
-            params[i] = newParam;
-        }
+    for (auto& param : params) {
+        replaceToken(param, "%in", in);
+        replaceToken(param, "%out", out);
+        replaceToken(param, "%offset", offset);
+        if (!range.empty())
+            replaceToken(param, "%range", range);
     }
 
     return params;
@@ -1471,11 +1451,7 @@ std::string getDLNAContentHeader(std::shared_ptr<ConfigManager> config, std::str
         content_parameter = getDLNAprofileString(contentType);
         if (string_ok(content_parameter))
             content_parameter = D_PROFILE + std::string("=") + content_parameter + ";";
-        // enabling or disabling seek
-        if (config->getBoolOption(CFG_SERVER_EXTEND_PROTOCOLINFO_DLNA_SEEK))
-            content_parameter = content_parameter + D_OP + "=" + D_OP_SEEK_ENABLED + ";";
-        else
-            content_parameter = content_parameter + D_OP + "=" + D_OP_SEEK_DISABLED + ";";
+        content_parameter = content_parameter + D_OP + "=" + getDLNASeekOperation(config, contentType) + ";";
         content_parameter = content_parameter + D_CONVERSION_INDICATOR + "=" + D_NO_CONVERSION + ";";
         content_parameter = content_parameter + D_FLAGS "=" D_TR_FLAGS_AV;
         return content_parameter;
@@ -1483,6 +1459,21 @@ std::string getDLNAContentHeader(std::shared_ptr<ConfigManager> config, std::str
     return nullptr;
 }
 
+bool isTimeSeekable(std::string contentType)
+{
+    // the containers SeekIndex reads, QuickTime files share the MP4 layout
+    return Headers::hasRequestHeaders()
+        && (contentType == CONTENT_TYPE_MP4 || contentType == CONTENT_TYPE_QUICKTIME
+            || contentType == CONTENT_TYPE_MKV || contentType == CONTENT_TYPE_MPEGTS);
+}
+
+std::string getDLNASeekOperation(std::shared_ptr<ConfigManager> config, std::string contentType)
+{
+    if (!config->getBoolOption(CFG_SERVER_EXTEND_PROTOCOLINFO_DLNA_SEEK))
+        return D_OP_SEEK_DISABLED;
+    return isTimeSeekable(contentType) ? D_OP_SEEK_BOTH : D_OP_SEEK_ENABLED;
+}
+
 std::string getDLNATransferHeader(std::shared_ptr<ConfigManager> config, std::string mimeType)
 {
     if (config->getBoolOption(CFG_SERVER_EXTEND_PROTOCOLINFO)) {
@@ -77,7 +77,8 @@ bool startswith(std::string str, std::string check);
 /// \brief returns lowercase of str
 std::string tolower_string(std::string str);
 
-int stoi_string(std::string str, int def = 0);
+/// \brief returns the decimal integer in str, def if str is empty or not a number in range
+int stoi_string(const std::string& str, int def = 0);
 
 std::string reduce_string(std::string str, char ch);
 
@@ -237,12 +238,6 @@ std::string getMIME(std::string filepath, const void *buffer, size_t length);
 int find_local_port(unsigned short range_min,
     unsigned short range_max);
 #endif
-/// \brief Extracts resolution from a JPEG image
-std::string get_jpeg_resolution(const std::unique_ptr<IOHandler>& ioh);
-
-/// \brief Sets resolution for a given resource index, item must be a JPEG image
-void set_jpeg_resolution_resource(std::shared_ptr<CdsItem> item, int res_num);
-
 /// \brief checks if the given string has the format xr x yr (i.e. 320x200 etc.)
 bool check_resolution(std::string resolution, int* x = NULL, int* y = NULL);
 
@@ -339,16 +334,17 @@ std::string ipToInterface(std::string interface);
 bool validateYesNo(std::string value);
 
 /// \brief Parses a command line, splitting the arguments into an array and
-/// substitutes %in and %out tokens with given strings.
+/// substitutes %in, %out, %range and %offset tokens with given strings.
 ///
 /// This function splits a string into array parts, where space is used as the
-/// separator. In addition special %in and %out tokens are replaced by given
-/// strings.
+/// separator. In addition special %in, %out and %offset tokens are replaced by
+/// given strings, %range only if a range is given.
 /// \todo add escaping
 std::vector<std::string> parseCommandLine(std::string line,
     std::string in,
     std::string out,
-    std::string range);
+    std::string range,
+    std::string offset);
 
 /// \brief this is the mkstemp routine from glibc, the only difference is that
 /// it does not return an fd but just the name that we could use.
@@ -373,6 +369,13 @@ std::string getDLNATransferHeader(std::shared_ptr<ConfigManager> config, std::st
 std::string getDLNAprofileString(std::string contentType);
 std::string getDLNAContentHeader(std::shared_ptr<ConfigManager> config, std::string contentType);
 
+/// \brief Returns whether time seeks into files of the content type are
+/// answered, which needs the key frame index of the container.
+bool isTimeSeekable(std::string contentType);
+
+/// \brief Returns the DLNA.ORG_OP value of a file served as it is.
+std::string getDLNASeekOperation(std::shared_ptr<ConfigManager> config, std::string contentType);
+
 #ifndef HAVE_FFMPEG
 /// \brief Fallback code to retrieve the used fourcc from an AVI file.
 ///
@@ -0,0 +1,228 @@
+/*GRB*
+
+Gerbera - https://gerbera.io/
+
+    trace.cc - this file is part of Gerbera.
+
+    Copyright (C) 2016-2019 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file trace.cc
+
+#include "trace.h"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#include "common.h"
+#include "tools.h"
+
+// upper bound of events kept per thread, older events are kept, newer dropped
+#define TRACE_MAX_EVENTS_PER_THREAD 200000
+
+std::atomic_bool Trace::enabled { false };
+
+namespace {
+
+struct TraceEvent {
+    const char* category;
+    const char* name;
+    std::string detail;
+    long long start;
+    long long duration;
+};
+
+struct TraceBuffer {
+    std::mutex mutex;
+    int tid;
+    size_t dropped = 0;
+    std::vector<TraceEvent> events;
+};
+
+const auto traceEpoch = std::chrono::steady_clock::now();
+
+std::mutex registryMutex;
+std::vector<std::shared_ptr<TraceBuffer>> registry;
+int nextTid = 1;
+
+// buffers are shared with the registry, so events of threads that have
+// already finished are still part of the dump
+thread_local std::shared_ptr<TraceBuffer> localBuffer;
+
+TraceBuffer* getLocalBuffer()
+{
+    if (localBuffer == nullptr) {
+        auto buffer = std::make_shared<TraceBuffer>();
+        std::lock_guard<std::mutex> lock(registryMutex);
+        buffer->tid = nextTid++;
+        registry.push_back(buffer);
+        localBuffer = buffer;
+    }
+    return localBuffer.get();
+}
+
+void appendJSONString(std::ostringstream& buf, const char* str)
+{
+    buf << '"';
+    for (const char* c = str; *c; c++) {
+        switch (*c) {
+        case '"':
+            buf << "\\\"";
+            break;
+        case '\\':
+            buf << "\\\\";
+            break;
+        case '\n':
+            buf << "\\n";
+            break;
+        case '\r':
+            buf << "\\r";
+            break;
+        case '\t':
+            buf << "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(*c) < 0x20) {
+                char hex[8];
+                snprintf(hex, sizeof(hex), "\\u%04x", *c);
+                buf << hex;
+            } else
+                buf << *c;
+        }
+    }
+    buf << '"';
+}
+
+} // namespace
+
+void Trace::setEnabled(bool enable)
+{
+    enabled = enable;
+    log_info("Tracing %s\n", enable ? "enabled" : "disabled");
+}
+
+void Trace::clear()
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (auto& buffer : registry) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        buffer->events.clear();
+        buffer->dropped = 0;
+    }
+}
+
+long long Trace::now()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - traceEpoch).count();
+}
+
+void Trace::record(const char* category, const char* name, std::string detail, long long start, long long duration)
+{
+    TraceBuffer* buffer = getLocalBuffer();
+    std::lock_guard<std::mutex> lock(buffer->mutex);
+    if (buffer->events.size() >= TRACE_MAX_EVENTS_PER_THREAD) {
+        buffer->dropped++;
+        return;
+    }
+    buffer->events.push_back({ category, name, std::move(detail), start, duration });
+}
+
+std::string Trace::toJSON()
+{
+    std::ostringstream buf;
+    bool first = true;
+    size_t dropped = 0;
+
+    buf << "{\"traceEvents\":[";
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (auto& buffer : registry) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        dropped += buffer->dropped;
+        for (const auto& event : buffer->events) {
+            if (!first)
+                buf << ",\n";
+            first = false;
+            buf << "{\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->tid
+                << ",\"ts\":" << event.start << ",\"dur\":" << event.duration
+                << ",\"cat\":";
+            appendJSONString(buf, event.category);
+            buf << ",\"name\":";
+            appendJSONString(buf, event.name);
+            if (!event.detail.empty()) {
+                buf << ",\"args\":{\"detail\":";
+                appendJSONString(buf, event.detail.c_str());
+                buf << "}";
+            }
+            buf << "}";
+        }
+    }
+    buf << "],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped\":" << dropped << "}}\n";
+    return buf.str();
+}
+
+void Trace::dump(std::string path)
+{
+    std::string data = toJSON();
+
+    FILE* f = fopen(path.c_str(), "w");
+    if (f == nullptr)
+        throw _Exception("Trace: failed to open " + path + ": " + mt_strerror(errno));
+
+    size_t size = fwrite(data.c_str(), sizeof(char), data.length(), f);
+    fclose(f);
+
+    if (size < data.length())
+        throw _Exception("Trace: failed to write to " + path);
+
+    log_info("Trace written to %s\n", path.c_str());
+}
+
+PhaseTimer::PhaseTimer(const char* category)
+    : category(category)
+    , start(Trace::now())
+    , phaseStart(start)
+{
+}
+
+void PhaseTimer::phase(const char* name)
+{
+    long long now = Trace::now();
+    phases.emplace_back(name, now - phaseStart);
+    if (Trace::isEnabled())
+        Trace::record(category, name, "", phaseStart, now - phaseStart);
+    phaseStart = now;
+}
+
+long long PhaseTimer::total() const
+{
+    return (Trace::now() - start) / 1000;
+}
+
+std::string PhaseTimer::summary() const
+{
+    std::ostringstream buf;
+    for (size_t i = 0; i < phases.size(); i++) {
+        if (i > 0)
+            buf << ", ";
+        buf << phases[i].first << ' ' << phases[i].second / 1000 << " ms";
+    }
+    return buf.str();
+}
@@ -0,0 +1,136 @@
+/*GRB*
+
+Gerbera - https://gerbera.io/
+
+    trace.h - this file is part of Gerbera.
+
+    Copyright (C) 2016-2019 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file trace.h
+/// \brief Lightweight scoped span tracing, exported in the Chrome trace format.
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include <atomic>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// \brief Process wide trace collector.
+///
+/// Spans are recorded into per thread buffers, so recording never contends
+/// with other threads. While tracing is disabled a span costs one relaxed
+/// atomic load. The collected events can be written as a JSON document that
+/// is understood by chrome://tracing and Perfetto.
+class Trace {
+public:
+    /// \brief Starts or stops recording of new spans.
+    static void setEnabled(bool enable);
+
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    /// \brief Drops all recorded events.
+    static void clear();
+
+    /// \brief Microseconds since the trace clock was started.
+    static long long now();
+
+    /// \brief Stores a finished span in the buffer of the calling thread.
+    static void record(const char* category, const char* name, std::string detail, long long start, long long duration);
+
+    /// \brief Renders all recorded events as a Chrome trace JSON document.
+    static std::string toJSON();
+
+    /// \brief Writes the JSON document to the given file.
+    static void dump(std::string path);
+
+protected:
+    static std::atomic_bool enabled;
+};
+
+/// \brief Records the lifetime of the enclosing scope as a trace span.
+///
+/// category and name must be string literals (or otherwise outlive the
+/// trace), detail is only copied if tracing is enabled.
+class TraceSpan {
+public:
+    TraceSpan(const char* category, const char* name)
+        : category(category)
+        , name(name)
+        , start(Trace::isEnabled() ? Trace::now() : -1)
+    {
+    }
+
+    TraceSpan(const char* category, const char* name, const std::string& detail)
+        : TraceSpan(category, name)
+    {
+        if (start >= 0)
+            this->detail = detail;
+    }
+
+    TraceSpan(const char* category, const char* name, const char* detail)
+        : TraceSpan(category, name)
+    {
+        if (start >= 0 && detail != nullptr)
+            this->detail = detail;
+    }
+
+    ~TraceSpan()
+    {
+        if (start >= 0)
+            Trace::record(category, name, std::move(detail), start, Trace::now() - start);
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+protected:
+    const char* category;
+    const char* name;
+    long long start;
+    std::string detail;
+};
+
+/// \brief Measures consecutive phases of a longer operation, like the
+/// server start, and records every phase as a trace span.
+class PhaseTimer {
+public:
+    explicit PhaseTimer(const char* category);
+
+    /// \brief Ends the running phase under the given name and starts the next one.
+    /// \param name must be a string literal
+    void phase(const char* name);
+
+    /// \brief Milliseconds since the timer was created.
+    long long total() const;
+
+    /// \brief Renders the finished phases as "name 12 ms, name 3 ms".
+    std::string summary() const;
+
+protected:
+    const char* category;
+    long long start;
+    long long phaseStart;
+    std::vector<std::pair<const char*, long long>> phases;
+};
+
+#define _TRACE_CONCAT2(a, b) a##b
+#define _TRACE_CONCAT(a, b) _TRACE_CONCAT2(a, b)
+#define TRACE_SPAN(category, ...) TraceSpan _TRACE_CONCAT(_trace_span_, __LINE__)(category, __VA_ARGS__)
+
+#endif // __TRACE_H__
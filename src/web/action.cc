@@ -32,6 +32,7 @@
 #include "pages.h"
 #include "config/config_manager.h"
 #include "content_manager.h"
+#include "util/trace.h"
 
 using namespace zmm;
 using namespace mxml;
@@ -52,5 +53,16 @@ void web::action::process()
         throw _Exception("No action given!");
     log_debug("action: %s\n", action.c_str());
 
+    if (action == "trace_start") {
+        Trace::clear();
+        Trace::setEnabled(true);
+    } else if (action == "trace_stop") {
+        Trace::setEnabled(false);
+        std::string path = config->getOption(CFG_SERVER_TRACE_FILE);
+        Trace::dump(path);
+        root->appendTextChild("trace", path);
+    }
+    root->setAttribute("tracing", Trace::isEnabled() ? "1" : "0", mxml_bool_type);
+
     log_debug("action: returning\n");
 }
@@ -0,0 +1,94 @@
+/*GRB*
+
+Gerbera - https://gerbera.io/
+
+    bulk.cc - this file is part of Gerbera.
+
+    Copyright (C) 2016-2019 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file bulk.cc
+
+#include "common.h"
+#include "content_manager.h"
+#include "pages.h"
+#include "util/tools.h"
+
+using namespace zmm;
+using namespace mxml;
+
+web::bulk::bulk(std::shared_ptr<ConfigManager> config, std::shared_ptr<Storage> storage,
+    std::shared_ptr<ContentManager> content, std::shared_ptr<SessionManager> sessionManager)
+    : WebRequestHandler(config, storage, content, sessionManager)
+{
+}
+
+void web::bulk::process()
+{
+    log_debug("bulk: start\n");
+    check_request();
+
+    std::string action = param("action");
+    if (action == "status") {
+        int taskID = intParam("task_id", 0);
+        auto result = content->getBulkResult(taskID);
+        if (result == nullptr)
+            throw _Exception("web:bulk: unknown task " + std::to_string(taskID));
+
+        Ref<Element> bulkEl(new Element("bulk"));
+        bulkEl->setArrayName("failed");
+        bulkEl->setAttribute("task_id", std::to_string(taskID), mxml_int_type);
+        bulkEl->setAttribute("done", result->done ? "1" : "0", mxml_bool_type);
+        if (!result->error.empty())
+            bulkEl->setAttribute("error", result->error);
+        for (int objectID : result->failedIDs)
+            bulkEl->appendTextChild("failed", std::to_string(objectID), mxml_int_type);
+        root->appendElementChild(bulkEl);
+        log_debug("bulk: returning\n");
+        return;
+    }
+
+    BulkAction bulkAction;
+    if (action == "remove")
+        bulkAction = BulkAction::Remove;
+    else if (action == "rescan")
+        bulkAction = BulkAction::Rescan;
+    else if (action == "edit")
+        bulkAction = BulkAction::Edit;
+    else
+        throw _Exception("web:bulk called with illegal action");
+
+    std::vector<int> objectIDs;
+    for (const auto& id : split_string(param("object_ids"), ',')) {
+        std::string trimmed = trim_string(id);
+        if (trimmed.empty())
+            continue;
+        try {
+            objectIDs.push_back(std::stoi(trimmed));
+        } catch (const std::logic_error& e) {
+            throw _Exception("invalid object id " + trimmed);
+        }
+    }
+    if (objectIDs.empty())
+        throw _Exception("web:bulk called without object ids");
+
+    unsigned int taskID = content->bulkObjects(bulkAction, objectIDs, params);
+    root->setAttribute("count", std::to_string(objectIDs.size()), mxml_int_type);
+    root->setAttribute("task_id", std::to_string(taskID), mxml_int_type);
+
+    log_debug("bulk: returning\n");
+}
@@ -63,6 +63,8 @@ void web::items::process()
     auto obj = storage->loadObject(parentID);
     auto param = std::make_unique<BrowseParam>(parentID, BROWSE_DIRECT_CHILDREN | BROWSE_ITEMS);
     param->setRange(start, count);
+    // each session pages through its own browse snapshot
+    param->setClient("session " + session->getID());
 
     if ((obj->getClass() == UPNP_DEFAULT_CLASS_MUSIC_ALBUM) || (obj->getClass() == UPNP_DEFAULT_CLASS_PLAYLIST_CONTAINER))
         param->setFlag(BROWSE_TRACK_SORT);
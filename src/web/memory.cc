@@ -0,0 +1,68 @@
+/*GRB*
+
+Gerbera - https://gerbera.io/
+
+    memory.cc - this file is part of Gerbera.
+
+    Copyright (C) 2016-2019 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file memory.cc
+
+#include "common.h"
+#include "config/config_manager.h"
+#include "pages.h"
+#include "util/memory_accounting.h"
+
+using namespace zmm;
+using namespace mxml;
+
+web::memory::memory(std::shared_ptr<ConfigManager> config, std::shared_ptr<Storage> storage,
+    std::shared_ptr<ContentManager> content, std::shared_ptr<SessionManager> sessionManager)
+    : WebRequestHandler(config, storage, content, sessionManager)
+{
+}
+
+void web::memory::process()
+{
+    check_request();
+    std::string action = param("action");
+    if (!string_ok(action))
+        throw _Exception("web:memory called with illegal action");
+
+    if (action == "shrink")
+        MemoryAccounting::shrink();
+    else if (action != "list")
+        throw _Exception("web:memory called with illegal action");
+
+    long long total = 0;
+    Ref<Element> accountsEl(new Element("accounts"));
+    accountsEl->setArrayName("account");
+    for (const auto& report : MemoryAccounting::getReport()) {
+        Ref<Element> accountEl(new Element("account"));
+        accountEl->setAttribute("name", report.name);
+        accountEl->setAttribute("bytes", std::to_string(report.bytes), mxml_int_type);
+        accountEl->setAttribute("peak", std::to_string(report.peak), mxml_int_type);
+        accountEl->setAttribute("items", std::to_string(report.items), mxml_int_type);
+        accountEl->setAttribute("shrinkable", report.shrinkable ? "1" : "0", mxml_bool_type);
+        accountsEl->appendElementChild(accountEl);
+        total += report.bytes;
+    }
+    root->appendElementChild(accountsEl); // inherited from WebRequestHandler
+    root->setAttribute("total", std::to_string(total), mxml_int_type);
+    root->setAttribute("soft_limit", std::to_string(config->getIntOption(CFG_SERVER_MEMORY_SOFT_LIMIT) * 1024LL * 1024LL), mxml_int_type);
+}
@@ -42,6 +42,8 @@ std::unique_ptr<WebRequestHandler> createWebRequestHandler(
         return std::make_unique<web::add>(config, storage, content, sessionManager);
     if (page == "remove")
         return std::make_unique<web::remove>(config, storage, content, sessionManager);
+    if (page == "bulk")
+        return std::make_unique<web::bulk>(config, storage, content, sessionManager);
     if (page == "add_object")
         return std::make_unique<web::addObject>(config, storage, content, sessionManager);
     if (page == "auth")
@@ -64,6 +66,10 @@ std::unique_ptr<WebRequestHandler> createWebRequestHandler(
         return std::make_unique<web::voidType>(config, storage, content, sessionManager);
     if (page == "tasks")
         return std::make_unique<web::tasks>(config, storage, content, sessionManager);
+    if (page == "sql_profile")
+        return std::make_unique<web::sqlProfile>(config, storage, content, sessionManager);
+    if (page == "memory")
+        return std::make_unique<web::memory>(config, storage, content, sessionManager);
     if (page == "action")
         return std::make_unique<web::action>(config, storage, content, sessionManager);
 
@@ -105,6 +105,14 @@ public:
     virtual void process();
 };
 
+/// \brief remove, rescan or edit a list of objects in one task
+class bulk : public WebRequestHandler {
+public:
+    bulk(std::shared_ptr<ConfigManager> config, std::shared_ptr<Storage> storage,
+        std::shared_ptr<ContentManager> content, std::shared_ptr<SessionManager> sessionManager);
+    virtual void process();
+};
+
 /// \brief Browser remove item
 class edit_load : public WebRequestHandler {
 public:
@@ -163,6 +171,22 @@ public:
     virtual void process();
 };
 
+/// \brief SQL statement statistics and slow query log
+class sqlProfile : public WebRequestHandler {
+public:
+    sqlProfile(std::shared_ptr<ConfigManager> config, std::shared_ptr<Storage> storage,
+        std::shared_ptr<ContentManager> content, std::shared_ptr<SessionManager> sessionManager);
+    virtual void process();
+};
+
+/// \brief memory usage per subsystem
+class memory : public WebRequestHandler {
+public:
+    memory(std::shared_ptr<ConfigManager> config, std::shared_ptr<Storage> storage,
+        std::shared_ptr<ContentManager> content, std::shared_ptr<SessionManager> sessionManager);
+    virtual void process();
+};
+
 /// \brief UI action button
 class action : public WebRequestHandler {
 public:
@@ -0,0 +1,88 @@
+/*GRB*
+
+Gerbera - https://gerbera.io/
+
+    sql_profile.cc - this file is part of Gerbera.
+
+    Copyright (C) 2016-2019 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file sql_profile.cc
+
+#include "common.h"
+#include "pages.h"
+#include "storage/sql_profiler.h"
+#include "storage/storage.h"
+
+using namespace zmm;
+using namespace mxml;
+
+web::sqlProfile::sqlProfile(std::shared_ptr<ConfigManager> config, std::shared_ptr<Storage> storage,
+    std::shared_ptr<ContentManager> content, std::shared_ptr<SessionManager> sessionManager)
+    : WebRequestHandler(config, storage, content, sessionManager)
+{
+}
+
+void web::sqlProfile::process()
+{
+    check_request();
+    std::string action = param("action");
+    if (!string_ok(action))
+        throw _Exception("web:sql_profile called with illegal action");
+
+    auto profiler = storage->getProfiler();
+    if (profiler == nullptr)
+        throw _Exception("web:sql_profile: storage driver does not support profiling");
+
+    if (action == "list") {
+        Ref<Element> statementsEl(new Element("statements"));
+        statementsEl->setArrayName("statement");
+        for (const auto& stats : profiler->getStatements()) {
+            Ref<Element> stmtEl(new Element("statement"));
+            stmtEl->setAttribute("count", std::to_string(stats.count), mxml_int_type);
+            stmtEl->setAttribute("total_ms", std::to_string(stats.totalTime / 1000), mxml_int_type);
+            stmtEl->setAttribute("avg_us", std::to_string(stats.count > 0 ? stats.totalTime / stats.count : 0), mxml_int_type);
+            stmtEl->setAttribute("max_ms", std::to_string(stats.maxTime / 1000), mxml_int_type);
+            stmtEl->setAttribute("queue_ms", std::to_string(stats.queueWait / 1000), mxml_int_type);
+            stmtEl->setAttribute("rows", std::to_string(stats.rows), mxml_int_type);
+            stmtEl->appendTextChild("shape", stats.shape);
+            statementsEl->appendElementChild(stmtEl);
+        }
+        root->appendElementChild(statementsEl); // inherited from WebRequestHandler
+
+        Ref<Element> slowEl(new Element("slow_queries"));
+        slowEl->setArrayName("query");
+        for (const auto& slow : profiler->getSlowQueries()) {
+            Ref<Element> queryEl(new Element("query"));
+            queryEl->setAttribute("timestamp", std::to_string(slow.timestamp), mxml_int_type);
+            queryEl->setAttribute("duration_ms", std::to_string(slow.duration / 1000), mxml_int_type);
+            queryEl->appendTextChild("sql", slow.query);
+            queryEl->appendTextChild("plan", slow.plan);
+            slowEl->appendElementChild(queryEl);
+        }
+        root->appendElementChild(slowEl);
+    } else if (action == "reset") {
+        profiler->reset();
+    } else if (action == "enable") {
+        profiler->setEnabled(true);
+    } else if (action == "disable") {
+        profiler->setEnabled(false);
+    } else
+        throw _Exception("web:sql_profile called with illegal action");
+
+    root->setAttribute("profiling", profiler->isEnabled() ? "1" : "0", mxml_bool_type);
+}
@@ -89,6 +89,14 @@ class ConfigManagerTest : public ::testing::Test {
     return configGenerator.generate(std::string(home.c_str()), std::string(confdir.c_str()), std::string(prefix.c_str()), magic);
   }
 
+  // rewrites the configuration with the given section added to <server>
+  void addToServer(const std::string& section) {
+    std::string cfgContent = createConfig();
+    cfgContent.insert(cfgContent.find("</server>"), section);
+    std::ofstream file(config_file);
+    file << cfgContent;
+  }
+
   virtual void TearDown() {
     if (subject)
       delete subject;
@@ -140,3 +148,46 @@ TEST_F(ConfigManagerTest, LoadsConfigFromDefaultHomeWhenExistsButNotSpecified) {
   ASSERT_FALSE(subject->getBoolOption(CFG_SERVER_UI_ACCOUNTS_ENABLED));
   ASSERT_EQ(30, subject->getIntOption(CFG_SERVER_UI_SESSION_TIMEOUT));
 }
+
+TEST_F(ConfigManagerTest, LoadsSchedulingDefaultValues) {
+  subject = new ConfigManager(config_file, home, confdir, prefix, magic, "", "", 0, false);
+
+  EXPECT_EQ(0, subject->getIntOption(CFG_SERVER_SCHEDULING_IMPORT_NICE));
+  EXPECT_EQ("none", subject->getOption(CFG_SERVER_SCHEDULING_IMPORT_IO_CLASS));
+  EXPECT_EQ("", subject->getOption(CFG_SERVER_SCHEDULING_IMPORT_CGROUP));
+  EXPECT_EQ("none", subject->getOption(CFG_SERVER_SCHEDULING_THUMBNAIL_IO_CLASS));
+  EXPECT_EQ(4, subject->getIntOption(CFG_SERVER_SCHEDULING_TRANSCODE_IO_LEVEL));
+  EXPECT_EQ(0, subject->getIntOption(CFG_SERVER_SCHEDULING_THROTTLE_DELAY));
+  EXPECT_EQ(1, subject->getIntOption(CFG_SERVER_SCHEDULING_THROTTLE_MAX_STREAMS));
+  EXPECT_EQ(50, subject->getIntOption(CFG_SERVER_SCHEDULING_THROTTLE_MAX_LATENCY));
+}
+
+TEST_F(ConfigManagerTest, LoadsSchedulingClasses) {
+  addToServer("<scheduling>"
+              "<import nice=\"10\" io-class=\"idle\" cgroup=\"/sys/fs/cgroup/gerbera/import\"/>"
+              "<thumbnail io-class=\"best-effort\" io-level=\"7\"/>"
+              "<transcode nice=\"5\" io-class=\"best-effort\" io-level=\"6\"/>"
+              "<throttle delay=\"20\" max-streams=\"2\" max-latency=\"30\"/>"
+              "</scheduling>");
+  subject = new ConfigManager(config_file, home, confdir, prefix, magic, "", "", 0, false);
+
+  EXPECT_EQ(10, subject->getIntOption(CFG_SERVER_SCHEDULING_IMPORT_NICE));
+  EXPECT_EQ("idle", subject->getOption(CFG_SERVER_SCHEDULING_IMPORT_IO_CLASS));
+  EXPECT_EQ("/sys/fs/cgroup/gerbera/import", subject->getOption(CFG_SERVER_SCHEDULING_IMPORT_CGROUP));
+  EXPECT_EQ("best-effort", subject->getOption(CFG_SERVER_SCHEDULING_THUMBNAIL_IO_CLASS));
+  EXPECT_EQ(7, subject->getIntOption(CFG_SERVER_SCHEDULING_THUMBNAIL_IO_LEVEL));
+  EXPECT_EQ(5, subject->getIntOption(CFG_SERVER_SCHEDULING_TRANSCODE_NICE));
+  EXPECT_EQ(6, subject->getIntOption(CFG_SERVER_SCHEDULING_TRANSCODE_IO_LEVEL));
+  EXPECT_EQ(20, subject->getIntOption(CFG_SERVER_SCHEDULING_THROTTLE_DELAY));
+  EXPECT_EQ(2, subject->getIntOption(CFG_SERVER_SCHEDULING_THROTTLE_MAX_STREAMS));
+  EXPECT_EQ(30, subject->getIntOption(CFG_SERVER_SCHEDULING_THROTTLE_MAX_LATENCY));
+}
+
+TEST_F(ConfigManagerTest, RejectsInvalidSchedulingClasses) {
+  for (auto section : { "<import io-class=\"realtime\"/>", "<import nice=\"20\"/>",
+                        "<import cgroup=\"gerbera/import\"/>", "<thumbnail io-level=\"8\"/>",
+                        "<transcode nice=\"-1\"/>", "<throttle delay=\"-1\"/>" }) {
+    addToServer(std::string("<scheduling>") + section + "</scheduling>");
+    EXPECT_THROW(ConfigManager(config_file, home, confdir, prefix, magic, "", "", 0, false), Exception) << section;
+  }
+}
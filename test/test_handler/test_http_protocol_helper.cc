@@ -185,3 +185,13 @@ TEST_F(HeadersHelperTest, HandlesExtraContentTwo) {
 
   EXPECT_STREQ(GET_HEADERS(info), "foo: bar\r\n");
 }
+
+TEST_F(HeadersHelperTest, WritesTheSubtitleHeaderOfSamsungServers) {
+  std::string header = "CaptionInfo.sec";
+  std::string value = "http://192.168.1.2:49152/content/media/object_id/7/res_id/0/ext/file.srt";
+
+  subject->addHeader(header, value);
+  subject->writeHeaders(info);
+
+  EXPECT_STREQ(GET_HEADERS(info), "CaptionInfo.sec: http://192.168.1.2:49152/content/media/object_id/7/res_id/0/ext/file.srt\r\n");
+}
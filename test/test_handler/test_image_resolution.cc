@@ -0,0 +1,96 @@
+#include "gtest/gtest.h"
+
+#include <string>
+#include <util/image_resolution.h>
+
+using namespace ::testing;
+
+static std::string be32(uint32_t v)
+{
+    return { char(v >> 24), char(v >> 16), char(v >> 8), char(v) };
+}
+
+static std::string box(const std::string& type, const std::string& payload)
+{
+    return be32(8 + payload.size()) + type + payload;
+}
+
+class ImageResolutionTest : public ::testing::Test {
+public:
+    bool probe(const std::string& data)
+    {
+        width = height = 0;
+        return probeImageResolution(data.data(), data.size(), &width, &height);
+    }
+
+    int width;
+    int height;
+};
+
+TEST_F(ImageResolutionTest, ReadsJpegStartOfFrameBehindExif)
+{
+    std::string exif("\xFF\xE1\x00\x10"
+                     "Exif\0\0\xFF\xC0\x00\x11\x08\x00\x10\x00",
+        16);
+    std::string sof("\xFF\xC2\x00\x11\x08\x02\xD0\x05\x00", 9);
+    EXPECT_TRUE(probe(std::string("\xFF\xD8", 2) + exif + std::string("\xFF\xFF", 2) + sof + std::string(8, '\0')));
+    EXPECT_EQ(width, 1280);
+    EXPECT_EQ(height, 720);
+}
+
+TEST_F(ImageResolutionTest, StopsAtJpegScanData)
+{
+    EXPECT_FALSE(probe(std::string("\xFF\xD8\xFF\xDA\x00\x08\x01\x02\x03\x04\x05\x06", 12)));
+}
+
+TEST_F(ImageResolutionTest, ReadsPngHeader)
+{
+    std::string png("\x89PNG\r\n\x1A\n", 8);
+    EXPECT_TRUE(probe(png + be32(13) + "IHDR" + be32(640) + be32(480) + std::string(5, '\0')));
+    EXPECT_EQ(width, 640);
+    EXPECT_EQ(height, 480);
+}
+
+TEST_F(ImageResolutionTest, ReadsGifScreenDescriptor)
+{
+    EXPECT_TRUE(probe(std::string("GIF89a\x40\x01\xF0\x00\x00\x00", 12)));
+    EXPECT_EQ(width, 320);
+    EXPECT_EQ(height, 240);
+}
+
+TEST_F(ImageResolutionTest, ReadsWebPVariants)
+{
+    std::string riff = std::string("RIFF\0\0\0\0WEBP", 12);
+    EXPECT_TRUE(probe(riff + std::string("VP8 \0\0\0\0\0\0\0\x9D\x01\x2A\x20\x03\x58\x02", 18)));
+    EXPECT_EQ(width, 800);
+    EXPECT_EQ(height, 600);
+
+    // 14 bit width - 1 and height - 1
+    uint32_t bits = (100 - 1) | ((50 - 1) << 14);
+    std::string lossless = std::string("VP8L\0\0\0\0\x2F", 9) + std::string { char(bits), char(bits >> 8), char(bits >> 16), char(bits >> 24) };
+    EXPECT_TRUE(probe(riff + lossless + std::string(5, '\0')));
+    EXPECT_EQ(width, 100);
+    EXPECT_EQ(height, 50);
+
+    EXPECT_TRUE(probe(riff + std::string("VP8X\0\0\0\0\0\0\0\0\xFF\x0F\x00\x37\x04\x00", 18)));
+    EXPECT_EQ(width, 4096);
+    EXPECT_EQ(height, 1080);
+}
+
+TEST_F(ImageResolutionTest, TakesLargestHeifExtent)
+{
+    std::string ftyp = box("ftyp", std::string("mif1\0\0\0\0heic", 12));
+    std::string thumb = box("ispe", std::string(4, '\0') + be32(320) + be32(240));
+    std::string primary = box("ispe", std::string(4, '\0') + be32(4032) + be32(3024));
+    std::string meta = box("meta", std::string(4, '\0') + box("hdlr", std::string(8, '\0')) + box("iprp", box("ipco", thumb + primary)));
+    EXPECT_TRUE(probe(ftyp + meta + box("mdat", "")));
+    EXPECT_EQ(width, 4032);
+    EXPECT_EQ(height, 3024);
+}
+
+TEST_F(ImageResolutionTest, RejectsUnknownAndTruncatedData)
+{
+    EXPECT_FALSE(probe("not an image at all"));
+    EXPECT_FALSE(probe(std::string("\x89PNG\r\n\x1A\n\0\0\0\x0DIHDR", 16)));
+    EXPECT_FALSE(probe(box("ftyp", std::string("isom\0\0\0\0mp41", 12))));
+}
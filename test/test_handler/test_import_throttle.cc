@@ -0,0 +1,96 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <ftw.h>
+#include <memory>
+#include <string>
+#include <sys/stat.h>
+
+#include "config/config_generator.h"
+#include "config/config_manager.h"
+#include "util/scheduling.h"
+
+using namespace ::testing;
+
+class ImportThrottleTest : public ::testing::Test {
+public:
+    void SetUp() override
+    {
+        char tmpl[] = "/tmp/gerbera-throttle-XXXXXX";
+        home = mkdtemp(tmpl);
+        for (auto dir : { home + "/web", home + "/js", home + "/.config" })
+            mkdir(dir.c_str(), 0777);
+        for (auto script : { "common.js", "import.js", "playlists.js" })
+            std::ofstream(home + "/js/" + script);
+    }
+
+    void TearDown() override
+    {
+        nftw(home.c_str(), [](const char* path, const struct stat*, int, struct FTW*) { return remove(path); }, 16, FTW_DEPTH | FTW_PHYS);
+    }
+
+    void init(const std::string& throttle)
+    {
+        ConfigGenerator configGenerator;
+        std::string config = configGenerator.generate(home, ".config", home, "");
+        config.insert(config.find("</server>"), "<scheduling>" + throttle + "</scheduling>");
+        std::string configFile = home + "/.config/config.xml";
+        std::ofstream(configFile) << config;
+        Scheduling::init(std::make_shared<ConfigManager>(configFile, home, ".config", home, "", "", "", 0, false));
+    }
+
+    // milliseconds ImportThrottle::pause() took
+    static long long pause()
+    {
+        auto start = std::chrono::steady_clock::now();
+        ImportThrottle::pause();
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    std::string home;
+};
+
+TEST_F(ImportThrottleTest, PausesOnlyWhileEnoughStreamsAreOpen)
+{
+    init("<throttle delay=\"100\" max-streams=\"2\" max-latency=\"0\"/>");
+    EXPECT_LT(pause(), 50);
+
+    ImportThrottle::streamOpened();
+    EXPECT_LT(pause(), 50);
+    ImportThrottle::streamOpened();
+    EXPECT_GE(pause(), 100);
+    EXPECT_EQ(ImportThrottle::getStreams(), 2);
+
+    ImportThrottle::streamClosed();
+    ImportThrottle::streamClosed();
+    EXPECT_LT(pause(), 50);
+}
+
+TEST_F(ImportThrottleTest, PausesOnSlowReads)
+{
+    init("<throttle delay=\"100\" max-streams=\"0\" max-latency=\"10\"/>");
+    ImportThrottle::streamOpened();
+    ImportThrottle::recordRead(1000);
+    EXPECT_LT(pause(), 50);
+
+    // the average follows the reads of the last moments
+    for (int i = 0; i < 32; i++)
+        ImportThrottle::recordRead(20000);
+    EXPECT_GE(ImportThrottle::getLatency(), 10000);
+    EXPECT_GE(pause(), 100);
+
+    // closing the last stream forgets the latency
+    ImportThrottle::streamClosed();
+    EXPECT_EQ(ImportThrottle::getLatency(), 0);
+    EXPECT_LT(pause(), 50);
+}
+
+TEST_F(ImportThrottleTest, IsOffWithoutDelay)
+{
+    init("<throttle delay=\"0\" max-streams=\"1\"/>");
+    ImportThrottle::streamOpened();
+    EXPECT_LT(pause(), 50);
+    ImportThrottle::streamClosed();
+}
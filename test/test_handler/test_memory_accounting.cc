@@ -0,0 +1,141 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <ftw.h>
+#include <memory>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+
+#include "config/config_generator.h"
+#include "config/config_manager.h"
+#include "util/memory_accounting.h"
+#include "util/timer.h"
+
+using namespace ::testing;
+
+static MemoryAccounting::Report report(MemoryAccounting::account_t account)
+{
+    return MemoryAccounting::getReport()[account];
+}
+
+TEST(MemoryAccountingTest, CountsBytesItemsAndPeak)
+{
+    auto before = report(MemoryAccounting::ACCOUNT_IO_BUFFERS);
+    MemoryAccounting::add(MemoryAccounting::ACCOUNT_IO_BUFFERS, 4096, 2);
+    MemoryAccounting::sub(MemoryAccounting::ACCOUNT_IO_BUFFERS, 1024, 1);
+
+    auto after = report(MemoryAccounting::ACCOUNT_IO_BUFFERS);
+    EXPECT_EQ(after.bytes, before.bytes + 3072);
+    EXPECT_EQ(after.items, before.items + 1);
+    EXPECT_GE(after.peak, before.bytes + 4096);
+
+    MemoryAccounting::sub(MemoryAccounting::ACCOUNT_IO_BUFFERS, 3072, 1);
+    EXPECT_EQ(report(MemoryAccounting::ACCOUNT_IO_BUFFERS).bytes, before.bytes);
+}
+
+TEST(MemoryAccountingTest, AddsSampledUsage)
+{
+    auto before = report(MemoryAccounting::ACCOUNT_TASK_QUEUES);
+    MemoryAccounting::setSampler(MemoryAccounting::ACCOUNT_TASK_QUEUES, []() {
+        return MemoryAccounting::Usage { 500, 3 };
+    });
+
+    auto sampled = report(MemoryAccounting::ACCOUNT_TASK_QUEUES);
+    EXPECT_EQ(sampled.bytes, before.bytes + 500);
+    EXPECT_EQ(sampled.items, before.items + 3);
+
+    MemoryAccounting::setSampler(MemoryAccounting::ACCOUNT_TASK_QUEUES, nullptr);
+    EXPECT_EQ(report(MemoryAccounting::ACCOUNT_TASK_QUEUES).bytes, before.bytes);
+}
+
+TEST(MemoryAccountingTest, RemovingASamplerWaitsForItsCalls)
+{
+    std::atomic<bool> sampling(false);
+    std::atomic<bool> release(false);
+    MemoryAccounting::setSampler(MemoryAccounting::ACCOUNT_TASK_QUEUES, [&]() {
+        sampling = true;
+        while (!release)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        return MemoryAccounting::Usage { 0, 0 };
+    });
+    std::thread reporter([]() { MemoryAccounting::getReport(); });
+    while (!sampling)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    std::atomic<bool> removed(false);
+    std::thread remover([&]() {
+        MemoryAccounting::setSampler(MemoryAccounting::ACCOUNT_TASK_QUEUES, nullptr);
+        removed = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_FALSE(removed);
+
+    release = true;
+    remover.join();
+    reporter.join();
+    EXPECT_TRUE(removed);
+}
+
+class MemorySoftLimitTest : public ::testing::Test {
+public:
+    void SetUp() override
+    {
+        char tmpl[] = "/tmp/gerbera-memory-XXXXXX";
+        home = mkdtemp(tmpl);
+        for (auto dir : { home + "/web", home + "/js", home + "/.config" })
+            mkdir(dir.c_str(), 0777);
+        for (auto script : { "common.js", "import.js", "playlists.js" })
+            std::ofstream(home + "/js/" + script);
+        timer = std::make_shared<Timer>();
+    }
+
+    void TearDown() override
+    {
+        nftw(home.c_str(), [](const char* path, const struct stat*, int, struct FTW*) { return remove(path); }, 16, FTW_DEPTH | FTW_PHYS);
+    }
+
+    std::shared_ptr<ConfigManager> createConfig(const std::string& memory)
+    {
+        ConfigGenerator configGenerator;
+        std::string config = configGenerator.generate(home, ".config", home, "");
+        config.insert(config.find("</server>"), memory);
+        std::string configFile = home + "/.config/config.xml";
+        std::ofstream(configFile) << config;
+        return std::make_shared<ConfigManager>(configFile, home, ".config", home, "", "", "", 0, false);
+    }
+
+    std::string home;
+    std::shared_ptr<Timer> timer;
+};
+
+TEST_F(MemorySoftLimitTest, ShrinksOnlyAboveTheLimit)
+{
+    MemorySoftLimit softLimit(createConfig("<memory soft-limit=\"1\"/>"), timer);
+    ASSERT_EQ(softLimit.getLimit(), 1024 * 1024);
+    int shrinks = 0;
+    MemoryAccounting::setShrinker(MemoryAccounting::ACCOUNT_SCRIPTING, [&]() {
+        shrinks++;
+        MemoryAccounting::sub(MemoryAccounting::ACCOUNT_SCRIPTING, 2 * 1024 * 1024);
+    });
+
+    softLimit.timerNotify(nullptr);
+    EXPECT_EQ(shrinks, 0);
+
+    MemoryAccounting::add(MemoryAccounting::ACCOUNT_SCRIPTING, 2 * 1024 * 1024);
+    softLimit.timerNotify(nullptr);
+    EXPECT_EQ(shrinks, 1);
+    EXPECT_LE(MemoryAccounting::getTotal(), softLimit.getLimit());
+
+    MemoryAccounting::setShrinker(MemoryAccounting::ACCOUNT_SCRIPTING, nullptr);
+}
+
+TEST_F(MemorySoftLimitTest, IsOffByDefault)
+{
+    MemorySoftLimit softLimit(createConfig(""), timer);
+    EXPECT_EQ(softLimit.getLimit(), 0);
+}
@@ -0,0 +1,166 @@
+#include "gtest/gtest.h"
+
+#include <string>
+#include <unistd.h>
+#include <util/seek_index.h>
+
+#include "iohandler/file_io_handler.h"
+
+using namespace ::testing;
+
+static std::string be16(uint32_t v)
+{
+    return { char(v >> 8), char(v) };
+}
+
+static std::string be32(uint32_t v)
+{
+    return { char(v >> 24), char(v >> 16), char(v >> 8), char(v) };
+}
+
+static std::string box(const std::string& type, const std::string& payload)
+{
+    return be32(8 + payload.size()) + type + payload;
+}
+
+static std::string fullBox(const std::string& type, const std::string& payload)
+{
+    return box(type, be32(0) + payload);
+}
+
+// EBML element with a one byte size
+static std::string element(const std::string& id, const std::string& payload)
+{
+    return id + char(0x80 | payload.size()) + payload;
+}
+
+// TS packet of the PCR PID, with a PCR unless pcr is negative
+static std::string packet(long long pcr, bool randomAccess)
+{
+    std::string p("\x47\x01\x00\x30", 4);
+    if (pcr >= 0) {
+        unsigned long long base = pcr;
+        p += std::string { 7, char(0x10 | (randomAccess ? 0x40 : 0)), char(base >> 25), char(base >> 17), char(base >> 9), char(base >> 1), char((base & 1) << 7), 0 };
+    } else {
+        p += std::string { 1, char(randomAccess ? 0x40 : 0) };
+    }
+    return p + std::string(188 - p.size(), '\xFF');
+}
+
+// six samples of 0.5 s in two chunks at bytes 1000 and 2000, samples 1
+// and 4 are key frames
+static std::string mp4File()
+{
+    std::string stbl = fullBox("stts", be32(1) + be32(6) + be32(500))
+        + fullBox("stss", be32(2) + be32(1) + be32(4))
+        + fullBox("stsc", be32(1) + be32(1) + be32(3) + be32(1))
+        + fullBox("stsz", be32(0) + be32(6) + be32(10) + be32(20) + be32(30) + be32(40) + be32(50) + be32(60))
+        + fullBox("stco", be32(2) + be32(1000) + be32(2000));
+    std::string mdia = fullBox("mdhd", be32(0) + be32(0) + be32(1000) + be32(3000) + be32(0))
+        + fullBox("hdlr", be32(0) + "vide" + std::string(12, '\0'))
+        + box("minf", box("stbl", stbl));
+    std::string file = box("ftyp", std::string("isom\0\0\0\0", 8)) + box("moov", box("trak", box("mdia", mdia)));
+    file += box("mdat", std::string(1000 - file.size() - 8, '\0') + "chunk one" + std::string(991, '\0') + "chunk two" + std::string(991, '\0'));
+    return file;
+}
+
+TEST(SeekIndexTest, ReadsMp4SyncSamples)
+{
+    std::string file = mp4File();
+
+    auto index = SeekIndex::build(file.data(), file.size());
+    ASSERT_NE(index, nullptr);
+    ASSERT_EQ(index->getPoints().size(), 2u);
+    EXPECT_DOUBLE_EQ(index->getDuration(), 3.0);
+
+    SeekIndex::Point point;
+    ASSERT_TRUE(index->find(1.4, point));
+    EXPECT_EQ(point.offset, 1000);
+    ASSERT_TRUE(index->find(2.0, point));
+    EXPECT_DOUBLE_EQ(point.time, 1.5);
+    EXPECT_EQ(point.offset, 2000);
+}
+
+TEST(SeekIndexTest, ReadsMatroskaCues)
+{
+    std::string info = element("\x2A\xD7\xB1", std::string("\x0F\x42\x40", 3))
+        + element("\x44\x89", be32(0x459C4000)); // 5000.0f
+    std::string cues = element("\xBB", element("\xB3", std::string(1, '\0')) + element("\xB7", element("\xF7", "\x01") + element("\xF1", be16(0x100))))
+        + element("\xBB", element("\xB3", be16(2000)) + element("\xB7", element("\xF7", "\x01") + element("\xF1", be16(0x200))));
+    std::string segment = std::string("\x15\x49\xA9\x66", 4) + char(0x80 | info.size()) + info
+        + std::string("\x1C\x53\xBB\x6B", 4) + char(0x80 | cues.size()) + cues;
+    segment += std::string("\xEC\x42\x00", 3) + std::string(0x200, '\0');
+    std::string file = std::string("\x1A\x45\xDF\xA3\x80\x18\x53\x80\x67\x01\x00\x00\x00\x00\x00", 15) + be16(segment.size()) + segment;
+    size_t data = 17;
+
+    auto index = SeekIndex::build(file.data(), file.size());
+    ASSERT_NE(index, nullptr);
+    ASSERT_EQ(index->getPoints().size(), 2u);
+    EXPECT_DOUBLE_EQ(index->getDuration(), 5.0);
+
+    SeekIndex::Point point;
+    ASSERT_TRUE(index->find(3.0, point));
+    EXPECT_DOUBLE_EQ(point.time, 2.0);
+    EXPECT_EQ(point.offset, off_t(data + 0x200));
+}
+
+TEST(SeekIndexTest, PrefersTransportStreamRandomAccessPoints)
+{
+    // a PCR every fourth packet, 0.5 s apart, packet 21 starts a key frame
+    std::string file;
+    for (int i = 0; i < 40; i++)
+        file += packet(i % 4 == 0 ? 45000 * (i / 4) : -1, i == 21);
+
+    auto index = SeekIndex::build(file.data(), file.size());
+    ASSERT_NE(index, nullptr);
+    EXPECT_DOUBLE_EQ(index->getDuration(), 4.5);
+
+    SeekIndex::Point point;
+    ASSERT_TRUE(index->find(2.7, point));
+    EXPECT_DOUBLE_EQ(point.time, 2.5);
+    EXPECT_EQ(point.offset, 21 * 188);
+}
+
+TEST(SeekIndexTest, RejectsUnknownData)
+{
+    EXPECT_EQ(SeekIndex::build("not a media file", 16), nullptr);
+}
+
+TEST(SeekIndexTest, ParsesNptRanges)
+{
+    EXPECT_DOUBLE_EQ(SeekIndex::parseNptStart("npt=10.5-"), 10.5);
+    EXPECT_DOUBLE_EQ(SeekIndex::parseNptStart("npt=1:01:10.5-1:02:00"), 3670.5);
+    EXPECT_DOUBLE_EQ(SeekIndex::parseNptStart("0-"), 0);
+    EXPECT_LT(SeekIndex::parseNptStart("npt=-10"), 0);
+    EXPECT_LT(SeekIndex::parseNptStart("bytes=0-"), 0);
+    EXPECT_EQ(SeekIndex::formatNpt(12.25), "12.250");
+}
+
+TEST(SeekIndexTest, ServesATimeSeekFromTheKeyFrame)
+{
+    char path[] = "/tmp/gerbera-seek-XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    std::string file = mp4File();
+    ASSERT_EQ(write(fd, file.data(), file.size()), ssize_t(file.size()));
+    close(fd);
+
+    // the way FileRequestHandler answers a TimeSeekRange.dlna.org request
+    SeekIndexCache cache(4);
+    auto index = cache.get(path);
+    ASSERT_NE(index, nullptr);
+    SeekIndex::Point point;
+    ASSERT_TRUE(index->find(SeekIndex::parseNptStart("npt=0:00:02.000-"), point));
+    EXPECT_EQ(SeekIndex::formatNpt(point.time), "1.500");
+
+    FileIOHandler ioHandler(path);
+    ioHandler.open(UPNP_READ);
+    ioHandler.seek(point.offset, SEEK_SET);
+    char buf[10] = {};
+    EXPECT_EQ(ioHandler.read(buf, 9), 9u);
+    EXPECT_STREQ(buf, "chunk two");
+    ioHandler.close();
+
+    EXPECT_EQ(cache.get(path), index);
+    unlink(path);
+}
@@ -0,0 +1,75 @@
+#include "gtest/gtest.h"
+
+#include <string>
+
+#include "storage/sql_profiler.h"
+
+using namespace ::testing;
+
+TEST(SQLProfilerTest, AggregatesExecutionsOfOneShape)
+{
+    SQLProfiler profiler(true, 0);
+    profiler.record("SELECT * FROM `mt_cds_object` WHERE `id` = 12", 100, 10);
+    profiler.record("SELECT *  FROM `mt_cds_object`\n WHERE `id` = 3", 300, 20);
+    profiler.record("SELECT * FROM `mt_cds_object` WHERE `id` IN (1, 2, 3)", 50, 0);
+    profiler.addRows("SELECT * FROM `mt_cds_object` WHERE `id` = ?", 2);
+
+    auto statements = profiler.getStatements();
+    ASSERT_EQ(statements.size(), 2);
+    EXPECT_EQ(statements[0].shape, "SELECT * FROM `mt_cds_object` WHERE `id` = ?");
+    EXPECT_EQ(statements[0].count, 2);
+    EXPECT_EQ(statements[0].totalTime, 400);
+    EXPECT_EQ(statements[0].maxTime, 300);
+    EXPECT_EQ(statements[0].queueWait, 30);
+    EXPECT_EQ(statements[0].rows, 2);
+    EXPECT_EQ(statements[1].shape, "SELECT * FROM `mt_cds_object` WHERE `id` IN (?...)");
+
+    profiler.reset();
+    EXPECT_TRUE(profiler.getStatements().empty());
+}
+
+TEST(SQLProfilerTest, NormalizesLiterals)
+{
+    EXPECT_EQ(SQLProfiler::normalize("UPDATE t SET a = 'it''s', b = 1.5 WHERE c2 = 7"),
+        "UPDATE t SET a = ?, b = ? WHERE c2 = ?");
+    EXPECT_EQ(SQLProfiler::normalize("SELECT 'a\\'b'", true), "SELECT ?");
+    EXPECT_EQ(SQLProfiler::normalize("INSERT INTO t VALUES ('a', 'b', 'c')"), "INSERT INTO t VALUES (?...)");
+}
+
+TEST(SQLProfilerTest, ReportsStatementsAtTheSlowThreshold)
+{
+    SQLProfiler profiler(true, 5);
+    EXPECT_FALSE(profiler.record("SELECT 1", 4999, 0));
+    EXPECT_TRUE(profiler.record("SELECT 1", 5000, 0));
+
+    profiler.addSlowQuery("SELECT 1", 5000, "SCAN");
+    profiler.addSlowQuery("SELECT 2", 6000, "");
+    auto slow = profiler.getSlowQueries();
+    ASSERT_EQ(slow.size(), 2);
+    EXPECT_EQ(slow[0].query, "SELECT 2");
+    EXPECT_EQ(slow[1].plan, "SCAN");
+}
+
+TEST(SQLProfilerTest, KeepsTheNewestSlowQueries)
+{
+    SQLProfiler profiler(true, 1);
+    for (int i = 0; i < SQL_PROFILER_SLOW_LOG_SIZE + 5; i++)
+        profiler.addSlowQuery(("SELECT " + std::to_string(i)).c_str(), 1000, "");
+
+    auto slow = profiler.getSlowQueries();
+    ASSERT_EQ(slow.size(), SQL_PROFILER_SLOW_LOG_SIZE);
+    EXPECT_EQ(slow.front().query, "SELECT " + std::to_string(SQL_PROFILER_SLOW_LOG_SIZE + 4));
+}
+
+TEST(SQLProfilerTest, WithoutThresholdNothingIsSlow)
+{
+    SQLProfiler profiler(true, 0);
+    EXPECT_FALSE(profiler.record("SELECT 1", 60 * 1000 * 1000, 0));
+}
+
+TEST(SQLProfilerTest, HandsTheQueueWaitOnOnce)
+{
+    SQLProfiler::setQueueWait(42);
+    EXPECT_EQ(SQLProfiler::takeQueueWait(), 42);
+    EXPECT_EQ(SQLProfiler::takeQueueWait(), 0);
+}
@@ -0,0 +1,112 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "util/trace.h"
+
+using namespace ::testing;
+
+class TraceTest : public ::testing::Test {
+public:
+    void SetUp() override
+    {
+        Trace::clear();
+        Trace::setEnabled(true);
+    }
+
+    void TearDown() override
+    {
+        Trace::setEnabled(false);
+        Trace::clear();
+    }
+
+    struct Event {
+        long long start = -1;
+        long long duration = -1;
+    };
+
+    // start and duration of the event with the given name in the JSON dump
+    static Event find(const std::string& json, const std::string& name)
+    {
+        Event event;
+        size_t pos = json.find("\"name\":\"" + name + "\"");
+        if (pos == std::string::npos)
+            return event;
+        size_t begin = json.rfind("{\"ph\"", pos);
+        sscanf(json.c_str() + json.find("\"ts\":", begin), "\"ts\":%lld,\"dur\":%lld", &event.start, &event.duration);
+        return event;
+    }
+};
+
+TEST_F(TraceTest, NestedSpansAreContainedInTheirParent)
+{
+    {
+        TRACE_SPAN("test", "outer");
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        {
+            TRACE_SPAN("test", "inner", "detail \"quoted\"");
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+
+    std::string json = Trace::toJSON();
+    auto outer = find(json, "outer");
+    auto inner = find(json, "inner");
+    ASSERT_GE(outer.start, 0);
+    ASSERT_GE(inner.start, 0);
+    EXPECT_GE(inner.duration, 2000);
+    EXPECT_GT(inner.start, outer.start);
+    EXPECT_LT(inner.start + inner.duration, outer.start + outer.duration);
+    EXPECT_NE(json.find("\"args\":{\"detail\":\"detail \\\"quoted\\\"\"}"), std::string::npos);
+}
+
+TEST_F(TraceTest, RecordsNothingWhileDisabled)
+{
+    Trace::setEnabled(false);
+    {
+        TRACE_SPAN("test", "disabled");
+    }
+    Trace::setEnabled(true);
+    {
+        // a span started while disabled stays unrecorded
+        Trace::setEnabled(false);
+        TRACE_SPAN("test", "late");
+        Trace::setEnabled(true);
+    }
+
+    std::string json = Trace::toJSON();
+    EXPECT_EQ(json.find("\"disabled\""), std::string::npos);
+    EXPECT_EQ(json.find("\"late\""), std::string::npos);
+}
+
+TEST_F(TraceTest, CollectsSpansOfFinishedThreads)
+{
+    std::thread worker([]() { TRACE_SPAN("test", "worker"); });
+    worker.join();
+    EXPECT_GE(find(Trace::toJSON(), "worker").start, 0);
+
+    Trace::clear();
+    EXPECT_LT(find(Trace::toJSON(), "worker").start, 0);
+}
+
+TEST_F(TraceTest, PhaseTimerRecordsConsecutivePhases)
+{
+    PhaseTimer phases("test");
+    std::this_thread::sleep_for(std::chrono::milliseconds(3));
+    phases.phase("first");
+    phases.phase("second");
+
+    std::string json = Trace::toJSON();
+    auto first = find(json, "first");
+    auto second = find(json, "second");
+    ASSERT_GE(first.start, 0);
+    EXPECT_GE(first.duration, 3000);
+    EXPECT_EQ(second.start, first.start + first.duration);
+
+    EXPECT_EQ(phases.summary().find("first "), 0);
+    EXPECT_NE(phases.summary().find(", second 0 ms"), std::string::npos);
+    EXPECT_GE(phases.total(), 3);
+}
@@ -0,0 +1,199 @@
+#include <arpa/inet.h>
+#include <atomic>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+#include <cds_objects.h>
+#include <mxml/mxml.h>
+#include <mxml/stream_parser.h>
+#include <onlineservice/online_service.h>
+#include <onlineservice/online_service_refresh.h>
+#include <url.h>
+#include "gtest/gtest.h"
+
+using namespace ::testing;
+using namespace zmm;
+using namespace mxml;
+
+static const char* FEED = "<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?>\n"
+                          "<records date=\"today\">\n"
+                          "  <header>ignored</header>\n"
+                          "  <movieinfo id=\"1\"><info><title>First &amp; Last</title></info></movieinfo>\n"
+                          "  <movieinfo id=\"2\"><info><title>Caf\xe9</title></info>"
+                          "<cast><name>A</name><name>B</name></cast></movieinfo>\n"
+                          "</records>\n";
+
+// Serves one fixed response per connection, the body is sent in small
+// pieces to make the client see several chunks.
+class LocalHttpServer {
+public:
+  LocalHttpServer(int status, std::string body) : status(status), body(body) {
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
+    socklen_t len = sizeof(addr);
+    getsockname(fd, reinterpret_cast<struct sockaddr*>(&addr), &len);
+    port = ntohs(addr.sin_port);
+    listen(fd, 4);
+    thread = std::thread([this]() { serve(); });
+  }
+
+  ~LocalHttpServer() {
+    shutdown(fd, SHUT_RDWR);
+    close(fd);
+    thread.join();
+  }
+
+  std::string getURL(std::string path = "/feed.xml") {
+    return "http://127.0.0.1:" + std::to_string(port) + path;
+  }
+
+  int getRequestCount() { return requests; }
+
+private:
+  void serve() {
+    int client;
+    while ((client = accept(fd, nullptr, nullptr)) >= 0) {
+      requests++;
+      char buf[4096];
+      std::string request;
+      ssize_t n;
+      while (request.find("\r\n\r\n") == std::string::npos && (n = recv(client, buf, sizeof(buf), 0)) > 0)
+        request.append(buf, n);
+
+      std::string head = "HTTP/1.1 " + std::to_string(status) + " Status\r\n"
+                         "Content-Type: text/xml\r\n"
+                         "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                         "Connection: close\r\n\r\n";
+      send(client, head.data(), head.size(), MSG_NOSIGNAL);
+      for (size_t pos = 0; pos < body.size(); pos += 16) {
+        send(client, body.data() + pos, std::min<size_t>(16, body.size() - pos), MSG_NOSIGNAL);
+        usleep(1000);
+      }
+      close(client);
+    }
+  }
+
+  int status;
+  std::string body;
+  int fd;
+  int port;
+  std::atomic_int requests { 0 };
+  std::thread thread;
+};
+
+static std::vector<Ref<Element>> parseInPieces(const std::string& xml, size_t pieceSize, std::string& rootName) {
+  std::vector<Ref<Element>> records;
+  Ref<StreamParser> parser(new StreamParser({ "movieinfo" }, [&records](Ref<Element> record) {
+    records.push_back(record);
+  }));
+  for (size_t pos = 0; pos < xml.size(); pos += pieceSize)
+    parser->feed(xml.data() + pos, std::min(pieceSize, xml.size() - pos));
+  parser->finish();
+  rootName = parser->getRootName();
+  return records;
+}
+
+TEST(StreamParserTest, BuildsRecordsIndependentOfChunking) {
+  for (size_t pieceSize : { 1, 7, 4096 }) {
+    std::string rootName;
+    auto records = parseInPieces(FEED, pieceSize, rootName);
+
+    EXPECT_EQ(rootName, "records");
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(records[0]->getAttribute("id"), "1");
+    EXPECT_EQ(records[0]->getChildByName("info")->getChildText("title"), "First & Last");
+    // the declared charset is converted to UTF-8 by the parser
+    EXPECT_EQ(records[1]->getChildByName("info")->getChildText("title"), "Caf\xc3\xa9");
+    EXPECT_EQ(records[1]->getChildByName("cast")->elementChildCount(), 2);
+  }
+}
+
+TEST(StreamParserTest, RethrowsHandlerErrorsAndStops) {
+  int calls = 0;
+  Ref<StreamParser> parser(new StreamParser({ "movieinfo" }, [&calls](Ref<Element> record) {
+    calls++;
+    throw _Exception("stop");
+  }));
+
+  EXPECT_THROW(parser->feed(FEED, strlen(FEED)), Exception);
+  EXPECT_EQ(calls, 1);
+}
+
+TEST(StreamParserTest, ReportsIncompleteDocuments) {
+  Ref<StreamParser> parser(new StreamParser({ "movieinfo" }, [](Ref<Element> record) {}));
+  std::string xml = FEED;
+  parser->feed(xml.data(), xml.size() / 2);
+
+  EXPECT_THROW(parser->finish(), ParseException);
+}
+
+TEST(StreamDownloadTest, ParsesRecordsWhileDownloading) {
+  LocalHttpServer server(200, FEED);
+  Ref<URL> url(new URL());
+
+  std::vector<std::string> ids;
+  int chunks = 0;
+  Ref<StreamParser> parser(new StreamParser({ "movieinfo" }, [&ids](Ref<Element> record) {
+    ids.push_back(record->getAttribute("id"));
+  }));
+
+  long retcode = 0;
+  url->downloadStream(server.getURL(), &retcode, [&](const char* data, size_t length) {
+    chunks++;
+    parser->feed(data, length);
+  });
+  parser->finish();
+
+  EXPECT_EQ(retcode, 200);
+  EXPECT_GT(chunks, 1);
+  EXPECT_EQ(ids, std::vector<std::string>({ "1", "2" }));
+}
+
+TEST(StreamDownloadTest, ReturnsHttpErrors) {
+  LocalHttpServer server(404, "<html>missing</html>");
+  Ref<URL> url(new URL());
+
+  long retcode = 0;
+  std::string received;
+  url->downloadStream(server.getURL(), &retcode, [&received](const char* data, size_t length) {
+    received.append(data, length);
+  });
+
+  EXPECT_EQ(retcode, 404);
+  EXPECT_EQ(received, "<html>missing</html>");
+}
+
+TEST(StreamDownloadTest, AbortsWithSinkException) {
+  LocalHttpServer server(200, FEED);
+  Ref<URL> url(new URL());
+
+  long retcode = 0;
+  EXPECT_THROW(url->downloadStream(server.getURL(), &retcode, [](const char* data, size_t length) {
+    throw std::runtime_error("sink failed");
+  }),
+      std::runtime_error);
+}
+
+TEST(OnlineServiceRefreshTest, ContentHashIgnoresLastUpdate) {
+  auto item = std::make_shared<CdsItemExternalURL>(nullptr);
+  item->setTitle("Trailer");
+  item->setURL("http://example.com/trailer.mov");
+  item->setMimeType("video/quicktime");
+  item->setMetadata("dc:description", "text");
+  item->setAuxData(ONLINE_SERVICE_LAST_UPDATE, "100");
+
+  std::string hash = OnlineServiceRefresh::getContentHash(item);
+  EXPECT_EQ(hash.size(), 16u);
+
+  item->setAuxData(ONLINE_SERVICE_LAST_UPDATE, "200");
+  EXPECT_EQ(OnlineServiceRefresh::getContentHash(item), hash);
+
+  item->setMetadata("dc:description", "other text");
+  EXPECT_NE(OnlineServiceRefresh::getContentHash(item), hash);
+}
@@ -269,22 +269,27 @@ TEST(SearchParser, SimpleSearchCriteriaUsingEqualsOperator)
     // equalsOpExpr
     EXPECT_TRUE(executeSearchParserTest(sqlEmitter,
             "dc:title=\"Hospital Roll Call\"",
-            "(m.property_name='dc:title' and lower(m.property_value)=lower('Hospital Roll Call') and c.upnp_class is not null)"));
+            "(m.property_name='dc:title' and m.value_hash=2866567726 and lower(m.property_value)=lower('Hospital Roll Call') and c.upnp_class is not null)"));
+
+    // equalsOpExpr with non-ASCII value, no hash
+    EXPECT_TRUE(executeSearchParserTest(sqlEmitter,
+            "dc:title=\"Ãrger\"",
+            "(m.property_name='dc:title' and lower(m.property_value)=lower('Ãrger') and c.upnp_class is not null)"));
 
     // equalsOpExpr
     EXPECT_TRUE(executeSearchParserTest(sqlEmitter,
             "upnp:album=\"Scraps At Midnight\"",
-            "(m.property_name='upnp:album' and lower(m.property_value)=lower('Scraps At Midnight') and c.upnp_class is not null)"));
+            "(c.upnp_album='Scraps At Midnight' and c.upnp_class is not null)"));
 
     // equalsOpExpr or equalsOpExpr
     EXPECT_TRUE(executeSearchParserTest(sqlEmitter,
             "upnp:album=\"Scraps At Midnight\" or dc:title=\"Hospital Roll Call\"",
-            "(m.property_name='upnp:album' and lower(m.property_value)=lower('Scraps At Midnight') and c.upnp_class is not null) or (m.property_name='dc:title' and lower(m.property_value)=lower('Hospital Roll Call') and c.upnp_class is not null)"));
+            "(c.upnp_album='Scraps At Midnight' and c.upnp_class is not null) or (m.property_name='dc:title' and m.value_hash=2866567726 and lower(m.property_value)=lower('Hospital Roll Call') and c.upnp_class is not null)"));
 
     // equalsOpExpr or equalsOpExpr or equalsOpExpr
     EXPECT_TRUE(executeSearchParserTest(sqlEmitter,
             "upnp:album=\"Scraps At Midnight\" or dc:title=\"Hospital Roll Call\" or upnp:artist=\"Deafheaven\"",
-            "(m.property_name='upnp:album' and lower(m.property_value)=lower('Scraps At Midnight') and c.upnp_class is not null) or (m.property_name='dc:title' and lower(m.property_value)=lower('Hospital Roll Call') and c.upnp_class is not null) or (m.property_name='upnp:artist' and lower(m.property_value)=lower('Deafheaven') and c.upnp_class is not null)"));
+            "(c.upnp_album='Scraps At Midnight' and c.upnp_class is not null) or (m.property_name='dc:title' and m.value_hash=2866567726 and lower(m.property_value)=lower('Hospital Roll Call') and c.upnp_class is not null) or (c.upnp_artist='Deafheaven' and c.upnp_class is not null)"));
 }
 
 TEST(SearchParser, SearchCriteriaUsingEqualsOperatorParenthesesForSqlite)
@@ -293,77 +298,77 @@ TEST(SearchParser, SearchCriteriaUsingEqualsOperatorParenthesesForSqlite)
     // (equalsOpExpr)
     EXPECT_TRUE(executeSearchParserTest(sqlEmitter,
             "(upnp:album=\"Scraps At Midnight\")",
-            "((m.property_name='upnp:album' and lower(m.property_value)=lower('Scraps At Midnight') and c.upnp_class is not null))"));
+            "((c.upnp_album='Scraps At Midnight' and c.upnp_class is not null))"));
 
     // (equalsOpExpr or equalsOpExpr)
     EXPECT_TRUE(executeSearchParserTest(sqlEmitter,
             "(upnp:album=\"Scraps At Midnight\" or dc:title=\"Hospital Roll Call\")",
-            "((m.property_name='upnp:album' and lower(m.property_value)=lower('Scraps At Midnight') and c.upnp_class is not null) or (m.property_name='dc:title' and lower(m.property_value)=lower('Hospital Roll Call') and c.upnp_class is not null))"));
+            "((c.upnp_album='Scraps At Midnight' and c.upnp_class is not null) or (m.property_name='dc:title' and m.value_hash=2866567726 and lower(m.property_value)=lower('Hospital Roll Call') and c.upnp_class is not null))"));
 
     // (equalsOpExpr or equalsOpExpr) or equalsOpExpr
     EXPECT_TRUE(executeSearchParserTest(sqlEmitter,
             "(upnp:album=\"Scraps At Midnight\" or dc:title=\"Hospital Roll Call\") or upnp:artist=\"Deafheaven\"",
-            "((m.property_name='upnp:album' and lower(m.property_value)=lower('Scraps At Midnight') and c.upnp_class is not null) or (m.property_name='dc:title' and lower(m.property_value)=lower('Hospital Roll Call') and c.upnp_class is not null)) or (m.property_name='upnp:artist' and lower(m.property_value)=lower('Deafheaven') and c.upnp_class is not null)"));
+            "((c.upnp_album='Scraps At Midnight' and c.upnp_class is not null) or (m.property_name='dc:title' and m.value_hash=2866567726 and lower(m.property_value)=lower('Hospital Roll Call') and c.upnp_class is not null)) or (c.upnp_artist='Deafheaven' and c.upnp_class is not null)"));
 
     // equalsOpExpr or (equalsOpExpr or equalsOpExpr)
     EXPECT_TRUE(executeSearchParserTest(sqlEmitter,
             "upnp:album=\"Scraps At Midnight\" or (dc:title=\"Hospital Roll Call\" or upnp:artist=\"Deafheaven\")",
-            "(m.property_name='upnp:album' and lower(m.property_value)=lower('Scraps At Midnight') and c.upnp_class is not null) or ((m.property_name='dc:title' and lower(m.property_value)=lower('Hospital Roll Call') and c.upnp_class is not null) or (m.property_name='upnp:artist' and lower(m.property_value)=lower('Deafheaven') and c.upnp_class is not null))"));
+            "(c.upnp_album='Scraps At Midnight' and c.upnp_class is not null) or ((m.property_name='dc:title' and m.value_hash=2866567726 and lower(m.property_value)=lower('Hospital Roll Call') and c.upnp_class is not null) or (c.upnp_artist='Deafheaven' and c.upnp_class is not null))"));
 
     // equalsOpExpr and (equalsOpExpr or equalsOpExpr)
     EXPECT_TRUE(executeSearchParserTest(sqlEmitter,
             "upnp:album=\"Scraps At Midnight\" and (dc:title=\"Hospital Roll Call\" or upnp:artist=\"Deafheaven\")",
-            "(m.property_name='upnp:album' and lower(m.property_value)=lower('Scraps At Midnight') and c.upnp_class is not null) and ((m.property_name='dc:title' and lower(m.property_value)=lower('Hospital Roll Call') and c.upnp_class is not null) or (m.property_name='upnp:artist' and lower(m.property_value)=lower('Deafheaven') and c.upnp_class is not null))"));
+            "(c.upnp_album='Scraps At Midnight' and c.upnp_class is not null) and ((m.property_name='dc:title' and m.value_hash=2866567726 and lower(m.property_value)=lower('Hospital Roll Call') and c.upnp_class is not null) or (c.upnp_artist='Deafheaven' and c.upnp_class is not null))"));
 
     // equalsOpExpr and (equalsOpExpr or equalsOpExpr or equalsOpExpr)
     EXPECT_TRUE(executeSearchParserTest(sqlEmitter,
             "upnp:album=\"Scraps At Midnight\" and (dc:title=\"Hospital Roll Call\" or upnp:artist=\"Deafheaven\" or upnp:artist=\"Pavement\")",
-            "(m.property_name='upnp:album' and lower(m.property_value)=lower('Scraps At Midnight') and c.upnp_class is not null) and ((m.property_name='dc:title' and lower(m.property_value)=lower('Hospital Roll Call') and c.upnp_class is not null) or (m.property_name='upnp:artist' and lower(m.property_value)=lower('Deafheaven') and c.upnp_class is not null) or (m.property_name='upnp:artist' and lower(m.property_value)=lower('Pavement') and c.upnp_class is not null))"));
+            "(c.upnp_album='Scraps At Midnight' and c.upnp_class is not null) and ((m.property_name='dc:title' and m.value_hash=2866567726 and lower(m.property_value)=lower('Hospital Roll Call') and c.upnp_class is not null) or (c.upnp_artist='Deafheaven' and c.upnp_class is not null) or (c.upnp_artist='Pavement' and c.upnp_class is not null))"));
 
     // (equalsOpExpr or equalsOpExpr or equalsOpExpr) and equalsOpExpr and equalsOpExpr
     EXPECT_TRUE(executeSearchParserTest(sqlEmitter,
             "(dc:title=\"Hospital Roll Call\" or upnp:artist=\"Deafheaven\" or upnp:artist=\"Pavement\") and upnp:album=\"Nevermind\" and upnp:album=\"Sunbather\"",
-            "((m.property_name='dc:title' and lower(m.property_value)=lower('Hospital Roll Call') and c.upnp_class is not null) or (m.property_name='upnp:artist' and lower(m.property_value)=lower('Deafheaven') and c.upnp_class is not null) or (m.property_name='upnp:artist' and lower(m.property_value)=lower('Pavement') and c.upnp_class is not null)) and (m.property_name='upnp:album' and lower(m.property_value)=lower('Nevermind') and c.upnp_class is not null) and (m.property_name='upnp:album' and lower(m.property_value)=lower('Sunbather') and c.upnp_class is not null)"));
+            "((m.property_name='dc:title' and m.value_hash=2866567726 and lower(m.property_value)=lower('Hospital Roll Call') and c.upnp_class is not null) or (c.upnp_artist='Deafheaven' and c.upnp_class is not null) or (c.upnp_artist='Pavement' and c.upnp_class is not null)) and (c.upnp_album='Nevermind' and c.upnp_class is not null) and (c.upnp_album='Sunbather' and c.upnp_class is not null)"));
 }
 
 TEST(SearchParser, SearchCriteriaUsingContainsOperator)
 {
     DefaultSQLEmitter sqlEmitter;
     // (containsOpExpr)
-    EXPECT_TRUE(executeSearchParserTest(sqlEmitter, "upnp:album contains \"Midnight\"", "(m.property_name='upnp:album' and lower(m.property_value) like lower('%Midnight%') and c.upnp_class is not null)"));
+    EXPECT_TRUE(executeSearchParserTest(sqlEmitter, "upnp:album contains \"Midnight\"", "(c.upnp_album like '%Midnight%' and c.upnp_class is not null)"));
 
     // (containsOpExpr or containsOpExpr)
-    EXPECT_TRUE(executeSearchParserTest(sqlEmitter, "upnp:album contains \"Midnight\" or upnp:artist contains \"HEAVE\"", "(m.property_name='upnp:album' and lower(m.property_value) like lower('%Midnight%') and c.upnp_class is not null) or (m.property_name='upnp:artist' and lower(m.property_value) like lower('%HEAVE%') and c.upnp_class is not null)"));
+    EXPECT_TRUE(executeSearchParserTest(sqlEmitter, "upnp:album contains \"Midnight\" or upnp:artist contains \"HEAVE\"", "(c.upnp_album like '%Midnight%' and c.upnp_class is not null) or (c.upnp_artist like '%HEAVE%' and c.upnp_class is not null)"));
 }
 
 TEST(SearchParser, SearchCriteriaUsingDoesNotContainOperator)
 {
     DefaultSQLEmitter sqlEmitter;
     // (containsOpExpr)
-    EXPECT_TRUE(executeSearchParserTest(sqlEmitter, "upnp:album doesnotcontain \"Midnight\"", "(m.property_name='upnp:album' and lower(m.property_value) not like lower('%Midnight%') and c.upnp_class is not null)"));
+    EXPECT_TRUE(executeSearchParserTest(sqlEmitter, "upnp:album doesnotcontain \"Midnight\"", "(c.upnp_album not like '%Midnight%' and c.upnp_class is not null)"));
 
     // (containsOpExpr or containsOpExpr)
-    EXPECT_TRUE(executeSearchParserTest(sqlEmitter, "upnp:album doesNotContain \"Midnight\" or upnp:artist doesnotcontain \"HEAVE\"", "(m.property_name='upnp:album' and lower(m.property_value) not like lower('%Midnight%') and c.upnp_class is not null) or (m.property_name='upnp:artist' and lower(m.property_value) not like lower('%HEAVE%') and c.upnp_class is not null)"));
+    EXPECT_TRUE(executeSearchParserTest(sqlEmitter, "upnp:album doesNotContain \"Midnight\" or upnp:artist doesnotcontain \"HEAVE\"", "(c.upnp_album not like '%Midnight%' and c.upnp_class is not null) or (c.upnp_artist not like '%HEAVE%' and c.upnp_class is not null)"));
 }
 
 TEST(SearchParser, SearchCriteriaUsingStartsWithOperator)
 {
     DefaultSQLEmitter sqlEmitter;
     // (containsOpExpr)
-    EXPECT_TRUE(executeSearchParserTest(sqlEmitter, "upnp:album startswith \"Midnight\"", "(m.property_name='upnp:album' and lower(m.property_value) like lower('Midnight%') and c.upnp_class is not null)"));
+    EXPECT_TRUE(executeSearchParserTest(sqlEmitter, "upnp:album startswith \"Midnight\"", "(c.upnp_album like 'Midnight%' and c.upnp_class is not null)"));
 
     // (containsOpExpr or containsOpExpr)
-    EXPECT_TRUE(executeSearchParserTest(sqlEmitter, "upnp:album startsWith \"Midnight\" or upnp:artist startswith \"HEAVE\"", "(m.property_name='upnp:album' and lower(m.property_value) like lower('Midnight%') and c.upnp_class is not null) or (m.property_name='upnp:artist' and lower(m.property_value) like lower('HEAVE%') and c.upnp_class is not null)"));
+    EXPECT_TRUE(executeSearchParserTest(sqlEmitter, "upnp:album startsWith \"Midnight\" or upnp:artist startswith \"HEAVE\"", "(c.upnp_album like 'Midnight%' and c.upnp_class is not null) or (c.upnp_artist like 'HEAVE%' and c.upnp_class is not null)"));
 }
 
 TEST(SearchParser, SearchCriteriaUsingExistsOperator)
 {
     DefaultSQLEmitter sqlEmitter;
     // (containsOpExpr)
-    EXPECT_TRUE(executeSearchParserTest(sqlEmitter, "upnp:album exists true", "(m.property_name='upnp:album' and m.property_value is not null and c.upnp_class is not null)"));
+    EXPECT_TRUE(executeSearchParserTest(sqlEmitter, "upnp:album exists true", "(c.upnp_album is not null and c.upnp_class is not null)"));
 
     // (containsOpExpr or containsOpExpr)
-    EXPECT_TRUE(executeSearchParserTest(sqlEmitter, "upnp:album exists true or upnp:artist exists false", "(m.property_name='upnp:album' and m.property_value is not null and c.upnp_class is not null) or (m.property_name='upnp:artist' and m.property_value is null and c.upnp_class is not null)"));
+    EXPECT_TRUE(executeSearchParserTest(sqlEmitter, "upnp:album exists true or upnp:artist exists false", "(c.upnp_album is not null and c.upnp_class is not null) or (c.upnp_artist is null and c.upnp_class is not null)"));
 }
 
 TEST(SearchParser, SearchCriteriaWithExtendsOperator)
@@ -379,3 +384,16 @@ TEST(SearchParser, SearchCriteriaWithExtendsOperator)
     // derivedFromOpExpr and (containsOpExpr or containsOpExpr)
     EXPECT_TRUE(executeSearchParserTest(sqlEmitter, "upnp:class derivedFrom \"object.item.audioItem\" and (dc:title contains \"britain\" or dc:creator contains \"britain\"", "c.upnp_class like lower('object.item.audioItem.%') and ((m.property_name='dc:title' and lower(m.property_value) like lower('%britain%') and c.upnp_class is not null) or (m.property_name='dc:creator' and lower(m.property_value) like lower('%britain%') and c.upnp_class is not null))"));    
 }
+
+TEST(SearchParser, MetadataColumnsNeedNoJoin)
+{
+    DefaultSQLEmitter sqlEmitter;
+
+    auto rootNode = SearchParser(sqlEmitter, "upnp:artist=\"Deafheaven\" and upnp:album startswith \"Sun\"").parse();
+    EXPECT_EQ("from mt_cds_object c where (c.upnp_artist='Deafheaven' and c.upnp_class is not null) and (c.upnp_album like 'Sun%' and c.upnp_class is not null)",
+        rootNode->emitSQL());
+
+    rootNode = SearchParser(sqlEmitter, "upnp:artist=\"Deafheaven\" and dc:title contains \"Sun\"").parse();
+    EXPECT_EQ("from mt_cds_object c inner join mt_metadata_view m on c.id = m.item_id where (c.upnp_artist='Deafheaven' and c.upnp_class is not null) and (m.property_name='dc:title' and lower(m.property_value) like lower('%Sun%') and c.upnp_class is not null)",
+        rootNode->emitSQL());
+}
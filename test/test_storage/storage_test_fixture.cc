@@ -0,0 +1,76 @@
+#include "storage_test_fixture.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <ftw.h>
+#include <sstream>
+#include <sys/stat.h>
+#include <uuid/uuid.h>
+
+#include "config/config_generator.h"
+#include "config/config_manager.h"
+
+void StorageTestFixture::SetUp() {
+  uuid_t uuid;
+#ifdef BSD_NATIVE_UUID
+  char *uuid_str;
+  uint32_t status;
+  uuid_create(&uuid, &status);
+  uuid_to_string(&uuid, &uuid_str, &status);
+#else
+  char uuid_str[37];
+  uuid_generate(uuid);
+  uuid_unparse(uuid, uuid_str);
+#endif
+
+  std::stringstream ss;
+  ss << CMAKE_BINARY_DIR << DIR_SEPARATOR << "test" << DIR_SEPARATOR << "test_storage" << DIR_SEPARATOR << uuid_str;
+  home = ss.str();
+  confdir = ".config";
+
+  for (auto dir : { home, home + DIR_SEPARATOR + "web", home + DIR_SEPARATOR + "js", home + DIR_SEPARATOR + confdir })
+    mkdir(dir.c_str(), 0777);
+  for (auto script : { "common.js", "import.js", "playlists.js" })
+    std::ofstream(home + DIR_SEPARATOR + "js" + DIR_SEPARATOR + script);
+}
+
+void StorageTestFixture::TearDown() {
+  if (!home.empty())
+    nftw(home.c_str(), [](const char* path, const struct stat*, int, struct FTW*) { return remove(path); }, 16, FTW_DEPTH | FTW_PHYS);
+}
+
+std::shared_ptr<ConfigManager> StorageTestFixture::createConfig(const std::string& storage) {
+  ConfigGenerator configGenerator;
+  std::string config = configGenerator.generate(home, confdir, home, "");
+  size_t start = config.find("<storage");
+  size_t end = config.find("</storage>") + std::string("</storage>").length();
+  config.replace(start, end - start, storage);
+
+  std::string configFile = home + DIR_SEPARATOR + confdir + DIR_SEPARATOR + "config.xml";
+  std::ofstream(configFile) << config;
+  return std::make_shared<ConfigManager>(configFile, home, confdir, home, "", "", "", 0, false);
+}
+
+std::string StorageTestFixture::mysqlStorage(const std::string& role) {
+  auto env = [](const char* name, const char* fallback) {
+    const char* value = getenv(name);
+    return std::string(value != nullptr ? value : fallback);
+  };
+  std::string database = env("GERBERA_TEST_MYSQL_DATABASE", "");
+  if (database.empty())
+    return "";
+
+  std::ostringstream storage;
+  storage << "<storage role=\"" << role << "\">"
+          << "<mysql enabled=\"yes\">"
+          << "<host>" << env("GERBERA_TEST_MYSQL_HOST", "localhost") << "</host>"
+          << "<port>" << env("GERBERA_TEST_MYSQL_PORT", "0") << "</port>"
+          << "<username>" << env("GERBERA_TEST_MYSQL_USER", "gerbera") << "</username>"
+          << "<database>" << database << "</database>";
+  std::string password = env("GERBERA_TEST_MYSQL_PASSWORD", "");
+  if (!password.empty())
+    storage << "<password>" << password << "</password>";
+  storage << "</mysql></storage>";
+  return storage.str();
+}
@@ -0,0 +1,31 @@
+#ifndef __STORAGE_TEST_FIXTURE_H__
+#define __STORAGE_TEST_FIXTURE_H__
+
+#include <memory>
+#include <string>
+#include "gtest/gtest.h"
+
+class ConfigManager;
+
+// Creates a temporary server home with a generated configuration whose
+// <storage> section is replaced by the given one. The home is removed
+// again on TearDown, after the subclass has shut its storage down.
+class StorageTestFixture : public ::testing::Test {
+ public:
+  StorageTestFixture() {};
+  virtual ~StorageTestFixture() {};
+
+  virtual void SetUp() override;
+  virtual void TearDown() override;
+
+  std::shared_ptr<ConfigManager> createConfig(const std::string& storage);
+
+  // <storage> section of a MySQL database given by the environment, empty
+  // if GERBERA_TEST_MYSQL_DATABASE is not set
+  static std::string mysqlStorage(const std::string& role);
+
+  std::string home;
+  std::string confdir;
+};
+
+#endif // __STORAGE_TEST_FIXTURE_H__
@@ -0,0 +1,67 @@
+#ifdef HAVE_SQLITE3
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include "gtest/gtest.h"
+
+#include "autoscan.h"
+#include "cds_objects.h"
+#include "storage/sqlite3/sqlite3_storage.h"
+#include "storage_test_fixture.h"
+
+using namespace ::testing;
+
+class AutoscanListTest : public StorageTestFixture {
+ public:
+  virtual void SetUp() override {
+    StorageTestFixture::SetUp();
+    storage = std::make_shared<Sqlite3Storage>(createConfig(
+        "<storage><sqlite3 enabled=\"yes\"><database-file>gerbera.db</database-file>"
+        "<backup enabled=\"no\"/></sqlite3></storage>"), nullptr);
+    std::static_pointer_cast<Storage>(storage)->init();
+  }
+
+  virtual void TearDown() override {
+    storage->shutdown();
+    StorageTestFixture::TearDown();
+  }
+
+  // adds an object with the given location and a timed autoscan on it
+  void addAutoscan(int objectID, int objectType, const std::string& location) {
+    std::ostringstream object;
+    object << "INSERT INTO mt_cds_object (id, parent_id, object_type, dc_title, location) VALUES ("
+           << objectID << ", 0, " << objectType << ", 'Dir', '" << location << "')";
+    storage->exec(object);
+    std::ostringstream autoscan;
+    autoscan << "INSERT INTO mt_autoscan (obj_id, scan_level, scan_mode, recursive, hidden, interval, last_modified) VALUES ("
+             << objectID << ", 'full', 'timed', 0, 0, 60, 0)";
+    storage->exec(autoscan);
+  }
+
+  int autoscanCount() {
+    zmm::Ref<SQLResult> res = storage->select(std::string("SELECT COUNT(*) FROM mt_autoscan"));
+    return res->nextRow()->col_int64(0);
+  }
+
+  std::shared_ptr<Sqlite3Storage> storage;
+};
+
+TEST_F(AutoscanListTest, RemovesEntriesOfFilesWhileReadingTheList) {
+  // more rows than the driver reads at once, so the invalid entries are
+  // removed while rows are still to be read
+  storage->beginTransaction();
+  for (int i = 0; i < 300; i++) {
+    addAutoscan(1000 + 2 * i, OBJECT_TYPE_CONTAINER, "D/music/" + std::to_string(i));
+    addAutoscan(1001 + 2 * i, OBJECT_TYPE_ITEM, "F/music/" + std::to_string(i) + ".mp3");
+  }
+  storage->commitTransaction();
+  ASSERT_EQ(autoscanCount(), 600);
+
+  auto list = storage->getAutoscanList(ScanMode::Timed);
+  EXPECT_EQ(list->size(), 300);
+  EXPECT_EQ(autoscanCount(), 300);
+  EXPECT_NE(list->get("/music/299"), nullptr);
+}
+
+#endif // HAVE_SQLITE3
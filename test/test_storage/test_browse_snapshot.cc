@@ -0,0 +1,147 @@
+#ifdef HAVE_SQLITE3
+
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "gtest/gtest.h"
+
+#include "cds_objects.h"
+#include "storage/sqlite3/sqlite3_storage.h"
+#include "storage_test_fixture.h"
+
+using namespace ::testing;
+
+class BrowseSnapshotTest : public StorageTestFixture {
+ public:
+  // creates the storage with the default snapshot window if none is given
+  void createStorage(const std::string& snapshotWindow = "") {
+    std::string window = snapshotWindow.empty() ? "" : " browse-snapshot-window=\"" + snapshotWindow + "\"";
+    storage = std::make_shared<Sqlite3Storage>(createConfig(
+        "<storage" + window + ">"
+        "<sqlite3 enabled=\"yes\"><database-file>gerbera.db</database-file>"
+        "<backup enabled=\"no\"/></sqlite3></storage>"), nullptr);
+    storage->init();
+
+    int updateID = INVALID_OBJECT_ID;
+    storage->addContainerChain("/Snapshot", "", INVALID_OBJECT_ID, &containerID, &updateID, {});
+    for (auto title : { "01", "02", "03", "04", "05" })
+      addChild(title);
+  }
+
+  virtual void TearDown() override {
+    if (storage != nullptr)
+      storage->shutdown();
+    StorageTestFixture::TearDown();
+  }
+
+  // adds a child container and announces the change of the parent
+  void addChild(const std::string& title) {
+    int childID;
+    int updateID = INVALID_OBJECT_ID;
+    storage->addContainerChain("/Snapshot/" + title, "", INVALID_OBJECT_ID, &childID, &updateID, {});
+    auto ids = std::make_unique<std::unordered_set<int>>();
+    ids->insert(containerID);
+    storage->incrementUpdateIDs(ids);
+  }
+
+  std::vector<std::string> browse(int start, int count, int& total, int& updateID, const std::string& client = "192.168.0.10") {
+    auto param = std::make_unique<BrowseParam>(containerID, BROWSE_DIRECT_CHILDREN | BROWSE_CONTAINERS | BROWSE_ITEMS);
+    param->setRange(start, count);
+    param->setClient(client);
+    std::vector<std::string> titles;
+    for (const auto& obj : storage->browse(param))
+      titles.push_back(obj->getTitle());
+    total = param->getTotalMatches();
+    updateID = param->getUpdateID();
+    return titles;
+  }
+
+  std::shared_ptr<Storage> storage;
+  int containerID;
+};
+
+TEST_F(BrowseSnapshotTest, LaterPagesStayOnTheFirstPage) {
+  createStorage("30");
+  int total, updateID, firstUpdateID;
+  EXPECT_EQ(browse(0, 2, total, firstUpdateID), std::vector<std::string>({ "01", "02" }));
+  EXPECT_EQ(total, 5);
+
+  addChild("00");
+
+  EXPECT_EQ(browse(2, 2, total, updateID), std::vector<std::string>({ "03", "04" }));
+  EXPECT_EQ(total, 5);
+  EXPECT_EQ(updateID, firstUpdateID);
+  EXPECT_EQ(browse(4, 2, total, updateID), std::vector<std::string>({ "05" }));
+}
+
+TEST_F(BrowseSnapshotTest, NewFirstPageSeesChanges) {
+  createStorage("30");
+  int total, updateID, firstUpdateID;
+  browse(0, 2, total, firstUpdateID);
+
+  addChild("00");
+
+  EXPECT_EQ(browse(0, 2, total, updateID), std::vector<std::string>({ "00", "01" }));
+  EXPECT_EQ(total, 6);
+  EXPECT_GT(updateID, firstUpdateID);
+  EXPECT_EQ(browse(2, 2, total, updateID), std::vector<std::string>({ "02", "03" }));
+}
+
+TEST_F(BrowseSnapshotTest, UnchangedFirstPageKeepsTheSnapshot) {
+  createStorage("30");
+  int total, updateID, firstUpdateID;
+  browse(0, 2, total, firstUpdateID);
+  EXPECT_EQ(browse(0, 0, total, updateID), std::vector<std::string>({ "01", "02", "03", "04", "05" }));
+  EXPECT_EQ(updateID, firstUpdateID);
+}
+
+TEST_F(BrowseSnapshotTest, EnabledByDefault) {
+  createStorage();
+  int total, updateID;
+  browse(0, 2, total, updateID);
+
+  addChild("00");
+
+  EXPECT_EQ(browse(2, 2, total, updateID), std::vector<std::string>({ "03", "04" }));
+  EXPECT_EQ(total, 5);
+}
+
+TEST_F(BrowseSnapshotTest, ZeroWindowDisablesSnapshots) {
+  createStorage("0");
+  int total, updateID;
+  browse(0, 2, total, updateID);
+
+  addChild("00");
+
+  EXPECT_EQ(browse(2, 2, total, updateID), std::vector<std::string>({ "02", "03" }));
+  EXPECT_EQ(total, 6);
+}
+
+TEST_F(BrowseSnapshotTest, ClientsKeepTheirOwnSnapshots) {
+  createStorage("30");
+  int total, updateID;
+  browse(0, 2, total, updateID, "192.168.0.10");
+
+  addChild("00");
+
+  // a new listing of another client does not replace the first snapshot
+  EXPECT_EQ(browse(0, 2, total, updateID, "192.168.0.11"), std::vector<std::string>({ "00", "01" }));
+  EXPECT_EQ(total, 6);
+  EXPECT_EQ(browse(2, 2, total, updateID, "192.168.0.10"), std::vector<std::string>({ "03", "04" }));
+  EXPECT_EQ(total, 5);
+}
+
+TEST_F(BrowseSnapshotTest, ReportsTheUpdateIDOfTheContainer) {
+  createStorage("30");
+  int total, updateID;
+  auto container = std::static_pointer_cast<CdsContainer>(storage->loadObject(containerID));
+
+  // all children at once are browsed without a snapshot
+  browse(0, 0, total, updateID);
+  EXPECT_EQ(updateID, container->getUpdateID());
+  browse(0, 2, total, updateID);
+  EXPECT_EQ(updateID, container->getUpdateID());
+}
+
+#endif // HAVE_SQLITE3
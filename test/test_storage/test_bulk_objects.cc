@@ -0,0 +1,162 @@
+#ifdef HAVE_SQLITE3
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <sys/stat.h>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+
+#include "cds_objects.h"
+#include "cds_resource.h"
+#include "content_manager.h"
+#include "metadata/metadata_handler.h"
+#include "mxml/mxml.h"
+#include "storage/sqlite3/sqlite3_storage.h"
+#include "storage_test_fixture.h"
+#include "update_manager.h"
+#include "util/timer.h"
+#include "util/tools.h"
+#include "web/pages.h"
+#include "web/session_manager.h"
+
+using namespace ::testing;
+
+class BulkObjectsTest : public StorageTestFixture {
+ public:
+  virtual void SetUp() override {
+    StorageTestFixture::SetUp();
+    config = createConfig(
+        "<storage><sqlite3 enabled=\"yes\"><database-file>gerbera.db</database-file>"
+        "<backup enabled=\"no\"/></sqlite3></storage>");
+    storage = std::make_shared<Sqlite3Storage>(config, nullptr);
+    std::static_pointer_cast<Storage>(storage)->init();
+
+    timer = std::make_shared<Timer>();
+    sessionManager = std::make_shared<web::SessionManager>(config, timer);
+    session = sessionManager->createSession(60000);
+    session->logIn();
+    auto updateManager = std::make_shared<UpdateManager>(config, storage, nullptr);
+    content = std::make_shared<ContentManager>(config, storage, updateManager, sessionManager, timer, nullptr, nullptr, nullptr);
+    content->init();
+  }
+
+  virtual void TearDown() override {
+    content->shutdown();
+    storage->shutdown();
+    StorageTestFixture::TearDown();
+  }
+
+  // edited items are validated, so their files have to exist; the
+  // storage puts them into the containers of their directories
+  int addItem(const std::string& dir, const std::string& name) {
+    std::string location = home + DIR_SEPARATOR + dir;
+    mkdir(location.c_str(), 0777);
+    location += DIR_SEPARATOR + name;
+    std::ofstream(location) << name;
+
+    auto item = std::make_shared<CdsItem>(storage);
+    item->setTitle(name);
+    item->setClass(UPNP_DEFAULT_CLASS_MUSIC_TRACK);
+    item->setLocation(location);
+    item->setMimeType("audio/mpeg");
+    auto resource = std::make_shared<CdsResource>(CH_DEFAULT);
+    resource->addAttribute("protocolInfo", "http-get:*:audio/mpeg:*");
+    item->addResource(resource);
+    int changedContainer;
+    storage->addObject(item, &changedContainer);
+    return item->getID();
+  }
+
+  std::string description(int objectID) {
+    return storage->loadObject(objectID)->getMetadata(MetadataHandler::getMetaFieldName(M_DESCRIPTION));
+  }
+
+  // sends a request to the bulk page and returns its <root> element
+  zmm::Ref<mxml::Element> request(const std::string& parameters) {
+    auto handler = std::make_unique<web::bulk>(config, storage, content, sessionManager);
+    std::string url = "/content/interface?req_type=bulk&return_type=xml&sid=" + session->getID() + "&" + parameters;
+    auto io = handler->open(url.c_str(), UPNP_READ, "");
+    std::string output;
+    char buf[1024];
+    size_t len;
+    while ((len = io->read(buf, sizeof(buf))) > 0)
+      output.append(buf, len);
+    io->close();
+    return zmm::Ref<mxml::Parser>(new mxml::Parser())->parseString(output)->getRoot();
+  }
+
+  std::unique_ptr<BulkResult> waitFor(unsigned int taskID) {
+    for (int i = 0; i < 1000; i++) {
+      auto result = content->getBulkResult(taskID);
+      if (result == nullptr || result->done)
+        return result;
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return nullptr;
+  }
+
+  std::shared_ptr<ConfigManager> config;
+  std::shared_ptr<Sqlite3Storage> storage;
+  std::shared_ptr<Timer> timer;
+  std::shared_ptr<web::SessionManager> sessionManager;
+  std::shared_ptr<web::Session> session;
+  std::shared_ptr<ContentManager> content;
+};
+
+TEST_F(BulkObjectsTest, EditReportsTheObjectsThatFailed) {
+  int first = addItem("Bulk", "a.mp3");
+  int second = addItem("Bulk", "b.mp3");
+  int missing = second + 1000;
+
+  auto root = request("action=edit&description=Live&object_ids=" + std::to_string(first) + "," + std::to_string(missing) + "," + std::to_string(second));
+  ASSERT_EQ(root->getAttribute("success"), "1");
+  std::string taskID = root->getAttribute("task_id");
+  ASSERT_FALSE(taskID.empty());
+  ASSERT_NE(waitFor(std::stoi(taskID)), nullptr);
+
+  auto status = request("action=status&task_id=" + taskID);
+  ASSERT_EQ(status->getAttribute("success"), "1");
+  auto bulk = status->getChildByName("bulk");
+  ASSERT_NE(bulk, nullptr);
+  EXPECT_EQ(bulk->getAttribute("done"), "1");
+  EXPECT_EQ(bulk->getAttribute("error"), "");
+  ASSERT_EQ(bulk->elementChildCount(), 1);
+  EXPECT_EQ(bulk->getElementChild(0)->getText(), std::to_string(missing));
+
+  // the failed object does not undo the edits of its chunk
+  EXPECT_EQ(description(first), "Live");
+  EXPECT_EQ(description(second), "Live");
+}
+
+TEST_F(BulkObjectsTest, StatusOfUnknownTaskFails) {
+  auto root = request("action=status&task_id=12345");
+  EXPECT_EQ(root->getAttribute("success"), "0");
+}
+
+TEST_F(BulkObjectsTest, AnnouncesEachChangedContainerOnce) {
+  std::vector<int> objectIDs;
+  // more objects than fit into one chunk
+  for (int i = 0; i < 250; i++)
+    objectIDs.push_back(addItem(i % 2 == 0 ? "A" : "B", std::to_string(i) + ".mp3"));
+  int firstContainer = storage->loadObject(objectIDs[0])->getParentID();
+  int secondContainer = storage->loadObject(objectIDs[1])->getParentID();
+  session->clearUpdateIDs();
+
+  unsigned int taskID = content->bulkObjects(BulkAction::Edit, objectIDs, { { "description", "Live" } });
+  auto result = waitFor(taskID);
+  ASSERT_NE(result, nullptr);
+  EXPECT_TRUE(result->failedIDs.empty());
+
+  std::vector<int> announced;
+  for (const auto& id : split_string(session->getUIUpdateIDs(), ','))
+    announced.push_back(std::stoi(id));
+  std::sort(announced.begin(), announced.end());
+  EXPECT_EQ(announced, std::vector<int>({ firstContainer, secondContainer }));
+  EXPECT_EQ(description(objectIDs.back()), "Live");
+}
+
+#endif // HAVE_SQLITE3
@@ -0,0 +1,238 @@
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "gtest/gtest.h"
+
+#include "cds_objects.h"
+#include "storage/cds_tree_index.h"
+#include "storage/sql_profiler.h"
+#include "storage/sqlite3/sqlite3_storage.h"
+#include "storage_test_fixture.h"
+
+using namespace ::testing;
+
+// children of container 10 in database order: containers first, then by
+// title and ID; the titles are c1 < c2 for the containers and
+// a(4) = a(5) < b(6) < c(7) for the items
+static const std::vector<CdsTreeIndex::Child> CHILDREN = {
+  { 2, OBJECT_TYPE_CONTAINER, -1, 3, "c1" },
+  { 3, OBJECT_TYPE_CONTAINER, -1, 0, "c2" },
+  { 4, OBJECT_TYPE_ITEM, 2, 0, "a" },
+  { 5, OBJECT_TYPE_ITEM, 1, 0, "a" },
+  { 6, OBJECT_TYPE_ITEM, 2, 0, "b" },
+  { 7, OBJECT_TYPE_ITEM, -1, 0, "c" },
+};
+
+class CdsTreeIndexTest : public ::testing::Test {
+ public:
+  CdsTreeIndexTest() : subject(100, true) {};
+
+  virtual void SetUp() override {
+    ASSERT_TRUE(subject.setChildren(10, CHILDREN, subject.getGeneration()));
+  }
+
+  std::vector<int> page(bool containers, bool items, bool trackSort, int excludeID, int start, int count, int& total) {
+    std::vector<int> ids;
+    EXPECT_TRUE(subject.getPage(10, containers, items, trackSort, excludeID, start, count, ids, total));
+    return ids;
+  }
+
+  CdsTreeIndex subject;
+};
+
+TEST_F(CdsTreeIndexTest, KeepsTheDatabaseOrder) {
+  int total;
+  EXPECT_EQ(page(true, true, false, INVALID_OBJECT_ID, 0, 0, total), std::vector<int>({ 2, 3, 4, 5, 6, 7 }));
+  EXPECT_EQ(total, 6);
+  EXPECT_EQ(page(true, false, false, INVALID_OBJECT_ID, 0, 0, total), std::vector<int>({ 2, 3 }));
+  EXPECT_EQ(page(false, true, false, INVALID_OBJECT_ID, 0, 0, total), std::vector<int>({ 4, 5, 6, 7 }));
+  EXPECT_EQ(page(false, false, false, INVALID_OBJECT_ID, 0, 0, total), std::vector<int>());
+  EXPECT_EQ(total, 0);
+}
+
+TEST_F(CdsTreeIndexTest, TrackOrderBreaksTiesByTitleAndID) {
+  // ORDER BY track_number, dc_title, id with NULL track numbers first
+  int total;
+  EXPECT_EQ(page(true, true, true, INVALID_OBJECT_ID, 0, 0, total), std::vector<int>({ 2, 3, 7, 5, 4, 6 }));
+  EXPECT_EQ(page(false, true, true, INVALID_OBJECT_ID, 1, 2, total), std::vector<int>({ 5, 4 }));
+  EXPECT_EQ(total, 4);
+}
+
+TEST_F(CdsTreeIndexTest, ReturnsNoChildrenPastTheEnd) {
+  int total;
+  EXPECT_EQ(page(true, true, false, INVALID_OBJECT_ID, 4, 10, total), std::vector<int>({ 6, 7 }));
+  EXPECT_EQ(page(true, true, false, INVALID_OBJECT_ID, 6, 10, total), std::vector<int>());
+  EXPECT_EQ(total, 6);
+  EXPECT_EQ(page(false, true, false, INVALID_OBJECT_ID, 100, 0, total), std::vector<int>());
+  EXPECT_EQ(total, 4);
+}
+
+TEST_F(CdsTreeIndexTest, LeavesOutTheExcludedChild) {
+  int total;
+  EXPECT_EQ(page(true, true, false, 3, 0, 0, total), std::vector<int>({ 2, 4, 5, 6, 7 }));
+  EXPECT_EQ(total, 5);
+  // pages after the excluded child are shifted, as with the SQL condition
+  EXPECT_EQ(page(true, true, false, 3, 1, 2, total), std::vector<int>({ 4, 5 }));
+  EXPECT_EQ(page(true, true, false, 6, 2, 2, total), std::vector<int>({ 4, 5 }));
+  EXPECT_EQ(page(true, true, false, 6, 4, 2, total), std::vector<int>({ 7 }));
+  EXPECT_EQ(page(true, true, false, 3, 5, 2, total), std::vector<int>());
+
+  // a child outside of the requested types does not count
+  EXPECT_EQ(page(false, true, false, 3, 0, 0, total), std::vector<int>({ 4, 5, 6, 7 }));
+  EXPECT_EQ(total, 4);
+
+  int count;
+  ASSERT_TRUE(subject.getCount(10, true, true, 3, count));
+  EXPECT_EQ(count, 5);
+  ASSERT_TRUE(subject.getCount(10, false, true, 3, count));
+  EXPECT_EQ(count, 4);
+}
+
+TEST_F(CdsTreeIndexTest, StoresResultsOfContainersChangedElsewhere) {
+  unsigned long generation = subject.getGeneration();
+  subject.invalidate(20);
+  subject.objectChanged(4, 10);
+  EXPECT_TRUE(subject.setChildren(30, CHILDREN, generation));
+  EXPECT_FALSE(subject.setChildren(10, CHILDREN, generation));
+  EXPECT_FALSE(subject.isIndexed(10));
+}
+
+TEST_F(CdsTreeIndexTest, RejectsResultsAfterChangesOfUnknownParents) {
+  unsigned long generation = subject.getGeneration();
+  subject.objectsRemoved({ 40 });
+  EXPECT_FALSE(subject.setChildren(30, CHILDREN, generation));
+  EXPECT_TRUE(subject.isIndexed(10));
+
+  generation = subject.getGeneration();
+  subject.objectChanged(41, 20);
+  subject.setCounts(30, 1, 1, generation);
+  int count;
+  EXPECT_FALSE(subject.getCount(30, true, true, INVALID_OBJECT_ID, count));
+}
+
+TEST_F(CdsTreeIndexTest, KnowsTypeAndUpdateIDOfIndexedChildren) {
+  int objectType, updateID;
+  ASSERT_TRUE(subject.getObject(2, objectType, updateID));
+  EXPECT_EQ(objectType, OBJECT_TYPE_CONTAINER);
+  EXPECT_EQ(updateID, 3);
+  EXPECT_FALSE(subject.getObject(10, objectType, updateID));
+}
+
+TEST_F(CdsTreeIndexTest, SortsAddedChildrenIn) {
+  subject.objectAdded(10, { 8, OBJECT_TYPE_ITEM, 1, 0, "b" });
+  subject.objectAdded(10, { 9, OBJECT_TYPE_CONTAINER, -1, 0, "c0" });
+  int total;
+  EXPECT_EQ(page(true, true, false, INVALID_OBJECT_ID, 0, 0, total), std::vector<int>({ 9, 2, 3, 4, 5, 6, 8, 7 }));
+  EXPECT_EQ(page(false, true, true, INVALID_OBJECT_ID, 0, 0, total), std::vector<int>({ 7, 5, 8, 4, 6 }));
+  int count;
+  ASSERT_TRUE(subject.getCount(10, true, false, INVALID_OBJECT_ID, count));
+  EXPECT_EQ(count, 3);
+}
+
+TEST_F(CdsTreeIndexTest, DropsTheListOnAddsWithoutBytewiseTitles) {
+  CdsTreeIndex collated(100, false);
+  ASSERT_TRUE(collated.setChildren(10, CHILDREN, collated.getGeneration()));
+  collated.objectAdded(10, { 8, OBJECT_TYPE_ITEM, 1, 0, "b" });
+  EXPECT_FALSE(collated.isIndexed(10));
+}
+
+TEST_F(CdsTreeIndexTest, KeepsUpdateIDsCurrent) {
+  unsigned long generation = subject.getGeneration();
+  subject.updateIDsChanged({ { 2, 7 } });
+  int objectType, updateID;
+  ASSERT_TRUE(subject.getObject(2, objectType, updateID));
+  EXPECT_EQ(updateID, 7);
+
+  // a list queried before holds the old update ID
+  EXPECT_FALSE(subject.setChildren(30, CHILDREN, generation));
+  EXPECT_TRUE(subject.setChildren(30, CHILDREN, subject.getGeneration()));
+}
+
+#ifdef HAVE_SQLITE3
+
+class BrowseIndexTest : public StorageTestFixture {
+ public:
+  virtual void SetUp() override {
+    StorageTestFixture::SetUp();
+    storage = std::make_shared<Sqlite3Storage>(createConfig(
+        "<storage profiling=\"yes\" browse-snapshot-window=\"0\">"
+        "<sqlite3 enabled=\"yes\"><database-file>gerbera.db</database-file>"
+        "<backup enabled=\"no\"/></sqlite3></storage>"), nullptr);
+    std::static_pointer_cast<Storage>(storage)->init();
+
+    int updateID = INVALID_OBJECT_ID;
+    storage->addContainerChain("/Index", "", INVALID_OBJECT_ID, &containerID, &updateID, {});
+    for (auto title : { "01", "02", "03", "04", "05" })
+      addChild(title);
+  }
+
+  virtual void TearDown() override {
+    storage->shutdown();
+    StorageTestFixture::TearDown();
+  }
+
+  void addChild(const std::string& title) {
+    int childID;
+    int updateID = INVALID_OBJECT_ID;
+    storage->addContainerChain("/Index/" + title, "", INVALID_OBJECT_ID, &childID, &updateID, {});
+    auto ids = std::make_unique<std::unordered_set<int>>();
+    ids->insert(containerID);
+    storage->incrementUpdateIDs(ids);
+  }
+
+  std::vector<std::string> browse(int objectID, int start, int count, int& updateID) {
+    auto param = std::make_unique<BrowseParam>(objectID, BROWSE_DIRECT_CHILDREN | BROWSE_CONTAINERS | BROWSE_ITEMS);
+    param->setRange(start, count);
+    std::vector<std::string> titles;
+    for (const auto& obj : storage->browse(param))
+      titles.push_back(obj->getTitle());
+    updateID = param->getUpdateID();
+    return titles;
+  }
+
+  // statements run apart from loading the metadata of the objects
+  std::vector<std::string> queries() {
+    std::vector<std::string> shapes;
+    for (const auto& statement : storage->getProfiler()->getStatements()) {
+      if (statement.shape.find("mt_metadata_view") == std::string::npos)
+        shapes.insert(shapes.end(), statement.count, statement.shape);
+    }
+    return shapes;
+  }
+
+  // the page is loaded by the IDs taken from the index
+  void expectOnlyObjectsLoaded() {
+    auto shapes = queries();
+    ASSERT_EQ(shapes.size(), 1);
+    EXPECT_NE(shapes[0].find("WHERE \"f\".\"id\" IN"), std::string::npos) << shapes[0];
+  }
+
+  std::shared_ptr<Sqlite3Storage> storage;
+  int containerID;
+};
+
+TEST_F(BrowseIndexTest, PagesOfKnownContainersOnlyLoadTheObjects) {
+  int updateID;
+  browse(CDS_ID_ROOT, 0, 0, updateID);
+  browse(containerID, 0, 0, updateID);
+
+  storage->getProfiler()->reset();
+  EXPECT_EQ(browse(containerID, 1, 2, updateID), std::vector<std::string>({ "02", "03" }));
+  expectOnlyObjectsLoaded();
+  EXPECT_EQ(updateID, std::static_pointer_cast<CdsContainer>(storage->loadObject(containerID))->getUpdateID());
+}
+
+TEST_F(BrowseIndexTest, AddedChildrenAreSortedIn) {
+  int updateID;
+  browse(CDS_ID_ROOT, 0, 0, updateID);
+  browse(containerID, 0, 0, updateID);
+
+  addChild("00");
+  storage->getProfiler()->reset();
+  EXPECT_EQ(browse(containerID, 0, 2, updateID), std::vector<std::string>({ "00", "01" }));
+  expectOnlyObjectsLoaded();
+  EXPECT_EQ(updateID, std::static_pointer_cast<CdsContainer>(storage->loadObject(containerID))->getUpdateID());
+}
+
+#endif // HAVE_SQLITE3
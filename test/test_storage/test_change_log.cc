@@ -0,0 +1,163 @@
+#if defined(HAVE_SQLITE3) || defined(HAVE_MYSQL)
+
+#include <ctime>
+#include <memory>
+#include <sstream>
+#include <unordered_set>
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include "cds_objects.h"
+#include "storage_test_fixture.h"
+#ifdef HAVE_SQLITE3
+#include "storage/sqlite3/sqlite3_storage.h"
+#endif
+#ifdef HAVE_MYSQL
+#include "storage/mysql/mysql_storage.h"
+#endif
+
+using namespace ::testing;
+
+#ifdef HAVE_SQLITE3
+// The configuration allows roles on a shared MySQL database only and
+// sqlite3 locks its file exclusively, so a writer reads its own log.
+class Sqlite3ChangeLogStorage : public Sqlite3Storage {
+ public:
+  Sqlite3ChangeLogStorage(std::shared_ptr<ConfigManager> config) : Sqlite3Storage(config, nullptr) { writer = true; };
+  using SQLStorage::pruneChangeLog;
+
+  static std::string storage(const std::string& role) {
+    return "<storage><sqlite3 enabled=\"yes\"><database-file>gerbera.db</database-file>"
+           "<backup enabled=\"no\"/></sqlite3></storage>";
+  }
+
+  static const bool hasReaderNode = false;
+  static const bool hasAutoIncrementSteps = false;
+};
+#endif
+
+#ifdef HAVE_MYSQL
+// Runs against a scratch database given by GERBERA_TEST_MYSQL_DATABASE and
+// GERBERA_TEST_MYSQL_{HOST,PORT,USER,PASSWORD}, a local MariaDB will do.
+class MysqlChangeLogStorage : public MysqlStorage {
+ public:
+  MysqlChangeLogStorage(std::shared_ptr<ConfigManager> config) : MysqlStorage(config) {};
+  using SQLStorage::pruneChangeLog;
+
+  static std::string storage(const std::string& role) {
+    return StorageTestFixture::mysqlStorage(role);
+  }
+
+  static const bool hasReaderNode = true;
+  static const bool hasAutoIncrementSteps = true;
+};
+#endif
+
+template <class ChangeLogStorage>
+class ChangeLogTest : public StorageTestFixture {
+ public:
+  virtual void SetUp() override {
+    if (ChangeLogStorage::storage("writer").empty())
+      GTEST_SKIP() << "GERBERA_TEST_MYSQL_DATABASE is not set";
+    StorageTestFixture::SetUp();
+
+    writer = std::make_shared<ChangeLogStorage>(createConfig(ChangeLogStorage::storage("writer")));
+    std::static_pointer_cast<Storage>(writer)->init();
+    exec("DELETE FROM `mt_change_log`");
+    exec("DELETE FROM `mt_internal_setting` WHERE `key` = 'change_log_pruned'");
+
+    if (!ChangeLogStorage::hasReaderNode) {
+      reader = writer;
+      return;
+    }
+    reader = std::make_shared<ChangeLogStorage>(createConfig(ChangeLogStorage::storage("reader")));
+    std::static_pointer_cast<Storage>(reader)->init();
+  }
+
+  virtual void TearDown() override {
+    if (reader != nullptr && reader != writer)
+      std::static_pointer_cast<Storage>(reader)->shutdown();
+    if (writer != nullptr)
+      std::static_pointer_cast<Storage>(writer)->shutdown();
+    StorageTestFixture::TearDown();
+  }
+
+  void exec(const std::string& query) {
+    std::ostringstream q;
+    q << query;
+    writer->exec(q);
+  }
+
+  std::string change(int objectID) {
+    auto ids = std::make_unique<std::unordered_set<int>>();
+    ids->insert(objectID);
+    return writer->incrementUpdateIDs(ids);
+  }
+
+  std::shared_ptr<ChangeLogStorage> writer;
+  std::shared_ptr<ChangeLogStorage> reader;
+};
+
+using ChangeLogStorages = Types<
+#ifdef HAVE_SQLITE3
+    Sqlite3ChangeLogStorage
+#endif
+#if defined(HAVE_SQLITE3) && defined(HAVE_MYSQL)
+    ,
+#endif
+#ifdef HAVE_MYSQL
+    MysqlChangeLogStorage
+#endif
+    >;
+TYPED_TEST_SUITE(ChangeLogTest, ChangeLogStorages);
+
+TYPED_TEST(ChangeLogTest, ReaderReceivesChangesOfTheWriter) {
+  int lastChangeID = -1;
+  EXPECT_EQ(this->reader->getChangesSince(lastChangeID), "");
+
+  this->change(CDS_ID_FS_ROOT);
+  std::string update = this->change(CDS_ID_FS_ROOT);
+  EXPECT_EQ(this->reader->getChangesSince(lastChangeID), update);
+  EXPECT_EQ(this->reader->getChangesSince(lastChangeID), "");
+}
+
+TYPED_TEST(ChangeLogTest, StartsAfterAnEmptiedLogWithoutFullAnnounce) {
+  this->change(CDS_ID_FS_ROOT);
+  this->writer->pruneChangeLog(time(nullptr) + 1);
+
+  // ids are not reused, the next id is above MAX(id) + 1 of the log
+  int lastChangeID = -1;
+  EXPECT_EQ(this->reader->getChangesSince(lastChangeID), "");
+  std::string update = this->change(CDS_ID_FS_ROOT);
+  EXPECT_EQ(this->reader->getChangesSince(lastChangeID), update);
+}
+
+TYPED_TEST(ChangeLogTest, AcceptsAutoIncrementSteps) {
+  if (!TypeParam::hasAutoIncrementSteps)
+    GTEST_SKIP() << "the database has no auto_increment_increment";
+  this->exec("SET SESSION auto_increment_increment = 3");
+
+  int lastChangeID = -1;
+  EXPECT_EQ(this->reader->getChangesSince(lastChangeID), "");
+  std::string update = this->change(CDS_ID_FS_ROOT);
+  EXPECT_EQ(this->reader->getChangesSince(lastChangeID), update);
+  update = this->change(CDS_ID_FS_ROOT);
+  EXPECT_EQ(this->reader->getChangesSince(lastChangeID), update);
+
+  this->exec("SET SESSION auto_increment_increment = 1");
+}
+
+TYPED_TEST(ChangeLogTest, AnnouncesTheWholeTreeAfterMissedChanges) {
+  int lastChangeID = -1;
+  EXPECT_EQ(this->reader->getChangesSince(lastChangeID), "");
+
+  this->change(CDS_ID_FS_ROOT);
+  this->writer->pruneChangeLog(time(nullptr) + 1);
+  std::string update = this->change(CDS_ID_FS_ROOT);
+
+  std::string changes = this->reader->getChangesSince(lastChangeID);
+  EXPECT_THAT(changes, StartsWith(std::to_string(CDS_ID_ROOT) + ","));
+  EXPECT_THAT(changes, HasSubstr(update));
+}
+
+#endif // HAVE_SQLITE3 || HAVE_MYSQL
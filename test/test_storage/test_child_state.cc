@@ -0,0 +1,124 @@
+#ifdef HAVE_SQLITE3
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include "gtest/gtest.h"
+
+#include "cds_objects.h"
+#include "storage/sqlite3/sqlite3_storage.h"
+#include "storage_test_fixture.h"
+
+using namespace ::testing;
+
+class ChildStateTest : public StorageTestFixture {
+ public:
+  virtual void SetUp() override {
+    StorageTestFixture::SetUp();
+    storage = std::make_shared<Sqlite3Storage>(createConfig(
+        "<storage><sqlite3 enabled=\"yes\"><database-file>gerbera.db</database-file>"
+        "<backup enabled=\"no\"/></sqlite3></storage>"), nullptr);
+    std::static_pointer_cast<Storage>(storage)->init();
+  }
+
+  virtual void TearDown() override {
+    storage->shutdown();
+    StorageTestFixture::TearDown();
+  }
+
+  int addContainer(const std::string& path) {
+    int containerID;
+    int updateID;
+    storage->addContainerChain(path, "", INVALID_OBJECT_ID, &containerID, &updateID, {});
+    return containerID;
+  }
+
+  // a container the storage keeps when its last child is removed
+  void makePersistent(int containerID) {
+    std::ostringstream q;
+    q << "UPDATE mt_cds_object SET flags = flags | " << OBJECT_FLAG_PERSISTENT_CONTAINER
+      << " WHERE id = " << containerID;
+    storage->exec(q);
+  }
+
+  // adds a track to the container, returns the reported grandparent;
+  // the storage moves file items into the containers of their directories
+  int addTrack(int parentID, const std::string& title, int* trackID = nullptr) {
+    auto item = std::make_shared<CdsItemExternalURL>(storage);
+    item->setParentID(parentID);
+    item->setTitle(title);
+    item->setClass(UPNP_DEFAULT_CLASS_MUSIC_TRACK);
+    item->setLocation("http://localhost/" + title + ".mp3");
+    item->setMimeType("audio/mpeg");
+    int changedContainer;
+    int changedGrandparent;
+    storage->addObject(item, &changedContainer, &changedGrandparent);
+    if (trackID != nullptr)
+      *trackID = item->getID();
+    return changedGrandparent;
+  }
+
+  int childCount(int containerID) {
+    return std::static_pointer_cast<Storage>(storage)->getChildCount(containerID);
+  }
+
+  void remove(int objectID) {
+    storage->removeObject(objectID, false);
+  }
+
+  std::shared_ptr<Sqlite3Storage> storage;
+};
+
+TEST_F(ChildStateTest, ContainerEmptiedByRemovalReportsItsParentAgain) {
+  int artist = addContainer("/Music");
+  int album = addContainer("/Music/Album");
+  makePersistent(album);
+
+  int firstID;
+  int secondID;
+  EXPECT_EQ(addTrack(album, "First", &firstID), artist);
+  EXPECT_EQ(addTrack(album, "Second", &secondID), INVALID_OBJECT_ID);
+  remove(firstID);
+  EXPECT_EQ(childCount(album), 1);
+
+  // the removal of the last child leaves the album empty
+  remove(secondID);
+  EXPECT_EQ(childCount(album), 0);
+
+  EXPECT_EQ(addTrack(album, "Third"), artist);
+  EXPECT_EQ(childCount(album), 1);
+}
+
+TEST_F(ChildStateTest, RemovalKeepsOtherContainersNonEmpty) {
+  addContainer("/Music");
+  int first = addContainer("/Music/First");
+  int second = addContainer("/Music/Second");
+  addTrack(first, "A");
+  addTrack(second, "B");
+  int trackID;
+  addTrack(second, "C", &trackID);
+
+  remove(trackID);
+  EXPECT_EQ(addTrack(first, "D"), INVALID_OBJECT_ID);
+  EXPECT_EQ(addTrack(second, "E"), INVALID_OBJECT_ID);
+  EXPECT_EQ(childCount(first), 2);
+  EXPECT_EQ(childCount(second), 2);
+}
+
+TEST_F(ChildStateTest, RemovedContainersAreNotReusedAsEmpty) {
+  addContainer("/Music");
+  int album = addContainer("/Music/Album");
+  int trackID;
+  addTrack(album, "A", &trackID);
+
+  // the emptied album goes away, a new one is created in its place
+  remove(trackID);
+  EXPECT_THROW(storage->loadObject(album), ObjectNotFoundException);
+  int newAlbum = addContainer("/Music/Album");
+  EXPECT_NE(newAlbum, album);
+  int newArtist = storage->loadObject(newAlbum)->getParentID();
+  EXPECT_EQ(addTrack(newAlbum, "B"), newArtist);
+  EXPECT_EQ(childCount(newAlbum), 1);
+}
+
+#endif // HAVE_SQLITE3
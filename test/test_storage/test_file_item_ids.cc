@@ -0,0 +1,65 @@
+#ifdef HAVE_SQLITE3
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+
+#include "cds_objects.h"
+#include "cds_resource.h"
+#include "metadata/metadata_handler.h"
+#include "storage/sqlite3/sqlite3_storage.h"
+#include "storage_test_fixture.h"
+
+using namespace ::testing;
+
+class FileItemIDsTest : public StorageTestFixture {
+ public:
+  virtual void SetUp() override {
+    StorageTestFixture::SetUp();
+    storage = std::make_shared<Sqlite3Storage>(createConfig(
+        "<storage><sqlite3 enabled=\"yes\"><database-file>gerbera.db</database-file>"
+        "<backup enabled=\"no\"/></sqlite3></storage>"), nullptr);
+    std::static_pointer_cast<Storage>(storage)->init();
+  }
+
+  virtual void TearDown() override {
+    storage->shutdown();
+    StorageTestFixture::TearDown();
+  }
+
+  int addItem(const std::string& location, const std::string& mimeType, int refID = INVALID_OBJECT_ID) {
+    auto item = std::make_shared<CdsItem>(storage);
+    item->setParentID(CDS_ID_ROOT);
+    item->setTitle(location);
+    item->setClass(UPNP_DEFAULT_CLASS_ITEM);
+    item->setLocation(location);
+    item->setMimeType(mimeType);
+    auto resource = std::make_shared<CdsResource>(CH_DEFAULT);
+    resource->addAttribute("protocolInfo", "http-get:*:" + mimeType + ":*");
+    item->addResource(resource);
+    if (refID != INVALID_OBJECT_ID) {
+      item->setVirtual(true);
+      item->setRefID(refID);
+      item->setFlag(OBJECT_FLAG_USE_RESOURCE_REF);
+    }
+    int changedContainer;
+    storage->addObject(item, &changedContainer);
+    return item->getID();
+  }
+
+  std::shared_ptr<Sqlite3Storage> storage;
+};
+
+TEST_F(FileItemIDsTest, ReturnsFilesOfTheMimeTypeByLocation) {
+  int second = addItem("/video/b.mkv", "video/x-matroska");
+  int first = addItem("/video/a.mp4", "video/mp4");
+  addItem("/music/a.mp3", "audio/mpeg");
+  addItem("/video/a.mp4", "video/mp4", first);
+
+  auto ids = storage->getFileItemIDs("video/");
+
+  EXPECT_EQ(*ids, std::vector<int>({ first, second }));
+}
+
+#endif // HAVE_SQLITE3
@@ -0,0 +1,61 @@
+#ifdef HAVE_SQLITE3
+
+#include <memory>
+#include <string>
+#include "gtest/gtest.h"
+
+#include "cds_objects.h"
+#include "storage/sqlite3/sqlite3_storage.h"
+#include "storage_test_fixture.h"
+
+using namespace ::testing;
+
+class MetadataColumnsTest : public StorageTestFixture {
+ public:
+  virtual void SetUp() override {
+    StorageTestFixture::SetUp();
+    storage = std::make_shared<Sqlite3Storage>(createConfig(
+        "<storage><sqlite3 enabled=\"yes\"><database-file>gerbera.db</database-file>"
+        "<backup enabled=\"no\"/></sqlite3></storage>"), nullptr);
+    std::static_pointer_cast<Storage>(storage)->init();
+  }
+
+  virtual void TearDown() override {
+    storage->shutdown();
+    StorageTestFixture::TearDown();
+  }
+
+  // adds an item with the given artist and returns the artist column
+  std::string storedArtist(const std::string& artist) {
+    auto item = std::make_shared<CdsItem>(storage);
+    item->setParentID(CDS_ID_ROOT);
+    item->setTitle("Track");
+    item->setClass(UPNP_DEFAULT_CLASS_MUSIC_TRACK);
+    item->setLocation("/music/track.mp3");
+    item->setMimeType("audio/mpeg");
+    item->setMetadata("upnp:artist", artist);
+    int changedContainer;
+    storage->addObject(item, &changedContainer);
+
+    zmm::Ref<SQLResult> res = storage->select("SELECT upnp_artist FROM mt_cds_object WHERE id=" + std::to_string(item->getID()));
+    std::unique_ptr<SQLRow> row = res->nextRow();
+    return row->col(0);
+  }
+
+  std::shared_ptr<Sqlite3Storage> storage;
+};
+
+TEST_F(MetadataColumnsTest, KeepsShortValues) {
+  EXPECT_EQ(storedArtist("Pavement"), "Pavement");
+}
+
+TEST_F(MetadataColumnsTest, CutsLongValuesAtCharacters) {
+  std::string artist;
+  for (int i = 0; i < 300; i++)
+    artist += "\xc3\xa4";
+  std::string stored = storedArtist(artist);
+  EXPECT_EQ(stored.length(), 2u * 255);
+  EXPECT_EQ(stored, artist.substr(0, stored.length()));
+}
+
+#endif // HAVE_SQLITE3
@@ -0,0 +1,111 @@
+#ifdef HAVE_SQLITE3
+
+#include <atomic>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "gtest/gtest.h"
+
+#include "cds_objects.h"
+#include "storage/sqlite3/sqlite3_storage.h"
+#include "storage_test_fixture.h"
+
+using namespace ::testing;
+
+class MetadataValuesTest : public StorageTestFixture {
+ public:
+  virtual void SetUp() override {
+    StorageTestFixture::SetUp();
+    storage = std::make_shared<Sqlite3Storage>(createConfig(
+        "<storage><sqlite3 enabled=\"yes\"><database-file>gerbera.db</database-file>"
+        "<backup enabled=\"no\"/></sqlite3></storage>"), nullptr);
+    std::static_pointer_cast<Storage>(storage)->init();
+  }
+
+  virtual void TearDown() override {
+    storage->shutdown();
+    StorageTestFixture::TearDown();
+  }
+
+  std::shared_ptr<CdsItem> addTrack(const std::string& artist) {
+    auto item = std::make_shared<CdsItem>(storage);
+    item->setParentID(CDS_ID_ROOT);
+    item->setTitle("Track");
+    item->setClass(UPNP_DEFAULT_CLASS_MUSIC_TRACK);
+    item->setLocation("/music/" + artist + ".mp3");
+    item->setMimeType("audio/mpeg");
+    item->setMetadata("upnp:artist", artist);
+    int changedContainer;
+    storage->addObject(item, &changedContainer);
+    return item;
+  }
+
+  int count(const std::string& query) {
+    zmm::Ref<SQLResult> res = storage->select(query);
+    std::unique_ptr<SQLRow> row = res->nextRow();
+    return std::stoi(row->col(0));
+  }
+
+  int valueCount(const std::string& value) {
+    return count("SELECT COUNT(*) FROM mt_metadata_value WHERE value='" + value + "'");
+  }
+
+  int danglingRows() {
+    return count("SELECT COUNT(*) FROM mt_metadata m WHERE NOT EXISTS "
+                 "(SELECT 1 FROM mt_metadata_value v WHERE v.id=m.value_id)");
+  }
+
+  void runMaintenance() {
+    while (storage->maintenanceStep())
+      ;
+  }
+
+  std::shared_ptr<Sqlite3Storage> storage;
+};
+
+TEST_F(MetadataValuesTest, PrunesValuesNoObjectUses) {
+  auto item = addTrack("Pavement");
+  item->setMetadata("upnp:artist", "Sebadoh");
+  int changedContainer;
+  storage->updateObject(item, &changedContainer);
+
+  runMaintenance();
+
+  EXPECT_EQ(valueCount("Pavement"), 0);
+  EXPECT_EQ(valueCount("Sebadoh"), 1);
+}
+
+TEST_F(MetadataValuesTest, KeepsValuesWrittenDuringMaintenance) {
+  std::atomic<bool> done(false);
+  std::thread maintenance([&]() {
+    while (!done)
+      storage->maintenanceStep();
+  });
+  // every value is unused for a moment before a new track takes it up again
+  int changedContainer;
+  for (int i = 0; i < 300; i++) {
+    auto item = addTrack("Artist" + std::to_string(i));
+    item->setMetadata("upnp:artist", "Various");
+    storage->updateObject(item, &changedContainer);
+    addTrack("Artist" + std::to_string(i));
+  }
+  done = true;
+  maintenance.join();
+
+  EXPECT_EQ(danglingRows(), 0);
+}
+
+TEST_F(MetadataValuesTest, ValuesAreUnique) {
+  addTrack("Pavement");
+  addTrack("Pavement");
+  EXPECT_EQ(valueCount("Pavement"), 1);
+
+  // a second writer can not add the value again
+  std::ostringstream q;
+  q << "INSERT INTO mt_metadata_value (value_hash, value) SELECT value_hash, value FROM mt_metadata_value WHERE value='Pavement'";
+  EXPECT_THROW(storage->exec(q), Exception);
+  EXPECT_EQ(valueCount("Pavement"), 1);
+}
+
+#endif // HAVE_SQLITE3
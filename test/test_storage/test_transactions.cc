@@ -0,0 +1,113 @@
+#ifdef HAVE_SQLITE3
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include "gtest/gtest.h"
+
+#include "cds_objects.h"
+#include "storage/sqlite3/sqlite3_storage.h"
+#include "storage_test_fixture.h"
+
+using namespace ::testing;
+
+class TransactionsTest : public StorageTestFixture {
+ public:
+  virtual void SetUp() override {
+    StorageTestFixture::SetUp();
+    storage = std::make_shared<Sqlite3Storage>(createConfig(
+        "<storage><sqlite3 enabled=\"yes\"><database-file>gerbera.db</database-file>"
+        "<backup enabled=\"no\"/></sqlite3></storage>"), nullptr);
+    std::static_pointer_cast<Storage>(storage)->init();
+  }
+
+  virtual void TearDown() override {
+    storage->shutdown();
+    StorageTestFixture::TearDown();
+  }
+
+  void addTrack(const std::string& artist) {
+    auto item = std::make_shared<CdsItem>(storage);
+    item->setParentID(CDS_ID_ROOT);
+    item->setTitle("Track");
+    item->setClass(UPNP_DEFAULT_CLASS_MUSIC_TRACK);
+    item->setLocation("/music/" + artist + ".mp3");
+    item->setMimeType("audio/mpeg");
+    item->setMetadata("upnp:artist", artist);
+    int changedContainer;
+    storage->addObject(item, &changedContainer);
+  }
+
+  int count(const std::string& query) {
+    zmm::Ref<SQLResult> res = storage->select(query);
+    std::unique_ptr<SQLRow> row = res->nextRow();
+    return std::stoi(row->col(0));
+  }
+
+  int trackCount() {
+    return count("SELECT COUNT(*) FROM mt_cds_object WHERE dc_title='Track'");
+  }
+
+  std::shared_ptr<Sqlite3Storage> storage;
+};
+
+TEST_F(TransactionsTest, RollbackDiscardsWrites) {
+  storage->beginTransaction();
+  addTrack("Pavement");
+  EXPECT_EQ(trackCount(), 1);
+  storage->rollbackTransaction();
+
+  EXPECT_EQ(trackCount(), 0);
+}
+
+TEST_F(TransactionsTest, InnerRollbackRollsBackWholeTransaction) {
+  storage->beginTransaction();
+  addTrack("Pavement");
+  storage->beginTransaction();
+  addTrack("Sebadoh");
+  storage->rollbackTransaction();
+  storage->commitTransaction();
+
+  EXPECT_EQ(trackCount(), 0);
+}
+
+TEST_F(TransactionsTest, CachedIDsOfRolledBackRowsAreNotUsed) {
+  storage->beginTransaction();
+  addTrack("Pavement");
+  storage->rollbackTransaction();
+
+  // the value and the IDs taken inside the transaction are gone
+  addTrack("Pavement");
+  EXPECT_EQ(trackCount(), 1);
+  EXPECT_EQ(count("SELECT COUNT(*) FROM mt_metadata m WHERE NOT EXISTS "
+                  "(SELECT 1 FROM mt_metadata_value v WHERE v.id=m.value_id)"), 0);
+}
+
+TEST_F(TransactionsTest, ReservedIDsAreRolledBackWithTheTransaction) {
+  std::string nextID = "SELECT next_id FROM mt_sequence WHERE name='object'";
+  int before = count(nextID);
+  storage->beginTransaction();
+  addTrack("Pavement");
+  EXPECT_GT(count(nextID), before);
+  storage->rollbackTransaction();
+
+  EXPECT_EQ(count(nextID), before);
+}
+
+TEST_F(TransactionsTest, OtherThreadsWaitForTheTransaction) {
+  storage->beginTransaction();
+  addTrack("Pavement");
+
+  std::atomic<int> seen(-1);
+  std::thread reader([&]() { seen = trackCount(); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  EXPECT_EQ(seen, -1);
+
+  storage->rollbackTransaction();
+  reader.join();
+  EXPECT_EQ(seen, 0);
+}
+
+#endif // HAVE_SQLITE3
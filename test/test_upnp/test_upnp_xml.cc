@@ -65,7 +65,7 @@ TEST_F(UpnpXmlTest, CreatesDcCreatorElement) {
 }
 
 TEST_F(UpnpXmlTest, CreatesSecCaptionInfoElement) {
-  zmm::Ref<mxml::Element> result = subject->renderCaptionInfo("file.srt");
+  zmm::Ref<mxml::Element> result = subject->renderCaptionInfo("file.srt", "srt");
 
   EXPECT_NE(result, nullptr);
   EXPECT_STREQ(result->getText().c_str(), "file.srt");
@@ -0,0 +1,214 @@
+/*GRB*
+
+Gerbera - https://gerbera.io/
+
+    http_client.cc - this file is part of Gerbera.
+
+    Copyright (C) 2016-2019 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file http_client.cc
+
+#include "http_client.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <netdb.h>
+#include <sstream>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace loadgen {
+
+namespace {
+
+class Socket {
+public:
+    explicit Socket(int fd)
+        : fd(fd)
+    {
+    }
+    ~Socket()
+    {
+        if (fd >= 0)
+            close(fd);
+    }
+    int get() const { return fd; }
+
+protected:
+    int fd;
+};
+
+int connectTo(const std::string& host, int port, int timeoutSeconds)
+{
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    struct addrinfo* res = nullptr;
+    int ret = getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &res);
+    if (ret != 0)
+        throw std::runtime_error("getaddrinfo " + host + ": " + gai_strerror(ret));
+
+    int fd = -1;
+    for (struct addrinfo* ai = res; ai != nullptr; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0)
+            continue;
+
+        struct timeval tv;
+        tv.tv_sec = timeoutSeconds;
+        tv.tv_usec = 0;
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0)
+            break;
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(res);
+
+    if (fd < 0)
+        throw std::runtime_error("connect to " + host + ":" + std::to_string(port) + " failed: " + strerror(errno));
+    return fd;
+}
+
+void sendAll(int fd, const std::string& data)
+{
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            throw std::runtime_error(std::string("send failed: ") + strerror(errno));
+        }
+        sent += n;
+    }
+}
+
+} // namespace
+
+HttpResponse httpRequest(const std::string& host, int port,
+    const std::string& method, const std::string& path,
+    const std::map<std::string, std::string>& headers,
+    const std::string& body, bool keepBody, int timeoutSeconds)
+{
+    Socket sock(connectTo(host, port, timeoutSeconds));
+
+    std::ostringstream req;
+    req << method << " " << path << " HTTP/1.1\r\n"
+        << "HOST: " << host << ":" << port << "\r\n"
+        << "Connection: close\r\n";
+    for (const auto& header : headers)
+        req << header.first << ": " << header.second << "\r\n";
+    if (!body.empty() || method == "POST")
+        req << "Content-Length: " << body.size() << "\r\n";
+    req << "\r\n"
+        << body;
+    sendAll(sock.get(), req.str());
+
+    // the connection is closed by the server after the response, so the
+    // body simply extends to EOF; chunked bodies are counted including framing
+    HttpResponse response;
+    std::string head;
+    bool inBody = false;
+    char buf[64 * 1024];
+    while (true) {
+        ssize_t n = recv(sock.get(), buf, sizeof(buf), 0);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            throw std::runtime_error(std::string("recv failed: ") + strerror(errno));
+        }
+        if (n == 0)
+            break;
+
+        if (inBody) {
+            response.bodyLength += n;
+            if (keepBody)
+                response.body.append(buf, n);
+            continue;
+        }
+
+        head.append(buf, n);
+        size_t end = head.find("\r\n\r\n");
+        if (end == std::string::npos)
+            continue;
+
+        inBody = true;
+        response.bodyLength = head.size() - end - 4;
+        if (keepBody)
+            response.body = head.substr(end + 4);
+        head.resize(end);
+    }
+
+    if (!inBody)
+        throw std::runtime_error("incomplete HTTP response for " + path);
+
+    std::istringstream lines(head);
+    std::string line;
+    std::getline(lines, line);
+    size_t sp = line.find(' ');
+    if (sp == std::string::npos)
+        throw std::runtime_error("malformed status line: " + line);
+    response.status = std::atoi(line.c_str() + sp + 1);
+
+    while (std::getline(lines, line)) {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        size_t colon = line.find(':');
+        if (colon == std::string::npos)
+            continue;
+        std::string name = line.substr(0, colon);
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        size_t valueStart = line.find_first_not_of(' ', colon + 1);
+        response.headers[name] = valueStart == std::string::npos ? "" : line.substr(valueStart);
+    }
+
+    return response;
+}
+
+bool splitUrl(const std::string& url, std::string& host, int& port, std::string& path)
+{
+    const std::string scheme = "http://";
+    if (url.compare(0, scheme.size(), scheme) != 0)
+        return false;
+
+    size_t hostStart = scheme.size();
+    size_t pathStart = url.find('/', hostStart);
+    std::string hostPort = url.substr(hostStart, pathStart == std::string::npos ? std::string::npos : pathStart - hostStart);
+    path = pathStart == std::string::npos ? "/" : url.substr(pathStart);
+
+    port = 80;
+    size_t colon = hostPort.rfind(':');
+    if (colon != std::string::npos && hostPort.find(']', colon) == std::string::npos) {
+        port = std::atoi(hostPort.c_str() + colon + 1);
+        hostPort.resize(colon);
+    }
+    if (hostPort.size() > 2 && hostPort.front() == '[' && hostPort.back() == ']')
+        hostPort = hostPort.substr(1, hostPort.size() - 2);
+    host = hostPort;
+    return !host.empty();
+}
+
+} // namespace loadgen
@@ -0,0 +1,57 @@
+/*GRB*
+
+Gerbera - https://gerbera.io/
+
+    http_client.h - this file is part of Gerbera.
+
+    Copyright (C) 2016-2019 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file http_client.h
+/// \brief Minimal blocking HTTP/1.1 client used by the load generator.
+#ifndef __LOADGEN_HTTP_CLIENT_H__
+#define __LOADGEN_HTTP_CLIENT_H__
+
+#include <map>
+#include <string>
+
+namespace loadgen {
+
+struct HttpResponse {
+    int status = 0;
+    std::map<std::string, std::string> headers;
+    std::string body;
+    /// \brief Number of body bytes received, also when the body is discarded.
+    size_t bodyLength = 0;
+};
+
+/// \brief Sends one request over a fresh connection and reads the complete response.
+///
+/// Header names in the response are lower cased. Throws std::runtime_error
+/// on connection or protocol errors.
+/// \param keepBody if false the body is only counted, useful for media fetches.
+HttpResponse httpRequest(const std::string& host, int port,
+    const std::string& method, const std::string& path,
+    const std::map<std::string, std::string>& headers,
+    const std::string& body = "", bool keepBody = true, int timeoutSeconds = 30);
+
+/// \brief Splits an absolute http:// URL into host, port and path.
+bool splitUrl(const std::string& url, std::string& host, int& port, std::string& path);
+
+} // namespace loadgen
+
+#endif // __LOADGEN_HTTP_CLIENT_H__
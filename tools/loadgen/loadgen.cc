@@ -0,0 +1,573 @@
+/*GRB*
+
+Gerbera - https://gerbera.io/
+
+    loadgen.cc - this file is part of Gerbera.
+
+    Copyright (C) 2016-2019 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file loadgen.cc
+/// \brief Emulates a number of UPnP control points against a running server.
+///
+/// Every client thread behaves like a renderer UI: it pages through the
+/// ContentDirectory, descends into containers, searches, asks for protocol
+/// info, subscribes to CDS events and fetches byte ranges of the media it
+/// found. Latencies are collected per operation and reported as
+/// percentiles when the run is over.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <regex>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "contrib/cxxopts.hpp"
+#include "http_client.h"
+
+using namespace loadgen;
+
+#define CDS_SERVICE_TYPE "urn:schemas-upnp-org:service:ContentDirectory:1"
+#define CM_SERVICE_TYPE "urn:schemas-upnp-org:service:ConnectionManager:1"
+#define CDS_CONTROL_URL "/upnp/control/cds"
+#define CDS_EVENT_URL "/upnp/event/cds"
+#define CM_CONTROL_URL "/upnp/control/cm"
+
+// upper bound of remembered containers and media urls
+#define POOL_SIZE 10000
+
+enum operation_t {
+    OP_BROWSE = 0,
+    OP_SEARCH,
+    OP_PROTOCOL_INFO,
+    OP_SUBSCRIBE,
+    OP_FETCH,
+    OP_MAX
+};
+
+static const char* operationNames[OP_MAX] = { "browse", "search", "protocolinfo", "subscribe", "fetch" };
+
+struct Settings {
+    std::string host;
+    int port;
+    int clients;
+    int duration;
+    int pageSize;
+    int fetchSize;
+    int thinkTime;
+    int timeout;
+    double pageThrough;
+    int weights[OP_MAX];
+};
+
+struct MediaRef {
+    std::string url;
+    long long size;
+};
+
+/// \brief Containers and media discovered by all clients.
+class Pool {
+public:
+    void addContainer(const std::string& id)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (containers.size() < POOL_SIZE)
+            containers.insert(id);
+    }
+
+    void addMedia(const MediaRef& media)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (media.size >= 0 && this->media.size() < POOL_SIZE && urls.insert(media.url).second)
+            this->media.push_back(media);
+    }
+
+    bool randomMedia(std::mt19937& rng, MediaRef& out)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (media.empty())
+            return false;
+        out = media[std::uniform_int_distribution<size_t>(0, media.size() - 1)(rng)];
+        return true;
+    }
+
+    size_t containerCount()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return containers.size();
+    }
+
+    size_t mediaCount()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return media.size();
+    }
+
+protected:
+    std::mutex mutex;
+    std::unordered_set<std::string> containers;
+    std::unordered_set<std::string> urls;
+    std::vector<MediaRef> media;
+};
+
+struct OpStats {
+    std::vector<long long> latencies; // microseconds
+    size_t errors = 0;
+    size_t bytes = 0;
+};
+
+static std::atomic_bool stopFlag { false };
+
+static std::string xmlEscape(const std::string& str)
+{
+    std::string out;
+    for (char c : str) {
+        switch (c) {
+        case '<':
+            out += "&lt;";
+            break;
+        case '>':
+            out += "&gt;";
+            break;
+        case '&':
+            out += "&amp;";
+            break;
+        case '"':
+            out += "&quot;";
+            break;
+        default:
+            out += c;
+        }
+    }
+    return out;
+}
+
+static std::string xmlUnescape(const std::string& str)
+{
+    static const std::pair<const char*, char> entities[] = {
+        { "&lt;", '<' }, { "&gt;", '>' }, { "&quot;", '"' }, { "&apos;", '\'' }, { "&amp;", '&' }
+    };
+    std::string out;
+    out.reserve(str.size());
+    for (size_t i = 0; i < str.size(); i++) {
+        if (str[i] == '&') {
+            bool found = false;
+            for (const auto& entity : entities) {
+                size_t len = strlen(entity.first);
+                if (str.compare(i, len, entity.first) == 0) {
+                    out += entity.second;
+                    i += len - 1;
+                    found = true;
+                    break;
+                }
+            }
+            if (found)
+                continue;
+        }
+        out += str[i];
+    }
+    return out;
+}
+
+static std::string childText(const std::string& xml, const std::string& name)
+{
+    std::string open = "<" + name + ">";
+    size_t start = xml.find(open);
+    if (start == std::string::npos)
+        return "";
+    start += open.size();
+    size_t end = xml.find("</" + name + ">", start);
+    if (end == std::string::npos)
+        return "";
+    return xml.substr(start, end - start);
+}
+
+class ControlPoint {
+public:
+    ControlPoint(const Settings& settings, Pool& pool, unsigned int seed)
+        : settings(settings)
+        , pool(pool)
+        , rng(seed)
+        , stats(OP_MAX)
+    {
+        for (int i = 0; i < OP_MAX; i++)
+            totalWeight += settings.weights[i];
+    }
+
+    void run()
+    {
+        while (!stopFlag) {
+            operation_t op = pickOperation();
+            // there is nothing to fetch until browsing found media, the
+            // browse is counted as such to keep the fetch numbers clean
+            MediaRef media;
+            if (op == OP_FETCH && !pool.randomMedia(rng, media))
+                op = OP_BROWSE;
+            auto start = std::chrono::steady_clock::now();
+            try {
+                size_t bytes = perform(op, media);
+                auto elapsed = std::chrono::steady_clock::now() - start;
+                stats[op].latencies.push_back(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+                stats[op].bytes += bytes;
+            } catch (const std::exception& e) {
+                stats[op].errors++;
+                lastError = e.what();
+            }
+            if (settings.thinkTime > 0)
+                std::this_thread::sleep_for(std::chrono::milliseconds(settings.thinkTime));
+        }
+    }
+
+    const std::vector<OpStats>& getStats() const { return stats; }
+    const std::string& getLastError() const { return lastError; }
+
+protected:
+    const Settings& settings;
+    Pool& pool;
+    std::mt19937 rng;
+    std::vector<OpStats> stats;
+    std::string lastError;
+    int totalWeight = 0;
+
+    // browse position of this renderer
+    std::vector<std::string> path { "0" };
+    int page = 0;
+    int searchPage = 0;
+
+    operation_t pickOperation()
+    {
+        int r = std::uniform_int_distribution<int>(0, totalWeight - 1)(rng);
+        for (int i = 0; i < OP_MAX; i++) {
+            if (r < settings.weights[i])
+                return static_cast<operation_t>(i);
+            r -= settings.weights[i];
+        }
+        return OP_BROWSE;
+    }
+
+    size_t perform(operation_t op, const MediaRef& media)
+    {
+        switch (op) {
+        case OP_BROWSE:
+            return browse();
+        case OP_SEARCH:
+            return search();
+        case OP_PROTOCOL_INFO:
+            return protocolInfo();
+        case OP_SUBSCRIBE:
+            return subscribe();
+        case OP_FETCH:
+            return fetch(media);
+        default:
+            return 0;
+        }
+    }
+
+    HttpResponse soap(const char* controlUrl, const char* serviceType, const std::string& action,
+        const std::vector<std::pair<std::string, std::string>>& args)
+    {
+        std::string body = "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+                           "<s:Envelope xmlns:s=\"http://schemas.xmlsoap.org/soap/envelope/\" "
+                           "s:encodingStyle=\"http://schemas.xmlsoap.org/soap/encoding/\"><s:Body>"
+                           "<u:"
+            + action + " xmlns:u=\"" + serviceType + "\">";
+        for (const auto& arg : args)
+            body += "<" + arg.first + ">" + xmlEscape(arg.second) + "</" + arg.first + ">";
+        body += "</u:" + action + "></s:Body></s:Envelope>";
+
+        std::map<std::string, std::string> headers = {
+            { "CONTENT-TYPE", "text/xml; charset=\"utf-8\"" },
+            { "SOAPACTION", std::string("\"") + serviceType + "#" + action + "\"" },
+        };
+        auto response = httpRequest(settings.host, settings.port, "POST", controlUrl, headers, body, true, settings.timeout);
+        if (response.status != 200)
+            throw std::runtime_error(action + " returned HTTP " + std::to_string(response.status));
+        return response;
+    }
+
+    /// \brief Collects containers and media from a DIDL-Lite result.
+    std::vector<std::string> digest(const std::string& didl)
+    {
+        static const std::regex containerRe("<container[^>]* id=\"([^\"]+)\"");
+        static const std::regex resRe("<res([^>]*)>([^<]+)</res>");
+        static const std::regex sizeRe("size=\"([0-9]+)\"");
+
+        std::vector<std::string> children;
+        for (auto it = std::sregex_iterator(didl.begin(), didl.end(), containerRe); it != std::sregex_iterator(); ++it) {
+            children.push_back((*it)[1]);
+            pool.addContainer((*it)[1]);
+        }
+        for (auto it = std::sregex_iterator(didl.begin(), didl.end(), resRe); it != std::sregex_iterator(); ++it) {
+            std::string attrs = (*it)[1];
+            std::smatch size;
+            MediaRef media { xmlUnescape((*it)[2]), -1 };
+            if (std::regex_search(attrs, size, sizeRe))
+                media.size = std::stoll(size[1]);
+            pool.addMedia(media);
+        }
+        return children;
+    }
+
+    /// \brief Pages through the current container or moves through the tree
+    /// like a user would.
+    size_t browse()
+    {
+        std::uniform_real_distribution<double> chance(0.0, 1.0);
+
+        if (chance(rng) < 0.1) {
+            auto response = soap(CDS_CONTROL_URL, CDS_SERVICE_TYPE, "Browse",
+                { { "ObjectID", path.back() }, { "BrowseFlag", "BrowseMetadata" }, { "Filter", "*" },
+                    { "StartingIndex", "0" }, { "RequestedCount", "0" }, { "SortCriteria", "" } });
+            return response.bodyLength;
+        }
+
+        auto response = soap(CDS_CONTROL_URL, CDS_SERVICE_TYPE, "Browse",
+            { { "ObjectID", path.back() }, { "BrowseFlag", "BrowseDirectChildren" }, { "Filter", "*" },
+                { "StartingIndex", std::to_string(page * settings.pageSize) },
+                { "RequestedCount", std::to_string(settings.pageSize) }, { "SortCriteria", "" } });
+
+        auto children = digest(xmlUnescape(childText(response.body, "Result")));
+        int total = std::atoi(childText(response.body, "TotalMatches").c_str());
+
+        if ((page + 1) * settings.pageSize < total && chance(rng) < settings.pageThrough) {
+            page++;
+        } else if (!children.empty() && chance(rng) < 0.7) {
+            path.push_back(children[std::uniform_int_distribution<size_t>(0, children.size() - 1)(rng)]);
+            page = 0;
+        } else {
+            // back up one level, or start over at the root
+            if (path.size() > 1 && chance(rng) < 0.7)
+                path.pop_back();
+            else
+                path.resize(1);
+            page = 0;
+        }
+        return response.bodyLength;
+    }
+
+    size_t search()
+    {
+        static const char* criteria[] = {
+            "upnp:class derivedfrom \"object.item.audioItem\"",
+            "upnp:class derivedfrom \"object.item.videoItem\"",
+            "upnp:class derivedfrom \"object.item.imageItem\"",
+            "dc:title contains \"a\"",
+            "upnp:class = \"object.container.album.musicAlbum\" and dc:title contains \"the\"",
+        };
+        std::string criterion = criteria[std::uniform_int_distribution<size_t>(0, sizeof(criteria) / sizeof(criteria[0]) - 1)(rng)];
+
+        auto response = soap(CDS_CONTROL_URL, CDS_SERVICE_TYPE, "Search",
+            { { "ContainerID", "0" }, { "SearchCriteria", criterion }, { "Filter", "*" },
+                { "StartingIndex", std::to_string(searchPage * settings.pageSize) },
+                { "RequestedCount", std::to_string(settings.pageSize) }, { "SortCriteria", "" } });
+
+        digest(xmlUnescape(childText(response.body, "Result")));
+        int total = std::atoi(childText(response.body, "TotalMatches").c_str());
+        searchPage = ((searchPage + 1) * settings.pageSize < total && searchPage < 4) ? searchPage + 1 : 0;
+        return response.bodyLength;
+    }
+
+    size_t protocolInfo()
+    {
+        return soap(CM_CONTROL_URL, CM_SERVICE_TYPE, "GetProtocolInfo", {}).bodyLength;
+    }
+
+    size_t subscribe()
+    {
+        // the callback points to the discard port, we are only interested in
+        // the server side cost of subscription handling
+        auto response = httpRequest(settings.host, settings.port, "SUBSCRIBE", CDS_EVENT_URL,
+            { { "CALLBACK", "<http://127.0.0.1:9/>" }, { "NT", "upnp:event" }, { "TIMEOUT", "Second-300" } },
+            "", true, settings.timeout);
+        if (response.status != 200)
+            throw std::runtime_error("SUBSCRIBE returned HTTP " + std::to_string(response.status));
+
+        std::string sid = response.headers["sid"];
+        if (!sid.empty()) {
+            httpRequest(settings.host, settings.port, "UNSUBSCRIBE", CDS_EVENT_URL,
+                { { "SID", sid } }, "", true, settings.timeout);
+        }
+        return response.bodyLength;
+    }
+
+    size_t fetch(const MediaRef& media)
+    {
+        std::string host;
+        int port;
+        std::string urlPath;
+        if (!splitUrl(media.url, host, port, urlPath))
+            throw std::runtime_error("unsupported media url " + media.url);
+
+        // renderers usually probe the start of the file and then seek
+        long long offset = 0;
+        if (media.size > settings.fetchSize && std::uniform_int_distribution<int>(0, 1)(rng) == 1)
+            offset = std::uniform_int_distribution<long long>(0, media.size - settings.fetchSize)(rng);
+        std::string range = "bytes=" + std::to_string(offset) + "-" + std::to_string(offset + settings.fetchSize - 1);
+
+        auto response = httpRequest(host, port, "GET", urlPath, { { "Range", range } }, "", false, settings.timeout);
+        if (response.status != 200 && response.status != 206)
+            throw std::runtime_error("GET " + urlPath + " returned HTTP " + std::to_string(response.status));
+        return response.bodyLength;
+    }
+};
+
+static long long percentile(const std::vector<long long>& sorted, double p)
+{
+    if (sorted.empty())
+        return 0;
+    size_t idx = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+static bool parseMix(const std::string& mix, int* weights)
+{
+    std::fill(weights, weights + OP_MAX, 0);
+    std::istringstream in(mix);
+    std::string entry;
+    int total = 0;
+    while (std::getline(in, entry, ',')) {
+        size_t eq = entry.find('=');
+        if (eq == std::string::npos)
+            return false;
+        std::string name = entry.substr(0, eq);
+        int weight = std::atoi(entry.c_str() + eq + 1);
+        auto it = std::find_if(operationNames, operationNames + OP_MAX, [&](const char* n) { return name == n; });
+        if (it == operationNames + OP_MAX || weight < 0)
+            return false;
+        weights[it - operationNames] = weight;
+        total += weight;
+    }
+    return total > 0;
+}
+
+int main(int argc, char** argv)
+{
+    cxxopts::Options options("gerbera-loadgen", "Emulates many UPnP control points against a running Gerbera");
+
+    options.add_options()
+    ("h,host", "Server address", cxxopts::value<std::string>()->default_value("127.0.0.1"))
+    ("p,port", "Server port", cxxopts::value<int>()->default_value("49152"))
+    ("c,clients", "Number of emulated control points", cxxopts::value<int>()->default_value("50"))
+    ("d,duration", "Run time in seconds", cxxopts::value<int>()->default_value("30"))
+    ("m,mix", "Operation weights", cxxopts::value<std::string>()->default_value("browse=60,search=10,protocolinfo=5,subscribe=5,fetch=20"))
+    ("page-size", "RequestedCount of Browse and Search", cxxopts::value<int>()->default_value("25"))
+    ("page-through", "Probability to request the next page of a container", cxxopts::value<double>()->default_value("0.5"))
+    ("fetch-size", "Bytes per ranged media request", cxxopts::value<int>()->default_value("1048576"))
+    ("think-time", "Pause between requests of one client in ms", cxxopts::value<int>()->default_value("0"))
+    ("timeout", "Socket timeout in seconds", cxxopts::value<int>()->default_value("30"))
+    ("seed", "Random seed", cxxopts::value<unsigned int>()->default_value("1"))
+    ("help", "Print this help and exit");
+
+    Settings settings;
+    unsigned int seed;
+    try {
+        auto opts = options.parse(argc, argv);
+        if (opts.count("help") > 0) {
+            std::cout << options.help() << std::endl;
+            return EXIT_SUCCESS;
+        }
+        settings.host = opts["host"].as<std::string>();
+        settings.port = opts["port"].as<int>();
+        settings.clients = opts["clients"].as<int>();
+        settings.duration = opts["duration"].as<int>();
+        settings.pageSize = opts["page-size"].as<int>();
+        settings.pageThrough = opts["page-through"].as<double>();
+        settings.fetchSize = opts["fetch-size"].as<int>();
+        settings.thinkTime = opts["think-time"].as<int>();
+        settings.timeout = opts["timeout"].as<int>();
+        seed = opts["seed"].as<unsigned int>();
+        if (!parseMix(opts["mix"].as<std::string>(), settings.weights)) {
+            std::cerr << "Invalid operation mix, expected e.g. browse=60,fetch=40" << std::endl;
+            return EXIT_FAILURE;
+        }
+    } catch (const cxxopts::OptionException& e) {
+        std::cerr << "Failed to parse arguments: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (settings.clients < 1 || settings.pageSize < 1 || settings.fetchSize < 1) {
+        std::cerr << "clients, page-size and fetch-size must be positive" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    Pool pool;
+    std::vector<std::unique_ptr<ControlPoint>> clients;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < settings.clients; i++)
+        clients.push_back(std::make_unique<ControlPoint>(settings, pool, seed + i));
+
+    printf("Running %d control points against %s:%d for %d seconds\n",
+        settings.clients, settings.host.c_str(), settings.port, settings.duration);
+
+    auto start = std::chrono::steady_clock::now();
+    for (auto& client : clients)
+        threads.emplace_back(&ControlPoint::run, client.get());
+
+    std::this_thread::sleep_for(std::chrono::seconds(settings.duration));
+    stopFlag = true;
+    for (auto& thread : threads)
+        thread.join();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("\n%-13s %9s %7s %9s %9s %9s %9s %9s %10s\n",
+        "operation", "count", "errors", "ops/s", "p50 ms", "p90 ms", "p99 ms", "max ms", "MB/s");
+    size_t totalOps = 0;
+    size_t totalErrors = 0;
+    for (int op = 0; op < OP_MAX; op++) {
+        OpStats merged;
+        for (const auto& client : clients) {
+            const auto& s = client->getStats()[op];
+            merged.latencies.insert(merged.latencies.end(), s.latencies.begin(), s.latencies.end());
+            merged.errors += s.errors;
+            merged.bytes += s.bytes;
+        }
+        if (merged.latencies.empty() && merged.errors == 0)
+            continue;
+        std::sort(merged.latencies.begin(), merged.latencies.end());
+        totalOps += merged.latencies.size();
+        totalErrors += merged.errors;
+
+        printf("%-13s %9zu %7zu %9.1f %9.2f %9.2f %9.2f %9.2f %10.2f\n",
+            operationNames[op], merged.latencies.size(), merged.errors,
+            merged.latencies.size() / elapsed,
+            percentile(merged.latencies, 0.50) / 1000.0,
+            percentile(merged.latencies, 0.90) / 1000.0,
+            percentile(merged.latencies, 0.99) / 1000.0,
+            merged.latencies.empty() ? 0.0 : merged.latencies.back() / 1000.0,
+            merged.bytes / elapsed / (1024.0 * 1024.0));
+    }
+    printf("\n%zu requests, %zu errors, %.1f requests/s; discovered %zu containers and %zu media resources\n",
+        totalOps, totalErrors, totalOps / elapsed, pool.containerCount(), pool.mediaCount());
+
+    for (const auto& client : clients) {
+        if (!client->getLastError().empty()) {
+            printf("last error: %s\n", client->getLastError().c_str());
+            break;
+        }
+    }
+
+    return totalErrors > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
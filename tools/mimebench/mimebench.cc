@@ -0,0 +1,179 @@
+/*GRB*
+
+Gerbera - https://gerbera.io/
+
+    mimebench.cc - this file is part of Gerbera.
+
+    Copyright (C) 2016-2019 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file mimebench.cc
+/// \brief Measures MIME detection throughput of the import.
+///
+/// Every file below the given directory is detected with each method in
+/// turn: loading the magic database per file as the import used to, a
+/// kept session looking at the file, a kept session looking at the head
+/// of the file, and a second pass served from the cache.
+
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <iostream>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <vector>
+
+#include "contrib/cxxopts.hpp"
+#include "util/mime_detector.h"
+
+// the detector logs through the server logger, which is not linked here
+FILE* LOG_FILE = stderr;
+void _log_warning(const char* format, ...)
+{
+    va_list ap;
+    va_start(ap, format);
+    vfprintf(LOG_FILE, format, ap);
+    va_end(ap);
+}
+
+struct File {
+    std::string path;
+    struct stat statbuf;
+};
+
+static void collect(const std::string& dir, std::vector<File>& files, size_t limit)
+{
+    DIR* d = opendir(dir.c_str());
+    if (d == nullptr)
+        return;
+    struct dirent* entry;
+    while ((entry = readdir(d)) != nullptr && files.size() < limit) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+            continue;
+        File file;
+        file.path = dir + '/' + entry->d_name;
+        if (lstat(file.path.c_str(), &file.statbuf) != 0)
+            continue;
+        if (S_ISDIR(file.statbuf.st_mode))
+            collect(file.path, files, limit);
+        else if (S_ISREG(file.statbuf.st_mode))
+            files.push_back(file);
+    }
+    closedir(d);
+}
+
+static std::string reload(const File& file)
+{
+    magic_t cookie = magic_open(MAGIC_MIME_TYPE);
+    if (cookie == nullptr)
+        return "";
+    std::string out;
+    if (magic_load(cookie, nullptr) == 0) {
+        const char* mime = magic_file(cookie, file.path.c_str());
+        out = mime != nullptr ? mime : "";
+    }
+    magic_close(cookie);
+    return out;
+}
+
+// detects all files with the given number of threads, returns files per second
+template <typename F>
+static double run(const std::vector<File>& files, int threads, F detect)
+{
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < threads; i++) {
+        workers.emplace_back([&]() {
+            size_t index;
+            while ((index = next++) < files.size())
+                detect(files[index]);
+        });
+    }
+    for (auto& worker : workers)
+        worker.join();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return files.size() / elapsed;
+}
+
+int main(int argc, char** argv)
+{
+    cxxopts::Options options("gerbera-mimebench", "Measures libmagic MIME detection throughput");
+
+    options.add_options()
+    ("d,directory", "Directory with sample files", cxxopts::value<std::string>())
+    ("t,threads", "Number of detecting threads", cxxopts::value<int>()->default_value("1"))
+    ("l,limit", "Maximum number of files", cxxopts::value<size_t>()->default_value("2000"))
+    ("skip-reload", "Do not measure loading the database per file")
+    ("help", "Print this help and exit");
+
+    std::string directory;
+    int threads;
+    size_t limit;
+    bool skipReload;
+    try {
+        auto opts = options.parse(argc, argv);
+        if (opts.count("help") > 0 || opts.count("directory") == 0) {
+            std::cout << options.help() << std::endl;
+            return opts.count("help") > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+        directory = opts["directory"].as<std::string>();
+        threads = opts["threads"].as<int>();
+        limit = opts["limit"].as<size_t>();
+        skipReload = opts.count("skip-reload") > 0;
+    } catch (const cxxopts::OptionException& e) {
+        std::cerr << "Failed to parse arguments: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (threads < 1) {
+        std::cerr << "threads must be positive" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<File> files;
+    collect(directory, files, limit);
+    if (files.empty()) {
+        std::cerr << "No files found in " << directory << std::endl;
+        return EXIT_FAILURE;
+    }
+    printf("Detecting %zu files with %d threads\n\n", files.size(), threads);
+    printf("%-16s %12s\n", "method", "files/s");
+
+    if (!skipReload)
+        printf("%-16s %12.1f\n", "load per file", run(files, threads, reload));
+
+    MimeDetector sessions("", 0);
+    printf("%-16s %12.1f\n", "session, file", run(files, threads, [&](const File& file) { sessions.fromFile(file.path); }));
+    printf("%-16s %12.1f\n", "session, head", run(files, threads, [&](const File& file) { sessions.fromFile(file.path, file.statbuf); }));
+
+    MimeDetector cached("", files.size());
+    run(files, threads, [&](const File& file) { cached.fromFile(file.path, file.statbuf); });
+    printf("%-16s %12.1f\n", "cached", run(files, threads, [&](const File& file) { cached.fromFile(file.path, file.statbuf); }));
+
+    // the head is a shortcut, it must not change the result
+    size_t differences = 0;
+    for (const auto& file : files) {
+        if (sessions.fromFile(file.path) != sessions.fromFile(file.path, file.statbuf))
+            differences++;
+    }
+    printf("\n%zu of %zu files detected differently from the head\n", differences, files.size());
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,252 @@
+/*GRB*
+
+Gerbera - https://gerbera.io/
+
+    tagbench.cc - this file is part of Gerbera.
+
+    Copyright (C) 2016-2019 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file tagbench.cc
+/// \brief Measures the tag reading of the import.
+///
+/// Every audio file below the given directory is read by the TagLib
+/// handler with each read style, first with all fields and then with the
+/// given fields only. The embedded artwork found is then served once from
+/// the offset recorded on import and once by parsing the tags as before.
+
+#include <chrono>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+#include "cds_objects.h"
+#include "cds_resource.h"
+#include "config/config_generator.h"
+#include "config/config_manager.h"
+#include "contrib/cxxopts.hpp"
+#include "metadata/taglib_handler.h"
+#include "util/tools.h"
+
+static const char* const CONTENT_TYPES[] = {
+    CONTENT_TYPE_MP3, CONTENT_TYPE_FLAC, CONTENT_TYPE_MP4, CONTENT_TYPE_OGG,
+    CONTENT_TYPE_APE, CONTENT_TYPE_WMA, CONTENT_TYPE_WAVPACK, CONTENT_TYPE_AIFF
+};
+
+struct File {
+    std::string path;
+    std::string mimeType;
+};
+
+static void collect(const std::string& dir, std::shared_ptr<ConfigManager> config, std::vector<File>& files, size_t limit)
+{
+    auto extensions = config->getDictionaryOption(CFG_IMPORT_MAPPINGS_EXTENSION_TO_MIMETYPE_LIST);
+    auto contentTypes = config->getDictionaryOption(CFG_IMPORT_MAPPINGS_MIMETYPE_TO_CONTENTTYPE_LIST);
+    DIR* d = opendir(dir.c_str());
+    if (d == nullptr)
+        return;
+    struct dirent* entry;
+    while ((entry = readdir(d)) != nullptr && files.size() < limit) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+            continue;
+        File file;
+        file.path = dir + '/' + entry->d_name;
+        struct stat statbuf;
+        if (lstat(file.path.c_str(), &statbuf) != 0)
+            continue;
+        if (S_ISDIR(statbuf.st_mode)) {
+            collect(file.path, config, files, limit);
+            continue;
+        }
+        size_t dot = file.path.rfind('.');
+        if (!S_ISREG(statbuf.st_mode) || dot == std::string::npos)
+            continue;
+        file.mimeType = getValueOrDefault(extensions, tolower_string(file.path.substr(dot + 1)));
+        if (!startswith(file.mimeType, "audio/"))
+            continue;
+        std::string contentType = getValueOrDefault(contentTypes, file.mimeType);
+        for (const char* handled : CONTENT_TYPES) {
+            if (contentType == handled) {
+                files.push_back(file);
+                break;
+            }
+        }
+    }
+    closedir(d);
+}
+
+// writes a generated configuration with the given <id3> options
+static std::shared_ptr<ConfigManager> createConfig(const std::string& home, const std::string& id3)
+{
+    std::string confdir = ".config";
+    for (auto dir : { home, home + "/web", home + "/js", home + '/' + confdir })
+        mkdir(dir.c_str(), 0777);
+    for (auto script : { "common.js", "import.js", "playlists.js" })
+        std::ofstream(home + "/js/" + script, std::ios::app);
+
+    ConfigGenerator configGenerator;
+    std::string config = configGenerator.generate(home, confdir, home, "");
+    config.insert(config.find("</import>"), "<library-options>" + id3 + "</library-options>");
+    std::string configFile = home + '/' + confdir + "/config.xml";
+    std::ofstream(configFile) << config;
+    return std::make_shared<ConfigManager>(configFile, home, confdir, home, "", "", "", 0, false);
+}
+
+static std::shared_ptr<CdsItem> createItem(const File& file)
+{
+    auto item = std::make_shared<CdsItem>(nullptr);
+    item->setLocation(file.path);
+    item->setMimeType(file.mimeType);
+    return item;
+}
+
+// returns the files per second and the items read by the last of the runs
+static double readTags(std::shared_ptr<ConfigManager> config, const std::vector<File>& files, int runs, std::vector<std::shared_ptr<CdsItem>>& items)
+{
+    TagLibHandler handler(config);
+    auto start = std::chrono::steady_clock::now();
+    for (int run = 0; run < runs; run++) {
+        items.clear();
+        for (const auto& file : files) {
+            auto item = createItem(file);
+            try {
+                handler.fillMetadata(item);
+            } catch (const std::exception& e) {
+                // broken files cost the same on every run
+            }
+            items.push_back(item);
+        }
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return files.size() * runs / elapsed;
+}
+
+// serves the artwork of the items, returns the pictures per second
+static double serveArtwork(std::shared_ptr<ConfigManager> config, const std::vector<std::pair<std::shared_ptr<CdsItem>, int>>& artwork, int runs)
+{
+    TagLibHandler handler(config);
+    char buf[64 * 1024];
+    auto start = std::chrono::steady_clock::now();
+    for (int run = 0; run < runs; run++) {
+        for (const auto& art : artwork) {
+            auto io = handler.serveContent(art.first, art.second);
+            io->open(UPNP_READ);
+            while (io->read(buf, sizeof(buf)) > 0) {
+            }
+            io->close();
+        }
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return artwork.size() * runs / elapsed;
+}
+
+int main(int argc, char** argv)
+{
+    cxxopts::Options options("gerbera-tagbench", "Measures TagLib tag reading and artwork serving");
+
+    options.add_options()
+    ("d,directory", "Directory with audio files", cxxopts::value<std::string>())
+    ("home", "Directory for the generated configuration", cxxopts::value<std::string>()->default_value("/tmp/gerbera-tagbench"))
+    ("fields", "Fields read in the second pass, comma separated", cxxopts::value<std::string>()->default_value("M_TITLE,M_ARTIST,M_ALBUM,M_TRACKNUMBER"))
+    ("l,limit", "Maximum number of files", cxxopts::value<size_t>()->default_value("2000"))
+    ("r,runs", "Passes over the files per measurement", cxxopts::value<int>()->default_value("1"))
+    ("help", "Print this help and exit");
+
+    std::string directory;
+    std::string home;
+    std::string fields;
+    size_t limit;
+    int runs;
+    try {
+        auto opts = options.parse(argc, argv);
+        if (opts.count("help") > 0 || opts.count("directory") == 0) {
+            std::cout << options.help() << std::endl;
+            return opts.count("help") > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+        directory = opts["directory"].as<std::string>();
+        home = opts["home"].as<std::string>();
+        fields = opts["fields"].as<std::string>();
+        limit = opts["limit"].as<size_t>();
+        runs = opts["runs"].as<int>();
+    } catch (const cxxopts::OptionException& e) {
+        std::cerr << "Failed to parse arguments: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (runs < 1) {
+        std::cerr << "runs must be positive" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::string selection = "<metadata>";
+    for (const auto& field : split_string(fields, ','))
+        selection += "<add-data tag=\"" + trim_string(field) + "\"/>";
+    selection += "</metadata>";
+
+    try {
+        std::vector<File> files;
+        collect(directory, createConfig(home, "<id3/>"), files, limit);
+        if (files.empty()) {
+            std::cerr << "No audio files found in " << directory << std::endl;
+            return EXIT_FAILURE;
+        }
+        printf("Reading %zu files %d times\n\n", files.size(), runs);
+        printf("%-10s %-10s %12s\n", "style", "fields", "files/s");
+
+        std::vector<std::shared_ptr<CdsItem>> items;
+        for (auto style : { "accurate", "average", "fast" }) {
+            std::string id3 = std::string("<id3 read-style=\"") + style + "\"";
+            printf("%-10s %-10s %12.1f\n", style, "all", readTags(createConfig(home, id3 + "/>"), files, runs, items));
+            printf("%-10s %-10s %12.1f\n", style, "selected", readTags(createConfig(home, id3 + ">" + selection + "</id3>"), files, runs, items));
+        }
+
+        // the items of the last pass are the ones a fast import creates
+        auto config = createConfig(home, "<id3/>");
+        std::vector<std::pair<std::shared_ptr<CdsItem>, int>> withOffset;
+        std::vector<std::pair<std::shared_ptr<CdsItem>, int>> withoutOffset;
+        for (const auto& item : items) {
+            for (int i = 0; i < item->getResourceCount(); i++) {
+                auto resource = item->getResource(i);
+                if (resource->getHandlerType() != CH_ID3)
+                    continue;
+                if (string_ok(resource->getOption(RESOURCE_OPTION_ARTWORK_OFFSET))) {
+                    withOffset.emplace_back(item, i);
+                    // the same picture as the import without offsets served it
+                    auto copy = std::static_pointer_cast<CdsItem>(CdsObject::createObject(nullptr, item->getObjectType()));
+                    item->copyTo(copy);
+                    copy->getResource(i)->addOption(RESOURCE_OPTION_ARTWORK_OFFSET, "");
+                    withoutOffset.emplace_back(copy, i);
+                }
+                break;
+            }
+        }
+        printf("\n%zu of %zu files have artwork stored at a known offset\n", withOffset.size(), files.size());
+        if (!withOffset.empty()) {
+            printf("%-21s %12s\n", "artwork", "pictures/s");
+            printf("%-21s %12.1f\n", "from offset", serveArtwork(config, withOffset, runs));
+            printf("%-21s %12.1f\n", "parsing the tags", serveArtwork(config, withoutOffset, runs));
+        }
+    } catch (const Exception& e) {
+        std::cerr << e.getMessage() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}